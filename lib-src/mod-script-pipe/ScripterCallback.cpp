@@ -59,6 +59,10 @@ typedef enum
 
 
 extern void PipeServer();
+#if !defined(WIN32)
+extern void SocketServer(tpPostScriptCommandFunc postFn,
+                         tpReceiveScriptResponseFunc receiveFn);
+#endif
 typedef SCRIPT_PIPE_DLL_IMPORT int (*tpExecScriptServerFunc)( wxString * pIn, wxString * pOut);
 static tpExecScriptServerFunc pScriptServerFn=NULL;
 
@@ -111,6 +115,19 @@ int SCRIPT_PIPE_DLL_API RegScriptServerFunc( tpExecScriptServerFunc pFn )
    return 4;
 }
 
+#if !defined(WIN32)
+// Registration for the socket server, which keeps several commands in
+// flight.  It runs on threads of its own, so this returns at once.
+int SCRIPT_PIPE_DLL_API RegScriptSocketFunc( tpPostScriptCommandFunc postFn,
+                                             tpReceiveScriptResponseFunc receiveFn )
+{
+   if( postFn && receiveFn )
+      SocketServer( postFn, receiveFn );
+
+   return 4;
+}
+#endif
+
 
 wxString Str2;
 wxArrayString aStr;
@@ -37,3 +37,12 @@
    #endif
 #endif
 
+#include <string>
+
+class wxString;
+
+// These must match the typedefs in ScriptCommandRelay.h
+typedef int (*tpPostScriptCommandFunc)(int id, wxString *pIn,
+                                       std::string *pData, wxString *pError);
+typedef int (*tpReceiveScriptResponseFunc)(int *pId, wxString *pOut,
+                                           std::string *pData);
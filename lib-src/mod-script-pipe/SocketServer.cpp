@@ -0,0 +1,436 @@
+// SocketServer.cpp :
+//
+// Serves scripts on a Unix domain socket, with a framed binary protocol.
+// Unlike the pipe, a script may send many commands without waiting for
+// the answers, and commands can carry binary data both ways, such as the
+// samples moved by GetTrackAudio and SetTrackAudio.
+//
+// Every message, in either direction, is a header of six 32-bit words in
+// the machine's own byte order:
+//
+//    magic    SOCKET_MAGIC
+//    id       chosen by the script; the response carries the same id
+//    type     kRequest, or kResponse / kError from the server
+//    flags    kFlagShm, or 0
+//    textLen  bytes of UTF-8 text that follow the header
+//    dataLen  bytes of binary data that follow the text
+//
+// A request's text is a command, as it would be written to the pipe, and
+// its data is the command's binary input.  A response's text is the lines
+// the command printed, and its data is any binary output.  Responses are
+// sent as the commands finish, and need not come in the order the
+// requests were sent.
+//
+// With kFlagShm the data of a request is instead the name of a POSIX
+// shared memory object.  Its whole contents are the command's input, and
+// the command's output is written back into it, the object being resized
+// to fit; the response then has the flag set and no data of its own.
+//
+// Enabling other programs to connect to Audacity via a socket is a
+// potential security risk.  Use at your own risk.
+
+#if !defined(WIN32)
+
+#include <wx/wx.h>
+#include <wx/thread.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+
+#include <map>
+#include <string>
+
+#include "ScripterCallback.h"
+
+const char sockettmpl[] = "/tmp/audacity_script_socket.%d";
+
+const uint32_t SOCKET_MAGIC = 0x53445541; // "AUDS"
+
+enum
+{
+   kRequest = 1,
+   kResponse = 2,
+   kError = 3
+};
+
+enum
+{
+   kFlagShm = 1
+};
+
+struct FrameHeader
+{
+   uint32_t magic;
+   uint32_t id;
+   uint32_t type;
+   uint32_t flags;
+   uint32_t textLen;
+   uint32_t dataLen;
+};
+
+// Larger messages are taken to be garbage, and end the connection
+const uint32_t kMaxText = 1 << 20;
+const uint32_t kMaxData = 1 << 30;
+
+static tpPostScriptCommandFunc pPostFn = NULL;
+static tpReceiveScriptResponseFunc pReceiveFn = NULL;
+
+// A request that has been posted and not yet answered
+struct Pending
+{
+   uint32_t clientId;
+   int connection;
+   std::string shmName;
+   wxString error;
+   std::string text;
+   std::string data;
+};
+
+// sMutex guards the pending requests, and sWriteMutex the connection, so
+// that a script slow to read its responses doesn't hold up its requests
+static wxMutex sMutex;
+static std::map<int, Pending> sPending;
+static int sNextId = 1;
+
+static wxMutex sWriteMutex;
+static int sConnection = 0;   // counts the connections accepted
+static int sClientFd = -1;
+
+static bool ReadFully(int fd, void *buffer, size_t len)
+{
+   char *p = (char *)buffer;
+   while (len > 0)
+   {
+      ssize_t got = read(fd, p, len);
+      if (got < 0 && errno == EINTR)
+         continue;
+      if (got <= 0)
+         return false;
+      p += got;
+      len -= got;
+   }
+   return true;
+}
+
+// Writing to a socket the script has closed must not raise SIGPIPE,
+// which would end Audacity; where there is no MSG_NOSIGNAL, the socket
+// has SO_NOSIGPIPE set instead when it is accepted
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
+// False if the script has gone (EPIPE) or the connection failed
+static bool WriteFully(int fd, const void *buffer, size_t len)
+{
+   const char *p = (const char *)buffer;
+   while (len > 0)
+   {
+      ssize_t put = send(fd, p, len, MSG_NOSIGNAL);
+      if (put < 0 && errno == EINTR)
+         continue;
+      if (put <= 0)
+         return false;
+      p += put;
+      len -= put;
+   }
+   return true;
+}
+
+static bool ReadShm(const std::string &name, std::string &data)
+{
+   int fd = shm_open(name.c_str(), O_RDONLY, 0);
+   if (fd < 0)
+      return false;
+
+   bool ok = false;
+   struct stat st;
+   if (fstat(fd, &st) == 0)
+   {
+      if (st.st_size == 0)
+      {
+         data.clear();
+         ok = true;
+      }
+      else
+      {
+         void *p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+         if (p != MAP_FAILED)
+         {
+            data.assign((const char *)p, st.st_size);
+            munmap(p, st.st_size);
+            ok = true;
+         }
+      }
+   }
+
+   close(fd);
+   return ok;
+}
+
+static bool WriteShm(const std::string &name, const std::string &data)
+{
+   int fd = shm_open(name.c_str(), O_RDWR, 0);
+   if (fd < 0)
+      return false;
+
+   bool ok = ftruncate(fd, data.size()) == 0;
+   if (ok && !data.empty())
+   {
+      void *p = mmap(NULL, data.size(), PROT_WRITE, MAP_SHARED, fd, 0);
+      ok = p != MAP_FAILED;
+      if (ok)
+      {
+         memcpy(p, data.data(), data.size());
+         munmap(p, data.size());
+      }
+   }
+
+   close(fd);
+   return ok;
+}
+
+// Call with sWriteMutex held, so that frames are not interleaved
+static void SendFrame(int fd, uint32_t id, uint32_t type, uint32_t flags,
+                      const std::string &text, const std::string &data)
+{
+   FrameHeader header;
+   header.magic = SOCKET_MAGIC;
+   header.id = id;
+   header.type = type;
+   header.flags = flags;
+   header.textLen = text.size();
+   header.dataLen = data.size();
+
+   // If the script has gone, shut the connection down, so that the read
+   // on the other thread fails and closes it
+   if (!WriteFully(fd, &header, sizeof(header)) ||
+       !WriteFully(fd, text.data(), text.size()) ||
+       !WriteFully(fd, data.data(), data.size()))
+   {
+      shutdown(fd, SHUT_RDWR);
+   }
+}
+
+// Collects the pieces of every response, and sends each response when
+// its last piece arrives
+class ResponseThread final : public wxThread
+{
+public:
+   ResponseThread() : wxThread(wxTHREAD_DETACHED) {}
+
+   ExitCode Entry() override
+   {
+      while (true)
+      {
+         int id;
+         wxString msg;
+         std::string data;
+         bool done = pReceiveFn(&id, &msg, &data) != 0;
+
+         Pending pending;
+         {
+            wxMutexLocker locker(sMutex);
+            std::map<int, Pending>::iterator iter = sPending.find(id);
+            if (iter == sPending.end())
+               continue;
+
+            if (!done)
+            {
+               if (!data.empty())
+                  iter->second.data += data;
+               else
+                  iter->second.text += std::string(msg.ToUTF8()) + "\n";
+               continue;
+            }
+
+            pending = std::move(iter->second);
+            sPending.erase(iter);
+         }
+
+         uint32_t type = kResponse;
+         uint32_t flags = 0;
+         if (!pending.error.IsEmpty())
+         {
+            type = kError;
+            pending.text = std::string(pending.error.ToUTF8());
+            pending.data.clear();
+         }
+         else if (!pending.shmName.empty())
+         {
+            flags = kFlagShm;
+            if (!WriteShm(pending.shmName, pending.data))
+            {
+               type = kError;
+               pending.text = "Could not write the shared memory object.\n";
+            }
+            pending.data.clear();
+         }
+
+         // The connection that sent the request may have gone
+         wxMutexLocker locker(sWriteMutex);
+         if (pending.connection == sConnection && sClientFd >= 0)
+         {
+            SendFrame(sClientFd, pending.clientId, type, flags,
+                      pending.text, pending.data);
+         }
+      }
+
+      return 0;
+   }
+};
+
+// Reads requests from one connection until it closes
+static void ServeClient(int fd)
+{
+   int connection;
+   {
+      wxMutexLocker locker(sWriteMutex);
+      connection = ++sConnection;
+      sClientFd = fd;
+   }
+
+   FrameHeader header;
+   while (ReadFully(fd, &header, sizeof(header)))
+   {
+      if (header.magic != SOCKET_MAGIC ||
+          header.type != kRequest ||
+          header.textLen > kMaxText ||
+          header.dataLen > kMaxData)
+         break;
+
+      std::string text(header.textLen, '\0');
+      std::string data(header.dataLen, '\0');
+      if ((header.textLen && !ReadFully(fd, &text[0], header.textLen)) ||
+          (header.dataLen && !ReadFully(fd, &data[0], header.dataLen)))
+         break;
+
+      Pending pending;
+      pending.clientId = header.id;
+      pending.connection = connection;
+
+      if (header.flags & kFlagShm)
+      {
+         pending.shmName = data;
+         if (!ReadShm(pending.shmName, data))
+         {
+            wxMutexLocker locker(sWriteMutex);
+            SendFrame(fd, header.id, kError, 0,
+                      "Could not read the shared memory object.\n", std::string());
+            continue;
+         }
+      }
+
+      wxString cmd = wxString::FromUTF8(text.c_str());
+      cmd.Replace(wxT("\r"), wxT(""));
+      cmd.Replace(wxT("\n"), wxT(""));
+
+      // Registered and posted under the lock, so that the response can't
+      // be collected before the request is known, or before its error is
+      wxMutexLocker locker(sMutex);
+      const int id = sNextId++;
+      if (sNextId <= 0)
+         sNextId = 1;
+      sPending[id] = pending;
+
+      wxString error;
+      if (!pPostFn(id, &cmd, &data, &error))
+         sPending[id].error = error;
+   }
+
+   wxMutexLocker locker(sWriteMutex);
+   sClientFd = -1;
+   close(fd);
+}
+
+class ListenThread final : public wxThread
+{
+public:
+   ListenThread() : wxThread(wxTHREAD_DETACHED) {}
+
+   ExitCode Entry() override
+   {
+      char socketName[sizeof(((struct sockaddr_un *)0)->sun_path)];
+      snprintf(socketName, sizeof(socketName), sockettmpl, (int)getuid());
+      unlink(socketName);
+
+      int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (listenFd < 0)
+      {
+         perror("Unable to create script socket");
+         return 0;
+      }
+
+      struct sockaddr_un addr;
+      memset(&addr, 0, sizeof(addr));
+      addr.sun_family = AF_UNIX;
+      strncpy(addr.sun_path, socketName, sizeof(addr.sun_path) - 1);
+
+      // Only this user may connect.  Nobody can connect before listen(),
+      // so the socket file is closed off in between.  fchmod() on the
+      // socket would not reach the file on Linux, and umask() would
+      // change the mask of every thread.
+      if (bind(listenFd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+          chmod(socketName, S_IRUSR | S_IWUSR) < 0 ||
+          listen(listenFd, 1) < 0)
+      {
+         perror("Unable to listen on script socket");
+         close(listenFd);
+         return 0;
+      }
+
+      // One script at a time, as with the pipe
+      while (true)
+      {
+         int fd = accept(listenFd, NULL, NULL);
+         if (fd < 0)
+         {
+            if (errno == EINTR)
+               continue;
+            break;
+         }
+#if defined(SO_NOSIGPIPE)
+         int on = 1;
+         setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+         ServeClient(fd);
+      }
+
+      close(listenFd);
+      unlink(socketName);
+      return 0;
+   }
+};
+
+void SocketServer(tpPostScriptCommandFunc postFn,
+                  tpReceiveScriptResponseFunc receiveFn)
+{
+   pPostFn = postFn;
+   pReceiveFn = receiveFn;
+
+   ResponseThread *responder = new ResponseThread;
+   if (responder->Create() != wxTHREAD_NO_ERROR)
+   {
+      delete responder;
+      return;
+   }
+   responder->Run();
+
+   ListenThread *listener = new ListenThread;
+   if (listener->Create() != wxTHREAD_NO_ERROR)
+   {
+      delete listener;
+      return;
+   }
+   listener->Run();
+}
+
+#endif
@@ -149,7 +149,9 @@ public:
   pthread_cond_t renderCond[2];
   channel_thread_data channelData[2];
   analyze_thread_data analyzeData[3];
-  bool bActive;
+  // Checked by the wait functions under their mutex, so that a thread
+  // can't start waiting after the destructor has woken it
+  volatile bool bActive;
 };
 
 void *analyzeThreadCB(void *data) {
@@ -390,18 +392,10 @@ ThreadInterface :: ~ThreadInterface()
     pthread_cond_broadcast(&trial2Cond[c]);
     pthread_mutex_unlock(&trial2Mutex[c]);
     pthread_join(trial2Thread[c],NULL);
-    pthread_mutex_lock(&adjust2Mutex);
-    pthread_cond_broadcast(&adjust2Cond);
-    pthread_mutex_unlock(&adjust2Mutex);
-    pthread_join(adjust2Thread,NULL);
     pthread_mutex_lock(&trial1Mutex[c]);
     pthread_cond_broadcast(&trial1Cond[c]);
     pthread_mutex_unlock(&trial1Mutex[c]);
     pthread_join(trial1Thread[c],NULL);
-    pthread_mutex_lock(&adjust1Mutex);
-    pthread_cond_broadcast(&adjust1Cond);
-    pthread_mutex_unlock(&adjust1Mutex);
-    pthread_join(adjust1Thread,NULL);
     if(bRenderThread) {
       pthread_mutex_lock(&renderMutex[c]);
       pthread_cond_broadcast(&renderCond[c]);
@@ -409,6 +403,15 @@ ThreadInterface :: ~ThreadInterface()
       pthread_join(renderThread[c],NULL);
     }
   }
+  // The adjust threads are shared by the channels, so are joined once
+  pthread_mutex_lock(&adjust2Mutex);
+  pthread_cond_broadcast(&adjust2Cond);
+  pthread_mutex_unlock(&adjust2Mutex);
+  pthread_join(adjust2Thread,NULL);
+  pthread_mutex_lock(&adjust1Mutex);
+  pthread_cond_broadcast(&adjust1Cond);
+  pthread_mutex_unlock(&adjust1Mutex);
+  pthread_join(adjust1Thread,NULL);
 }
 
 void ThreadInterface :: signalReadWrite() 
@@ -537,7 +540,7 @@ void ThreadInterface :: waitReadWrite() {
 
 void ThreadInterface :: waitAnalyze(int i) {
   pthread_mutex_lock(&analyzeMutex[i]);
-  if(!top->analyzeInit(i,false)) {
+  if(bActive && !top->analyzeInit(i,false)) {
     pthread_cond_wait(&analyzeCond[i],&analyzeMutex[i]);
   }
   pthread_mutex_unlock(&analyzeMutex[i]);
@@ -545,7 +548,7 @@ void ThreadInterface :: waitAnalyze(int i) {
 
 void ThreadInterface :: waitExtract(int c) {
   pthread_mutex_lock(&extractMutex[c]);
-  if(!top->extractInit(c,false)) {
+  if(bActive && !top->extractInit(c,false)) {
     pthread_cond_wait(&extractCond[c],&extractMutex[c]);
   }
   pthread_mutex_unlock(&extractMutex[c]);
@@ -553,7 +556,7 @@ void ThreadInterface :: waitExtract(int c) {
 
 void ThreadInterface :: waitAssign(int c) {
   pthread_mutex_lock(&assignMutex[c]);
-  if(!top->markInit(c,false) && !top->assignInit(c,false)) {
+  if(bActive && !top->markInit(c,false) && !top->assignInit(c,false)) {
     pthread_cond_wait(&assignCond[c],&assignMutex[c]);
   }
   pthread_mutex_unlock(&assignMutex[c]);
@@ -561,7 +564,7 @@ void ThreadInterface :: waitAssign(int c) {
 
 void ThreadInterface :: waitTrial2(int c) {
   pthread_mutex_lock(&trial2Mutex[c]);
-  if(!top->trial2Init(c,false)) {
+  if(bActive && !top->trial2Init(c,false)) {
     pthread_cond_wait(&trial2Cond[c],&trial2Mutex[c]);
   }
   pthread_mutex_unlock(&trial2Mutex[c]);
@@ -569,7 +572,7 @@ void ThreadInterface :: waitTrial2(int c) {
 
 void ThreadInterface :: waitAdjust2() {
   pthread_mutex_lock(&adjust2Mutex);
-  if(!top->adjust2Init(false)) {
+  if(bActive && !top->adjust2Init(false)) {
     pthread_cond_wait(&adjust2Cond,&adjust2Mutex);
   }
   pthread_mutex_unlock(&adjust2Mutex);
@@ -577,7 +580,7 @@ void ThreadInterface :: waitAdjust2() {
 
 void ThreadInterface :: waitTrial1(int c) {
   pthread_mutex_lock(&trial1Mutex[c]);
-  if(!top->trial1Init(c,false)) {
+  if(bActive && !top->trial1Init(c,false)) {
     pthread_cond_wait(&trial1Cond[c],&trial1Mutex[c]);
   }
   pthread_mutex_unlock(&trial1Mutex[c]);
@@ -585,7 +588,7 @@ void ThreadInterface :: waitTrial1(int c) {
 
 void ThreadInterface :: waitAdjust1() {
   pthread_mutex_lock(&adjust1Mutex);
-  if(!top->adjust1Init(false)) {
+  if(bActive && !top->adjust1Init(false)) {
     pthread_cond_wait(&adjust1Cond,&adjust1Mutex);
   }
   pthread_mutex_unlock(&adjust1Mutex);
@@ -593,7 +596,7 @@ void ThreadInterface :: waitAdjust1() {
 
 void ThreadInterface :: waitRender(int c) {
   pthread_mutex_lock(&renderMutex[c]);
-  if(!top->renderInit(c,false)) {
+  if(bActive && !top->renderInit(c,false)) {
     pthread_cond_wait(&renderCond[c],&renderMutex[c]);
   }
   pthread_mutex_unlock(&renderMutex[c]);
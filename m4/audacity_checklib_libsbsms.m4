@@ -30,8 +30,9 @@ AC_DEFUN([AUDACITY_CHECKLIB_LIBSBSMS], [
                  LIBSBSMS_LOCAL_AVAILABLE="no")
 
    if test "$LIBSBSMS_LOCAL_AVAILABLE" = "yes"; then
-      dnl do not build programs we don't need
-      LIBSBSMS_LOCAL_CONFIGURE_ARGS="--disable-programs"
+      dnl do not build programs we don't need, and let the analysis and
+      dnl synthesis of each band run on threads of their own
+      LIBSBSMS_LOCAL_CONFIGURE_ARGS="--disable-programs --enable-multithreaded"
       AC_MSG_NOTICE([libsbsms libraries are available in the local tree])
    else
       AC_MSG_NOTICE([libsbsms libraries are NOT available in the local tree])
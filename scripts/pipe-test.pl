@@ -74,7 +74,7 @@ sub stopTiming{
 sub sendCommand{
    my $command = shift;
    if ($^O eq 'MSWin32') {
-      print TO_SRV "$command\r\n\0";
+      print TO_SRV "$command\r\n\0";
    } else {
       # Don't explicitly send \0 on Linux or reads after the first one fail...
       print TO_SRV "$command\n";
@@ -481,6 +481,86 @@ sub printHeading{
    print "$line\n$msg\n$line\n\n";
 }
 
+###############################################################################
+#  On-demand import testing                                                   #
+###############################################################################
+
+# Select the given range of tracks, over the length of the first
+sub selectTracks{
+   my $first = shift;
+   my $last = shift;
+   sendCommand("GetTrackInfo: Type=EndTime TrackIndex=$first");
+   my @resps = getResponses();
+   my $endTime = shift(@resps);
+   doCommand("Select: Mode=Range FirstTrack=$first LastTrack=$last StartTime=0.0 EndTime=$endTime");
+}
+
+# Compare tracks 0 and 1.  Blocks not yet decoded read as silence, so give
+# the decoding time, and return the samples that still differ.
+sub compareWhenDecoded{
+   my $threshold = shift;
+   my @res;
+   for my $wait (0 .. 60) {
+      sleep(1.0) if $wait;
+      selectTracks(0, 1);
+      @res = compareAudio($threshold);
+      last if $res[0] == 0;
+   }
+   return $res[0];
+}
+
+# Export a chirp as FLAC, which always imports on demand, and check it
+# against a WAV export of the same chirp.  The two exports are dithered
+# separately, so they may differ in the last bits.
+sub testODImportFLAC{
+   my $dirname = shift;
+   my $wavFile = $dirname . "od-chirp.wav";
+   my $flacFile = $dirname . "od-chirp.flac";
+
+   deleteAll();
+   generateBase();
+   doCommand("Export: Mode=All Filename=$wavFile Channels=1");
+   doCommand("Export: Mode=All Filename=$flacFile Channels=1");
+
+   deleteAll();
+   doCommand("Import: Filename=$wavFile");
+   doCommand("Import: Filename=$flacFile");
+   return compareWhenDecoded(0.001);
+}
+
+# Export a chirp through FFmpeg, and check that importing it on demand
+# gives the same samples as decoding it up front
+sub testODImportFFmpeg{
+   my $dirname = shift;
+   my $file = $dirname . "od-chirp.m4a";
+   my $origOD = getPref("/Library/FFmpegOnDemand");
+
+   deleteAll();
+   generateBase();
+   doCommand("Export: Mode=All Filename=$file Channels=1");
+
+   deleteAll();
+   setPref("/Library/FFmpegOnDemand", 0);
+   doCommand("Import: Filename=$file");
+   setPref("/Library/FFmpegOnDemand", 1);
+   doCommand("Import: Filename=$file");
+   setPref("/Library/FFmpegOnDemand", $origOD);
+   return compareWhenDecoded(0.0);
+}
+
+sub testODImport{
+   my $dirname = shift;
+   my %results = ();
+   $results{ "FLAC" } = testODImportFLAC($dirname);
+   $results{ "FFmpeg" } = testODImportFFmpeg($dirname);
+
+   printHeading("On-demand import results");
+   print "Decoder\tSamples\n\n";
+   for my $decoder (sort keys %results) {
+      print "$decoder\t$results{ $decoder }\n";
+   }
+}
+
 ###############################################################################
 
 startUp();
@@ -489,5 +569,6 @@ startUp();
 
 exportEffects($effectTestDir);
 testEffects($effectTestDir);
+testODImport($effectTestDir);
 
 finish();
@@ -102,6 +102,10 @@ It handles initialization and termination by subclassing wxApp.
 
 #include "import/Import.h"
 
+#if defined(USE_NYQUIST)
+#include "effects/nyquist/NyquistPool.h"
+#endif
+
 #include "Experimental.h"
 
 #if defined(EXPERIMENTAL_CRASH_REPORT)
@@ -314,6 +318,8 @@ void QuitAudacity(bool bForce)
    //release ODManager Threads
    ODManager::Quit();
 
+   WaveClip::StopDisplayWorker();
+
    //print out profile if we have one by deleting it
    //temporarilly commented out till it is added to all projects
    //DELETE Profiler::Instance();
@@ -1168,6 +1174,14 @@ AudacityApp::~AudacityApp()
 // main frame
 bool AudacityApp::OnInit()
 {
+#if defined(USE_NYQUIST)
+   // A helper started by NyquistPool runs no user interface at all
+   if (argc > 1 && argv[1] == NYQUIST_WORKER_ARG) {
+      NyquistWorkerMain();
+      return false;
+   }
+#endif
+
    // JKC: ANSWER-ME: Who actually added the event loop guarantor?
    // Although 'blame' says Leland, I think it came from a donated patch.
 
@@ -1893,19 +1893,18 @@ int AudioIO::StartStream(const WaveTrackArray &playbackTracks,
             }
 
             mCaptureBuffers = new RingBuffer* [mCaptureTracks.size()];
-            mResample = new Resample* [mCaptureTracks.size()];
             mFactor = sampleRate / mRate;
 
             // Set everything to zero in case we have to DELETE these due to a memory exception.
             memset(mCaptureBuffers, 0, sizeof(RingBuffer*)*mCaptureTracks.size());
-            memset(mResample, 0, sizeof(Resample*)*mCaptureTracks.size());
 
             for( unsigned int i = 0; i < mCaptureTracks.size(); i++ )
             {
                mCaptureBuffers[i] = new RingBuffer( mCaptureTracks[i]->GetSampleFormat(),
                                                     captureBufferSize );
-               mResample[i] = new Resample(true, mFactor, mFactor); // constant rate resampling
             }
+            // constant rate resampling of all channels at once
+            mResample = new Resample(true, mFactor, mFactor, mCaptureTracks.size());
          }
       }
       catch(std::bad_alloc&)
@@ -2103,9 +2102,7 @@ void AudioIO::StartStreamCleanup(bool bOnlyBuffers)
 
    if(mResample)
    {
-      for (unsigned int i = 0; i < mCaptureTracks.size(); i++)
-         delete mResample[i];
-      delete [] mResample;
+      delete mResample;
       mResample = NULL;
    }
 
@@ -2464,7 +2461,6 @@ void AudioIO::StopStream()
          for (unsigned int i = 0; i < mCaptureTracks.size(); i++)
             {
                delete mCaptureBuffers[i];
-               delete mResample[i];
 
                WaveTrack* track = mCaptureTracks[i];
                track->Flush();
@@ -2513,7 +2509,8 @@ void AudioIO::StopStream()
             }
 
          delete[] mCaptureBuffers;
-         delete[] mResample;
+         delete mResample;
+         mResample = NULL;
       }
    }
 
@@ -3640,6 +3637,31 @@ void AudioIO::FillBuffers()
          AutoSaveFile blockFileLog;
          int numChannels = mCaptureTracks.size();
 
+         // When re-sampling, convert all channels in one call first
+         int size = 0;
+         SampleBuffer resampled;
+         std::vector<float *> outBuffers(numChannels);
+         if( mFactor != 1.0 )
+         {
+            int avail = commonlyAvail;
+            size = lrint(avail * mFactor);
+            SampleBuffer captured(avail * numChannels, floatSample);
+            resampled.Allocate(size * numChannels, floatSample);
+            std::vector<float *> inBuffers(numChannels);
+            for( i = 0; (int)i < numChannels; i++ )
+            {
+               inBuffers[i] = (float *)captured.ptr() + i * avail;
+               outBuffers[i] = (float *)resampled.ptr() + i * size;
+               mCaptureBuffers[i]->Get((samplePtr)inBuffers[i], floatSample, avail);
+            }
+            /* we are re-sampling on the fly. The last resampling call
+             * must flush any samples left in the rate conversion buffer
+             * so that they get recorded
+             */
+            size = mResample->Process(mFactor, &inBuffers[0], avail, !IsStreamActive(),
+                                      &avail, &outBuffers[0], size);
+         }
+
          for( i = 0; (int)i < numChannels; i++ )
          {
             int avail = commonlyAvail;
@@ -3656,17 +3678,7 @@ void AudioIO::FillBuffers()
             }
             else
             {
-               int size = lrint(avail * mFactor);
-               SampleBuffer temp1(avail, floatSample);
-               SampleBuffer temp2(size, floatSample);
-               mCaptureBuffers[i]->Get(temp1.ptr(), floatSample, avail);
-               /* we are re-sampling on the fly. The last resampling call
-                * must flush any samples left in the rate conversion buffer
-                * so that they get recorded
-                */
-               size = mResample[i]->Process(mFactor, (float *)temp1.ptr(), avail, !IsStreamActive(),
-                                            &size, (float *)temp2.ptr(), size);
-               mCaptureTracks[i]-> Append(temp2.ptr(), floatSample, size, 1,
+               mCaptureTracks[i]-> Append((samplePtr)outBuffers[i], floatSample, size, 1,
                                           &appendLog);
             }
 
@@ -553,7 +553,7 @@ private:
 #ifdef EXPERIMENTAL_MIDI_OUT
    std::unique_ptr<AudioThread> mMidiThread;
 #endif
-   Resample          **mResample;
+   Resample           *mResample; // converts all capture channels together
    RingBuffer        **mCaptureBuffers;
    WaveTrackArray      mCaptureTracks;
    RingBuffer        **mPlaybackBuffers;
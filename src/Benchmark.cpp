@@ -28,6 +28,7 @@ of the BlockFile system.
 #include <wx/msgdlg.h>
 #include <wx/sizer.h>
 #include <wx/stattext.h>
+#include <wx/thread.h>
 #include <wx/timer.h>
 #include <wx/utils.h>
 #include <wx/valgen.h>
@@ -42,6 +43,13 @@ of the BlockFile system.
 
 #include "FileDialog.h"
 
+#if USE_SBSMS
+#include <algorithm>
+#include <vector>
+#include "sbsms.h"
+using namespace _sbsms_;
+#endif
+
 class BenchmarkDialog final : public wxDialogWrapper
 {
 public:
@@ -57,6 +65,8 @@ private:
    void OnClear( wxCommandEvent &event );
    void OnClose( wxCommandEvent &event );
 
+   void RunSBSMS(long randSeed);
+
    void Printf(const wxChar *format, ...);
    void HoldPrint(bool hold);
    void FlushPrint();
@@ -71,6 +81,7 @@ private:
 
    bool      mBlockDetail;
    bool      mEditDetail;
+   bool      mSBSMS;
 
    wxTextCtrl  *mText;
 
@@ -139,6 +150,7 @@ BenchmarkDialog::BenchmarkDialog(wxWindow *parent):
 
    mBlockDetail = false;
    mEditDetail = false;
+   mSBSMS = false;
 
    HoldPrint(false);
 
@@ -206,6 +218,13 @@ void BenchmarkDialog::MakeBenchmarkDialog()
                            wxT("false"));
       item->SetValidator(wxGenericValidator(&mEditDetail));
 
+#if USE_SBSMS
+      //
+      item = S.AddCheckBox(wxT("Time SBSMS tempo changes"),
+                           wxT("false"));
+      item->SetValidator(wxGenericValidator(&mSBSMS));
+#endif
+
       //
       mText = S.Id(StaticTextID).AddTextWindow(wxT(""));
       mText->SetName(wxT("Output"));
@@ -298,6 +317,93 @@ void BenchmarkDialog::FlushPrint()
    mToPrint = wxT("");
 }
 
+#if USE_SBSMS
+
+namespace {
+
+// Feeds SBSMS white noise, as fast as it asks for it
+class BenchmarkSBSMSInterface final : public SBSMSInterfaceSliding
+{
+public:
+   BenchmarkSBSMSInterface(Slide *rateSlide, Slide *pitchSlide,
+                           SampleCountType samples, SBSMSQuality *quality)
+      : SBSMSInterfaceSliding(rateSlide, pitchSlide, false, samples, 0, quality)
+      , mRemaining(samples)
+   {
+   }
+
+   long samples(audio *buf, long n) override
+   {
+      n = (long)std::min((SampleCountType)n, mRemaining);
+      for (long i = 0; i < n; i++) {
+         buf[i][0] = 2.0f * rand() / RAND_MAX - 1.0f;
+         buf[i][1] = 2.0f * rand() / RAND_MAX - 1.0f;
+      }
+      mRemaining -= n;
+      return n;
+   }
+
+private:
+   SampleCountType mRemaining;
+};
+
+}
+
+// SBSMS runs a fixed set of threads for each channel when libsbsms is built
+// with --enable-multithreaded, and none otherwise.  Compare the times printed
+// by builds with and without it, and between mono and stereo.
+void BenchmarkDialog::RunSBSMS(long randSeed)
+{
+   const int seconds = 30;
+   const SampleCountType samplesIn = seconds * 44100;
+   const long outBlockSize = 4096;
+
+   Printf(wxT("Timing SBSMS on %d s of noise at 44100 Hz, %d processors...\n"),
+          seconds, wxThread::GetCPUCount());
+   FlushPrint();
+   wxTheApp->Yield();
+
+   srand(randSeed);
+
+   SBSMSQuality quality(&SBSMSQualityStandard);
+   std::vector<audio> outBuf(outBlockSize);
+   wxStopWatch timer;
+
+   for (int channels = 1; channels <= 2; channels++) {
+      // A slowdown, and a speedup with a pitch change
+      const float rates[] = { 0.8f, 1.25f };
+      const float pitches[] = { 1.0f, 1.5f };
+      for (int i = 0; i < 2; i++) {
+         Slide rateSlide(SlideConstant, rates[i], rates[i]);
+         Slide pitchSlide(SlideConstant, pitches[i], pitches[i]);
+         BenchmarkSBSMSInterface iface(&rateSlide, &pitchSlide, samplesIn, &quality);
+         SBSMS sbsms(channels, &quality, true);
+
+         const SampleCountType samplesOut = iface.getSamplesToOutput();
+         SampleCountType done = 0;
+
+         timer.Start();
+         while (done < samplesOut) {
+            long n = (long)std::min((SampleCountType)outBlockSize, samplesOut - done);
+            n = sbsms.read(&iface, &outBuf[0], n);
+            if (n == 0)
+               break;
+            done += n;
+         }
+         long elapsed = timer.Time();
+
+         Printf(wxT("SBSMS, %d channel(s), rate %.2f, pitch %.2f: %ld ms ")
+                wxT("(%.1f x real time)\n"),
+                channels, rates[i], pitches[i], elapsed,
+                seconds / std::max(elapsed / 1000.0, 0.001));
+         FlushPrint();
+         wxTheApp->Yield();
+      }
+   }
+}
+
+#endif
+
 void BenchmarkDialog::OnRun( wxCommandEvent & WXUNUSED(event))
 {
    TransferDataFromWindow();
@@ -523,6 +629,11 @@ void BenchmarkDialog::OnRun( wxCommandEvent & WXUNUSED(event))
           wxT("simultaneous tracks that could be played at once: %.1f\n"),
           (nChunks*chunkSize/44100.0)/(elapsed/1000.0));
 
+#if USE_SBSMS
+   if (mSBSMS)
+      RunSBSMS(randSeed);
+#endif
+
    goto success;
 
  fail:
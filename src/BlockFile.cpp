@@ -40,6 +40,14 @@ counts.
 over multiple samples, which in turn allows rapid drawing when zoomed
 out.
 
+*//****************************************************************//**
+
+\class SampleStats
+\brief Sum, clipped sample count and a coarse magnitude histogram of a
+run of samples, kept for each BlockFile so that analyses such as DC
+offset, clip finding and silence detection can answer whole blocks
+without reading them.
+
 *//*******************************************************************/
 
 #include "Audacity.h"
@@ -47,13 +55,17 @@ out.
 
 #include <float.h>
 #include <math.h>
+#include <string.h>
+#include <stdint.h>
 
 #include <wx/utils.h>
 #include <wx/filefn.h>
 #include <wx/ffile.h>
 #include <wx/log.h>
 #include <wx/math.h>
+#include <wx/tokenzr.h>
 
+#include "AudacityApp.h"
 #include "Internat.h"
 #include "MemoryX.h"
 
@@ -87,6 +99,111 @@ SummaryInfo::SummaryInfo(sampleCount samples)
    totalSummaryBytes = offset256 + (frames256 * bytesPerFrame);
 }
 
+void SampleStats::Clear()
+{
+   count = 0;
+   sum = 0.0;
+   clipped = 0;
+   for (int i = 0; i < nBins; i++)
+      histogram[i] = 0;
+}
+
+// static
+int SampleStats::BinOf(float value)
+{
+   // The octave is the binary exponent, so take it straight from the bits
+   uint32_t bits;
+   memcpy(&bits, &value, sizeof(bits));
+   const int exponent = (bits >> 23) & 0xff;
+   const int bin = 126 - exponent;
+   return bin < 0 ? 0 : (bin >= nBins ? nBins - 1 : bin);
+}
+
+void SampleStats::Accumulate(const float *buffer, sampleCount len)
+{
+   double total = 0.0;
+   for (sampleCount i = 0; i < len; i++) {
+      const float value = buffer[i];
+      total += value;
+      if (fabs(value) >= MAX_AUDIO)
+         clipped++;
+      histogram[BinOf(value)]++;
+   }
+   sum += total;
+   count += len;
+}
+
+void SampleStats::AccumulateSilence(sampleCount len)
+{
+   histogram[nBins - 1] += len;
+   count += len;
+}
+
+SampleStats &SampleStats::operator+= (const SampleStats &other)
+{
+   count += other.count;
+   sum += other.sum;
+   clipped += other.clipped;
+   for (int i = 0; i < nBins; i++)
+      histogram[i] += other.histogram[i];
+   return *this;
+}
+
+sampleCount SampleStats::CountBelow(float level) const
+{
+   // Bins whose upper edge, 2^-k, does not exceed the level
+   sampleCount result = 0;
+   for (int k = 1; k < nBins; k++)
+      if (ldexp(1.0, -k) <= level)
+         result += histogram[k];
+   return result;
+}
+
+sampleCount SampleStats::CountAtLeast(float level) const
+{
+   // Bins whose lower edge, 2^-(k+1), is not below the level
+   sampleCount result = 0;
+   for (int k = 0; k < nBins - 1; k++)
+      if (ldexp(1.0, -(k + 1)) >= level)
+         result += histogram[k];
+   return result;
+}
+
+wxString SampleStats::ToString() const
+{
+   wxString result = wxString::Format(wxT("%lld %s %lld"),
+      (long long) count, Internat::ToString(sum, 12).c_str(), (long long) clipped);
+   for (int i = 0; i < nBins; i++)
+      result += wxString::Format(wxT(" %lld"), (long long) histogram[i]);
+   return result;
+}
+
+bool SampleStats::FromString(const wxString &str)
+{
+   wxStringTokenizer tokens(str, wxT(" "));
+   if (tokens.CountTokens() != 3 + nBins)
+      return false;
+
+   wxLongLong_t nValue;
+   if (!tokens.GetNextToken().ToLongLong(&nValue) || nValue < 0)
+      return false;
+   count = nValue;
+   if (!Internat::CompatibleToDouble(tokens.GetNextToken(), &sum))
+      return false;
+   if (!tokens.GetNextToken().ToLongLong(&nValue) || nValue < 0)
+      return false;
+   clipped = nValue;
+
+   sampleCount total = 0;
+   for (int i = 0; i < nBins; i++) {
+      if (!tokens.GetNextToken().ToLongLong(&nValue) || nValue < 0)
+         return false;
+      histogram[i] = nValue;
+      total += nValue;
+   }
+   return total == count;
+}
+
 ArrayOf<char> BlockFile::fullSummary;
 
 /// Initializes the base BlockFile data.  The block is initially
@@ -103,13 +220,14 @@ BlockFile::BlockFile(wxFileNameWrapper &&fileName, sampleCount samples):
    mLockCount(0),
    mFileName(std::move(fileName)),
    mLen(samples),
-   mSummaryInfo(samples)
+   mSummaryInfo(samples),
+   mStatsAvailable(false)
 {
    mSilentLog=FALSE;
 }
 
 // static
-unsigned long BlockFile::gBlockFileDestructionCount { 0 };
+std::atomic<unsigned long> BlockFile::gBlockFileDestructionCount { 0 };
 
 BlockFile::~BlockFile()
 {
@@ -298,6 +416,65 @@ void BlockFile::CalcSummaryFromBuffer(const float *fbuffer, sampleCount len,
 
    mMin = min;
    mMax = max;
+
+   // The extended statistics need every sample, so take them now too
+   ODLocker locker(&mStatsMutex);
+   mStats.Clear();
+   mStats.Accumulate(fbuffer, len);
+   mStatsAvailable = true;
+}
+
+bool BlockFile::GetStats(SampleStats &stats) const
+{
+   {
+      ODLocker locker(&mStatsMutex);
+      if (mStatsAvailable) {
+         stats = mStats;
+         return true;
+      }
+   }
+
+   // Projects saved before the statistics existed don't have them, so
+   // compute them once from the data
+   if (!IsDataAvailable())
+      return false;
+
+   SampleBuffer buffer(mLen, floatSample);
+   const sampleCount read = ReadData(buffer.ptr(), floatSample, 0, mLen);
+   if (read != mLen)
+      return false;
+
+   SampleStats computed;
+   computed.Accumulate((const float *)buffer.ptr(), mLen);
+
+   ODLocker locker(&mStatsMutex);
+   mStats = computed;
+   mStatsAvailable = true;
+   stats = mStats;
+   return true;
+}
+
+void BlockFile::SetStats(const SampleStats &stats)
+{
+   ODLocker locker(&mStatsMutex);
+   if (stats.count == mLen) {
+      mStats = stats;
+      mStatsAvailable = true;
+   }
+}
+
+void BlockFile::CopyStatsTo(BlockFile &copy) const
+{
+   ODLocker locker(&mStatsMutex);
+   if (mStatsAvailable)
+      copy.SetStats(mStats);
+}
+
+void BlockFile::WriteStatsAttr(XMLWriter &xmlFile) const
+{
+   ODLocker locker(&mStatsMutex);
+   if (mStatsAvailable)
+      xmlFile.WriteAttr(wxT("stats"), mStats.ToString());
 }
 
 static void ComputeMinMax256(float *summary256,
@@ -437,7 +614,7 @@ bool BlockFile::Read256(float *buffer,
 
    char *summary = new char[mSummaryInfo.totalSummaryBytes];
    // FIXME: TRAP_ERR ReadSummay() could return fail.
-   this->ReadSummary(summary);
+   const bool result = this->ReadSummary(summary);
 
    if (start+len > mSummaryInfo.frames256)
       len = mSummaryInfo.frames256 - start;
@@ -458,7 +635,7 @@ bool BlockFile::Read256(float *buffer,
 
    delete[] summary;
 
-   return true;
+   return result;
 }
 
 /// Retrieves a portion of the 64K summary buffer from this BlockFile.  This
@@ -13,6 +13,7 @@
 #define __AUDACITY_BLOCKFILE__
 
 #include "MemoryX.h"
+#include <atomic>
 #include <wx/string.h>
 #include <wx/ffile.h>
 #include <wx/filename.h>
@@ -41,6 +42,38 @@ class SummaryInfo {
    int            totalSummaryBytes;
 };
 
+class SampleStats {
+ public:
+   // The histogram counts magnitudes by octave (6.02 dB) below full scale:
+   // bin k holds samples with 2^-(k+1) <= |x| < 2^-k, bin 0 also holds
+   // anything louder, and the last bin holds everything quieter,
+   // including digital silence.
+   enum { nBins = 16 };
+
+   SampleStats() { Clear(); }
+
+   void Clear();
+   void Accumulate(const float *buffer, sampleCount len);
+   void AccumulateSilence(sampleCount len);
+   SampleStats &operator+= (const SampleStats &other);
+
+   static int BinOf(float value);
+
+   /// Number of samples known to have a magnitude below level (linear)
+   sampleCount CountBelow(float level) const;
+   /// Number of samples known to have a magnitude of at least level (linear)
+   sampleCount CountAtLeast(float level) const;
+
+   /// Converts between the text form kept in project files and the record
+   wxString ToString() const;
+   bool FromString(const wxString &str);
+
+   sampleCount count;
+   double sum;                    // for the DC offset
+   sampleCount clipped;           // magnitudes of at least MAX_AUDIO
+   sampleCount histogram[nBins];
+};
+
 
 
 class BlockFile;
@@ -61,7 +94,8 @@ class PROFILE_DLL_API BlockFile /* not final, abstract */ {
    BlockFile(wxFileNameWrapper &&fileName, sampleCount samples);
    virtual ~BlockFile();
 
-   static unsigned long gBlockFileDestructionCount;
+   // Block files may be destroyed on import and on-demand threads too
+   static std::atomic<unsigned long> gBlockFileDestructionCount;
 
    // Reading
 
@@ -120,6 +154,14 @@ class PROFILE_DLL_API BlockFile /* not final, abstract */ {
                           float *outMin, float *outMax, float *outRMS) const;
    /// Gets extreme values for the entire block
    virtual void GetMinMax(float *outMin, float *outMax, float *outRMS) const;
+   /// Gets the extended statistics of the entire block, computing them from
+   /// the data if they were not stored.  Returns false if the data are not
+   /// available yet.
+   bool GetStats(SampleStats &stats) const;
+   /// Used when loading and copying blocks, so stored statistics survive
+   void SetStats(const SampleStats &stats);
+   /// Writes the statistics, if known, as an attribute of a block's tag
+   void WriteStatsAttr(XMLWriter &xmlFile) const;
    /// Returns the 256 byte summary data block
    virtual bool Read256(float *buffer, sampleCount start, sampleCount len);
    /// Returns the 64K summary data block
@@ -179,6 +221,9 @@ class PROFILE_DLL_API BlockFile /* not final, abstract */ {
    /// Read the summary section of the file.  Derived classes implement.
    virtual bool ReadSummary(void *data) = 0;
 
+   /// Gives a copy of this block the statistics already known, if any
+   void CopyStatsTo(BlockFile &copy) const;
+
    /// Byte-swap the summary data, in case it was saved by a system
    /// on a different platform
    virtual void FixSummary(void *data);
@@ -193,6 +238,10 @@ class PROFILE_DLL_API BlockFile /* not final, abstract */ {
    sampleCount mLen;
    SummaryInfo mSummaryInfo;
    float mMin, mMax, mRMS;
+   // Computed with the summary, or on demand on any thread
+   mutable SampleStats mStats;
+   mutable bool mStatsAvailable;
+   mutable ODLock mStatsMutex;
    mutable bool mSilentLog;
 };
 
@@ -0,0 +1,151 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ClipIndex.h
+
+*******************************************************************//**
+
+\class ClipIndex
+\brief The clips of a track in order of start, for finding those in a
+range by binary search.
+
+Each entry holds a clip's start sample and its place in the track's own
+list.  The index is rebuilt when next wanted after it is invalidated,
+which its owner does whenever clips are added or removed, or after the
+placement generation it is given changes, which the clips do whenever
+any of them moves or changes rate.  Lengths are read live, so clips may
+grow or shrink without either.
+
+Clips in a track don't overlap, so their ends are in order too, which is
+what makes it possible to find those in a range by their starts alone.
+Empty clips may lie anywhere, and are stepped over.
+
+Clip must have GetStartSample, GetEndSample, GetNumSamples, GetStartTime
+and GetEndTime, as WaveClip has.  The index does no locking of its own.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_CLIP_INDEX__
+#define __AUDACITY_CLIP_INDEX__
+
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+#include "audacity/Types.h"
+
+template<typename Clip>
+class ClipIndex
+{
+public:
+   struct Entry
+   {
+      sampleCount start;
+      Clip *clip;
+      int position;
+   };
+
+   ClipIndex()
+      : mValid(false)
+      , mGeneration(0)
+   {
+   }
+
+   // Call whenever clips are added or removed
+   void Invalidate() { mValid = false; }
+
+   // Rebuilds from clips, the track's list of pointers to Clip, unless
+   // the index is valid and was built at the same generation.  Read the
+   // generation before calling, so that a move during the rebuild is
+   // noticed next time.
+   template<typename Clips>
+   void Update(const Clips &clips, unsigned long generation)
+   {
+      if (mValid && mGeneration == generation)
+         return;
+
+      mEntries.clear();
+      mEntries.reserve(clips.size());
+      int position = 0;
+      for (const auto &clip : clips)
+         mEntries.push_back({ clip->GetStartSample(), &*clip, position++ });
+
+      std::stable_sort(mEntries.begin(), mEntries.end(),
+         [](const Entry &a, const Entry &b)
+      { return a.clip->GetStartTime() < b.clip->GetStartTime(); });
+
+      mValid = true;
+      mGeneration = generation;
+   }
+
+   // All of the clips, in order of start; call after Update
+   const std::vector<Entry> &GetEntries() const { return mEntries; }
+
+   // Appends the clips that overlap the samples from start up to end, in
+   // order of start; call after Update
+   template<typename Cont>
+   void GetInRange(sampleCount start, sampleCount end, Cont &clips) const
+   {
+      size_t first, last;
+      Find(end,
+         [=](const Clip *clip){ return clip->GetEndSample() > start; },
+         first, last);
+      for (size_t ii = first; ii < last; ++ii)
+      {
+         Clip *clip = mEntries[ii].clip;
+         if (clip->GetEndSample() > start && clip->GetStartSample() < end)
+            clips.push_back(clip);
+      }
+   }
+
+   // The same for the times from t0 up to t1, in a track of the given rate
+   template<typename Cont>
+   void GetInTimeRange(double t0, double t1, double rate, Cont &clips) const
+   {
+      // Clip starts are rounded to samples, so look a sample further, then
+      // compare the times exactly
+      const sampleCount end = (sampleCount)ceil(t1 * rate) + 1;
+
+      size_t first, last;
+      Find(end,
+         [=](const Clip *clip){ return clip->GetEndTime() > t0; },
+         first, last);
+      for (size_t ii = first; ii < last; ++ii)
+      {
+         Clip *clip = mEntries[ii].clip;
+         if (clip->GetEndTime() > t0 && clip->GetStartTime() < t1)
+            clips.push_back(clip);
+      }
+   }
+
+private:
+   // Finds the entries [first, last) that start before end, less those at
+   // the front that don't reach far enough
+   template<typename Reaches>
+   void Find(sampleCount end, const Reaches &reaches,
+             size_t &first, size_t &last) const
+   {
+      last = std::lower_bound(mEntries.begin(), mEntries.end(), end,
+         [](const Entry &entry, sampleCount s)
+      { return entry.start < s; }) - mEntries.begin();
+
+      // Step back while clips reach into the range.  Only a clip with
+      // samples that falls short ends the search.
+      first = last;
+      for (size_t ii = last; ii-- > 0;)
+      {
+         const Clip *clip = mEntries[ii].clip;
+         if (reaches(clip))
+            first = ii;
+         else if (clip->GetNumSamples() > 0)
+            break;
+      }
+   }
+
+   std::vector<Entry> mEntries;
+   bool mValid;
+   unsigned long mGeneration;
+};
+
+#endif
@@ -715,7 +715,7 @@ auto DirManager::GetBalanceInfo() -> BalanceInfo &
    // see whether any block files have disappeared,
    // and if so update
 
-   auto count = BlockFile::gBlockFileDestructionCount;
+   unsigned long count = BlockFile::gBlockFileDestructionCount;
    if ( mLastBlockFileDestructionCount != count ) {
       auto it = mBlockFileHash.begin(), end = mBlockFileHash.end();
       while (it != end)
@@ -810,6 +810,8 @@ void DirManager::BalanceInfoDel(const wxString &file)
 // perform maintainence
 wxFileNameWrapper DirManager::MakeBlockFileName()
 {
+   ODLocker locker{ &mBlockFileMutex };
+
    auto &balanceInfo = GetBalanceInfo();
    auto &dirMidPool = balanceInfo.dirMidPool;
    auto &dirTopPool = balanceInfo.dirTopPool;
@@ -902,7 +904,8 @@ wxFileNameWrapper DirManager::MakeBlockFileName()
 
       baseFileName.Printf(wxT("e%02x%02x%03x"),topnum,midnum,filenum);
 
-      if (!ContainsBlockFile(baseFileName)) {
+      if (!ContainsBlockFile(baseFileName) &&
+          mReservedBlockFileNames.find(baseFileName) == mReservedBlockFileNames.end()) {
          // not in the hash, good.
          if (!this->AssignFile(ret, baseFileName, true))
          {
@@ -921,9 +924,23 @@ wxFileNameWrapper DirManager::MakeBlockFileName()
    // FIXME: Might we get here without midkey having been set?
    //    Seemed like a possible problem in these changes in .aup directory hierarchy.
    BalanceFileAdd(midkey);
+   mReservedBlockFileNames.insert(baseFileName);
    return std::move(ret);
 }
 
+void DirManager::InsertBlockFile(const wxString &fileName, const BlockFilePtr &blockFile)
+{
+   ODLocker locker{ &mBlockFileMutex };
+   mBlockFileHash[fileName] = blockFile;
+   mReservedBlockFileNames.erase(fileName);
+}
+
+void DirManager::AddAlias(const wxString &aliasedFile)
+{
+   ODLocker locker{ &mAliasListMutex };
+   aliasList.Add(aliasedFile);
+}
+
 BlockFilePtr DirManager::NewSimpleBlockFile(
                                  samplePtr sampleData, sampleCount sampleLen,
                                  sampleFormat format,
@@ -935,7 +952,7 @@ BlockFilePtr DirManager::NewSimpleBlockFile(
    auto newBlockFile = make_blockfile<SimpleBlockFile>
       (std::move(filePath), sampleData, sampleLen, format, allowDeferredWrite);
 
-   mBlockFileHash[fileName] = newBlockFile;
+   InsertBlockFile(fileName, newBlockFile);
 
    return newBlockFile;
 }
@@ -951,8 +968,8 @@ BlockFilePtr DirManager::NewAliasBlockFile(
       (std::move(filePath), wxFileNameWrapper{aliasedFile},
        aliasStart, aliasLen, aliasChannel);
 
-   mBlockFileHash[fileName]=newBlockFile;
-   aliasList.Add(aliasedFile);
+   InsertBlockFile(fileName, newBlockFile);
+   AddAlias(aliasedFile);
 
    return newBlockFile;
 }
@@ -968,8 +985,8 @@ BlockFilePtr DirManager::NewODAliasBlockFile(
       (std::move(filePath), wxFileNameWrapper{aliasedFile},
        aliasStart, aliasLen, aliasChannel);
 
-   mBlockFileHash[fileName]=newBlockFile;
-   aliasList.Add(aliasedFile);
+   InsertBlockFile(fileName, newBlockFile);
+   AddAlias(aliasedFile);
 
    return newBlockFile;
 }
@@ -985,8 +1002,8 @@ BlockFilePtr DirManager::NewODDecodeBlockFile(
       (std::move(filePath), wxFileNameWrapper{ aliasedFile },
        aliasStart, aliasLen, aliasChannel, decodeType);
 
-   mBlockFileHash[fileName]=newBlockFile;
-   aliasList.Add(aliasedFile); //OD TODO: check to see if we need to remove this when done decoding.
+   InsertBlockFile(fileName, newBlockFile);
+   AddAlias(aliasedFile); //OD TODO: check to see if we need to remove this when done decoding.
                                //I don't immediately see a place where aliased files remove when a file is closed.
 
    return newBlockFile;
@@ -1064,8 +1081,8 @@ BlockFilePtr DirManager::CopyBlockFile(const BlockFilePtr &b)
       if (b2 == NULL)
          return {};
 
-      mBlockFileHash[newName]=b2;
-      aliasList.Add(newPath);
+      InsertBlockFile(newName, b2);
+      AddAlias(newPath);
    }
 
    return b2;
@@ -1258,8 +1275,11 @@ bool DirManager::EnsureSafeFilename(const wxFileName &fName)
    // then the file name is A-OK.
 
    const wxString fullPath{fName.GetFullPath()};
-   if (aliasList.Index(fullPath) == wxNOT_FOUND)
-      return true;
+   {
+      ODLocker locker{ &mAliasListMutex };
+      if (aliasList.Index(fullPath) == wxNOT_FOUND)
+         return true;
+   }
 
    /* i18n-hint: 'old' is part of a filename used when a file is renamed. */
    // Figure out what the NEW name for the existing file would be.
@@ -1400,6 +1420,7 @@ bool DirManager::EnsureSafeFilename(const wxFileName &fName)
 
       }
 
+      ODLocker locker{ &mAliasListMutex };
       aliasList.Remove(fullPath);
       aliasList.Add(renamedFullPath);
    }
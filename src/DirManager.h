@@ -21,6 +21,8 @@
 #include "audacity/Types.h"
 #include "xml/XMLTagHandler.h"
 #include "wxFileNameWrapper.h"
+#include "ondemand/ODTaskThread.h"
+#include <set>
 
 class wxHashTable;
 class BlockArray;
@@ -171,10 +173,24 @@ class PROFILE_DLL_API DirManager final : public XMLTagHandler {
    wxFileNameWrapper MakeBlockFileName();
    wxFileNameWrapper MakeBlockFilePath(const wxString &value);
 
+   // Enters a block file made with a name from MakeBlockFileName()
+   // into the hash, and releases the reservation of that name
+   void InsertBlockFile(const wxString &fileName, const BlockFilePtr &blockFile);
+
+   // Adds to aliasList, which import threads may do at once
+   void AddAlias(const wxString &aliasedFile);
+
    bool MoveOrCopyToNewProjectDirectory(BlockFile *f, bool copy);
 
    BlockHash mBlockFileHash; // repository for blockfiles
 
+   // Block files may be made on any thread, and by several at once, such
+   // as import and effect workers each filling tracks of their own.  Names
+   // are reserved from MakeBlockFileName() until the file is in the hash.
+   ODLock mBlockFileMutex;
+   std::set<wxString> mReservedBlockFileNames;
+   ODLock mAliasListMutex;
+
    // Hashes for management of the sub-directory tree of _data
    struct BalanceInfo
    {
@@ -1144,9 +1144,101 @@ void Envelope::GetValues(double *buffer, int bufferLen,
    }
 }
 
+void Envelope::GetSegments(EnvSegments &segments, int len,
+                           double t0, double tstep, int offset) const
+{
+   if (len <= 0)
+      return;
+
+   // Convert t0 from absolute to clip-relative time
+   t0 -= mOffset;
+
+   const int numPoints = mEnv.size();
+   if (numPoints <= 0) {
+      segments.push_back(EnvSegment(offset, len, mDefaultValue));
+      return;
+   }
+
+   // Index of the first sample, not before start, whose time is after t
+   auto firstAfter = [=](double t, int start) {
+      double index = floor((t - t0) / tstep) + 1.0;
+      return (int)std::max((double)start, std::min((double)len, index));
+   };
+
+   // Samples at or before the first point take its value
+   int start = 0;
+   int end = firstAfter(mEnv[0].GetT(), start);
+   if (end > start)
+      segments.push_back(EnvSegment(offset + start, end - start, mEnv[0].GetVal()));
+   start = end;
+
+   for (int ii = 0; ii + 1 < numPoints && start < len; ++ii) {
+      const double tprev = mEnv[ii].GetT();
+      const double tnext = mEnv[ii + 1].GetT();
+      end = firstAfter(tnext, start);
+      if (end <= start || tnext <= tprev)
+         continue;
+
+      // Interpolate, either linear or log depending on mDB,
+      // as in GetValues()
+      const double vprev = GetInterpolationStartValueAtPoint(ii);
+      const double vnext = GetInterpolationStartValueAtPoint(ii + 1);
+      const double dt = tnext - tprev;
+      const double to = t0 + start * tstep - tprev;
+      double v = (vprev * (dt - to) + vnext * to) / dt;
+      double vstep = (vnext - vprev) * tstep / dt;
+      if (mDB) {
+         v = pow(10.0, v);
+         vstep = pow(10.0, vstep);
+      }
+      segments.push_back(EnvSegment(offset + start, end - start, v, vstep, mDB));
+      start = end;
+   }
+
+   // Samples after the last point take its value
+   if (start < len)
+      segments.push_back(EnvSegment(offset + start, len - start,
+                                    mEnv[numPoints - 1].GetVal()));
+}
+
+void ApplyEnvelopeSegments(float *buffer, const EnvSegments &segments)
+{
+   for (const auto &segment : segments) {
+      if (segment.IsUnity())
+         continue;
+
+      float *const dst = buffer + segment.start;
+      const int len = segment.len;
+      if (segment.IsConstant()) {
+         const float gain = segment.value;
+         for (int i = 0; i < len; i++)
+            dst[i] *= gain;
+      }
+      else if (!segment.exponential) {
+         // Linear ramp, computed without a loop-carried dependency
+         const double value = segment.value, step = segment.step;
+         for (int i = 0; i < len; i++)
+            dst[i] *= (float)(value + i * step);
+      }
+      else {
+         double value = segment.value;
+         for (int i = 0; i < len; i++) {
+            dst[i] *= (float)value;
+            value *= segment.step;
+         }
+      }
+   }
+}
+
 void Envelope::GetValues
    (double *buffer, int bufferLen, int leftOffset, const ZoomInfo &zoomInfo) const
 {
+   // Without points the value is the same everywhere
+   if (mEnv.empty()) {
+      std::fill(buffer, buffer + bufferLen, mDefaultValue);
+      return;
+   }
+
    for (int xx = 0; xx < bufferLen; ++xx)
       buffer[xx] = GetValue(zoomInfo.PositionToTime(xx, -leftOffset));
 }
@@ -74,6 +74,33 @@ private:
 
 typedef std::vector<EnvPoint> EnvArray;
 
+/// A run of consecutive envelope values that follow one simple law.
+/// Starting from value at sample index start, each next sample adds step,
+/// or for exponential (dB interpolated) segments multiplies by it.
+struct EnvSegment
+{
+   EnvSegment(int start_, int len_, double value_,
+              double step_ = 0.0, bool exponential_ = false)
+      : start(start_), len(len_), value(value_)
+      , step(step_), exponential(exponential_)
+   {}
+
+   bool IsConstant() const { return step == (exponential ? 1.0 : 0.0); }
+   bool IsUnity() const { return IsConstant() && value == 1.0; }
+
+   int start;
+   int len;
+   double value;
+   double step;
+   bool exponential;
+};
+
+typedef std::vector<EnvSegment> EnvSegments;
+
+/// Multiply len samples of buffer by the values described in segments,
+/// doing nothing for stretches of unit gain.
+void ApplyEnvelopeSegments(float *buffer, const EnvSegments &segments);
+
 class Envelope final : public XMLTagHandler {
  public:
    Envelope();
@@ -145,6 +172,14 @@ class Envelope final : public XMLTagHandler {
     * more than one value in a row. */
    void GetValues(double *buffer, int len, double t0, double tstep) const;
 
+   /** \brief Describe the same values as GetValues() as piecewise segments.
+    *
+    * Appends segments, in order, covering sample indices offset ..
+    * offset+len-1 with no gaps.  An envelope without points gives a single
+    * constant segment. */
+   void GetSegments(EnvSegments &segments, int len, double t0, double tstep,
+                    int offset = 0) const;
+
    /** \brief Get many envelope points at once, but don't assume uniform time step.
    */
    void GetValues
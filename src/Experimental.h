@@ -93,13 +93,15 @@
 //#define EXPERIMENTAL_SEEK_BEHIND_CURSOR
 
 // Michael Chinen, 08.Oct 2009
-// Use on-demand importing for FLAC. Has issues with opening projects that
-// have not been fully imported in builds without FLAC support, so disabled for
-// 2.0 release
-//#define EXPERIMENTAL_OD_FLAC
-// similarly for FFmpeg:
-// Won't build on Fedora 17 or Windows VC++, per http://bugzilla.audacityteam.org/show_bug.cgi?id=539.
-//#define EXPERIMENTAL_OD_FFMPEG 1
+// Use on-demand importing for FLAC. Projects that have not been fully
+// imported still cannot be finished by builds without FLAC support.
+#define EXPERIMENTAL_OD_FLAC
+// similarly for FFmpeg, when enabled in Library Preferences:
+// Used not to build on Fedora 17 or Windows VC++, per http://bugzilla.audacityteam.org/show_bug.cgi?id=539.
+#define EXPERIMENTAL_OD_FFMPEG 1
+// Use on-demand importing for MP3, decoding blocks from a frame seek index
+// built by a quick scan of the file.
+#define EXPERIMENTAL_OD_MP3
 
 // Paul Licameli (PRL) 5 Oct 2014
 #define EXPERIMENTAL_SPECTRAL_EDITING
@@ -602,6 +602,11 @@ extern "C" {
       (AVCodecContext *avctx),
       (avctx)
    );
+   FFMPEG_FUNCTION_NO_RETURN(
+      avcodec_flush_buffers,
+      (AVCodecContext *avctx),
+      (avctx)
+   );
    FFMPEG_FUNCTION_NO_RETURN(
       avcodec_register_all,
       (void),
@@ -256,6 +256,8 @@ Mixer::Mixer(const WaveTrackConstArray &inputTracks,
    // yet processed.
    mSamplePos = new sampleCount[mNumInputTracks];
    for(i=0; i<mNumInputTracks; i++) {
+      // Mixing reads each track straight through, so read ahead of it
+      mInputTrack[i].SetReadAhead(2);
       mInputTrack[i].SetTrack(inputTracks[i]);
       mSamplePos[i] = inputTracks[i]->TimeToLongSamples(startTime);
    }
@@ -292,8 +294,6 @@ Mixer::Mixer(const WaveTrackConstArray &inputTracks,
       mBuffer[c].Allocate(mInterleavedBufferSize, mFormat);
       mTemp[c].Allocate(mInterleavedBufferSize, floatSample);
    }
-   mFloatBuffer = new float[mInterleavedBufferSize];
-
    // This is the number of samples grabbed in one go from a track
    // and placed in a queue, when mixing with resampling.
    // (Should we use WaveTrack::GetBestBlockSize instead?)
@@ -311,8 +311,13 @@ Mixer::Mixer(const WaveTrackConstArray &inputTracks,
    mQueueLen = new int[mNumInputTracks];
    mSampleQueue = new float *[mNumInputTracks];
    mResample = new Resample*[mNumInputTracks];
+   mGroupSize = new int[mNumInputTracks];
+   mResampleIn = new float *[mNumInputTracks];
+   mResampleOut = new float *[mNumInputTracks];
+   int maxGroupSize = 1;
    for(i=0; i<mNumInputTracks; i++) {
-      double factor = (mRate / mInputTrack[i].GetTrack()->GetRate());
+      const WaveTrack *const track = mInputTrack[i].GetTrack();
+      double factor = (mRate / track->GetRate());
       double minFactor, maxFactor;
       if (mTimeTrack) {
          // variable rate resampling
@@ -332,16 +337,39 @@ Mixer::Mixer(const WaveTrackConstArray &inputTracks,
          minFactor = maxFactor = factor;
       }
 
-      mResample[i] = new Resample(mHighQuality, minFactor, maxFactor);
+      // The channels of a stereo track share rate and position, so one
+      // resampler can convert both of them in each call
+      mGroupSize[i] = 1;
+      if (i + 1 < mNumInputTracks &&
+          track->GetLinked() &&
+          track->GetLink() == mInputTrack[i + 1].GetTrack() &&
+          track->GetRate() == mInputTrack[i + 1].GetTrack()->GetRate())
+         mGroupSize[i] = 2;
+
+      // One thread each: several mixers may run at once, during a
+      // multi-track export or playback, and libsoxr would start threads
+      // for every core in each of them
+      mResample[i] = new Resample(mHighQuality, minFactor, maxFactor,
+                                  mGroupSize[i], 1);
       mSampleQueue[i] = new float[mQueueMaxLen];
       mQueueStart[i] = 0;
       mQueueLen[i] = 0;
+      maxGroupSize = std::max(maxGroupSize, mGroupSize[i]);
+
+      for (int j = 1; j < mGroupSize[i]; j++) {
+         mResample[i + j] = NULL;
+         mGroupSize[i + j] = 0;
+         mSampleQueue[i + j] = new float[mQueueMaxLen];
+         mQueueStart[i + j] = 0;
+         mQueueLen[i + j] = 0;
+      }
+      i += mGroupSize[i] - 1;
    }
 
-   int envLen = mInterleavedBufferSize;
-   if (mQueueMaxLen > envLen)
-      envLen = mQueueMaxLen;
-   mEnvValues = new double[envLen];
+   // Resampled output of each channel in a group goes to its own
+   // mBufferSize stretch of mFloatBuffer
+   mFloatBuffer =
+      new float[std::max(mInterleavedBufferSize, mBufferSize * maxGroupSize)];
 }
 
 Mixer::~Mixer()
@@ -351,7 +379,6 @@ Mixer::~Mixer()
    delete[] mBuffer;
    delete[] mTemp;
    delete[] mInputTrack;
-   delete[] mEnvValues;
    delete[] mFloatBuffer;
    delete[] mGains;
    delete[] mSamplePos;
@@ -361,6 +388,9 @@ Mixer::~Mixer()
       delete[] mSampleQueue[i];
    }
    delete[] mResample;
+   delete[] mGroupSize;
+   delete[] mResampleIn;
+   delete[] mResampleOut;
    delete[] mSampleQueue;
    delete[] mQueueStart;
    delete[] mQueueLen;
@@ -407,17 +437,22 @@ void MixBuffers(int numChannels, int *channelFlags, float *gains,
    }
 }
 
-sampleCount Mixer::MixVariableRates(int *channelFlags, WaveTrackCache &cache,
-                                    sampleCount *pos, float *queue,
-                                    int *queueStart, int *queueLen,
-                                    Resample * pResample)
+sampleCount Mixer::MixVariableRates(int *channelFlags, int iTrack, int nTracks)
 {
-   const WaveTrack *const track = cache.GetTrack();
+   WaveTrackCache *const caches = &mInputTrack[iTrack];
+   const WaveTrack *const track = caches[0].GetTrack();
    const double trackRate = track->GetRate();
    const double initialWarp = mRate / mSpeed / trackRate;
    const double tstep = 1.0 / trackRate;
    int sampleSize = SAMPLE_SIZE(floatSample);
 
+   // All tracks of the group advance together, so the leader's
+   // position and queue bounds stand for every channel
+   sampleCount *const pos = &mSamplePos[iTrack];
+   int *const queueStart = &mQueueStart[iTrack];
+   int *const queueLen = &mQueueLen[iTrack];
+   Resample *const pResample = mResample[iTrack];
+
    sampleCount out = 0;
 
    /* time is floating point. Sample rate is integer. The number of samples
@@ -434,6 +469,10 @@ sampleCount Mixer::MixVariableRates(int *channelFlags, WaveTrackCache &cache,
    // Find the last sample
    double endTime = track->GetEndTime();
    double startTime = track->GetStartTime();
+   for (int c = 1; c < nTracks; c++) {
+      endTime = std::max(endTime, caches[c].GetTrack()->GetEndTime());
+      startTime = std::min(startTime, caches[c].GetTrack()->GetStartTime());
+   }
    const bool backwards = (mT1 < mT0);
    const double tEnd = backwards
       ? std::max(startTime, mT1)
@@ -444,47 +483,39 @@ sampleCount Mixer::MixVariableRates(int *channelFlags, WaveTrackCache &cache,
 
    while (out < mMaxOut) {
       if (*queueLen < mProcessLen) {
-         // Shift pending portion to start of the buffer
-         memmove(queue, &queue[*queueStart], (*queueLen) * sampleSize);
-         *queueStart = 0;
-
          int getLen =
             std::min((backwards ? *pos - endPos : endPos - *pos),
                       sampleCount(mQueueMaxLen - *queueLen));
 
-         // Nothing to do if past end of play interval
-         if (getLen > 0) {
-            if (backwards) {
-               auto results = cache.Get(floatSample, *pos - (getLen - 1), getLen);
-               memcpy(&queue[*queueLen], results, sizeof(float) * getLen);
+         for (int c = 0; c < nTracks; c++) {
+            float *const queue = mSampleQueue[iTrack + c];
+            const WaveTrack *const channel = caches[c].GetTrack();
 
-               track->GetEnvelopeValues(mEnvValues,
-                                        getLen,
-                                        (*pos - (getLen- 1)) / trackRate,
-                                        tstep);
+            // Shift pending portion to start of the buffer
+            memmove(queue, &queue[*queueStart], (*queueLen) * sampleSize);
 
-               *pos -= getLen;
-            }
-            else {
-               auto results = cache.Get(floatSample, *pos, getLen);
-               memcpy(&queue[*queueLen], results, sizeof(float) * getLen);
+            // Nothing to do if past end of play interval
+            if (getLen <= 0)
+               continue;
 
-               track->GetEnvelopeValues(mEnvValues,
-                                        getLen,
-                                        (*pos) / trackRate,
-                                        tstep);
+            const sampleCount start = backwards ? *pos - (getLen - 1) : *pos;
+            auto results = caches[c].Get(floatSample, start, getLen);
+            memcpy(&queue[*queueLen], results, sizeof(float) * getLen);
 
-               *pos += getLen;
-            }
-
-            for (int i = 0; i < getLen; i++) {
-               queue[(*queueLen) + i] *= mEnvValues[i];
-            }
+            channel->GetEnvelopeSegments(mEnvSegments,
+                                         getLen,
+                                         start / trackRate,
+                                         tstep);
+            ApplyEnvelopeSegments(&queue[*queueLen], mEnvSegments);
 
             if (backwards)
                ReverseSamples((samplePtr)&queue[0], floatSample,
                               *queueLen, getLen);
+         }
+         *queueStart = 0;
 
+         if (getLen > 0) {
+            *pos += (backwards ? -getLen : getLen);
             *queueLen += getLen;
          }
       }
@@ -511,13 +542,18 @@ sampleCount Mixer::MixVariableRates(int *channelFlags, WaveTrackCache &cache,
                (t, t + (double)thisProcessLen / trackRate);
       }
 
+      for (int c = 0; c < nTracks; c++) {
+         mResampleIn[c] = &mSampleQueue[iTrack + c][*queueStart];
+         mResampleOut[c] = &mFloatBuffer[c * mBufferSize + out];
+      }
+
       int input_used;
       int outgen = pResample->Process(factor,
-                                      &queue[*queueStart],
+                                      mResampleIn,
                                       thisProcessLen,
                                       last,
                                       &input_used,
-                                      &mFloatBuffer[out],
+                                      mResampleOut,
                                       mMaxOut - out);
 
       if (outgen < 0) {
@@ -534,22 +570,29 @@ sampleCount Mixer::MixVariableRates(int *channelFlags, WaveTrackCache &cache,
       }
    }
 
-   for (int c = 0; c < mNumChannels; c++) {
-      if (mApplyTrackGains) {
-         mGains[c] = track->GetChannelGain(c);
-      }
-      else {
-         mGains[c] = 1.0;
+   for (int c = 0; c < nTracks; c++) {
+      const WaveTrack *const channel = caches[c].GetTrack();
+      for (int j = 0; j < mNumChannels; j++) {
+         if (mApplyTrackGains) {
+            mGains[j] = channel->GetChannelGain(j);
+         }
+         else {
+            mGains[j] = 1.0;
+         }
       }
-   }
 
-   MixBuffers(mNumChannels,
-              channelFlags,
-              mGains,
-              (samplePtr)mFloatBuffer,
-              mTemp,
-              out,
-              mInterleaved);
+      MixBuffers(mNumChannels,
+                 &channelFlags[c * mNumChannels],
+                 mGains,
+                 (samplePtr)&mFloatBuffer[c * mBufferSize],
+                 mTemp,
+                 out,
+                 mInterleaved);
+
+      mSamplePos[iTrack + c] = *pos;
+      mQueueStart[iTrack + c] = *queueStart;
+      mQueueLen[iTrack + c] = *queueLen;
+   }
 
    return out;
 }
@@ -587,9 +630,8 @@ sampleCount Mixer::MixSameRate(int *channelFlags, WaveTrackCache &cache,
    if (backwards) {
       auto results = cache.Get(floatSample, *pos - (slen - 1), slen);
       memcpy(mFloatBuffer, results, sizeof(float) * slen);
-      track->GetEnvelopeValues(mEnvValues, slen, t - (slen - 1) / mRate, 1.0 / mRate);
-      for(int i=0; i<slen; i++)
-         mFloatBuffer[i] *= mEnvValues[i]; // Track gain control will go here?
+      track->GetEnvelopeSegments(mEnvSegments, slen, t - (slen - 1) / mRate, 1.0 / mRate);
+      ApplyEnvelopeSegments(mFloatBuffer, mEnvSegments); // Track gain control will go here?
       ReverseSamples((samplePtr)mFloatBuffer, floatSample, 0, slen);
 
       *pos -= slen;
@@ -597,9 +639,8 @@ sampleCount Mixer::MixSameRate(int *channelFlags, WaveTrackCache &cache,
    else {
       auto results = cache.Get(floatSample, *pos, slen);
       memcpy(mFloatBuffer, results, sizeof(float) * slen);
-      track->GetEnvelopeValues(mEnvValues, slen, t, 1.0 / mRate);
-      for(int i=0; i<slen; i++)
-         mFloatBuffer[i] *= mEnvValues[i]; // Track gain control will go here?
+      track->GetEnvelopeSegments(mEnvSegments, slen, t, 1.0 / mRate);
+      ApplyEnvelopeSegments(mFloatBuffer, mEnvSegments); // Track gain control will go here?
 
       *pos += slen;
    }
@@ -625,48 +666,55 @@ sampleCount Mixer::Process(sampleCount maxToProcess)
 
    int i, j;
    sampleCount maxOut = 0;
-   int *channelFlags = new int[mNumChannels];
+   int *channelFlags = new int[mNumChannels * 2];
 
    mMaxOut = maxToProcess;
 
    Clear();
    for(i=0; i<mNumInputTracks; i++) {
       const WaveTrack *const track = mInputTrack[i].GetTrack();
-      for(j=0; j<mNumChannels; j++)
-         channelFlags[j] = 0;
-
-      if( mMixerSpec ) {
-         //ignore left and right when downmixing is not required
-         for( j = 0; j < mNumChannels; j++ )
-            channelFlags[ j ] = mMixerSpec->mMap[ i ][ j ] ? 1 : 0;
-      }
-      else {
-         switch(track->GetChannel()) {
-         case Track::MonoChannel:
-         default:
-            for(j=0; j<mNumChannels; j++)
-               channelFlags[j] = 1;
-            break;
-         case Track::LeftChannel:
-            channelFlags[0] = 1;
-            break;
-         case Track::RightChannel:
-            if (mNumChannels >= 2)
-               channelFlags[1] = 1;
-            else
-               channelFlags[0] = 1;
-            break;
+      const bool resample = (mbVariableRates || track->GetRate() != mRate);
+      const int nTracks = resample ? mGroupSize[i] : 1;
+
+      for (int k = 0; k < nTracks; k++) {
+         const WaveTrack *const channel = mInputTrack[i + k].GetTrack();
+         int *const flags = &channelFlags[k * mNumChannels];
+         for(j=0; j<mNumChannels; j++)
+            flags[j] = 0;
+
+         if( mMixerSpec ) {
+            //ignore left and right when downmixing is not required
+            for( j = 0; j < mNumChannels; j++ )
+               flags[ j ] = mMixerSpec->mMap[ i + k ][ j ] ? 1 : 0;
+         }
+         else {
+            switch(channel->GetChannel()) {
+            case Track::MonoChannel:
+            default:
+               for(j=0; j<mNumChannels; j++)
+                  flags[j] = 1;
+               break;
+            case Track::LeftChannel:
+               flags[0] = 1;
+               break;
+            case Track::RightChannel:
+               if (mNumChannels >= 2)
+                  flags[1] = 1;
+               else
+                  flags[0] = 1;
+               break;
+            }
          }
       }
-      if (mbVariableRates || track->GetRate() != mRate)
+      if (resample)
          maxOut = std::max(maxOut,
-            MixVariableRates(channelFlags, mInputTrack[i],
-               &mSamplePos[i], mSampleQueue[i],
-               &mQueueStart[i], &mQueueLen[i], mResample[i]));
+            MixVariableRates(channelFlags, i, nTracks));
       else
          maxOut = std::max(maxOut,
             MixSameRate(channelFlags, mInputTrack[i], &mSamplePos[i]));
 
+      i += nTracks - 1;
+
       double t = (double)mSamplePos[i] / (double)track->GetRate();
       if (mT0 > mT1)
          // backwards (as possibly in scrubbing)
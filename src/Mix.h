@@ -15,6 +15,7 @@
 #include "MemoryX.h"
 #include <wx/string.h>
 #include "SampleFormat.h"
+#include "Envelope.h"
 
 class Resample;
 class DirManager;
@@ -144,10 +145,9 @@ class AUDACITY_DLL_API Mixer {
    sampleCount MixSameRate(int *channelFlags, WaveTrackCache &cache,
                            sampleCount *pos);
 
-   sampleCount MixVariableRates(int *channelFlags, WaveTrackCache &cache,
-                                sampleCount *pos, float *queue,
-                                int *queueStart, int *queueLen,
-                                Resample * pResample);
+   // Resamples input tracks iTrack .. iTrack + nTracks - 1 together,
+   // channelFlags holding mNumChannels flags for each of them
+   sampleCount MixVariableRates(int *channelFlags, int iTrack, int nTracks);
 
  private:
    // Input
@@ -159,11 +159,12 @@ class AUDACITY_DLL_API Mixer {
    sampleCount     *mSamplePos;
    bool             mApplyTrackGains;
    float           *mGains;
-   double          *mEnvValues;
+   EnvSegments      mEnvSegments;
    double           mT0; // Start time
    double           mT1; // Stop time (none if mT0==mT1)
    double           mTime;  // Current time (renamed from mT to mTime for consistency with AudioIO - mT represented warped time there)
-   Resample       **mResample;
+   Resample       **mResample;  // NULL except for the first track of a group
+   int             *mGroupSize;  // tracks resampled together, from each leader
    float          **mSampleQueue;
    int             *mQueueStart;
    int             *mQueueLen;
@@ -182,6 +183,8 @@ class AUDACITY_DLL_API Mixer {
    SampleBuffer    *mBuffer;
    SampleBuffer    *mTemp;
    float           *mFloatBuffer;
+   float          **mResampleIn;
+   float          **mResampleOut;
    double           mRate;
    double           mSpeed;
    bool             mHighQuality;
@@ -31,6 +31,7 @@ i.e. an alternative to the usual interface, for Audacity.
 #include "FileNames.h"
 #include "Internat.h"
 #include "PluginManager.h"
+#include "PluginScanner.h"
 
 #include "commands/ScriptCommandRelay.h"
 #include <NonGuiThread.h>  // header from libwidgetextra
@@ -52,6 +53,7 @@ i.e. an alternative to the usual interface, for Audacity.
 #define initFnName      "ExtensionModuleInit"
 #define versionFnName   "GetVersionString"
 #define scriptFnName    "RegScriptServerFunc"
+#define socketFnName    "RegScriptSocketFunc"
 #define mainPanelFnName "MainPanelFunc"
 
 typedef wxWindow * pwxWindow;
@@ -88,6 +90,10 @@ wxWindow * MakeHijackPanel()
 // starts a thread and reads script commands.
 static tpRegScriptServerFunc scriptFn;
 
+// And this one, of a subroutine that starts a thread serving scripts
+// that keep several commands in flight.
+static tpRegScriptSocketFunc socketFn;
+
 Module::Module(const wxString & name)
 {
    mName = name;
@@ -301,6 +307,8 @@ void ModuleManager::Initialize(CommandHandler &cmdHandler)
          // (a) for scripting.
          if( scriptFn == NULL )
             scriptFn = (tpRegScriptServerFunc)(module->GetSymbol(wxT(scriptFnName)));
+         if( socketFn == NULL )
+            socketFn = (tpRegScriptSocketFunc)(module->GetSymbol(wxT(socketFnName)));
          // (b) for hijacking the entire Audacity panel.
          if( pPanelHijack==NULL )
          {
@@ -321,6 +329,11 @@ void ModuleManager::Initialize(CommandHandler &cmdHandler)
       ScriptCommandRelay::SetRegScriptServerFunc(scriptFn);
       NonGuiThread::StartChild(&ScriptCommandRelay::Run);
    }
+   if(socketFn)
+   {
+      ScriptCommandRelay::SetCommandHandler(cmdHandler);
+      ScriptCommandRelay::StartSocketServer(socketFn);
+   }
 }
 
 // static
@@ -549,6 +562,43 @@ bool ModuleManager::RegisterPlugin(const PluginID & providerID, const wxString &
    return mDynModules[providerID]->RegisterPlugin(PluginManager::Get(), path);
 }
 
+wxString ModuleManager::GetProbeCommand(const PluginID & providerID,
+                                       const wxString & path)
+{
+   if (mDynModules.find(providerID) == mDynModules.end())
+   {
+      return wxEmptyString;
+   }
+
+   PluginProbeInterface *prober =
+      dynamic_cast<PluginProbeInterface *>(mDynModules[providerID].get());
+   if (!prober)
+   {
+      return wxEmptyString;
+   }
+
+   return prober->GetProbeCommand(path);
+}
+
+bool ModuleManager::RegisterProbedPlugin(const PluginID & providerID,
+                                         const wxString & path,
+                                         const wxString & output)
+{
+   if (mDynModules.find(providerID) == mDynModules.end())
+   {
+      return false;
+   }
+
+   PluginProbeInterface *prober =
+      dynamic_cast<PluginProbeInterface *>(mDynModules[providerID].get());
+   if (!prober)
+   {
+      return false;
+   }
+
+   return prober->RegisterProbedPlugin(PluginManager::Get(), path, output);
+}
+
 IdentInterface *ModuleManager::CreateProviderInstance(const PluginID & providerID,
                                                       const wxString & path)
 {
@@ -99,6 +99,12 @@ public:
    wxArrayString FindPluginsForProvider(const PluginID & provider, const wxString & path);
    bool RegisterPlugin(const PluginID & provider, const wxString & path);
 
+   // For providers that implement PluginProbeInterface; otherwise the
+   // command is empty and the path must be registered with RegisterPlugin()
+   wxString GetProbeCommand(const PluginID & provider, const wxString & path);
+   bool RegisterProbedPlugin(const PluginID & provider, const wxString & path,
+                             const wxString & output);
+
    IdentInterface *CreateProviderInstance(const PluginID & provider, const wxString & path);
    IdentInterface *CreateInstance(const PluginID & provider, const wxString & path);
    void DeleteInstance(const PluginID & provider, IdentInterface *instance);
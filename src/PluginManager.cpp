@@ -39,7 +39,9 @@
 #include "FileNames.h"
 #include "ModuleManager.h"
 #include "PlatformCompatibility.h"
+#include "PluginScanner.h"
 #include "Prefs.h"
+#include "Project.h"
 #include "ShuttleGui.h"
 #include "effects/EffectManager.h"
 #include "widgets/ProgressDialog.h"
@@ -944,9 +946,23 @@ void PluginRegistrationDialog::OnDisable(wxCommandEvent & WXUNUSED(evt))
 void PluginRegistrationDialog::OnOK(wxCommandEvent & WXUNUSED(evt))
 {
    PluginManager & pm = PluginManager::Get();
-   ModuleManager & mm = ModuleManager::Get();
 
-   int enableCount = 0;
+   // Plugins to enable are registered by the scanner, several at once;
+   // the others only change state
+   PluginScanner scanner([&](const wxString & path, const PluginID & provider)
+   {
+      if (provider.IsEmpty())
+      {
+         return;
+      }
+
+      ItemData & item = mItems[path];
+      for (size_t j = 0, cnt = item.plugs.GetCount(); j < cnt; j++)
+      {
+         pm.mPlugins.erase(item.plugs[j]->GetProviderID() + wxT("_") + path);
+      }
+   });
+
    for (ItemDataMap::iterator iter = mItems.begin(); iter != mItems.end(); ++iter)
    {
       ItemData & item = iter->second;
@@ -954,7 +970,28 @@ void PluginRegistrationDialog::OnOK(wxCommandEvent & WXUNUSED(evt))
 
       if (item.state == STATE_Enabled && item.plugs[0]->GetPluginType() == PluginTypeStub)
       {
-         enableCount++;
+         // Try to register the plugin via each provider until one succeeds
+         wxArrayString providers;
+         for (size_t j = 0, cnt = item.plugs.GetCount(); j < cnt; j++)
+         {
+            providers.Add(item.plugs[j]->GetProviderID());
+         }
+         scanner.Add(path, providers);
+      }
+      else if (item.state == STATE_New)
+      {
+         for (size_t j = 0, cnt = item.plugs.GetCount(); j < cnt; j++)
+         {
+            item.plugs[j]->SetValid(false);
+         }
+      }
+      else if (item.state != STATE_New)
+      {
+         for (size_t j = 0, cnt = item.plugs.GetCount(); j < cnt; j++)
+         {
+            item.plugs[j]->SetEnabled(item.state == STATE_Enabled);
+            item.plugs[j]->SetValid(item.valid);
+         }
       }
    }
 
@@ -972,49 +1009,27 @@ void PluginRegistrationDialog::OnOK(wxCommandEvent & WXUNUSED(evt))
       ProgressDialog progress(GetTitle(), msg, pdlgHideStopButton);
       progress.CenterOnParent();
 
-      int i = 0;
-      for (ItemDataMap::iterator iter = mItems.begin(); iter != mItems.end(); ++iter)
-      {
-         ItemData & item = iter->second;
-         wxString path = item.path;
-
-         if (item.state == STATE_Enabled && item.plugs[0]->GetPluginType() == PluginTypeStub)
-         {
-            last3 = last3.AfterFirst(wxT('\n')) + item.path + wxT("\n");
-            int status = progress.Update(++i, enableCount, wxString::Format(_("Enabling effect:\n\n%s"), last3.c_str()));
-            if (!status)
-            {
-               break;
-            }
+      scanner.Start();
 
-            // Try to register the plugin via each provider until one succeeds
-            for (size_t j = 0, cnt = item.plugs.GetCount(); j < cnt; j++)
-            {
-               if (mm.RegisterPlugin(item.plugs[j]->GetProviderID(), path))
-               {
-                  for (size_t j = 0, cnt = item.plugs.GetCount(); j < cnt; j++)
-                  {
-                     pm.mPlugins.erase(item.plugs[j]->GetProviderID() + wxT("_") + path);
-                  }
-                  break;
-               }
-            }
-         }
-         else if (item.state == STATE_New)
+      wxString lastPath;
+      while (scanner.IsRunning())
+      {
+         if (scanner.GetLastPath() != lastPath)
          {
-            for (size_t j = 0, cnt = item.plugs.GetCount(); j < cnt; j++)
-            {
-               item.plugs[j]->SetValid(false);
-            }
+            lastPath = scanner.GetLastPath();
+            last3 = last3.AfterFirst(wxT('\n')) + lastPath + wxT("\n");
          }
-         else if (item.state != STATE_New)
+
+         int status = progress.Update((int)scanner.GetDone(), (int)scanner.GetCount(),
+                                      wxString::Format(_("Enabling effect:\n\n%s"), last3.c_str()));
+         if (!status)
          {
-            for (size_t j = 0, cnt = item.plugs.GetCount(); j < cnt; j++)
-            {
-               item.plugs[j]->SetEnabled(item.state == STATE_Enabled);
-               item.plugs[j]->SetValid(item.valid);
-            }
+            scanner.Cancel();
+            break;
          }
+
+         wxMilliSleep(10);
+         wxTheApp->Yield();
       }
 
       pm.Save();
@@ -1160,6 +1175,11 @@ bool PluginDescriptor::IsValid() const
    return mValid;
 }
 
+const wxString & PluginDescriptor::GetFileStamp() const
+{
+   return mFileStamp;
+}
+
 void PluginDescriptor::SetPluginType(PluginType type)
 {
    mPluginType = type;
@@ -1215,6 +1235,11 @@ void PluginDescriptor::SetValid(bool valid)
    mValid = valid;
 }
 
+void PluginDescriptor::SetFileStamp(const wxString & stamp)
+{
+   mFileStamp = stamp;
+}
+
 // Effects
 
 wxString PluginDescriptor::GetEffectFamily(bool translate) const
@@ -1341,6 +1366,7 @@ void PluginDescriptor::SetImporterExtensions(const wxArrayString & extensions)
 #define KEY_VERSION                    wxT("Version")
 #define KEY_DESCRIPTION                wxT("Description")
 #define KEY_LASTUPDATED                wxT("LastUpdated")
+#define KEY_FILESTAMP                  wxT("FileStamp")
 #define KEY_ENABLED                    wxT("Enabled")
 #define KEY_VALID                      wxT("Valid")
 #define KEY_PROVIDERID                 wxT("ProviderID")
@@ -1715,11 +1741,21 @@ void PluginManager::Initialize()
    // And finally check for updates
 #ifndef EXPERIMENTAL_EFFECT_MANAGEMENT
    CheckForUpdates();
+
+   bool checkForUpdates;
+   gPrefs->Read(wxT("/Plugins/CheckForUpdates"), &checkForUpdates, true);
+   if (checkForUpdates)
+   {
+      RescanChangedPlugins();
+   }
 #endif
 }
 
 void PluginManager::Terminate()
 {
+   // Abandon any background scan, which is picked up again next time
+   mScanner.reset();
+
    // Get rid of all non-module plugins first
    PluginMap::iterator iter = mPlugins.begin();
    while (iter != mPlugins.end())
@@ -1875,6 +1911,10 @@ void PluginManager::LoadGroup(wxFileConfig *pRegistry, PluginType type)
       pRegistry->Read(KEY_VALID, &boolVal, false);
       plug.SetValid(boolVal);
 
+      // Get the file stamp (optional)
+      pRegistry->Read(KEY_FILESTAMP, &strVal, wxEmptyString);
+      plug.SetFileStamp(strVal);
+
       switch (type)
       {
          case PluginTypeModule:
@@ -2061,6 +2101,10 @@ void PluginManager::SaveGroup(wxFileConfig *pRegistry, PluginType type)
       pRegistry->Write(KEY_PROVIDERID, plug.GetProviderID());
       pRegistry->Write(KEY_ENABLED, plug.IsEnabled());
       pRegistry->Write(KEY_VALID, plug.IsValid());
+      if (!plug.GetFileStamp().IsEmpty())
+      {
+         pRegistry->Write(KEY_FILESTAMP, plug.GetFileStamp());
+      }
 
       switch (type)
       {
@@ -2211,12 +2255,182 @@ void PluginManager::CheckForUpdates()
 
 bool PluginManager::ShowManager(wxWindow *parent, EffectType type)
 {
+   // The dialog registers plugins itself.  Any that the background scan
+   // has not got to yet keep their old file stamps, and are scanned again
+   // next time.
+   mScanner.reset();
+   mRescanEnabled.clear();
+
    CheckForUpdates();
 
    PluginRegistrationDialog dlg(parent, type);
    return dlg.ShowModal() == wxID_OK;
 }
 
+wxString PluginManager::GetFileStamp(const wxString & path)
+{
+   // VST shell effects append an ID to the path of their file
+   wxFileName file(path.BeforeFirst(wxT(';')));
+   if (!file.IsAbsolute())
+   {
+      return wxEmptyString;
+   }
+
+   wxULongLong size = 0;
+   if (file.FileExists())
+   {
+      size = file.GetSize();
+   }
+   else if (!file.DirExists())
+   {
+      return wxEmptyString;
+   }
+
+   wxDateTime modified = file.GetModificationTime();
+   if (!modified.IsValid())
+   {
+      return wxEmptyString;
+   }
+
+   return modified.GetValue().ToString() + wxT(":") + size.ToString();
+}
+
+void PluginManager::RescanChangedPlugins()
+{
+   // The user may ask for everything to be registered again, once
+   bool rescanAll;
+   gPrefs->Read(wxT("/Plugins/Rescan"), &rescanAll, false);
+   if (rescanAll)
+   {
+      gPrefs->Write(wxT("/Plugins/Rescan"), false);
+      gPrefs->Flush();
+   }
+
+   mScanner = std::make_unique<PluginScanner>(
+      [this](const wxString & path, const PluginID & provider)
+      {
+         OnRescanned(path, provider);
+      },
+      [this]
+      {
+         OnRescanFinished();
+      });
+   mRescanEnabled.clear();
+   mRescanStale.Clear();
+
+   bool dirty = false;
+   wxArrayString scanned;
+   for (PluginMap::iterator iter = mPlugins.begin(); iter != mPlugins.end(); ++iter)
+   {
+      PluginDescriptor & plug = iter->second;
+      if (plug.GetPluginType() != PluginTypeEffect || !plug.IsValid())
+      {
+         continue;
+      }
+
+      wxString stamp = GetFileStamp(plug.GetPath());
+      if (stamp.IsEmpty())
+      {
+         continue;
+      }
+
+      // Registered before file stamps were kept...take it as unchanged
+      if (plug.GetFileStamp().IsEmpty())
+      {
+         plug.SetFileStamp(stamp);
+         dirty = true;
+         continue;
+      }
+
+      if (stamp == plug.GetFileStamp() && !rescanAll)
+      {
+         continue;
+      }
+
+      mRescanEnabled[plug.GetID()] = plug.IsEnabled();
+
+      // Register each file once, although it may hold several effects
+      wxString path = plug.GetPath().BeforeFirst(wxT(';'));
+      if (scanned.Index(plug.GetProviderID() + wxT("_") + path) == wxNOT_FOUND)
+      {
+         scanned.Add(plug.GetProviderID() + wxT("_") + path);
+
+         wxArrayString providers;
+         providers.Add(plug.GetProviderID());
+         mScanner->Add(path, providers);
+      }
+   }
+
+   if (dirty)
+   {
+      Save();
+   }
+
+   if (mScanner->GetCount() == 0)
+   {
+      mScanner.reset();
+      return;
+   }
+
+   mScanner->Start();
+}
+
+void PluginManager::OnRescanned(const wxString & path, const PluginID & provider)
+{
+   PluginMap::iterator iter = mPlugins.begin();
+   while (iter != mPlugins.end())
+   {
+      PluginDescriptor & plug = iter->second;
+      std::map<PluginID, bool>::iterator old = mRescanEnabled.find(plug.GetID());
+      if (old == mRescanEnabled.end() || plug.GetPath().BeforeFirst(wxT(';')) != path)
+      {
+         ++iter;
+         continue;
+      }
+
+      if (provider.IsEmpty())
+      {
+         // It can't be registered any more
+         plug.SetEnabled(false);
+         plug.SetValid(false);
+      }
+      else if (plug.GetFileStamp() != GetFileStamp(plug.GetPath()))
+      {
+         // Registered again, but without this effect
+         plug.SetEnabled(false);
+         plug.SetValid(false);
+         mRescanStale.Add(plug.GetID());
+      }
+      else
+      {
+         // Registering enables it, but the user may not have wanted it
+         plug.SetEnabled(old->second);
+      }
+
+      mRescanEnabled.erase(old);
+      ++iter;
+   }
+}
+
+void PluginManager::OnRescanFinished()
+{
+   mRescanEnabled.clear();
+
+   for (size_t i = 0; i < gAudacityProjects.size(); i++)
+   {
+      gAudacityProjects[i]->RebuildMenuBar();
+   }
+
+   // Nothing refers to the stale effects any more
+   for (size_t i = 0; i < mRescanStale.GetCount(); i++)
+   {
+      mPlugins.erase(mRescanStale[i]);
+   }
+   mRescanStale.Clear();
+
+   Save();
+}
+
 // Here solely for the purpose of Nyquist Workbench until
 // a better solution is devised.
 const PluginID & PluginManager::RegisterPlugin(EffectIdentInterface *effect)
@@ -2499,6 +2713,7 @@ PluginDescriptor & PluginManager::CreatePlugin(const PluginID & id,
    plug.SetVendor(ident->GetVendor());
    plug.SetVersion(ident->GetVersion());
    plug.SetDescription(ident->GetDescription());
+   plug.SetFileStamp(GetFileStamp(plug.GetPath()));
 
    return plug;
 }
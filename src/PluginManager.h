@@ -70,6 +70,10 @@ public:
    bool IsEnabled() const;
    bool IsValid() const;
 
+   // Modification time and size of the file at the path, when the plugin
+   // was registered; empty if the path is not a file
+   const wxString & GetFileStamp() const;
+
    // These should be passed an untranslated value
    void SetID(const PluginID & ID);
    void SetProviderID(const PluginID & providerID);
@@ -85,6 +89,7 @@ public:
 
    void SetEnabled(bool enable);
    void SetValid(bool valid);
+   void SetFileStamp(const wxString & stamp);
 
    // Effect plugins only
 
@@ -139,6 +144,7 @@ private:
    wxString mProviderID;
    bool mEnabled;
    bool mValid;
+   wxString mFileStamp;
 
    // Effects
 
@@ -169,6 +175,7 @@ typedef wxArrayString PluginIDList;
 
 class ProviderMap;
 class PluginRegistrationDialog;
+class PluginScanner;
 
 class PluginManager final : public PluginManagerInterface
 {
@@ -260,6 +267,10 @@ public:
 
    void CheckForUpdates();
 
+   // Identifies the version of the file at a plugin path, by modification
+   // time and size, so that only plugins that change are registered again
+   static wxString GetFileStamp(const wxString & path);
+
    bool ShowManager(wxWindow *parent, EffectType type = EffectTypeNone);
 
    // Here solely for the purpose of Nyquist Workbench until
@@ -279,6 +290,11 @@ private:
 
    PluginDescriptor & CreatePlugin(const PluginID & id, IdentInterface *ident, PluginType type);
 
+   // Registers again, in the background, the effects whose files changed
+   void RescanChangedPlugins();
+   void OnRescanned(const wxString & path, const PluginID & provider);
+   void OnRescanFinished();
+
    wxFileConfig *GetSettings();
 
    bool HasGroup(const wxString & group);
@@ -324,6 +340,13 @@ private:
    PluginMap mPlugins;
    PluginMap::iterator mPluginsIter;
 
+   std::unique_ptr<PluginScanner> mScanner;
+   // Enabled state of the effects being registered again, to restore
+   std::map<PluginID, bool> mRescanEnabled;
+   // Effects gone from their files since the rescan; the menus may still
+   // refer to them, so they are erased only after the menus are rebuilt
+   wxArrayString mRescanStale;
+
    friend class PluginRegistrationDialog;
 };
 
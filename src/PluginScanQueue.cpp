@@ -0,0 +1,96 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PluginScanQueue.cpp
+
+*******************************************************************//*!
+
+\file PluginScanQueue.cpp
+\brief The order in which PluginScanner tries paths and providers.
+
+*//*******************************************************************/
+
+#include "Audacity.h"
+#include "PluginScanQueue.h"
+
+#include <algorithm>
+
+PluginScanQueue::PluginScanQueue(size_t maxRunning)
+   : mMaxRunning(std::max<size_t>(1, maxRunning))
+   , mRunning(0)
+   , mDone(0)
+{
+}
+
+void PluginScanQueue::Add(const wxString & path, const wxArrayString & providers)
+{
+   Job job;
+   job.path = path;
+   job.providers = providers;
+   job.next = 0;
+
+   mWaiting.push_back(mJobs.size());
+   mJobs.push_back(job);
+}
+
+bool PluginScanQueue::Take(size_t & index, PluginID & provider)
+{
+   if (mWaiting.empty() || mRunning >= mMaxRunning)
+   {
+      return false;
+   }
+
+   index = mWaiting.front();
+   mWaiting.pop_front();
+
+   Job & job = mJobs[index];
+   provider = job.providers[job.next++];
+   mRunning++;
+   return true;
+}
+
+bool PluginScanQueue::Tried(size_t index, bool registered)
+{
+   Job & job = mJobs[index];
+   if (mRunning > 0)
+   {
+      mRunning--;
+   }
+
+   // Give the other providers a chance before the paths still waiting
+   if (!registered && job.next < job.providers.GetCount())
+   {
+      mWaiting.push_front(index);
+      return false;
+   }
+
+   mDone++;
+   return true;
+}
+
+void PluginScanQueue::Clear()
+{
+   mWaiting.clear();
+   mRunning = 0;
+}
+
+const wxString & PluginScanQueue::GetPath(size_t index) const
+{
+   return mJobs[index].path;
+}
+
+size_t PluginScanQueue::GetCount() const
+{
+   return mJobs.size();
+}
+
+size_t PluginScanQueue::GetDone() const
+{
+   return mDone;
+}
+
+size_t PluginScanQueue::GetRunning() const
+{
+   return mRunning;
+}
@@ -0,0 +1,70 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PluginScanQueue.h
+
+**********************************************************************//**
+
+\class PluginScanQueue
+\brief The order in which PluginScanner tries paths and providers.
+
+Each path waits its turn, and is then tried with its providers in turn
+until one registers it.  A path whose provider fails goes back ahead of
+the others, so that it is done as soon as may be.  No more than a given
+number of tries are under way at once.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_PLUGINSCANQUEUE_H__
+#define __AUDACITY_PLUGINSCANQUEUE_H__
+
+#include <deque>
+#include <vector>
+
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+#include "audacity/Types.h"
+
+class PluginScanQueue
+{
+public:
+   explicit PluginScanQueue(size_t maxRunning);
+
+   /// The providers, of which there must be one at least, are tried in
+   /// turn until one registers the path
+   void Add(const wxString & path, const wxArrayString & providers);
+
+   /// Takes the next path to try, and the provider to try it with, if one
+   /// is waiting and there is room for another try
+   bool Take(size_t & index, PluginID & provider);
+
+   /// Ends the try of the path.  Returns true if it is done, or false if
+   /// it waits again for its next provider.
+   bool Tried(size_t index, bool registered);
+
+   /// Abandons the paths waiting, and forgets the tries under way
+   void Clear();
+
+   const wxString & GetPath(size_t index) const;
+   size_t GetCount() const;
+   size_t GetDone() const;
+   size_t GetRunning() const;
+
+private:
+   struct Job
+   {
+      wxString path;
+      wxArrayString providers;
+      size_t next;  // index of the next provider to try
+   };
+
+   std::vector<Job> mJobs;
+   std::deque<size_t> mWaiting;
+   const size_t mMaxRunning;
+   size_t mRunning;
+   size_t mDone;
+};
+
+#endif /* __AUDACITY_PLUGINSCANQUEUE_H__ */
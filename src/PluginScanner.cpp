@@ -0,0 +1,238 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PluginScanner.cpp
+
+*******************************************************************//*!
+
+\file PluginScanner.cpp
+\brief Registers plug-ins in concurrent helper processes.
+
+*//*******************************************************************/
+
+#include "Audacity.h"
+#include "PluginScanner.h"
+
+#include <algorithm>
+
+#include <wx/log.h>
+#include <wx/process.h>
+#include <wx/stream.h>
+#include <wx/thread.h>
+#include <wx/utils.h>
+
+#include "ModuleManager.h"
+
+// How often running helpers are checked on, and waiting paths started
+#define SCANNER_INTERVAL 50 // milliseconds
+
+// Reads what is available without waiting
+static void Drain(wxInputStream *s, std::string & o)
+{
+   while (s && s->CanRead()) {
+      char buffer[4096];
+
+      s->Read(buffer, WXSIZEOF(buffer));
+      if (s->LastRead() == 0)
+         break;
+      o.append(buffer, s->LastRead());
+   }
+}
+
+class PluginScannerProcess final : public wxProcess
+{
+public:
+   PluginScannerProcess(PluginScanner *scanner, size_t index,
+                        const PluginID & provider)
+      : mScanner(scanner)
+      , mIndex(index)
+      , mProvider(provider)
+   {
+      Redirect();
+   }
+
+   // Helpers that print a lot would otherwise block on a full pipe
+   void Read()
+   {
+      Drain(GetInputStream(), mOutput);
+      std::string ignored;
+      Drain(GetErrorStream(), ignored);
+   }
+
+   void OnTerminate(int WXUNUSED(pid), int WXUNUSED(status)) override
+   {
+      Read();
+
+      // The scanner is gone if it was cancelled
+      if (mScanner)
+         mScanner->ProcessFinished(this, wxString::FromUTF8(mOutput.c_str()));
+
+      delete this;
+   }
+
+   PluginScanner *mScanner;
+   const size_t mIndex;
+   const PluginID mProvider;
+
+private:
+   std::string mOutput;
+};
+
+BEGIN_EVENT_TABLE(PluginScanner, wxEvtHandler)
+   EVT_TIMER(wxID_ANY, PluginScanner::OnTimer)
+END_EVENT_TABLE()
+
+PluginScanner::PluginScanner(const PathCallback & onPath,
+                             const FinishedCallback & onFinished)
+   : mOnPath(onPath)
+   , mOnFinished(onFinished)
+   , mQueue(std::max(1, wxThread::GetCPUCount()))
+   , mRunning(false)
+{
+   mTimer.SetOwner(this);
+}
+
+PluginScanner::~PluginScanner()
+{
+   Cancel();
+}
+
+void PluginScanner::Add(const wxString & path, const wxArrayString & providers)
+{
+   mQueue.Add(path, providers);
+}
+
+void PluginScanner::Start()
+{
+   if (mQueue.GetDone() == mQueue.GetCount())
+   {
+      if (mOnFinished)
+      {
+         mOnFinished();
+      }
+      return;
+   }
+
+   mRunning = true;
+   mTimer.Start(SCANNER_INTERVAL);
+}
+
+void PluginScanner::Cancel()
+{
+   mTimer.Stop();
+   mRunning = false;
+   mQueue.Clear();
+
+   for (size_t i = 0, cnt = mProcesses.size(); i < cnt; i++)
+   {
+      mProcesses[i]->mScanner = NULL;
+   }
+   mProcesses.clear();
+}
+
+bool PluginScanner::IsRunning() const
+{
+   return mRunning;
+}
+
+size_t PluginScanner::GetCount() const
+{
+   return mQueue.GetCount();
+}
+
+size_t PluginScanner::GetDone() const
+{
+   return mQueue.GetDone();
+}
+
+const wxString & PluginScanner::GetLastPath() const
+{
+   return mLastPath;
+}
+
+void PluginScanner::OnTimer(wxTimerEvent & WXUNUSED(evt))
+{
+   for (size_t i = 0, cnt = mProcesses.size(); i < cnt; i++)
+   {
+      mProcesses[i]->Read();
+   }
+
+   // Start helpers while there is room, but register no more than one
+   // plug-in in-process per tick, so that the GUI keeps up
+   size_t index;
+   PluginID provider;
+   while (mRunning && mQueue.Take(index, provider))
+   {
+      if (!Try(index, provider))
+      {
+         break;
+      }
+   }
+}
+
+bool PluginScanner::Try(size_t index, const PluginID & provider)
+{
+   ModuleManager & mm = ModuleManager::Get();
+   const wxString & path = mQueue.GetPath(index);
+
+   mLastPath = path;
+
+   wxString cmd = mm.GetProbeCommand(provider, path);
+   if (cmd.IsEmpty())
+   {
+      Tried(index, provider, mm.RegisterPlugin(provider, path));
+      return false;
+   }
+
+   int flags = wxEXEC_ASYNC;
+#if defined(__WXMSW__)
+   flags += wxEXEC_NOHIDE;
+#endif
+
+   PluginScannerProcess *process = safenew PluginScannerProcess(this, index, provider);
+   if (wxExecute(cmd, flags, process) == 0)
+   {
+      wxLogMessage(_("Plugin registration failed for %s\n"), path.c_str());
+      delete process;
+      Tried(index, provider, false);
+      return true;
+   }
+
+   mProcesses.push_back(process);
+   return true;
+}
+
+void PluginScanner::ProcessFinished(PluginScannerProcess *process, const wxString & output)
+{
+   mProcesses.erase(std::find(mProcesses.begin(), mProcesses.end(), process));
+
+   bool registered = ModuleManager::Get().RegisterProbedPlugin(
+      process->mProvider, mQueue.GetPath(process->mIndex), output);
+
+   Tried(process->mIndex, process->mProvider, registered);
+}
+
+void PluginScanner::Tried(size_t index, const PluginID & provider, bool registered)
+{
+   // The path may wait for its next provider
+   if (!mQueue.Tried(index, registered))
+   {
+      return;
+   }
+
+   if (mOnPath)
+   {
+      mOnPath(mQueue.GetPath(index), registered ? provider : PluginID());
+   }
+
+   if (mRunning && mQueue.GetDone() == mQueue.GetCount())
+   {
+      mTimer.Stop();
+      mRunning = false;
+      if (mOnFinished)
+      {
+         mOnFinished();
+      }
+   }
+}
@@ -0,0 +1,109 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PluginScanner.h
+
+**********************************************************************//**
+
+\class PluginScanner
+\brief Registers many plug-ins at once, without blocking the GUI.
+
+Providers that register a plug-in by looking at it in a helper process,
+such as VST, implement PluginProbeInterface.  Up to one helper per
+processor is then run at a time, and the scanner is driven by a timer
+on the main thread, so the GUI stays usable meanwhile.  Plug-ins of
+other providers are registered in-process, one per tick of the timer.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_PLUGINSCANNER_H__
+#define __AUDACITY_PLUGINSCANNER_H__
+
+#include <functional>
+#include <vector>
+
+#include <wx/arrstr.h>
+#include <wx/event.h>
+#include <wx/string.h>
+#include <wx/timer.h>
+
+#include "audacity/PluginInterface.h"
+
+#include "PluginScanQueue.h"
+
+class PluginScannerProcess;
+
+/// Implemented by providers that look at a plug-in in a helper process
+/// to register it, so that several can be looked at at once
+class PluginProbeInterface
+{
+public:
+   virtual ~PluginProbeInterface() {};
+
+   /// Command line of the helper process that looks at path
+   virtual wxString GetProbeCommand(const wxString & path) = 0;
+
+   /// Registers the plug-ins described by what the helper printed.
+   /// Returns true if any were.
+   virtual bool RegisterProbedPlugin(PluginManagerInterface & pm,
+                                     const wxString & path,
+                                     const wxString & output) = 0;
+};
+
+class PluginScanner final : public wxEvtHandler
+{
+public:
+   /// Called as each path is done, with the provider that registered it,
+   /// or an empty ID if none did
+   using PathCallback =
+      std::function< void(const wxString & path, const PluginID & provider) >;
+   /// Called when all paths are done, but not if cancelled.
+   /// Neither callback may destroy the scanner.
+   using FinishedCallback = std::function< void() >;
+
+   PluginScanner(const PathCallback & onPath,
+                 const FinishedCallback & onFinished = FinishedCallback());
+   virtual ~PluginScanner();
+
+   /// The providers are tried in turn until one registers the path
+   void Add(const wxString & path, const wxArrayString & providers);
+
+   void Start();
+
+   /// Abandons the paths not yet done.  Helpers already running are left
+   /// to finish, and what they print is ignored.
+   void Cancel();
+
+   bool IsRunning() const;
+   size_t GetCount() const;
+   size_t GetDone() const;
+
+   /// The path most recently started, for progress messages
+   const wxString & GetLastPath() const;
+
+private:
+   friend class PluginScannerProcess;
+
+   void OnTimer(wxTimerEvent & evt);
+
+   // Tries the path with the provider the queue gave.  Returns true if a
+   // helper was started, rather than the path being tried in-process.
+   bool Try(size_t index, const PluginID & provider);
+   void Tried(size_t index, const PluginID & provider, bool registered);
+   void ProcessFinished(PluginScannerProcess *process, const wxString & output);
+
+   PathCallback mOnPath;
+   FinishedCallback mOnFinished;
+
+   PluginScanQueue mQueue;
+   std::vector<PluginScannerProcess *> mProcesses;
+   bool mRunning;
+   wxString mLastPath;
+
+   wxTimer mTimer;
+
+   DECLARE_EVENT_TABLE()
+};
+
+#endif /* __AUDACITY_PLUGINSCANNER_H__ */
@@ -133,9 +133,12 @@ scroll information.  It also has some status flags.
 #include "ondemand/ODManager.h"
 #include "ondemand/ODTask.h"
 #include "ondemand/ODComputeSummaryTask.h"
-#ifdef EXPERIMENTAL_OD_FLAC
+#if defined(EXPERIMENTAL_OD_FLAC) && defined(USE_LIBFLAC)
 #include "ondemand/ODDecodeFlacTask.h"
 #endif
+#if defined(EXPERIMENTAL_OD_MP3) && defined(USE_LIBMAD)
+#include "ondemand/ODDecodeMP3Task.h"
+#endif
 #include "ModuleManager.h"
 
 #include "Theme.h"
@@ -451,10 +454,7 @@ public:
       ODManager::Pauser pauser;
 
       sortednames.Sort(CompareNoCaseFileName);
-      for (unsigned int i = 0; i < sortednames.GetCount(); i++) {
-
-         mProject->Import(sortednames[i]);
-      }
+      mProject->ImportFiles(sortednames);
       mProject->HandleResize(); // Adjust scrollers for NEW track sizes.
 
       return true;
@@ -3031,12 +3031,19 @@ void AudacityProject::OpenFile(const wxString &fileNameArg, bool addtohistory)
             while((odFlags|createdODTasks) != createdODTasks)
             {
                movable_ptr<ODTask> newTask;
-#ifdef EXPERIMENTAL_OD_FLAC
+#if defined(EXPERIMENTAL_OD_FLAC) && defined(USE_LIBFLAC)
                if(!(createdODTasks&ODTask::eODFLAC) && odFlags & ODTask::eODFLAC) {
                   newTask = make_movable<ODDecodeFlacTask>();
                   createdODTasks= createdODTasks | ODTask::eODFLAC;
                }
                else
+#endif
+#if defined(EXPERIMENTAL_OD_MP3) && defined(USE_LIBMAD)
+               if(!(createdODTasks&ODTask::eODMP3) && odFlags & ODTask::eODMP3) {
+                  newTask = make_movable<ODDecodeMP3Task>();
+                  createdODTasks= createdODTasks | ODTask::eODMP3;
+               }
+               else
 #endif
                if(!(createdODTasks&ODTask::eODPCMSummary) && odFlags & ODTask::eODPCMSummary) {
                   newTask = make_movable<ODComputeSummaryTask>();
@@ -3933,6 +3940,61 @@ bool AudacityProject::Import(const wxString &fileName, WaveTrackArray* pTrackArr
       return false;
    }
 
+   FinishImport(fileName, std::move(newTracks), pTrackArray);
+   return true;
+}
+
+void AudacityProject::ImportFiles(const wxArrayString &fileNames)
+{
+   // LOF files import the files they list as they go, so they are left
+   // out of the batch and imported in their place.
+   wxArrayString batch;
+   for (size_t ff = 0; ff < fileNames.GetCount(); ff++) {
+      if (!fileNames[ff].AfterLast('.').IsSameAs(wxT("lof"), false))
+         batch.Add(fileNames[ff]);
+   }
+
+   std::vector<Importer::BatchResult> results;
+   bool completed = true;
+   if (batch.GetCount() > 1)
+      completed = Importer::Get().ImportBatch(batch,
+                                              GetTrackFactory(),
+                                              results);
+
+   size_t nextResult = 0;
+   for (size_t ff = 0; ff < fileNames.GetCount(); ff++) {
+      const wxString &fileName = fileNames[ff];
+
+      wxString path = ::wxPathOnly(fileName);
+      gPrefs->Write(wxT("/DefaultOpenPath"), path);
+
+      if (results.empty() || fileName.AfterLast('.').IsSameAs(wxT("lof"), false)) {
+         if (completed)
+            Import(fileName);
+         continue;
+      }
+
+      auto &result = results[nextResult++];
+      if (!result.errorMessage.IsEmpty()) {
+         ShowErrorDialog(this, _("Error Importing"),
+                    result.errorMessage, wxT("innerlink:wma-proprietary"));
+      }
+      if (!result.success)
+         continue;
+
+      wxGetApp().AddFileToHistory(fileName);
+      // As if the files were imported one after another, the tags of
+      // later files win
+      for (const auto &pair : result.tags->GetRange())
+         mTags->SetTag(pair.first, pair.second);
+      FinishImport(fileName, std::move(result.tracks), NULL);
+   }
+}
+
+void AudacityProject::FinishImport(const wxString &fileName,
+                                   TrackHolders &&newTracks,
+                                   WaveTrackArray* pTrackArray)
+{
    // Have to set up newTrackList before calling AddImportedTracks,
    // because AddImportedTracks deletes newTracks.
    if (pTrackArray) {
@@ -3956,7 +4018,6 @@ bool AudacityProject::Import(const wxString &fileName, WaveTrackArray* pTrackArr
    }
 
    GetDirManager()->FillBlockfilesCache();
-   return true;
 }
 
 bool AudacityProject::SaveAs(const wxString & newFileName, bool bWantSaveCompressed /*= false*/, bool addToHistory /*= true*/)
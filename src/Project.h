@@ -244,9 +244,19 @@ class AUDACITY_DLL_API AudacityProject final : public wxFrame,
    // If pNewTrackList is passed in non-NULL, it gets filled with the pointers to NEW tracks.
    bool Import(const wxString &fileName, WaveTrackArray *pTrackArray = NULL);
 
+   // Imports several files at once, decoding on worker threads what the
+   // importers allow, and adds the tracks in the order of fileNames.
+   void ImportFiles(const wxArrayString &fileNames);
+
    void AddImportedTracks(const wxString &fileName,
                           TrackHolders &&newTracks);
 
+   // Adds the tracks of one imported file and does the rest of the
+   // bookkeeping of Import()
+   void FinishImport(const wxString &fileName,
+                     TrackHolders &&newTracks,
+                     WaveTrackArray *pTrackArray);
+
    bool Save(bool overwrite = true, bool fromSaveAs = false, bool bWantSaveCompressed = false);
    bool SaveAs(bool bWantSaveCompressed = false);
    bool SaveAs(const wxString & newFileName, bool bWantSaveCompressed = false, bool addToHistory = true);
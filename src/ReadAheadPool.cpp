@@ -0,0 +1,143 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ReadAheadPool.cpp
+
+*******************************************************************//**
+
+\file ReadAheadPool.cpp
+\brief A few threads, shared by every reader, that run jobs from one
+queue.
+
+*//*******************************************************************/
+
+#include "Audacity.h"
+#include "ReadAheadPool.h"
+
+#include <algorithm>
+
+// Detached, so that it may end when idle with no one to wait for it
+class ReadAheadPool::Worker final : public wxThread
+{
+public:
+   Worker(ReadAheadPool &pool)
+      : wxThread()
+      , mPool(pool)
+   {
+   }
+
+   ExitCode Entry() override
+   {
+      mPool.Work();
+      return 0;
+   }
+
+private:
+   ReadAheadPool &mPool;
+};
+
+ReadAheadPool::ReadAheadPool(size_t maxThreads, unsigned long idleMs)
+   : mMaxThreads(maxThreads)
+   , mIdleMs(idleMs)
+   , mCondition(mMutex)
+   , mThreads(0)
+   , mIdle(0)
+   , mStop(false)
+{
+}
+
+ReadAheadPool::~ReadAheadPool()
+{
+   wxMutexLocker locker(mMutex);
+   mStop = true;
+   mQueue.clear();
+   mCondition.Broadcast();
+   while (mThreads > 0)
+      mCondition.Wait();
+}
+
+namespace {
+   // Reading is bound by the disk, so two threads serve any number of
+   // tracks.  Made before main(), so that no two threads race to make it.
+   ReadAheadPool sPool(2);
+}
+
+ReadAheadPool &ReadAheadPool::Get()
+{
+   return sPool;
+}
+
+bool ReadAheadPool::Post(const void *owner, const Job &job)
+{
+   wxMutexLocker locker(mMutex);
+   if (mStop)
+      return false;
+
+   mQueue.push_back({ owner, job });
+
+   // Start another thread if there is more to do than the idle ones can
+   // take at once
+   if (mQueue.size() > mIdle && mThreads < mMaxThreads) {
+      Worker *worker = new Worker(*this);
+      if (worker->Create() == wxTHREAD_NO_ERROR &&
+          worker->Run() == wxTHREAD_NO_ERROR)
+         ++mThreads;
+      else
+         delete worker;
+   }
+
+   if (mThreads == 0) {
+      mQueue.pop_back();
+      return false;
+   }
+
+   mCondition.Broadcast();
+   return true;
+}
+
+void ReadAheadPool::Cancel(const void *owner)
+{
+   wxMutexLocker locker(mMutex);
+   mQueue.erase(std::remove_if(mQueue.begin(), mQueue.end(),
+      [=](const Entry &entry){ return entry.owner == owner; }),
+      mQueue.end());
+   while (std::find(mRunning.begin(), mRunning.end(), owner) != mRunning.end())
+      mCondition.Wait();
+}
+
+size_t ReadAheadPool::GetThreadCount()
+{
+   wxMutexLocker locker(mMutex);
+   return mThreads;
+}
+
+void ReadAheadPool::Work()
+{
+   wxMutexLocker locker(mMutex);
+   while (!mStop) {
+      if (mQueue.empty()) {
+         ++mIdle;
+         const wxCondError result = mCondition.WaitTimeout(mIdleMs);
+         --mIdle;
+         if (result == wxCOND_TIMEOUT && mQueue.empty())
+            break;
+         continue;
+      }
+
+      Entry entry = std::move(mQueue.front());
+      mQueue.pop_front();
+      mRunning.push_back(entry.owner);
+
+      mMutex.Unlock();
+      entry.job();
+      mMutex.Lock();
+
+      mRunning.erase(std::find(mRunning.begin(), mRunning.end(), entry.owner));
+      mCondition.Broadcast();
+   }
+
+   // The thread does nothing more with the pool, which may now go
+   --mThreads;
+   mCondition.Broadcast();
+}
@@ -0,0 +1,80 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ReadAheadPool.h
+
+*******************************************************************//**
+
+\class ReadAheadPool
+\brief A few threads, shared by every reader, that run jobs from one
+queue.
+
+Reading ahead is bound by the disk, so however many tracks are read at
+once, a couple of threads keep it as busy as one for each would.  The
+threads are started as jobs arrive, up to the limit, and end after they
+have been idle a while.
+
+Each job belongs to an owner, which must cancel its jobs before it goes
+away.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_READ_AHEAD_POOL__
+#define __AUDACITY_READ_AHEAD_POOL__
+
+#include <stddef.h>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include <wx/thread.h>
+
+class ReadAheadPool
+{
+public:
+   using Job = std::function<void()>;
+
+   explicit ReadAheadPool(size_t maxThreads, unsigned long idleMs = 5000);
+
+   // Returns once all of the threads have ended; the jobs still queued are
+   // dropped
+   ~ReadAheadPool();
+
+   // The pool that WaveTrackCache reads ahead on
+   static ReadAheadPool &Get();
+
+   // Queues job behind all others.  Returns false, not queueing it, if
+   // there is no thread to run it.
+   bool Post(const void *owner, const Job &job);
+
+   // Drops the owner's queued jobs, and returns once none of its jobs is
+   // running.  Never call from a job.
+   void Cancel(const void *owner);
+
+   size_t GetThreadCount();
+
+private:
+   class Worker;
+
+   struct Entry
+   {
+      const void *owner;
+      Job job;
+   };
+
+   void Work();
+
+   const size_t mMaxThreads;
+   const unsigned long mIdleMs;
+
+   wxMutex mMutex;
+   wxCondition mCondition;
+   std::deque<Entry> mQueue;
+   std::vector<const void *> mRunning;
+   size_t mThreads;
+   size_t mIdle;
+   bool mStop;
+};
+
+#endif
@@ -16,9 +16,10 @@
 
       libsoxr, written by Rob Sykes. LGPL.
 
-   Since Audacity always does resampling on mono streams that are
-   contiguous in memory, this class doesn't support multiple channels
-   or some of the other optional features of some of these resamplers.
+   Audacity keeps each channel contiguous in memory, so a multi-channel
+   Resample is set up for split (non-interleaved) buffers, one per
+   channel, which libsoxr converts together in a single call and can
+   spread over several threads.
 
 *//*******************************************************************/
 
@@ -27,8 +28,12 @@
 
 #include <soxr.h>
 
-Resample::Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor)
+#include <algorithm>
+
+Resample::Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor,
+                   const unsigned numChannels, const unsigned numThreads)
 {
+   mNumChannels = std::max(1u, numChannels);
    this->SetMethod(useBestMethod);
    soxr_quality_spec_t q_spec;
    if (dMinFactor == dMaxFactor)
@@ -41,7 +46,15 @@ Resample::Resample(const bool useBestMethod, const double dMinFactor, const doub
       mbWantConstRateResampling = false; // variable rate resampling
       q_spec = soxr_quality_spec(SOXR_HQ, SOXR_VR);
    }
-   mHandle = (void *)soxr_create(1, dMinFactor, 1, 0, 0, &q_spec, 0);
+   soxr_runtime_spec_t runtime_spec = soxr_runtime_spec(numThreads);
+   if (mNumChannels == 1)
+      mHandle = (void *)soxr_create(1, dMinFactor, 1, 0, 0, &q_spec, &runtime_spec);
+   else
+   {
+      soxr_io_spec_t io_spec = soxr_io_spec(SOXR_FLOAT32_S, SOXR_FLOAT32_S);
+      mHandle = (void *)soxr_create(1, dMinFactor, mNumChannels, 0,
+                                    &io_spec, &q_spec, &runtime_spec);
+   }
 }
 
 Resample::~Resample()
@@ -74,34 +87,62 @@ const wxString Resample::GetBestMethodKey()
 int Resample::GetFastMethodDefault() {return 1;}
 int Resample::GetBestMethodDefault() {return 3;}
 
-int Resample::Process(double  factor,
-                        float  *inBuffer,
-                        int     inBufferLen,
-                        bool    lastFlag,
-                        int    *inBufferUsed,
-                        float  *outBuffer,
-                        int     outBufferLen)
+static int DoProcess(soxr_t handle, bool constRate, double factor,
+                     const void *in, int inBufferLen, bool lastFlag,
+                     int *inBufferUsed, void *out, int outBufferLen)
 {
    size_t idone, odone;
-   if (mbWantConstRateResampling)
+   if (constRate)
    {
-      soxr_process((soxr_t)mHandle,
-            inBuffer , (size_t)(lastFlag? ~inBufferLen : inBufferLen), &idone,
-            outBuffer, (size_t)                          outBufferLen, &odone);
+      soxr_process(handle,
+            in , (size_t)(lastFlag? ~inBufferLen : inBufferLen), &idone,
+            out, (size_t)                          outBufferLen, &odone);
    }
    else
    {
-      soxr_set_io_ratio((soxr_t)mHandle, 1/factor, 0);
+      soxr_set_io_ratio(handle, 1/factor, 0);
 
       inBufferLen = lastFlag? ~inBufferLen : inBufferLen;
-      soxr_process((soxr_t)mHandle,
-            inBuffer , (size_t)inBufferLen , &idone,
-            outBuffer, (size_t)outBufferLen, &odone);
+      soxr_process(handle,
+            in , (size_t)inBufferLen , &idone,
+            out, (size_t)outBufferLen, &odone);
    }
    *inBufferUsed = (int)idone;
    return (int)odone;
 }
 
+int Resample::Process(double  factor,
+                        float  *inBuffer,
+                        int     inBufferLen,
+                        bool    lastFlag,
+                        int    *inBufferUsed,
+                        float  *outBuffer,
+                        int     outBufferLen)
+{
+   wxASSERT(mNumChannels == 1);
+   return DoProcess((soxr_t)mHandle, mbWantConstRateResampling, factor,
+                    inBuffer, inBufferLen, lastFlag, inBufferUsed,
+                    outBuffer, outBufferLen);
+}
+
+int Resample::Process(double  factor,
+                        float * const *inBuffers,
+                        int     inBufferLen,
+                        bool    lastFlag,
+                        int    *inBufferUsed,
+                        float * const *outBuffers,
+                        int     outBufferLen)
+{
+   if (mNumChannels == 1)
+      return Process(factor, inBuffers[0], inBufferLen, lastFlag,
+                     inBufferUsed, outBuffers[0], outBufferLen);
+
+   // With split I/O, libsoxr takes arrays of per-channel pointers
+   return DoProcess((soxr_t)mHandle, mbWantConstRateResampling, factor,
+                    inBuffers, inBufferLen, lastFlag, inBufferUsed,
+                    outBuffers, outBufferLen);
+}
+
 void Resample::SetMethod(const bool useBestMethod)
 {
    if (useBestMethod)
@@ -32,7 +32,11 @@ class Resample final
    /// the fast method.
    // dMinFactor and dMaxFactor specify the range of factors for variable-rate resampling.
    // For constant-rate, pass the same value for both.
-   Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor);
+   // numChannels channels are converted together by one resampler, which
+   // then expects one non-interleaved buffer per channel in Process().
+   // numThreads is passed to libsoxr; 0 lets it choose, 1 disables threading.
+   Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor,
+            const unsigned numChannels = 1, const unsigned numThreads = 1);
    ~Resample();
 
    static int GetNumMethods();
@@ -73,6 +77,23 @@ class Resample final
                         float  *outBuffer,
                         int     outBufferLen);
 
+   /** @brief Multi-channel variant of Process().
+    *
+    * inBuffers and outBuffers each hold GetNumChannels() pointers to
+    * separate (non-interleaved) channel buffers.  All channels consume
+    * and produce the same number of samples, so lengths and the
+    * results are counted per channel.
+   */
+   int Process(double   factor,
+                        float * const *inBuffers,
+                        int     inBufferLen,
+                        bool    lastFlag,
+                        int    *inBufferUsed,
+                        float * const *outBuffers,
+                        int     outBufferLen);
+
+   unsigned GetNumChannels() const { return mNumChannels; }
+
  protected:
    void SetMethod(const bool useBestMethod);
 
@@ -80,6 +101,7 @@ class Resample final
    int   mMethod; // resampler-specific enum for resampling method
    void* mHandle; // constant-rate or variable-rate resampler (XOR per instance)
    bool mbWantConstRateResampling;
+   unsigned mNumChannels;
 };
 
 #endif // __AUDACITY_RESAMPLE_H__
@@ -386,6 +386,93 @@ bool Sequence::GetRMS(sampleCount start, sampleCount len,
    return true;
 }
 
+bool Sequence::GetStats(sampleCount start, sampleCount len,
+                        SampleStats &stats) const
+{
+   stats.Clear();
+
+   if (len == 0 || mBlock.size() == 0)
+      return true;
+
+   if (start < 0 || start + len > mNumSamples)
+      return false;
+
+   SampleBuffer buffer;
+   int b = FindBlock(start);
+   while (len) {
+      const SeqBlock &block = mBlock[b];
+      const auto &theFile = block.f;
+      const sampleCount bstart = start - block.start;
+      const sampleCount blen =
+         std::min(len, theFile->GetLength() - bstart);
+
+      SampleStats blockStats;
+      if (blen == theFile->GetLength() && theFile->GetStats(blockStats))
+         stats += blockStats;
+      else {
+         buffer.Allocate(blen, floatSample);
+         Read(buffer.ptr(), floatSample, block, bstart, blen);
+         stats.Accumulate((const float *)buffer.ptr(), blen);
+      }
+
+      len -= blen;
+      start += blen;
+      b++;
+   }
+
+   return true;
+}
+
+sampleCount Sequence::GetBlockStats(sampleCount start, SampleStats &stats) const
+{
+   if (start < 0 || start >= mNumSamples)
+      return 0;
+
+   const SeqBlock &block = mBlock[FindBlock(start)];
+   if (!block.f->GetStats(stats))
+      return 0;
+
+   return block.start + block.f->GetLength() - start;
+}
+
+bool Sequence::GetBlockAt(sampleCount start, BlockFilePtr &file,
+                          sampleCount &blockStart, sampleCount &blockLen) const
+{
+   if (start < 0 || start >= mNumSamples)
+      return false;
+
+   const SeqBlock &block = mBlock[FindBlock(start)];
+   file = block.f;
+   blockStart = block.start;
+   blockLen = block.f->GetLength();
+   return true;
+}
+
+bool Sequence::GetBlockPeaks(sampleCount start, sampleCount &blockStart,
+                             sampleCount &blockLen, std::vector<float> &peaks) const
+{
+   if (start < 0 || start >= mNumSamples)
+      return false;
+
+   const SeqBlock &block = mBlock[FindBlock(start)];
+   const auto &theFile = block.f;
+   if (!theFile->IsSummaryAvailable())
+      return false;
+
+   const sampleCount frames = (theFile->GetLength() + 255) / 256;
+   std::vector<float> summary(3 * frames);
+   if (!theFile->Read256(&summary[0], 0, frames))
+      return false;
+
+   peaks.resize(frames);
+   for (sampleCount i = 0; i < frames; i++)
+      peaks[i] = std::max(-summary[3 * i], summary[3 * i + 1]);
+
+   blockStart = block.start;
+   blockLen = theFile->GetLength();
+   return true;
+}
+
 bool Sequence::Copy(sampleCount s0, sampleCount s1, std::unique_ptr<Sequence> &dest) const
 {
    dest.reset();
@@ -1092,7 +1179,7 @@ int Sequence::FindBlock(sampleCount pos) const
 }
 
 bool Sequence::Read(samplePtr buffer, sampleFormat format,
-                    const SeqBlock &b, sampleCount start, sampleCount len) const
+                    const SeqBlock &b, sampleCount start, sampleCount len)
 {
    const auto &f = b.f;
 
@@ -1273,18 +1360,55 @@ struct MinMaxSumsq
 
 bool Sequence::GetWaveDisplay(float *min, float *max, float *rms, int* bl,
                               int len, const sampleCount *where)
+{
+   DisplayBlocks display;
+   if (!CopyDisplayBlocks(display, len, where))
+      return false;
+   return GetWaveDisplay(display, min, max, rms, bl, len, where);
+}
+
+bool Sequence::CopyDisplayBlocks(DisplayBlocks &display,
+                                 int len, const sampleCount *where) const
 {
    const sampleCount s0 = std::max(sampleCount(0), where[0]);
    if (s0 >= mNumSamples)
       // None of the samples asked for are in range. Abandon.
       return false;
 
+   // The same limit as GetWaveDisplay computes
+   const sampleCount s1 =
+      std::min(mNumSamples, std::max(1 + where[len - 1], where[len]));
+
+   const unsigned block0 = FindBlock(s0);
+   const unsigned block1 = FindBlock(s1 - 1) + 1;
+   display.blocks.clear();
+   display.blocks.insert(display.blocks.end(),
+                         mBlock.begin() + block0, mBlock.begin() + block1);
+   display.firstBlock = block0;
+   display.numSamples = mNumSamples;
+   display.maxSamples = mMaxSamples;
+   return true;
+}
+
+bool Sequence::GetWaveDisplay(const DisplayBlocks &display,
+                              float *min, float *max, float *rms, int* bl,
+                              int len, const sampleCount *where)
+{
+   const sampleCount numSamples = display.numSamples;
+   const sampleCount maxSamples = display.maxSamples;
+   const BlockArray &blocks = display.blocks;
+
+   const sampleCount s0 = std::max(sampleCount(0), where[0]);
+   if (s0 >= numSamples)
+      // None of the samples asked for are in range. Abandon.
+      return false;
+
    // In case where[len - 1] == where[len], raise the limit by one,
    // so we load at least one pixel for column len - 1
-   // ... unless the mNumSamples ceiling applies, and then there are other defenses
+   // ... unless the numSamples ceiling applies, and then there are other defenses
    const sampleCount s1 =
-      std::min(mNumSamples, std::max(1 + where[len - 1], where[len]));
-   float *temp = new float[mMaxSamples];
+      std::min(numSamples, std::max(1 + where[len - 1], where[len]));
+   float *temp = new float[maxSamples];
 
    int pixel = 0;
 
@@ -1296,8 +1420,9 @@ bool Sequence::GetWaveDisplay(float *min, float *max, float *rms, int* bl,
    sampleCount whereNext = 0;
    // Loop over block files, opening and reading and closing each
    // not more than once
-   unsigned nBlocks = mBlock.size();
-   const unsigned int block0 = FindBlock(s0);
+   // The copy begins with the block holding s0
+   unsigned nBlocks = blocks.size();
+   const unsigned int block0 = 0;
    for (unsigned int b = block0; b < nBlocks; ++b) {
       if (b > block0)
          srcX = nextSrcX;
@@ -1306,7 +1431,7 @@ bool Sequence::GetWaveDisplay(float *min, float *max, float *rms, int* bl,
 
       // Find the range of sample values for this block that
       // are in the display.
-      SeqBlock &seqBlock = mBlock[b];
+      const SeqBlock &seqBlock = blocks[b];
       const sampleCount start = seqBlock.start;
       nextSrcX = std::min(s1, start + seqBlock.f->GetLength());
 
@@ -1347,13 +1472,13 @@ bool Sequence::GetWaveDisplay(float *min, float *max, float *rms, int* bl,
          : (samplesPerPixel >= 256) ? 256
          : 1;
 
-      int blockStatus = b;
+      int blockStatus = display.firstBlock + b;
 
       // How many samples or triples are needed?
       const sampleCount startPosition =
          std::max(sampleCount(0), (srcX - start) / divisor);
       const sampleCount inclusiveEndPosition =
-         std::min((mMaxSamples / divisor) - 1, (nextSrcX - 1 - start) / divisor);
+         std::min((maxSamples / divisor) - 1, (nextSrcX - 1 - start) / divisor);
       const sampleCount num = 1 + inclusiveEndPosition - startPosition;
       if (num <= 0) {
          // What?  There was a zero length block file?
@@ -1381,7 +1506,7 @@ bool Sequence::GetWaveDisplay(float *min, float *max, float *rms, int* bl,
             seqBlock.f->Read256(temp, startPosition, num);
          else
             //otherwise, mark the display as not yet computed
-            blockStatus = -1 - b;
+            blockStatus = -1 - blockStatus;
          break;
       case 65536:
          // Read triples
@@ -1390,7 +1515,7 @@ bool Sequence::GetWaveDisplay(float *min, float *max, float *rms, int* bl,
             seqBlock.f->Read64K(temp, startPosition, num);
          else
             //otherwise, mark the display as not yet computed
-            blockStatus = -1 - b;
+            blockStatus = -1 - blockStatus;
          break;
       }
       
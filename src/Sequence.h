@@ -30,6 +30,7 @@ typedef wxLongLong_t sampleCount; /** < A native 64-bit integer type, because
 #endif
 
 class BlockFile;
+class SampleStats;
 using BlockFilePtr = std::shared_ptr<BlockFile>;
 
 class DirManager;
@@ -102,6 +103,26 @@ class PROFILE_DLL_API Sequence final : public XMLTagHandler{
    bool GetWaveDisplay(float *min, float *max, float *rms, int* bl,
                        int len, const sampleCount *where);
 
+   // What GetWaveDisplay reads, copied so that it can be read on another
+   // thread.  Block files are never rewritten, so the copy stays good
+   // however the sequence is edited meanwhile.
+   struct DisplayBlocks {
+      BlockArray blocks;
+      unsigned firstBlock{ 0 }; // index in the sequence of blocks[0]
+      sampleCount numSamples{ 0 };
+      sampleCount maxSamples{ 0 };
+   };
+
+   // Copies the blocks needed for the columns given by where, as above.
+   // Return false if none of the samples asked for are in range.
+   bool CopyDisplayBlocks(DisplayBlocks &display,
+                          int len, const sampleCount *where) const;
+
+   // As above, but from a copy, and safe to call on any thread
+   static bool GetWaveDisplay(const DisplayBlocks &display,
+                              float *min, float *max, float *rms, int* bl,
+                              int len, const sampleCount *where);
+
    bool Copy(sampleCount s0, sampleCount s1, std::unique_ptr<Sequence> &dest) const;
    bool Paste(sampleCount s0, const Sequence *src);
 
@@ -130,7 +151,7 @@ class PROFILE_DLL_API Sequence final : public XMLTagHandler{
    bool SetSilence(sampleCount s0, sampleCount len);
    bool InsertSilence(sampleCount s0, sampleCount len);
 
-   const std::shared_ptr<DirManager> &GetDirManager() { return mDirManager; }
+   const std::shared_ptr<DirManager> &GetDirManager() const { return mDirManager; }
 
    //
    // XMLTagHandler callback methods for loading and saving
@@ -172,6 +193,23 @@ class PROFILE_DLL_API Sequence final : public XMLTagHandler{
                   float * min, float * max) const;
    bool GetRMS(sampleCount start, sampleCount len,
                   float * outRMS) const;
+   // Whole blocks are answered from their stored statistics; only the
+   // blocks partly inside the region are read
+   bool GetStats(sampleCount start, sampleCount len,
+                 SampleStats &stats) const;
+   // Gets the statistics of the whole block holding sample start, and
+   // returns the number of samples from start to the end of that block,
+   // or 0 if the block has none yet
+   sampleCount GetBlockStats(sampleCount start, SampleStats &stats) const;
+   // Gets the block file holding sample start, and that block's extent;
+   // false if start is outside the sequence
+   bool GetBlockAt(sampleCount start, BlockFilePtr &file,
+                   sampleCount &blockStart, sampleCount &blockLen) const;
+   // Gets the largest magnitude in each 256-sample summary frame of the
+   // block holding sample start, and that block's extent; false if the
+   // block's summary isn't ready
+   bool GetBlockPeaks(sampleCount start, sampleCount &blockStart,
+                      sampleCount &blockLen, std::vector<float> &peaks) const;
 
    //
    // Getting block size and alignment information
@@ -242,9 +280,9 @@ class PROFILE_DLL_API Sequence final : public XMLTagHandler{
 
    bool AppendBlock(const SeqBlock &b);
 
-   bool Read(samplePtr buffer, sampleFormat format,
-             const SeqBlock &b,
-             sampleCount start, sampleCount len) const;
+   static bool Read(samplePtr buffer, sampleFormat format,
+                    const SeqBlock &b,
+                    sampleCount start, sampleCount len);
 
    bool CopyWrite(SampleBuffer &scratch,
                   samplePtr buffer,    SeqBlock &b,
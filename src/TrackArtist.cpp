@@ -1471,8 +1471,12 @@ void TrackArtist::DrawWaveform(const WaveTrack *track,
    DrawBackgroundWithSelection(&dc, rect, track, blankSelectedBrush, blankBrush,
          selectedRegion, zoomInfo);
 
-   for (const auto &clip: track->GetClips())
-      DrawClipWaveform(track, clip.get(), dc, rect, selectedRegion, zoomInfo,
+   // Clips out of view draw nothing, so don't visit them; with a pixel
+   // to spare, as ClipParameters finds what is visible
+   const double h0 = zoomInfo.PositionToTime(-1, 0, true);
+   const double h1 = zoomInfo.PositionToTime(rect.width + 1, 0, true);
+   for (const auto clip: track->GetClipsInTimeRange(h0, h1))
+      DrawClipWaveform(track, clip, dc, rect, selectedRegion, zoomInfo,
                        drawEnvelope, bigPoints,
                        dB, muted);
 
@@ -2009,9 +2013,12 @@ void TrackArtist::DrawSpectrum(const WaveTrack *track,
    DrawBackgroundWithSelection(&dc, rect, track, blankSelectedBrush, blankBrush,
          selectedRegion, zoomInfo);
 
+   // As in DrawWaveform, visit only the clips in view
+   const double h0 = zoomInfo.PositionToTime(-1, 0, true);
+   const double h1 = zoomInfo.PositionToTime(rect.width + 1, 0, true);
    WaveTrackCache cache(track);
-   for (const auto &clip: track->GetClips()) {
-      DrawClipSpectrum(cache, clip.get(), dc, rect, selectedRegion, zoomInfo);
+   for (const auto clip: track->GetClipsInTimeRange(h0, h1)) {
+      DrawClipSpectrum(cache, clip, dc, rect, selectedRegion, zoomInfo);
    }
 }
 
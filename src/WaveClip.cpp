@@ -17,15 +17,24 @@
 \class WaveCache
 \brief Cache used with WaveClip to cache wave information (for drawing).
 
+*//****************************************************************//**
+
+\class WaveDisplayWorker
+\brief Thread that reads the columns of WaveCaches from the disk, so that
+drawing never waits for it.
+
 *//*******************************************************************/
 
 #include "WaveClip.h"
 
 #include <math.h>
 #include "MemoryX.h"
+#include <deque>
 #include <functional>
+#include <set>
 #include <vector>
 #include <wx/log.h>
+#include <wx/thread.h>
 
 #include "Sequence.h"
 #include "Spectrum.h"
@@ -37,11 +46,197 @@
 #include "FFT.h"
 
 #include "prefs/SpectrogramSettings.h"
+#include "ondemand/ODManager.h"
 
 #include <wx/listimpl.cpp>
 
 #include "Experimental.h"
 
+namespace {
+
+// Columns of a WaveCache for the worker to compute.  It is given its own
+// copy of where and of the blocks, so that it doesn't touch the clip.
+struct WaveDisplayRequest
+{
+   WaveDisplayRequest(int p0_, int len_, const DirManager *dirManager_)
+      : p0(p0_), len(len_), dirManager(dirManager_)
+      , where(len_ + 1), min(len_), max(len_), rms(len_), bl(len_)
+   {}
+
+   const int p0;  // first column in the cache
+   const int len;
+   // Identifies the project to redraw; only compared, never used
+   const DirManager *const dirManager;
+   Sequence::DisplayBlocks blocks;
+   std::vector<sampleCount> where;
+   std::vector<float> min;
+   std::vector<float> max;
+   std::vector<float> rms;
+   std::vector<int> bl;
+
+   // Guarded by the worker's mutex
+   bool done{ false };
+   bool cancelled{ false };
+};
+
+using WaveDisplayRequestPtr = std::shared_ptr<WaveDisplayRequest>;
+
+// One thread serves the requests of all clips, in order.  Results are not
+// written into the caches; each cache takes them the next time its clip
+// is drawn, and the worker asks for a redraw when it has some, as
+// ODManager does for its tasks.
+//
+// The blocks in a request may be the last references to their files, and
+// a BlockFile deletes its file when destroyed, so requests are only
+// destroyed on the main thread: the worker hands those it has finished
+// to sFinished, dropping its own reference under the lock, and they are
+// kept there until ReleaseFinished() is next called.
+class WaveDisplayWorker final : public wxThread
+{
+public:
+   // Returns false if there is no worker to take the request
+   static bool Schedule(const WaveDisplayRequestPtr &request)
+   {
+      wxMutexLocker locker(sMutex);
+      if (sStopping)
+         return false;
+
+      if (!sWorker) {
+         auto worker = std::unique_ptr<WaveDisplayWorker>
+            { safenew WaveDisplayWorker };
+         if (worker->Create() != wxTHREAD_NO_ERROR ||
+             worker->Run() != wxTHREAD_NO_ERROR)
+            return false;
+         sWorker = std::move(worker);
+      }
+
+      sQueue.push_back(request);
+      sCondition.Signal();
+      return true;
+   }
+
+   static bool IsDone(const WaveDisplayRequest &request)
+   {
+      wxMutexLocker locker(sMutex);
+      return request.done;
+   }
+
+   static void Cancel(WaveDisplayRequest &request)
+   {
+      wxMutexLocker locker(sMutex);
+      request.cancelled = true;
+   }
+
+   static void ReleaseFinished()
+   {
+      std::vector<WaveDisplayRequestPtr> finished;
+      {
+         wxMutexLocker locker(sMutex);
+         finished.swap(sFinished);
+      }
+   }
+
+   static void Stop()
+   {
+      std::unique_ptr<WaveDisplayWorker> worker;
+      {
+         wxMutexLocker locker(sMutex);
+         sStopping = true;
+         sCondition.Signal();
+         worker = std::move(sWorker);
+      }
+      if (worker)
+         worker->Wait();
+
+      sQueue.clear();
+      ReleaseFinished();
+   }
+
+private:
+   WaveDisplayWorker() : wxThread(wxTHREAD_JOINABLE) {}
+
+   // Don't redraw more often than this, while requests are queued
+   enum { kRepaintInterval = 100 }; // milliseconds
+
+   ExitCode Entry() override
+   {
+      wxLongLong lastRepaint = ::wxGetLocalTimeMillis();
+      // The projects with requests done since the last redraw
+      std::set<const DirManager*> toRepaint;
+      while (true) {
+         WaveDisplayRequestPtr request;
+         {
+            wxMutexLocker locker(sMutex);
+            while (sQueue.empty() && !sStopping)
+               sCondition.Wait();
+            if (sStopping)
+               break;
+
+            request = std::move(sQueue.front());
+            sQueue.pop_front();
+            if (request->cancelled) {
+               sFinished.push_back(std::move(request));
+               continue;
+            }
+         }
+
+         WaveDisplayRequest &r = *request;
+         if (!Sequence::GetWaveDisplay(r.blocks,
+                                       &r.min[0], &r.max[0], &r.rms[0], &r.bl[0],
+                                       r.len, &r.where[0])) {
+            // Draw silence, rather than leave the columns waiting forever
+            std::fill(r.min.begin(), r.min.end(), 0.0f);
+            std::fill(r.max.begin(), r.max.end(), 0.0f);
+            std::fill(r.rms.begin(), r.rms.end(), 0.0f);
+            std::fill(r.bl.begin(), r.bl.end(), 1);
+         }
+
+         toRepaint.insert(r.dirManager);
+
+         bool idle;
+         {
+            wxMutexLocker locker(sMutex);
+            r.done = true;
+            idle = sQueue.empty();
+            sFinished.push_back(std::move(request));
+         }
+
+         const wxLongLong now = ::wxGetLocalTimeMillis();
+         if (idle || now - lastRepaint >= kRepaintInterval) {
+            lastRepaint = now;
+            // Redraw whichever projects the clips belong to, as ODTask
+            // finds the projects of its tracks
+            wxCommandEvent event( EVT_ODTASK_UPDATE );
+            ODLocker locker{ &AudacityProject::AllProjectDeleteMutex() };
+            for (unsigned i = 0; i < gAudacityProjects.size(); i++) {
+               AudacityProject *proj = gAudacityProjects[i].get();
+               if (toRepaint.count(proj->GetDirManager().get()))
+                  proj->GetEventHandler()->AddPendingEvent(event);
+            }
+            toRepaint.clear();
+         }
+      }
+
+      return 0;
+   }
+
+   static wxMutex sMutex;
+   static wxCondition sCondition;
+   static std::deque<WaveDisplayRequestPtr> sQueue;
+   static std::vector<WaveDisplayRequestPtr> sFinished;
+   static std::unique_ptr<WaveDisplayWorker> sWorker;
+   static bool sStopping;
+};
+
+wxMutex WaveDisplayWorker::sMutex;
+wxCondition WaveDisplayWorker::sCondition(WaveDisplayWorker::sMutex);
+std::deque<WaveDisplayRequestPtr> WaveDisplayWorker::sQueue;
+std::vector<WaveDisplayRequestPtr> WaveDisplayWorker::sFinished;
+std::unique_ptr<WaveDisplayWorker> WaveDisplayWorker::sWorker;
+bool WaveDisplayWorker::sStopping = false;
+
+}
+
 class WaveCache {
 public:
    WaveCache()
@@ -80,6 +275,8 @@ public:
    ~WaveCache()
    {
       ClearInvalidRegions();
+      for (const auto &request : pending)
+         WaveDisplayWorker::Cancel(*request);
    }
 
    int          dirty;
@@ -94,6 +291,9 @@ public:
    std::vector<int> bl;
    int         numODPixels;
 
+   // Requests to the worker, in the order made
+   std::vector<WaveDisplayRequestPtr> pending;
+
    class InvalidRegion
    {
    public:
@@ -215,36 +415,72 @@ public:
       mRegions.clear();
    }
 
-   void LoadInvalidRegion(int ii, Sequence *sequence, bool updateODCount)
+   // Asks the worker for columns [p0, p1).  If clear, they are drawn as
+   // not yet loaded until it is done; otherwise what they hold now is
+   // drawn.  Returns false if none of their samples are in the sequence.
+   bool Request(int p0, int p1, const Sequence *sequence, bool clear)
    {
-      const int invStart = GetInvalidRegionStart(ii);
-      const int invEnd = GetInvalidRegionEnd(ii);
-
-      //before check number of ODPixels
-      int regionODPixels = 0;
-      if (updateODCount)
-         regionODPixels = CountODPixels(invStart, invEnd);
-
-      sequence->GetWaveDisplay(&min[invStart],
-         &max[invStart],
-         &rms[invStart],
-         &bl[invStart],
-         invEnd - invStart,
-         &where[invStart]);
-
-      //after check number of ODPixels
-      if (updateODCount)
-      {
-         const int regionODPixelsAfter = CountODPixels(invStart, invEnd);
-         numODPixels -= (regionODPixels - regionODPixelsAfter);
+      auto request = std::make_shared<WaveDisplayRequest>
+         (p0, p1 - p0, sequence->GetDirManager().get());
+      if (!sequence->CopyDisplayBlocks(request->blocks, p1 - p0, &where[p0]))
+         return false;
+      std::copy(&where[p0], &where[p1 + 1], request->where.begin());
+
+      if (!WaveDisplayWorker::Schedule(request)) {
+         // No thread; read the columns here, as before there was one
+         const int regionODPixels = CountODPixels(p0, p1);
+         Sequence::GetWaveDisplay(request->blocks,
+            &min[p0], &max[p0], &rms[p0], &bl[p0], p1 - p0, &where[p0]);
+         numODPixels -= regionODPixels - CountODPixels(p0, p1);
+         return true;
       }
+
+      if (clear) {
+         const int regionODPixels = CountODPixels(p0, p1);
+         std::fill(&min[p0], &min[p1], 0.0f);
+         std::fill(&max[p0], &max[p1], 0.0f);
+         std::fill(&rms[p0], &rms[p1], 0.0f);
+         std::fill(&bl[p0], &bl[p1], -1);
+         numODPixels += (p1 - p0) - regionODPixels;
+      }
+
+      pending.push_back(request);
+      return true;
    }
 
-   void LoadInvalidRegions(Sequence *sequence, bool updateODCount)
+   void RequestInvalidRegions(const Sequence *sequence)
    {
       //invalid regions are kept in a sorted array.
-      for (int i = 0; i < GetNumInvalidRegions(); i++)
-         LoadInvalidRegion(i, sequence, updateODCount);
+      for (int i = 0; i < GetNumInvalidRegions(); i++) {
+         const int invStart = GetInvalidRegionStart(i);
+         const int invEnd = std::min(len, GetInvalidRegionEnd(i));
+         if (invEnd > invStart)
+            Request(invStart, invEnd, sequence, false);
+      }
+   }
+
+   // Copies in the columns of the requests the worker has finished.  It
+   // serves them in order, so a later request for a column wins.
+   void TakeFinished()
+   {
+      auto iter = pending.begin(), end = pending.end();
+      for (; iter != end && WaveDisplayWorker::IsDone(**iter); ++iter) {
+         const WaveDisplayRequest &request = **iter;
+         const int p0 = request.p0, p1 = p0 + request.len;
+
+         //before check number of ODPixels
+         const int regionODPixels = CountODPixels(p0, p1);
+
+         std::copy(request.min.begin(), request.min.end(), &min[p0]);
+         std::copy(request.max.begin(), request.max.end(), &max[p0]);
+         std::copy(request.rms.begin(), request.rms.end(), &rms[p0]);
+         std::copy(request.bl.begin(), request.bl.end(), &bl[p0]);
+
+         //after check number of ODPixels
+         const int regionODPixelsAfter = CountODPixels(p0, p1);
+         numODPixels -= (regionODPixels - regionODPixelsAfter);
+      }
+      pending.erase(pending.begin(), iter);
    }
 
    int CountODPixels(int start, int end)
@@ -288,6 +524,8 @@ static void ComputeSpectrumUsingRealFFTf
    }
 }
 
+std::atomic<unsigned long> WaveClip::sPlacementGeneration { 0 };
+
 WaveClip::WaveClip(const std::shared_ptr<DirManager> &projDirManager, sampleFormat format, int rate)
 {
    mOffset = 0;
@@ -333,6 +571,8 @@ WaveClip::~WaveClip()
 
 void WaveClip::SetOffset(double offset)
 {
+    if (offset != mOffset)
+       ++sPlacementGeneration;
     mOffset = offset;
     mEnvelope->SetOffset(mOffset);
 }
@@ -421,6 +661,11 @@ void WaveClip::AddInvalidRegion(long startSample, long endSample)
       mWaveCache->AddInvalidRegion(startSample,endSample);
 }
 
+void WaveClip::StopDisplayWorker()
+{
+   WaveDisplayWorker::Stop();
+}
+
 namespace {
 
 inline
@@ -511,6 +756,8 @@ bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
       pWhere = &display.ownWhere;
    }
    else {
+      WaveDisplayWorker::ReleaseFinished();
+
       // Lock the list of invalid regions
       ODLocker locker(&mWaveCacheMutex);
 
@@ -532,7 +779,8 @@ bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
       if (match &&
          mWaveCache->start == t0 &&
          mWaveCache->len >= numPixels) {
-         mWaveCache->LoadInvalidRegions(mSequence.get(), true);
+         mWaveCache->TakeFinished();
+         mWaveCache->RequestInvalidRegions(mSequence.get());
          mWaveCache->ClearInvalidRegions();
 
          // Satisfy the request completely from the cache
@@ -584,12 +832,7 @@ bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
       // possible
 
       if (oldCache) {
-
-         //TODO: only load inval regions if
-         //necessary.  (usually is the case, so no rush.)
-         //also, we should be updating the NEW cache, but here we are patching the old one up.
-         oldCache->LoadInvalidRegions(mSequence.get(), false);
-         oldCache->ClearInvalidRegions();
+         oldCache->TakeFinished();
 
          // Copy what we can from the old cache.
          const int length = copyEnd - copyBegin;
@@ -599,6 +842,23 @@ bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
          memcpy(&max[copyBegin], &oldCache->max[srcIdx], sizeFloats);
          memcpy(&rms[copyBegin], &oldCache->rms[srcIdx], sizeFloats);
          memcpy(&bl[copyBegin], &oldCache->bl[srcIdx], length * sizeof(int));
+         mWaveCache->numODPixels =
+            mWaveCache->CountODPixels(copyBegin, copyEnd);
+
+         // Ask again for what the old cache was still waiting for, and for
+         // what was invalidated in it, wherever it was copied
+         auto requestCopied = [&](int oldStart, int oldEnd) {
+            const int start = std::max(copyBegin, oldStart - oldX0);
+            const int end = std::min(copyEnd, oldEnd - oldX0);
+            if (end > start)
+               mWaveCache->Request(start, end, mSequence.get(), false);
+         };
+         for (const auto &request : oldCache->pending)
+            requestCopied(request->p0, request->p0 + request->len);
+         for (int i = 0; i < oldCache->GetNumInvalidRegions(); i++)
+            requestCopied(oldCache->GetInvalidRegionStart(i),
+                          oldCache->GetInvalidRegionEnd(i));
+         oldCache->ClearInvalidRegions();
       }
    }
 
@@ -683,14 +943,23 @@ bool WaveClip::GetWaveDisplay(WaveDisplay &display, double t0,
       }
 
       // Done with append buffer, now fetch the rest of the cache miss
-      // from the sequence
+      // from the sequence.  Only the uncached display waits for it; the
+      // cache shows the columns as not yet loaded until the worker is done.
       if (p1 > p0) {
-         if (!mSequence->GetWaveDisplay(&min[p0],
-                                        &max[p0],
-                                        &rms[p0],
-                                        &bl[p0],
-                                        p1-p0,
-                                        &where[p0]))
+         bool success;
+         if (allocated)
+            success = mSequence->GetWaveDisplay(&min[p0],
+                                                &max[p0],
+                                                &rms[p0],
+                                                &bl[p0],
+                                                p1-p0,
+                                                &where[p0]);
+         else {
+            ODLocker locker(&mWaveCacheMutex);
+            success = mWaveCache->Request(p0, p1, mSequence.get(), true);
+         }
+
+         if (!success)
          {
             isLoadingOD=false;
             return false;
@@ -1686,6 +1955,7 @@ void WaveClip::Unlock()
 
 void WaveClip::SetRate(int rate)
 {
+   ++sPlacementGeneration;
    mRate = rate;
    UpdateEnvelopeTrackLen();
    MarkChanged();
@@ -1765,6 +2035,7 @@ bool WaveClip::Resample(int rate, ProgressDialog *progress)
    if (!error)
    {
       mSequence = std::move(newSequence);
+      ++sPlacementGeneration;
       mRate = rate;
 
       // Invalidate wave display cache
@@ -26,6 +26,7 @@
 #include <wx/longlong.h>
 #include <wx/msgdlg.h>
 
+#include <atomic>
 #include <vector>
 
 class BlockArray;
@@ -244,6 +245,10 @@ public:
    sampleCount GetEndSample() const;
    sampleCount GetNumSamples() const;
 
+   // Changes whenever the offset or the rate of any clip does, so that a
+   // track can tell when it must put its clips in order again
+   static unsigned long GetPlacementGeneration() { return sPlacementGeneration; }
+
    // One and only one of the following is true for a given t (unless the clip
    // has zero length -- then BeforeClip() and AfterClip() can both be true).
    // Within() is true if the time is substantially within the clip
@@ -264,6 +269,7 @@ public:
    // but use more high-level functions inside WaveClip (or add them if you
    // think they are useful for general use)
    Sequence* GetSequence() { return mSequence.get(); }
+   const Sequence* GetSequence() const { return mSequence.get(); }
 
    /** WaveTrack calls this whenever data in the wave clip changes. It is
     * called automatically when WaveClip has a chance to know that something
@@ -361,6 +367,10 @@ public:
    ///Adds an invalid region to the wavecache so it redraws that portion only.
    void AddInvalidRegion(long startSample, long endSample);
 
+   ///Stops the thread that reads wave display columns for the caches.
+   ///Call when quitting.
+   static void StopDisplayWorker();
+
    //
    // XMLTagHandler callback methods for loading and saving
    //
@@ -378,6 +388,8 @@ public:
    void SetIsPlaceholder(bool val) { mIsPlaceholder = val; }
 
 protected:
+   static std::atomic<unsigned long> sPlacementGeneration;
+
    mutable wxRect mDisplayRect;
 
    double mOffset;
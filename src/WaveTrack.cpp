@@ -39,7 +39,9 @@ Track classes.
 
 #include "float_cast.h"
 
+#include "BlockFile.h"
 #include "Envelope.h"
+#include "ReadAheadPool.h"
 #include "Sequence.h"
 #include "Spectrum.h"
 
@@ -91,7 +93,7 @@ WaveTrack::WaveTrack(const std::shared_ptr<DirManager> &projDirManager, sampleFo
    // Force creation always:
    WaveformSettings &settings = GetIndependentWaveformSettings();
 
-   mDisplay = FindDefaultViewMode();
+   mDisplay = sPrefsSnapshot ? sPrefsSnapshot->mViewMode : FindDefaultViewMode();
    if (mDisplay == obsoleteWaveformDBDisplay) {
       mDisplay = Waveform;
       settings.scaleType = WaveformSettings::stLogarithmic;
@@ -103,7 +105,9 @@ WaveTrack::WaveTrack(const std::shared_ptr<DirManager> &projDirManager, sampleFo
    mRate = (int) rate;
    mGain = 1.0;
    mPan = 0.0;
-   SetDefaultName(gPrefs->Read(wxT("/GUI/TrackNames/DefaultTrackName"), _("Audio Track")));
+   SetDefaultName(sPrefsSnapshot
+      ? sPrefsSnapshot->mDefaultName
+      : gPrefs->Read(wxT("/GUI/TrackNames/DefaultTrackName"), _("Audio Track")));
    SetName(GetDefaultName());
    mDisplayMin = -1.0;
    mDisplayMax = 1.0;
@@ -194,6 +198,25 @@ void WaveTrack::SetOffset(double o)
    mOffset = o;
 }
 
+const WaveTrack::PrefsSnapshot *WaveTrack::sPrefsSnapshot = NULL;
+
+WaveTrack::PrefsSnapshot::PrefsSnapshot()
+   : mDefaultName(gPrefs->Read(wxT("/GUI/TrackNames/DefaultTrackName"), _("Audio Track")))
+   , mViewMode(FindDefaultViewMode())
+{
+   wxASSERT(wxThread::IsMain() && !sPrefsSnapshot);
+
+   // The default settings read preferences when first wanted
+   WaveformSettings::defaults();
+
+   sPrefsSnapshot = this;
+}
+
+WaveTrack::PrefsSnapshot::~PrefsSnapshot()
+{
+   sPrefsSnapshot = NULL;
+}
+
 //static
 WaveTrack::WaveTrackDisplay WaveTrack::FindDefaultViewMode()
 {
@@ -705,6 +728,7 @@ Track::Holder WaveTrack::Copy(double t0, double t1) const
          newTrack->mClips.push_back(std::move(placeholder)); // transfer ownership
       }
    }
+   newTrack->InvalidateClipIndex();
 
    return std::move(result);
 }
@@ -1012,6 +1036,7 @@ movable_ptr<WaveClip> WaveTrack::RemoveAndReturnClip(WaveClip* clip)
    if (it != mClips.end()) {
       auto result = std::move(*it); // Array stops owning the clip, before we shrink it
       mClips.erase(it);
+      InvalidateClipIndex();
       return result;
    }
    else
@@ -1023,6 +1048,7 @@ void WaveTrack::AddClip(movable_ptr<WaveClip> &&clip)
    // Uncomment the following line after we correct the problem of zero-length clips
    //if (CanInsertClip(clip))
       mClips.push_back(std::move(clip)); // transfer ownership
+   InvalidateClipIndex();
 }
 
 bool WaveTrack::HandleClear(double t0, double t1,
@@ -1145,6 +1171,8 @@ bool WaveTrack::HandleClear(double t0, double t1,
    for (auto &clip: clipsToAdd)
       mClips.push_back(std::move(clip)); // transfer ownership
 
+   InvalidateClipIndex();
+
    return true;
 }
 
@@ -1351,6 +1379,7 @@ bool WaveTrack::Paste(double t0, const Track *src)
          newClip->Offset(t0);
          newClip->MarkChanged();
          mClips.push_back(std::move(newClip)); // transfer ownership
+         InvalidateClipIndex();
       }
    }
    return true;
@@ -1557,6 +1586,7 @@ bool WaveTrack::Join(double t0, double t1)
 
       auto it = FindClip(mClips, clip);
       mClips.erase(it); // deletes the clip
+      InvalidateClipIndex();
    }
 
    return true;
@@ -1597,12 +1627,11 @@ unsigned int WaveTrack::GetODFlags()
 
 sampleCount WaveTrack::GetBlockStart(sampleCount s) const
 {
-   for (const auto &clip : mClips)
+   const WaveClip *clip = GetClipAtSample(s);
+   if (clip)
    {
       const sampleCount startSample = (sampleCount)floor(0.5 + clip->GetStartTime()*mRate);
-      const sampleCount endSample = startSample + clip->GetNumSamples();
-      if (s >= startSample && s < endSample)
-         return startSample + clip->GetSequence()->GetBlockStart(s - startSample);
+      return startSample + clip->GetSequence()->GetBlockStart(s - startSample);
    }
 
    return -1;
@@ -1612,15 +1641,11 @@ sampleCount WaveTrack::GetBestBlockSize(sampleCount s) const
 {
    sampleCount bestBlockSize = GetMaxBlockSize();
 
-   for (const auto &clip : mClips)
+   const WaveClip *clip = GetClipAtSample(s);
+   if (clip)
    {
       sampleCount startSample = (sampleCount)floor(clip->GetStartTime()*mRate + 0.5);
-      sampleCount endSample = startSample + clip->GetNumSamples();
-      if (s >= startSample && s < endSample)
-      {
-         bestBlockSize = clip->GetSequence()->GetBestBlockSize(s - startSample);
-         break;
-      }
+      bestBlockSize = clip->GetSequence()->GetBestBlockSize(s - startSample);
    }
 
    return bestBlockSize;
@@ -1992,14 +2017,89 @@ bool WaveTrack::GetRMS(float *rms, double t0, double t1)
    return result;
 }
 
+bool WaveTrack::GetStats(sampleCount start, sampleCount len,
+                         SampleStats &stats) const
+{
+   stats.Clear();
+
+   // Like Get(), treat the space between clips as silence
+   sampleCount covered = 0;
+   for (const auto clip: GetClipsInRange(start, start+len))
+   {
+      sampleCount clipStart = clip->GetStartSample();
+      sampleCount clipEnd = clip->GetEndSample();
+
+      if (clipEnd > start && clipStart < start+len)
+      {
+         const sampleCount inclipStart = std::max(start, clipStart) - clipStart;
+         const sampleCount inclipEnd = std::min(start+len, clipEnd) - clipStart;
+
+         SampleStats clipStats;
+         if (!clip->GetSequence()->GetStats(inclipStart,
+                                            inclipEnd - inclipStart, clipStats))
+            return false;
+         stats += clipStats;
+         covered += clipStats.count;
+      }
+   }
+
+   stats.AccumulateSilence(len - covered);
+
+   return true;
+}
+
+sampleCount WaveTrack::GetBlockStats(sampleCount s, SampleStats &stats) const
+{
+   const WaveClip *clip = GetClipAtSample(s);
+   if (clip)
+      return clip->GetSequence()->GetBlockStats(s - clip->GetStartSample(), stats);
+
+   return 0;
+}
+
+bool WaveTrack::GetBlockAt(sampleCount s, BlockFilePtr &file,
+                           sampleCount &blockStart, sampleCount &blockLen) const
+{
+   const WaveClip *clip = GetClipAtSample(s);
+   if (clip)
+   {
+      sampleCount clipStart = clip->GetStartSample();
+      if (!clip->GetSequence()->GetBlockAt(s - clipStart,
+                                           file, blockStart, blockLen))
+         return false;
+      blockStart += clipStart;
+      return true;
+   }
+
+   return false;
+}
+
+bool WaveTrack::GetBlockPeaks(sampleCount s, sampleCount &blockStart,
+                              sampleCount &blockLen, std::vector<float> &peaks) const
+{
+   const WaveClip *clip = GetClipAtSample(s);
+   if (clip)
+   {
+      sampleCount clipStart = clip->GetStartSample();
+      if (!clip->GetSequence()->GetBlockPeaks(s - clipStart,
+                                              blockStart, blockLen, peaks))
+         return false;
+      blockStart += clipStart;
+      return true;
+   }
+
+   return false;
+}
+
 bool WaveTrack::Get(samplePtr buffer, sampleFormat format,
                     sampleCount start, sampleCount len, fillFormat fill ) const
 {
    // Simple optimization: When this buffer is completely contained within one clip,
    // don't clear anything (because we won't have to). Otherwise, just clear
    // everything to be on the safe side.
+   const auto clips = GetClipsInRange(start, start+len);
    bool doClear = true;
-   for (const auto &clip: mClips)
+   for (const auto clip: clips)
    {
       if (start >= clip->GetStartSample() && start+len <= clip->GetEndSample())
       {
@@ -2026,7 +2126,7 @@ bool WaveTrack::Get(samplePtr buffer, sampleFormat format,
       }
    }
 
-   for (const auto &clip: mClips)
+   for (const auto clip: clips)
    {
       sampleCount clipStart = clip->GetStartSample();
       sampleCount clipEnd = clip->GetEndSample();
@@ -2063,7 +2163,7 @@ bool WaveTrack::Set(samplePtr buffer, sampleFormat format,
 {
    bool result = true;
 
-   for (const auto &clip: mClips)
+   for (const auto clip: GetClipsInRange(start, start+len))
    {
       sampleCount clipStart = clip->GetStartSample();
       sampleCount clipEnd = clip->GetEndSample();
@@ -2120,7 +2220,7 @@ void WaveTrack::GetEnvelopeValues(double *buffer, int bufferLen,
 
    double startTime = t0;
    double endTime = t0+tstep*bufferLen;
-   for (const auto &clip: mClips)
+   for (const auto clip: GetClipsInTimeRange(startTime, endTime))
    {
       // IF clip intersects startTime..endTime THEN...
       double dClipStartTime = clip->GetStartTime();
@@ -2159,6 +2259,70 @@ void WaveTrack::GetEnvelopeValues(double *buffer, int bufferLen,
    }
 }
 
+void WaveTrack::GetEnvelopeSegments(EnvSegments &segments, int bufferLen,
+                                    double t0, double tstep) const
+{
+   segments.clear();
+
+   // Possibly nothing to do.
+   if( bufferLen <= 0 )
+      return;
+
+   // Clip ranges are found exactly as in GetEnvelopeValues
+   double startTime = t0;
+   double endTime = t0+tstep*bufferLen;
+   for (const auto clip: GetClipsInTimeRange(startTime, endTime))
+   {
+      double dClipStartTime = clip->GetStartTime();
+      double dClipEndTime = clip->GetEndTime();
+      if ((dClipStartTime < endTime) && (dClipEndTime > startTime))
+      {
+         int roffset = 0;
+         int rlen = bufferLen;
+         double rt0 = t0;
+
+         if (rt0 < dClipStartTime)
+         {
+            sampleCount nDiff = (sampleCount)floor((dClipStartTime - rt0) * mRate + 0.5);
+            roffset += nDiff;
+            rlen -= nDiff;
+            rt0 = dClipStartTime;
+         }
+
+         if (rt0 + rlen*tstep > dClipEndTime)
+         {
+            int nClipLen = clip->GetEndSample() - clip->GetStartSample();
+
+            if (nClipLen <= 0)
+               continue;
+
+            rlen = std::min(rlen, nClipLen);
+            rlen = std::min(rlen, int(floor(0.5 + (dClipEndTime - rt0) / tstep)));
+         }
+         clip->GetEnvelope()->GetSegments(segments, rlen, rt0, tstep, roffset);
+      }
+   }
+
+   // Clips are not stored in time order; sort, then fill the gaps
+   // between them with unit gain
+   auto byStart = [](const EnvSegment &a, const EnvSegment &b)
+      { return a.start < b.start; };
+   std::sort(segments.begin(), segments.end(), byStart);
+   int covered = 0;
+   const size_t numClipSegments = segments.size();
+   for (size_t ii = 0; ii < numClipSegments; ++ii)
+   {
+      const EnvSegment segment = segments[ii];
+      if (segment.start > covered)
+         segments.push_back(EnvSegment(covered, segment.start - covered, 1.0));
+      covered = std::max(covered, segment.start + segment.len);
+   }
+   if (covered < bufferLen)
+      segments.push_back(EnvSegment(covered, bufferLen - covered, 1.0));
+   if (segments.size() > numClipSegments)
+      std::sort(segments.begin(), segments.end(), byStart);
+}
+
 WaveClip* WaveTrack::GetClipAtX(int xcoord)
 {
    for (const auto &clip: mClips)
@@ -2174,18 +2338,13 @@ WaveClip* WaveTrack::GetClipAtX(int xcoord)
 
 WaveClip* WaveTrack::GetClipAtSample(sampleCount sample)
 {
-   for (const auto &clip: mClips)
-   {
-      sampleCount start, len;
-
-      start = clip->GetStartSample();
-      len   = clip->GetNumSamples();
-
-      if (sample >= start && sample < start + len)
-         return clip.get();
-   }
+   const auto clips = GetClipsInRange(sample, sample + 1);
+   return clips.empty() ? NULL : clips.front();
+}
 
-   return NULL;
+const WaveClip* WaveTrack::GetClipAtSample(sampleCount sample) const
+{
+   return const_cast<WaveTrack&>(*this).GetClipAtSample(sample);
 }
 
 Envelope* WaveTrack::GetEnvelopeAtX(int xcoord)
@@ -2221,6 +2380,7 @@ Sequence* WaveTrack::GetSequenceAtX(int xcoord)
 WaveClip* WaveTrack::CreateClip()
 {
    mClips.push_back(make_movable<WaveClip>(mDirManager, mFormat, mRate));
+   InvalidateClipIndex();
    return mClips.back().get();
 }
 
@@ -2379,6 +2539,7 @@ bool WaveTrack::SplitAt(double t)
          // This could invalidate the iterators for the loop!  But we return
          // at once so it's okay
          mClips.push_back(std::move(newClip)); // transfer ownership
+         InvalidateClipIndex();
          return true;
       }
    }
@@ -2388,7 +2549,10 @@ bool WaveTrack::SplitAt(double t)
 
 void WaveTrack::UpdateLocationsCache() const
 {
-   auto clips = SortedClipArray();
+   // The index gives each clip's place in mClips, for the merge points
+   ODLocker locker(&mClipIndexMutex);
+   UpdateClipIndex();
+   const auto &clips = mClipIndex.GetEntries();
 
    mDisplayLocationsCache.clear();
 
@@ -2396,8 +2560,9 @@ void WaveTrack::UpdateLocationsCache() const
    int num = 0;
    {
       const WaveClip *prev = nullptr;
-      for (const auto clip : clips)
+      for (const auto &entry : clips)
       {
+         const WaveClip *clip = entry.clip;
          num += clip->NumCutLines();
 
          if (prev && fabs(prev->GetEndTime() -
@@ -2417,9 +2582,10 @@ void WaveTrack::UpdateLocationsCache() const
    // Add all display locations to cache
    int curpos = 0;
 
-   const WaveClip *previousClip = nullptr;
-   for (const auto clip: clips)
+   const ClipIndex<WaveClip>::Entry *previous = nullptr;
+   for (const auto &entry: clips)
    {
+      const WaveClip *clip = entry.clip;
       for (const auto &cc : clip->GetCutLines())
       {
          // Add cut line expander point
@@ -2430,8 +2596,9 @@ void WaveTrack::UpdateLocationsCache() const
          curpos++;
       }
 
-      if (previousClip)
+      if (previous)
       {
+         const WaveClip *previousClip = previous->clip;
          if (fabs(previousClip->GetEndTime() - clip->GetStartTime())
                                           < WAVETRACK_MERGE_POINT_TOLERANCE)
          {
@@ -2439,14 +2606,14 @@ void WaveTrack::UpdateLocationsCache() const
             mDisplayLocationsCache.push_back(WaveTrackLocation{
                previousClip->GetEndTime(),
                WaveTrackLocation::locationMergePoint,
-               GetClipIndex(previousClip),
-               GetClipIndex(clip)
+               previous->position,
+               entry.position
             });
             curpos++;
          }
       }
 
-      previousClip = clip;
+      previous = &entry;
    }
 
    wxASSERT(curpos == num);
@@ -2532,6 +2699,7 @@ bool WaveTrack::MergeClips(int clipidx1, int clipidx2)
    // Delete second clip
    auto it = FindClip(mClips, clip2);
    mClips.erase(it);
+   InvalidateClipIndex();
 
    return true;
 }
@@ -2552,28 +2720,74 @@ bool WaveTrack::Resample(int rate, ProgressDialog *progress)
    return true;
 }
 
-namespace {
-   template < typename Cont1, typename Cont2 >
-   Cont1 FillSortedClipArray(const Cont2& mClips)
-   {
-      Cont1 clips;
-      for (const auto &clip : mClips)
-         clips.push_back(clip.get());
-      std::sort(clips.begin(), clips.end(),
-         [](const WaveClip *a, const WaveClip *b)
-      { return a->GetStartTime() < b->GetStartTime(); });
-      return clips;
-   }
+void WaveTrack::InvalidateClipIndex()
+{
+   ODLocker locker(&mClipIndexMutex);
+   mClipIndex.Invalidate();
+}
+
+void WaveTrack::UpdateClipIndex() const
+{
+   // Moving any clip anywhere changes the generation
+   mClipIndex.Update(mClips, WaveClip::GetPlacementGeneration());
+}
+
+template<typename Cont>
+Cont WaveTrack::ClipsInRange(sampleCount start, sampleCount end) const
+{
+   Cont clips;
+
+   ODLocker locker(&mClipIndexMutex);
+   UpdateClipIndex();
+   mClipIndex.GetInRange(start, end, clips);
+
+   return clips;
+}
+
+WaveClipPointers WaveTrack::GetClipsInRange(sampleCount start, sampleCount end)
+{
+   return ClipsInRange<WaveClipPointers>(start, end);
+}
+
+WaveClipConstPointers WaveTrack::GetClipsInRange(sampleCount start, sampleCount end) const
+{
+   return ClipsInRange<WaveClipConstPointers>(start, end);
+}
+
+WaveClipConstPointers WaveTrack::GetClipsInTimeRange(double t0, double t1) const
+{
+   WaveClipConstPointers clips;
+
+   ODLocker locker(&mClipIndexMutex);
+   UpdateClipIndex();
+   mClipIndex.GetInTimeRange(t0, t1, mRate, clips);
+
+   return clips;
+}
+
+template<typename Cont>
+Cont WaveTrack::SortedClips() const
+{
+   Cont clips;
+
+   ODLocker locker(&mClipIndexMutex);
+   UpdateClipIndex();
+   const auto &entries = mClipIndex.GetEntries();
+   clips.reserve(entries.size());
+   for (const auto &entry : entries)
+      clips.push_back(entry.clip);
+
+   return clips;
 }
 
 WaveClipPointers WaveTrack::SortedClipArray()
 {
-   return FillSortedClipArray<WaveClipPointers>(mClips);
+   return SortedClips<WaveClipPointers>();
 }
 
 WaveClipConstPointers WaveTrack::SortedClipArray() const
 {
-   return FillSortedClipArray<WaveClipConstPointers>(mClips);
+   return SortedClips<WaveClipConstPointers>();
 }
 
 ///Deletes all clips' wavecaches.  Careful, This may not be threadsafe.
@@ -2600,6 +2814,162 @@ void WaveTrack::SetAutoSaveIdent(int ident)
    mAutoSaveIdent = ident;
 }
 
+// Reads blocks ahead for one WaveTrackCache, on the shared ReadAheadPool.
+// The blocks are read in buffers of the cache's size, whose memory is
+// swapped with the cache's own when it asks for one of them.
+class WaveTrackCacheReader
+{
+ public:
+   WaveTrackCacheReader(const WaveTrack *track, int depth, sampleCount bufferSize)
+      : mTrack(track)
+      , mBufferSize(bufferSize)
+      , mCondition(mMutex)
+      , mSlots(depth)
+   {
+      for (auto &slot : mSlots)
+         slot.data = new float[mBufferSize];
+   }
+
+   // Returns once nothing is being read for this reader
+   ~WaveTrackCacheReader()
+   {
+      ReadAheadPool::Get().Cancel(this);
+      for (auto &slot : mSlots)
+         delete[] slot.data;
+   }
+
+   // Queues the blocks that follow start, and drops any others not yet
+   // taken
+   void Schedule(sampleCount start);
+
+   // Swaps the block, if it was read ahead, into data, waiting for it if
+   // it is being read.  Returns false if the caller must read it.
+   bool Take(sampleCount start, sampleCount len, float *&data);
+
+ private:
+   enum State { kEmpty, kQueued, kReading, kReady, kFailed };
+
+   struct Slot {
+      Slot() : data(0), start(0), len(0), state(kEmpty) {}
+
+      float *data;
+      sampleCount start;
+      sampleCount len;
+      State state;
+   };
+
+   Slot *Find(sampleCount start, sampleCount len)
+   {
+      for (auto &slot : mSlots)
+         if (slot.state != kEmpty && slot.start == start && slot.len == len)
+            return &slot;
+      return NULL;
+   }
+
+   // Called on the pool's threads
+   void Read(sampleCount start, sampleCount len);
+
+   const WaveTrack *mTrack;
+   const sampleCount mBufferSize;
+
+   wxMutex mMutex;
+   wxCondition mCondition;
+   std::vector<Slot> mSlots;
+};
+
+void WaveTrackCacheReader::Read(sampleCount start, sampleCount len)
+{
+   wxMutexLocker locker(mMutex);
+
+   // The block may have been dropped, or taken, since it was queued
+   Slot *slot = Find(start, len);
+   if (!slot || slot->state != kQueued)
+      return;
+
+   slot->state = kReading;
+   float *data = slot->data;
+   mMutex.Unlock();
+   const bool ok = mTrack->Get(samplePtr(data), floatSample, start, len);
+   mMutex.Lock();
+
+   // Only Take and Schedule change a slot, and both leave one being read
+   // alone
+   slot->state = ok ? kReady : kFailed;
+   mCondition.Broadcast();
+}
+
+void WaveTrackCacheReader::Schedule(sampleCount start)
+{
+   wxMutexLocker locker(mMutex);
+
+   // The blocks wanted next, as far as the clip goes
+   std::vector<std::pair<sampleCount, sampleCount>> wanted;
+   sampleCount pos = start;
+   while (wanted.size() < mSlots.size() && mTrack->GetBlockStart(pos) == pos)
+   {
+      const sampleCount len = std::min(mTrack->GetBestBlockSize(pos), mBufferSize);
+      wanted.push_back(std::make_pair(pos, len));
+      pos += len;
+   }
+
+   // Free the slots that hold something else, unless they are being read
+   for (auto &slot : mSlots)
+   {
+      if (slot.state == kEmpty || slot.state == kReading)
+         continue;
+      bool keep = false;
+      for (const auto &block : wanted)
+         keep = keep || (slot.start == block.first && slot.len == block.second);
+      if (!keep)
+         slot.state = kEmpty;
+   }
+
+   for (const auto &block : wanted)
+   {
+      if (Find(block.first, block.second))
+         continue;
+      for (auto &slot : mSlots)
+      {
+         if (slot.state == kEmpty)
+         {
+            const sampleCount s = block.first, l = block.second;
+            if (!ReadAheadPool::Get().Post(this, [this, s, l]{ Read(s, l); }))
+               return;   // No threads; the cache reads on demand
+            slot.start = s;
+            slot.len = l;
+            slot.state = kQueued;
+            break;
+         }
+      }
+   }
+}
+
+bool WaveTrackCacheReader::Take(sampleCount start, sampleCount len, float *&data)
+{
+   wxMutexLocker locker(mMutex);
+
+   Slot *slot = Find(start, len);
+   if (!slot)
+      return false;
+
+   // Not started yet, perhaps behind other caches' blocks; reading it now
+   // is quicker than waiting
+   if (slot->state == kQueued)
+   {
+      slot->state = kEmpty;
+      return false;
+   }
+
+   while (slot->state == kReading)
+      mCondition.Wait();
+
+   const bool ok = slot->state == kReady;
+   if (ok)
+      std::swap(data, slot->data);
+   slot->state = kEmpty;
+   return ok;
+}
+
 WaveTrackCache::~WaveTrackCache()
 {
    Free();
@@ -2608,6 +2978,7 @@ WaveTrackCache::~WaveTrackCache()
 void WaveTrackCache::SetTrack(const WaveTrack *pTrack)
 {
    if (mPTrack != pTrack) {
+      StopReadAhead();
       if (pTrack) {
          mBufferSize = pTrack->GetMaxBlockSize();
          if (!mPTrack ||
@@ -2621,9 +2992,42 @@ void WaveTrackCache::SetTrack(const WaveTrack *pTrack)
          Free();
       mPTrack = pTrack;
       mNValidBuffers = 0;
+      StartReadAhead();
+   }
+}
+
+void WaveTrackCache::SetReadAhead(int depth)
+{
+   if (depth != mReadAheadDepth) {
+      StopReadAhead();
+      mReadAheadDepth = std::max(0, depth);
+      StartReadAhead();
    }
 }
 
+void WaveTrackCache::StartReadAhead()
+{
+   if (!mReader && mPTrack && mReadAheadDepth > 0)
+      mReader = std::make_unique<WaveTrackCacheReader>
+         (mPTrack, mReadAheadDepth, mBufferSize);
+}
+
+void WaveTrackCache::StopReadAhead()
+{
+   mReader.reset();
+}
+
+bool WaveTrackCache::Fill(Buffer &buffer, sampleCount start, sampleCount len)
+{
+   if (!mReader || !mReader->Take(start, len, buffer.data)) {
+      if (!mPTrack->Get(samplePtr(buffer.data), floatSample, start, len))
+         return false;
+   }
+   buffer.start = start;
+   buffer.len = len;
+   return true;
+}
+
 constSamplePtr WaveTrackCache::Get(sampleFormat format,
    sampleCount start, sampleCount len)
 {
@@ -2678,10 +3082,8 @@ constSamplePtr WaveTrackCache::Get(sampleFormat format,
          if (start0 >= 0) {
             const sampleCount len0 = mPTrack->GetBestBlockSize(start0);
             wxASSERT(len0 <= mBufferSize);
-            if (!mPTrack->Get(samplePtr(mBuffers[0].data), floatSample, start0, len0))
+            if (!Fill(mBuffers[0], start0, len0))
                return 0;
-            mBuffers[0].start = start0;
-            mBuffers[0].len = len0;
             if (!fillSecond &&
                 mBuffers[0].end() != mBuffers[1].start)
                fillSecond = true;
@@ -2704,16 +3106,18 @@ constSamplePtr WaveTrackCache::Get(sampleFormat format,
             if (start1 == end0) {
                const sampleCount len1 = mPTrack->GetBestBlockSize(start1);
                wxASSERT(len1 <= mBufferSize);
-               if (!mPTrack->Get(samplePtr(mBuffers[1].data), floatSample, start1, len1))
+               if (!Fill(mBuffers[1], start1, len1))
                   return 0;
-               mBuffers[1].start = start1;
-               mBuffers[1].len = len1;
                mNValidBuffers = 2;
             }
          }
       }
       wxASSERT(mNValidBuffers < 2 || mBuffers[0].end() == mBuffers[1].start);
 
+      // Whenever the buffers move on, read ahead of them again
+      if (mReader && (fillFirst || fillSecond) && mNValidBuffers > 0)
+         mReader->Schedule(mBuffers[mNValidBuffers - 1].end());
+
       samplePtr buffer = 0;
       sampleCount remaining = len;
 
@@ -2775,6 +3179,7 @@ constSamplePtr WaveTrackCache::Get(sampleFormat format,
 
 void WaveTrackCache::Free()
 {
+   StopReadAhead();
    mBuffers[0].Free();
    mBuffers[1].Free();
    mOverlapBuffer.Free();
@@ -14,6 +14,7 @@
 #include "Track.h"
 #include "SampleFormat.h"
 #include "WaveClip.h"
+#include "ClipIndex.h"
 #include "Experimental.h"
 #include "widgets/ProgressDialog.h"
 
@@ -24,10 +25,16 @@
 
 #include "WaveTrackLocation.h"
 
+class BlockFile;
+using BlockFilePtr = std::shared_ptr<BlockFile>;
+
 class SpectrogramSettings;
 class WaveformSettings;
 class TimeWarper;
 
+struct EnvSegment;
+typedef std::vector<EnvSegment> EnvSegments;
+
 //
 // Tolerance for merging wave tracks (in seconds)
 //
@@ -241,9 +248,30 @@ class AUDACITY_DLL_API WaveTrack final : public Track {
                    sampleCount start, sampleCount len);
    void GetEnvelopeValues(double *buffer, int bufferLen,
                          double t0, double tstep) const;
+   // Like GetEnvelopeValues, but describes the values as segments
+   // (see Envelope::GetSegments); stretches outside clips have unit gain
+   void GetEnvelopeSegments(EnvSegments &segments, int bufferLen,
+                            double t0, double tstep) const;
    bool GetMinMax(float *min, float *max,
                   double t0, double t1) const;
    bool GetRMS(float *rms, double t0, double t1);
+   // Gets the extended statistics of the samples that Get() would give for
+   // the same region, mostly from the blocks' stored statistics
+   bool GetStats(sampleCount start, sampleCount len, SampleStats &stats) const;
+   // Gets the statistics of the whole block holding sample s, and returns
+   // the number of samples from s to the end of that block, or 0 if s is
+   // not in a clip or the block has none yet
+   sampleCount GetBlockStats(sampleCount s, SampleStats &stats) const;
+   // Gets the block file holding sample s, and that block's extent in
+   // track samples; false if s is not in a clip.  Two tracks holding the
+   // same file at the same extent have the same samples there.
+   bool GetBlockAt(sampleCount s, BlockFilePtr &file,
+                   sampleCount &blockStart, sampleCount &blockLen) const;
+   // Gets the largest magnitude in each 256-sample summary frame of the
+   // block holding sample s, and that block's extent in track samples;
+   // false if s is not in a clip or the summary isn't ready
+   bool GetBlockPeaks(sampleCount s, sampleCount &blockStart,
+                      sampleCount &blockLen, std::vector<float> &peaks) const;
 
    //
    // MM: We now have more than one sequence and envelope per track, so
@@ -257,6 +285,14 @@ class AUDACITY_DLL_API WaveTrack final : public Track {
    Envelope* GetActiveEnvelope(void);
 
    WaveClip* GetClipAtSample(sampleCount sample);
+   const WaveClip* GetClipAtSample(sampleCount sample) const;
+
+   // Get the clips that overlap the samples from start up to end, or the
+   // times from t0 up to t1, in order of start.  These look in an index of
+   // the clips, so are quick however many clips the track has.
+   WaveClipPointers GetClipsInRange(sampleCount start, sampleCount end);
+   WaveClipConstPointers GetClipsInRange(sampleCount start, sampleCount end) const;
+   WaveClipConstPointers GetClipsInTimeRange(double t0, double t1) const;
 
    //
    // Getting information about the track's internal block sizes
@@ -533,6 +569,21 @@ class AUDACITY_DLL_API WaveTrack final : public Track {
    // Handle restriction of range of values of the enum from future versions
    static WaveTrackDisplay ValidateWaveTrackDisplay(WaveTrackDisplay display);
 
+   // NEW tracks read some preferences.  While a PrefsSnapshot exists, they
+   // take the values it read instead, so that tracks may be made on import
+   // threads.  Make it on the main thread.
+   class PrefsSnapshot
+   {
+   public:
+      PrefsSnapshot();
+      ~PrefsSnapshot();
+
+   private:
+      friend class WaveTrack;
+      wxString mDefaultName;
+      WaveTrackDisplay mViewMode;
+   };
+
    int GetLastScaleType() const { return mLastScaleType; }
    void SetLastScaleType() const;
 
@@ -585,8 +636,25 @@ class AUDACITY_DLL_API WaveTrack final : public Track {
    // Private variables
    //
 
+   static const PrefsSnapshot *sPrefsSnapshot;
+
    wxCriticalSection mFlushCriticalSection;
    wxCriticalSection mAppendCriticalSection;
+
+   // The clips in order of start, guarded by mClipIndexMutex, because
+   // the read-ahead and display threads call Get too
+   mutable ClipIndex<WaveClip> mClipIndex;
+
+   // Call whenever mClips changes
+   void InvalidateClipIndex();
+   // Call with mClipIndexMutex locked
+   void UpdateClipIndex() const;
+   template<typename Cont>
+   Cont ClipsInRange(sampleCount start, sampleCount end) const;
+   template<typename Cont>
+   Cont SortedClips() const;
+
+   mutable ODLock mClipIndexMutex;
    double mLegacyProjectFileOffset;
    int mAutoSaveIdent;
 
@@ -594,10 +662,16 @@ class AUDACITY_DLL_API WaveTrack final : public Track {
    std::unique_ptr<WaveformSettings> mpWaveformSettings;
 };
 
+class WaveTrackCacheReader;
+
 // This is meant to be a short-lived object, during whose lifetime,
 // the contents of the WaveTrack are known not to change.  It can replace
 // repeated calls to WaveTrack::Get() (each of which opens and closes at least
 // one block file).
+//
+// Consumers that read sequentially can also have the next few blocks read
+// ahead, on threads shared by all caches, so that they seldom wait for the
+// disk.
 class WaveTrackCache {
 public:
    explicit WaveTrackCache(const WaveTrack *pTrack = 0)
@@ -605,6 +679,7 @@ public:
       , mBufferSize(0)
       , mOverlapBuffer()
       , mNValidBuffers(0)
+      , mReadAheadDepth(0)
    {
       SetTrack(pTrack);
    }
@@ -613,6 +688,10 @@ public:
    const WaveTrack *GetTrack() const { return mPTrack; }
    void SetTrack(const WaveTrack *pTrack);
 
+   // Reads up to depth blocks past those last asked for, in the
+   // background.  0, the default, reads only what is asked for.
+   void SetReadAhead(int depth);
+
    // Uses fillZero always
    // Returns null on failure
    // Returned pointer may be invalidated if Get is called again
@@ -632,11 +711,19 @@ private:
       sampleCount end() const { return start + len; }
    };
 
+   // Fills buffer with the block, from the read-ahead if it has it
+   bool Fill(Buffer &buffer, sampleCount start, sampleCount len);
+   void StartReadAhead();
+   void StopReadAhead();
+
    const WaveTrack *mPTrack;
    sampleCount mBufferSize;
    Buffer mBuffers[2];
    GrowableSampleBuffer mOverlapBuffer;
    int mNValidBuffers;
+
+   int mReadAheadDepth;
+   std::unique_ptr<WaveTrackCacheReader> mReader;
 };
 
 #endif // __AUDACITY_WAVETRACK__
@@ -178,6 +178,7 @@ BlockFilePtr ODDecodeBlockFile::Copy(wxFileNameWrapper &&newFileName)
           mMin, mMax, mRMS, IsSummaryAvailable());
       //The client code will need to schedule this blockfile for OD decoding if it is going to a NEW track.
       //It can do this by checking for IsDataAvailable()==false.
+      CopyStatsTo(*newBlockFile);
    }
 
    UnlockRead();
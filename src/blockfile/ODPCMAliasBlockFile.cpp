@@ -215,6 +215,7 @@ BlockFilePtr ODPCMAliasBlockFile::Copy(wxFileNameWrapper &&newFileName)
           IsSummaryAvailable());
       //The client code will need to schedule this blockfile for OD summarizing if it is going to a NEW track.
    }
+   CopyStatsTo(*newBlockFile);
 
    UnlockRead();
 
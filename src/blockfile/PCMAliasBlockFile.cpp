@@ -155,6 +155,7 @@ BlockFilePtr PCMAliasBlockFile::Copy(wxFileNameWrapper &&newFileName)
    auto newBlockFile = make_blockfile<PCMAliasBlockFile>
       (std::move(newFileName), wxFileNameWrapper{mAliasedFileName},
        mAliasStart, mLen, mAliasChannel, mMin, mMax, mRMS);
+   CopyStatsTo(*newBlockFile);
 
    return newBlockFile;
 }
@@ -171,6 +172,7 @@ void PCMAliasBlockFile::SaveXML(XMLWriter &xmlFile)
    xmlFile.WriteAttr(wxT("min"), mMin);
    xmlFile.WriteAttr(wxT("max"), mMax);
    xmlFile.WriteAttr(wxT("rms"), mRMS);
+   WriteStatsAttr(xmlFile);
 
    xmlFile.EndTag(wxT("pcmaliasblockfile"));
 }
@@ -186,6 +188,8 @@ BlockFilePtr PCMAliasBlockFile::BuildFromXML(DirManager &dm, const wxChar **attr
    float min = 0.0f, max = 0.0f, rms = 0.0f;
    double dblValue;
    long nValue;
+   SampleStats stats;
+   bool haveStats = false;
 
    while(*attrs)
    {
@@ -217,6 +221,8 @@ BlockFilePtr PCMAliasBlockFile::BuildFromXML(DirManager &dm, const wxChar **attr
             // but we want to keep the reference to the missing file because it's a good path string.
             aliasFileName.Assign(strValue);
       }
+      else if (!wxStricmp(attr, wxT("stats")) && XMLValueChecker::IsGoodString(strValue))
+         haveStats = stats.FromString(strValue);
       else if (XMLValueChecker::IsGoodInt(strValue) && strValue.ToLong(&nValue))
       {  // integer parameters
          if (!wxStricmp(attr, wxT("aliasstart")) && (nValue >= 0))
@@ -248,9 +254,13 @@ BlockFilePtr PCMAliasBlockFile::BuildFromXML(DirManager &dm, const wxChar **attr
       }
    }
 
-   return make_blockfile<PCMAliasBlockFile>
+   auto blockFile = make_blockfile<PCMAliasBlockFile>
       (std::move(summaryFileName), std::move(aliasFileName),
        aliasStart, aliasLen, aliasChannel, min, max, rms);
+   if (haveStats)
+      blockFile->SetStats(stats);
+
+   return blockFile;
 }
 
 void PCMAliasBlockFile::Recover(void)
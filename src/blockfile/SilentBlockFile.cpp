@@ -18,6 +18,8 @@ BlockFile(wxFileNameWrapper{}, sampleLen)
    mMin = 0.;
    mMax = 0.;
    mRMS = 0.;
+   mStats.AccumulateSilence(sampleLen);
+   mStatsAvailable = true;
 }
 
 SilentBlockFile::~SilentBlockFile()
@@ -484,6 +484,7 @@ void SimpleBlockFile::SaveXML(XMLWriter &xmlFile)
    xmlFile.WriteAttr(wxT("min"), mMin);
    xmlFile.WriteAttr(wxT("max"), mMax);
    xmlFile.WriteAttr(wxT("rms"), mRMS);
+   WriteStatsAttr(xmlFile);
 
    xmlFile.EndTag(wxT("simpleblockfile"));
 }
@@ -499,6 +500,8 @@ BlockFilePtr SimpleBlockFile::BuildFromXML(DirManager &dm, const wxChar **attrs)
    sampleCount len = 0;
    double dblValue;
    long nValue;
+   SampleStats stats;
+   bool haveStats = false;
 
    while(*attrs)
    {
@@ -521,6 +524,8 @@ BlockFilePtr SimpleBlockFile::BuildFromXML(DirManager &dm, const wxChar **attrs)
                XMLValueChecker::IsGoodInt(strValue) && strValue.ToLong(&nValue) &&
                nValue > 0)
          len = nValue;
+      else if (!wxStricmp(attr, wxT("stats")) && XMLValueChecker::IsGoodString(strValue))
+         haveStats = stats.FromString(strValue);
       else if (XMLValueChecker::IsGoodString(strValue) && Internat::CompatibleToDouble(strValue, &dblValue))
       {  // double parameters
          if (!wxStricmp(attr, wxT("min")))
@@ -532,8 +537,12 @@ BlockFilePtr SimpleBlockFile::BuildFromXML(DirManager &dm, const wxChar **attrs)
       }
    }
 
-   return make_blockfile<SimpleBlockFile>
+   auto blockFile = make_blockfile<SimpleBlockFile>
       (std::move(fileName), len, min, max, rms);
+   if (haveStats)
+      blockFile->SetStats(stats);
+
+   return blockFile;
 }
 
 /// Create a copy of this BlockFile, but using a different disk file.
@@ -543,6 +552,7 @@ BlockFilePtr SimpleBlockFile::Copy(wxFileNameWrapper &&newFileName)
 {
    auto newBlockFile = make_blockfile<SimpleBlockFile>
       (std::move(newFileName), mLen, mMin, mMax, mRMS);
+   CopyStatsTo(*newBlockFile);
 
    return newBlockFile;
 }
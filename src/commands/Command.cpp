@@ -34,6 +34,11 @@ bool Command::SetParameter(const wxString & WXUNUSED(paramName),
    return false;
 }
 
+void Command::SetData(std::string && WXUNUSED(data))
+{
+   wxASSERT_MSG(false, wxT("Tried to set data for command which doesn't take any!"));
+}
+
 void DecoratedCommand::Progress(double completed)
 {
    mCommand->Progress(completed);
@@ -69,6 +74,11 @@ bool DecoratedCommand::SetParameter(const wxString &paramName,
    return mCommand->SetParameter(paramName, paramValue);
 }
 
+void DecoratedCommand::SetData(std::string &&data)
+{
+   mCommand->SetData(std::move(data));
+}
+
 bool ApplyAndSendResponse::Apply(CommandExecutionContext context)
 {
    bool result = mCommand->Apply(context);
@@ -155,6 +165,11 @@ wxString CommandImplementation::GetString(const wxString &paramName)
    return v.GetString();
 }
 
+std::string &CommandImplementation::GetData()
+{
+   return mData;
+}
+
 // Convenience methods for passing messages to the output target
 void CommandImplementation::Progress(double completed)
 {
@@ -171,6 +186,11 @@ void CommandImplementation::Error(const wxString &message)
    mOutput->Error(message);
 }
 
+void CommandImplementation::Data(const void *data, size_t len)
+{
+   mOutput->Data(data, len);
+}
+
 /// Get the name of the command
 wxString CommandImplementation::GetName()
 {
@@ -183,6 +203,11 @@ CommandSignature &CommandImplementation::GetSignature()
    return mType.GetSignature();
 }
 
+void CommandImplementation::SetData(std::string &&data)
+{
+   mData = std::move(data);
+}
+
 bool CommandImplementation::SetParameter(const wxString &paramName, const wxVariant &paramValue)
 {
    wxASSERT(!paramValue.IsType(wxT("null")));
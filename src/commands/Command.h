@@ -27,6 +27,7 @@ be controlled by a script should be separated out into its own Command class.
 #ifndef __COMMAND__
 #define __COMMAND__
 
+#include <string>
 #include <wx/app.h>
 
 #include "../Project.h"
@@ -67,6 +68,8 @@ public:
    virtual wxString GetName() = 0;
    virtual CommandSignature &GetSignature() = 0;
    virtual bool SetParameter(const wxString &paramName, const wxVariant &paramValue);
+   /// Binary input, such as samples, sent along with the command
+   virtual void SetData(std::string &&data);
    virtual bool Apply(CommandExecutionContext context) = 0;
 };
 
@@ -91,6 +94,7 @@ public:
    wxString GetName() override;
    CommandSignature &GetSignature() override;
    bool SetParameter(const wxString &paramName, const wxVariant &paramValue) override;
+   void SetData(std::string &&data) override;
 };
 
 // Decorator command that performs the given command and then outputs a status
@@ -110,6 +114,7 @@ class CommandImplementation /* not final */ : public Command
 private:
    CommandType &mType;
    ParamValueMap mParams;
+   std::string mData;
 
    /// Using the command signature, looks up a possible parameter value and
    /// checks whether it passes the validator.
@@ -127,12 +132,14 @@ protected:
    long GetLong(const wxString &paramName);
    double GetDouble(const wxString &paramName);
    wxString GetString(const wxString &paramName);
+   std::string &GetData();
 
 public:
    // Convenience methods for passing messages to the output target
    void Progress(double completed);
    void Status(const wxString &status) override;
    void Error(const wxString &message) override;
+   void Data(const void *data, size_t len);
 
    /// Constructor should not be called directly; only by a factory which
    /// ensures name and params are set appropriately for the command.
@@ -151,6 +158,8 @@ public:
    /// (Note: wxVariant is reference counted)
    bool SetParameter(const wxString &paramName, const wxVariant &paramValue);
 
+   void SetData(std::string &&data) override;
+
    // Subclasses should override the following:
    // =========================================
 
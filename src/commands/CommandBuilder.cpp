@@ -30,14 +30,16 @@ system by constructing BatchCommandEval objects.
 #include "CommandTargets.h"
 #include "ScriptCommandRelay.h"
 
-CommandBuilder::CommandBuilder(const wxString &cmdString)
+CommandBuilder::CommandBuilder(const wxString &cmdString, int id)
    : mValid(false)
+   , mId(id)
 {
    BuildCommand(cmdString);
 }
 
 CommandBuilder::CommandBuilder(const wxString &cmdName, const wxString &params)
    : mValid(false)
+   , mId(0)
 {
    BuildCommand(cmdName, params);
 }
@@ -82,7 +84,7 @@ void CommandBuilder::BuildCommand(const wxString &cmdName,
 {
    // Stage 1: create a Command object of the right type
 
-   auto scriptOutput = ScriptCommandRelay::GetResponseTarget();
+   auto scriptOutput = ScriptCommandRelay::GetResponseTarget(mId);
    auto output
       = std::make_unique<CommandOutputTarget>(std::make_unique<NullProgressTarget>(),
                                 scriptOutput,
@@ -169,7 +171,7 @@ void CommandBuilder::BuildCommand(const wxString &cmdStringArg)
    int splitAt = cmdString.Find(wxT(':'));
    if (splitAt < 0 && cmdString.Find(wxT(' ')) >= 0) {
       mError = wxT("Command is missing ':'");
-      ScriptCommandRelay::SendResponse(wxT("\n"));
+      ScriptCommandRelay::SendResponse(wxT("\n"), mId);
       mValid = false;
       return;
    }
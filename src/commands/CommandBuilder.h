@@ -30,6 +30,7 @@ class CommandBuilder
 {
    private:
       bool mValid;
+      int mId;
       CommandHolder mCommand;
       wxString mError;
 
@@ -38,7 +39,9 @@ class CommandBuilder
       void BuildCommand(const wxString &cmdName, const wxString &cmdParams);
       void BuildCommand(const wxString &cmdString);
    public:
-      CommandBuilder(const wxString &cmdString);
+      /// id tags the responses, for scripts that have several commands
+      /// in flight at once
+      CommandBuilder(const wxString &cmdString, int id = 0);
       CommandBuilder(const wxString &cmdName,
                      const wxString &cmdParams);
       ~CommandBuilder();
@@ -32,6 +32,7 @@
 #include "PreferenceCommands.h"
 #include "ImportExportCommands.h"
 #include "OpenSaveCommands.h"
+#include "TrackAudioCommands.h"
 
 std::unique_ptr<CommandDirectory> CommandDirectory::mInstance;
 
@@ -59,6 +60,8 @@ CommandDirectory::CommandDirectory()
    AddCommand(make_movable<ExportCommandType>());
    AddCommand(make_movable<OpenProjectCommandType>());
    AddCommand(make_movable<SaveProjectCommandType>());
+   AddCommand(make_movable<GetTrackAudioCommandType>());
+   AddCommand(make_movable<SetTrackAudioCommandType>());
 }
 
 CommandDirectory::~CommandDirectory()
@@ -68,6 +68,8 @@ class CommandMessageTarget /* not final */
 public:
    virtual ~CommandMessageTarget() {}
    virtual void Update(const wxString &message) = 0;
+   /// Binary output, such as samples; ignored by targets that only show text
+   virtual void UpdateData(const void *WXUNUSED(data), size_t WXUNUSED(len)) {}
 };
 
 ///
@@ -127,17 +129,23 @@ class ResponseQueueTarget final : public CommandMessageTarget
 {
 private:
    ResponseQueue &mResponseQueue;
+   int mId;
 public:
-   ResponseQueueTarget(ResponseQueue &responseQueue)
-      : mResponseQueue(responseQueue)
+   ResponseQueueTarget(ResponseQueue &responseQueue, int id = 0)
+      : mResponseQueue(responseQueue), mId(id)
    { }
    virtual ~ResponseQueueTarget()
    {
-      mResponseQueue.AddResponse(wxString(wxT("\n")));
+      mResponseQueue.AddResponse(Response(wxT("\n"), mId));
    }
    void Update(const wxString &message) override
    {
-      mResponseQueue.AddResponse(message);
+      mResponseQueue.AddResponse(Response(message, mId));
+   }
+   void UpdateData(const void *data, size_t len) override
+   {
+      mResponseQueue.AddResponse(Response(wxEmptyString, mId,
+         std::string(static_cast<const char *>(data), len)));
    }
 };
 
@@ -162,6 +170,11 @@ public:
       m1->Update(message);
       m2->Update(message);
    }
+   void UpdateData(const void *data, size_t len) override
+   {
+      m1->UpdateData(data, len);
+      m2->UpdateData(data, len);
+   }
 };
 
 
@@ -213,6 +226,11 @@ public:
       if (mErrorTarget)
          mErrorTarget->Update(message);
    }
+   void Data(const void *data, size_t len)
+   {
+      if (mStatusTarget)
+         mStatusTarget->UpdateData(data, len);
+   }
 };
 
 #endif /* End of include guard: __COMMANDTARGETS__ */
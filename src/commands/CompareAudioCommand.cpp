@@ -15,12 +15,105 @@
 \brief Returns information about the amount of audio that is about a certain
 threshold of difference in two selected tracks
 
+Stretches where both tracks share a block file are equal without reading
+them, and so are blocks that hold a single value (such as silence) in
+both; only the rest is read and compared.  The selection is split into
+chunks that are compared on several threads.
+
 *//*******************************************************************/
 
 #include "CompareAudioCommand.h"
+#include <algorithm>
+#include <functional>
+#include <math.h>
+#include <vector>
+#include <wx/thread.h>
 #include "../Project.h"
 #include "Command.h"
+#include "../BlockFile.h"
 #include "../WaveTrack.h"
+#include "CompareKernels.h"
+
+namespace {
+
+// True if every sample of the block is value, as its summary shows
+bool IsConstantBlock(const BlockFilePtr &file, float &value)
+{
+   if (!file->IsSummaryAvailable())
+      return false;
+
+   float min, max, rms;
+   file->GetMinMax(&min, &max, &rms);
+   value = min;
+   return min == max;
+}
+
+// Compares the samples of the two tracks from start to end
+bool CompareRange(const WaveTrack *track0, const WaveTrack *track1,
+                  sampleCount start, sampleCount end, float threshold,
+                  float *buff0, float *buff1, sampleCount buffSize,
+                  CompareStats &stats)
+{
+   sampleCount pos = start;
+   while (pos < end)
+   {
+      BlockFilePtr file0, file1;
+      sampleCount blockStart0, blockLen0, blockStart1, blockLen1;
+      const bool inBlock0 = track0->GetBlockAt(pos, file0, blockStart0, blockLen0);
+      const bool inBlock1 = track1->GetBlockAt(pos, file1, blockStart1, blockLen1);
+
+      // Go no further than the end of either block
+      sampleCount len = std::min(end - pos, buffSize);
+      if (inBlock0)
+         len = std::min(len, blockStart0 + blockLen0 - pos);
+      if (inBlock1)
+         len = std::min(len, blockStart1 + blockLen1 - pos);
+
+      float value0, value1;
+      if (inBlock0 && inBlock1 && file0 == file1 && blockStart0 == blockStart1)
+      {
+         // The same samples, as after a copy and paste
+         CompareConstant(0.0f, pos, len, threshold, stats);
+      }
+      else if (inBlock0 && inBlock1 &&
+               IsConstantBlock(file0, value0) && IsConstantBlock(file1, value1))
+      {
+         CompareConstant(value0 - value1, pos, len, threshold, stats);
+      }
+      else
+      {
+         if (!track0->Get((samplePtr)buff0, floatSample, pos, len) ||
+             !track1->Get((samplePtr)buff1, floatSample, pos, len))
+            return false;
+         CompareBuffers(buff0, buff1, pos, len, threshold, stats);
+      }
+
+      pos += len;
+   }
+
+   return true;
+}
+
+class CompareThread final : public wxThread
+{
+public:
+   CompareThread(const std::function<void()> &work)
+      : wxThread(wxTHREAD_JOINABLE)
+      , mWork(work)
+   {
+   }
+
+   ExitCode Entry() override
+   {
+      mWork();
+      return 0;
+   }
+
+private:
+   std::function<void()> mWork;
+};
+
+}
 
 wxString CompareAudioCommandType::BuildName()
 {
@@ -72,16 +165,6 @@ bool CompareAudioCommand::GetSelection(AudacityProject &proj)
    return true;
 }
 
-double CompareAudioCommand::CompareSample(double value1, double value2)
-{
-   return fabs(value1 - value2);
-}
-
-inline int min(int a, int b)
-{
-   return (a < b) ? a : b;
-}
-
 bool CompareAudioCommand::Apply(CommandExecutionContext context)
 {
    if (!GetSelection(*context.GetProject()))
@@ -94,50 +177,114 @@ bool CompareAudioCommand::Apply(CommandExecutionContext context)
       + mTrack1->GetName() + wxT("'.");
    Status(msg);
 
-   long errorCount = 0;
    double errorThreshold = GetDouble(wxT("Threshold"));
 
-   // Initialize buffers for track data to be analyzed
-   int buffSize = min(mTrack0->GetMaxBlockSize(), mTrack1->GetMaxBlockSize());
-   float *buff0 = new float[buffSize];
-   float *buff1 = new float[buffSize];
-
-   // Compare tracks block by block
-   long s0 = mTrack0->TimeToLongSamples(mT0);
-   long s1 = mTrack0->TimeToLongSamples(mT1);
-   long position = s0;
-   long length = s1 - s0;
-   while (position < s1)
+   sampleCount s0 = mTrack0->TimeToLongSamples(mT0);
+   sampleCount s1 = mTrack0->TimeToLongSamples(mT1);
+   sampleCount length = s1 - s0;
+
+   // Split the selection into chunks of several blocks, each compared on
+   // whichever thread is free
+   const sampleCount buffSize =
+      std::min(mTrack0->GetMaxBlockSize(), mTrack1->GetMaxBlockSize());
+   const sampleCount chunkLen = 16 * buffSize;
+   const size_t numChunks = (length + chunkLen - 1) / chunkLen;
+   std::vector<CompareStats> results(numChunks);
+
+   wxMutex mutex;
+   wxCondition chunkDone(mutex);
+   size_t nextChunk = 0;
+   size_t chunksDone = 0;
+   bool failed = false;
+
+   auto work = [&](bool reportProgress)
    {
-      // Get a block of data into the buffers
-      sampleCount block = mTrack0->GetBestBlockSize(position);
-      if (position + block > s1)
+      std::vector<float> buff0(buffSize), buff1(buffSize);
+      while (true)
       {
-         block = s1 - position;
-      }
-      mTrack0->Get((samplePtr)buff0, floatSample, position, block);
-      mTrack1->Get((samplePtr)buff1, floatSample, position, block);
+         size_t c;
+         {
+            wxMutexLocker locker(mutex);
+            if (failed || nextChunk >= numChunks)
+               break;
+            c = nextChunk++;
+         }
 
-      int buffPos = 0;
-      for (buffPos = 0; buffPos < block; ++buffPos)
-      {
-         if (CompareSample(buff0[buffPos], buff1[buffPos]) > errorThreshold)
+         const sampleCount start = s0 + c * chunkLen;
+         const bool ok = CompareRange(mTrack0, mTrack1,
+                                      start, std::min(s1, start + chunkLen),
+                                      errorThreshold, &buff0[0], &buff1[0],
+                                      buffSize, results[c]);
+
+         size_t done;
          {
-            ++errorCount;
+            wxMutexLocker locker(mutex);
+            failed = failed || !ok;
+            done = ++chunksDone;
+            chunkDone.Signal();
          }
+         if (reportProgress)
+            Progress((double)done / numChunks);
+      }
+   };
+
+   const size_t numThreads =
+      std::min<size_t>(numChunks, std::max(1, wxThread::GetCPUCount()));
+   std::vector<std::unique_ptr<CompareThread>> threads;
+   for (size_t i = 1; i < numThreads; i++)
+   {
+      auto thread = std::make_unique<CompareThread>([&]{ work(false); });
+      if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR)
+         break;
+      threads.push_back(std::move(thread));
+   }
+
+   // This thread does its share too, reporting progress as it goes, and
+   // then as the others finish what they took
+   work(true);
+
+   size_t reported = 0;
+   while (true)
+   {
+      size_t done;
+      {
+         wxMutexLocker locker(mutex);
+         while (chunksDone == reported && chunksDone < numChunks && !failed)
+            chunkDone.Wait();
+         if (chunksDone == numChunks || failed)
+            break;
+         done = reported = chunksDone;
       }
+      Progress((double)done / numChunks);
+   }
 
-      position += block;
-      Progress((position - mT0) / length);
+   for (auto &thread : threads)
+      thread->Wait();
+
+   if (failed)
+   {
+      Error(wxT("Could not read the tracks."));
+      return false;
    }
 
-   delete [] buff0;
-   delete [] buff1;
+   CompareStats stats;
+   for (const auto &result : results)
+      stats.Add(result);
+   Progress(1.0);
 
    // Output the results
+   long errorCount = stats.errorCount;
    double errorSeconds = mTrack0->LongSamplesToTime(errorCount);
+   double firstErrorTime =
+      stats.firstError < 0 ? -1.0 : mTrack0->LongSamplesToTime(stats.firstError);
+   double rmsError = length > 0 ? sqrt(stats.sumSquares / length) : 0.0;
    Status(wxString::Format(wxT("%li"), errorCount));
    Status(wxString::Format(wxT("%.4f"), errorSeconds));
+   Status(wxString::Format(wxT("%.6f"), firstErrorTime));
+   Status(wxString::Format(wxT("%f"), stats.maxError));
+   Status(wxString::Format(wxT("%f"), rmsError));
    Status(wxString::Format(wxT("Finished comparison: %li samples (%.3f seconds) exceeded the error threshold of %f."), errorCount, errorSeconds, errorThreshold));
+   if (stats.firstError >= 0)
+      Status(wxString::Format(wxT("First difference at %.6f seconds; maximum error %f, RMS error %f."), firstErrorTime, stats.maxError, rmsError));
    return true;
 }
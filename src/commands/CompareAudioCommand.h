@@ -40,9 +40,6 @@ private:
    // Update member variables with project selection data (and validate)
    bool GetSelection(AudacityProject &proj);
 
-protected:
-   double CompareSample(double value1, double value2) /* not override */;
-
 public:
    CompareAudioCommand(CommandType &type, std::unique_ptr<CommandOutputTarget> &&target)
       : CommandImplementation(type, std::move(target))
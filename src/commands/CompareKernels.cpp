@@ -0,0 +1,133 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CompareKernels.cpp
+
+*******************************************************************//**
+
+\file CompareKernels.cpp
+\brief Sample by sample comparison for CompareAudioCommand.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "CompareKernels.h"
+
+#include <algorithm>
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COMPARE_KERNELS_SSE
+#include <emmintrin.h>
+#endif
+
+CompareStats::CompareStats()
+   : errorCount(0), firstError(-1), maxError(0.0), sumSquares(0.0)
+{
+}
+
+void CompareStats::Add(const CompareStats &other)
+{
+   errorCount += other.errorCount;
+   if (firstError < 0)
+      firstError = other.firstError;
+   maxError = std::max(maxError, other.maxError);
+   sumSquares += other.sumSquares;
+}
+
+void CompareConstant(float diff, sampleCount pos, sampleCount len,
+                     float threshold, CompareStats &stats)
+{
+   const float error = fabs(diff);
+   if (error > threshold)
+   {
+      stats.errorCount += len;
+      if (stats.firstError < 0)
+         stats.firstError = pos;
+   }
+   stats.maxError = std::max(stats.maxError, (double)error);
+   stats.sumSquares += (double)error * error * len;
+}
+
+void CompareBuffers(const float *buff0, const float *buff1,
+                    sampleCount pos, sampleCount len,
+                    float threshold, CompareStats &stats)
+{
+   sampleCount i = 0;
+   sampleCount errorCount = 0;
+   float maxError = 0.0f;
+   double sumSquares = 0.0;
+
+#if defined(COMPARE_KERNELS_SSE)
+   const __m128 signMask = _mm_set1_ps(-0.0f);
+   const __m128 vThreshold = _mm_set1_ps(threshold);
+   const __m128 vOne = _mm_set1_ps(1.0f);
+   __m128 vMax = _mm_setzero_ps();
+   __m128d vSumLow = _mm_setzero_pd();
+   __m128d vSumHigh = _mm_setzero_pd();
+
+   // The lane counts are kept in float, which is exact for one run of at
+   // most 4096 samples; the squares are summed in double throughout
+   for (; i + 4 <= len; )
+   {
+      __m128 vCount = _mm_setzero_ps();
+      const sampleCount runEnd = std::min(len & ~(sampleCount)3, i + 4096);
+      for (; i < runEnd; i += 4)
+      {
+         const __m128 d = _mm_andnot_ps(signMask,
+            _mm_sub_ps(_mm_loadu_ps(buff0 + i), _mm_loadu_ps(buff1 + i)));
+         const __m128 over = _mm_cmpgt_ps(d, vThreshold);
+         if (stats.firstError < 0 && _mm_movemask_ps(over))
+         {
+            for (int j = 0; j < 4; j++)
+            {
+               if (fabs(buff0[i + j] - buff1[i + j]) > threshold)
+               {
+                  stats.firstError = pos + i + j;
+                  break;
+               }
+            }
+         }
+         vCount = _mm_add_ps(vCount, _mm_and_ps(over, vOne));
+         vMax = _mm_max_ps(vMax, d);
+
+         const __m128d low = _mm_cvtps_pd(d);
+         const __m128d high = _mm_cvtps_pd(_mm_movehl_ps(d, d));
+         vSumLow = _mm_add_pd(vSumLow, _mm_mul_pd(low, low));
+         vSumHigh = _mm_add_pd(vSumHigh, _mm_mul_pd(high, high));
+      }
+
+      float counts[4];
+      _mm_storeu_ps(counts, vCount);
+      for (int j = 0; j < 4; j++)
+         errorCount += (sampleCount)counts[j];
+   }
+
+   float maxes[4];
+   _mm_storeu_ps(maxes, vMax);
+   for (int j = 0; j < 4; j++)
+      maxError = std::max(maxError, maxes[j]);
+
+   double sums[2];
+   _mm_storeu_pd(sums, _mm_add_pd(vSumLow, vSumHigh));
+   sumSquares = sums[0] + sums[1];
+#endif
+
+   for (; i < len; i++)
+   {
+      const float error = fabs(buff0[i] - buff1[i]);
+      if (error > threshold)
+      {
+         ++errorCount;
+         if (stats.firstError < 0)
+            stats.firstError = pos + i;
+      }
+      maxError = std::max(maxError, error);
+      sumSquares += (double)error * error;
+   }
+
+   stats.errorCount += errorCount;
+   stats.maxError = std::max(stats.maxError, (double)maxError);
+   stats.sumSquares += sumSquares;
+}
@@ -0,0 +1,48 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  CompareKernels.h
+
+*******************************************************************//**
+
+\file CompareKernels.h
+\brief Sample by sample comparison for CompareAudioCommand.
+
+The samples of the two tracks are compared four at a time where SSE2 is
+available, and one at a time otherwise, with the same results: counts
+and positions are exact either way, and sums of squares are kept in
+double, so they differ from the scalar loop only by the order in which
+they were added.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_COMPARE_KERNELS__
+#define __AUDACITY_COMPARE_KERNELS__
+
+#include "audacity/Types.h"
+
+// What is known about the differences in a stretch of the two tracks
+struct CompareStats
+{
+   CompareStats();
+
+   sampleCount errorCount;   // samples differing by more than the threshold
+   sampleCount firstError;   // the first of those, or -1
+   double maxError;
+   double sumSquares;
+
+   // other must describe samples that come after these
+   void Add(const CompareStats &other);
+};
+
+// len samples from pos that all differ by diff
+void CompareConstant(float diff, sampleCount pos, sampleCount len,
+                     float threshold, CompareStats &stats);
+
+// The differences between buff0 and buff1, which hold len samples from pos
+void CompareBuffers(const float *buff0, const float *buff1,
+                    sampleCount pos, sampleCount len,
+                    float threshold, CompareStats &stats);
+
+#endif
@@ -25,10 +25,10 @@ ResponseQueue::ResponseQueue()
 ResponseQueue::~ResponseQueue()
 { }
 
-void ResponseQueue::AddResponse(Response response)
+void ResponseQueue::AddResponse(Response &&response)
 {
    wxMutexLocker locker(mMutex);
-   mResponses.push(response);
+   mResponses.push(std::move(response));
    mCondition.Signal();
 }
 
@@ -40,7 +40,7 @@ Response ResponseQueue::WaitAndGetResponse()
       mCondition.Wait();
    }
    wxASSERT(!mResponses.empty());
-   Response msg = mResponses.front();
+   Response msg = std::move(mResponses.front());
    mResponses.pop();
    return msg;
 }
@@ -14,8 +14,8 @@
 *//****************************************************************//**
 
 \class Response
-\brief Stores a command response string (and other response data if it becomes
-necessary)
+\brief Stores a command response string, the id of the request it answers,
+and any binary data (such as samples) that goes with it
 
 The string is internally stored as a std::string rather than wxString
 because of thread-safety concerns.
@@ -46,15 +46,35 @@ class wxMutexLocker;
 class Response {
    private:
       std::string mMessage;
+      int mId;
+      std::string mData;
    public:
-      Response(const wxString &response)
+      Response(const wxString &response, int id = 0)
          : mMessage(response.mb_str())
+         , mId(id)
+      { }
+
+      Response(const wxString &response, int id, std::string &&data)
+         : mMessage(response.mb_str())
+         , mId(id)
+         , mData(std::move(data))
       { }
 
       wxString GetMessage()
       {
          return wxString(mMessage.c_str(), wxConvUTF8);
       }
+
+      /// The request this answers; 0 for the one-at-a-time pipe
+      int GetId() const
+      {
+         return mId;
+      }
+
+      std::string &GetData()
+      {
+         return mData;
+      }
 };
 
 class ResponseQueue {
@@ -67,7 +87,7 @@ class ResponseQueue {
       ResponseQueue();
       ~ResponseQueue();
 
-      void AddResponse(Response response);
+      void AddResponse(Response &&response);
       Response WaitAndGetResponse();
 };
 
@@ -31,6 +31,7 @@ code out of ModuleManager.
 CommandHandler *ScriptCommandRelay::sCmdHandler;
 tpRegScriptServerFunc ScriptCommandRelay::sScriptFn;
 ResponseQueue ScriptCommandRelay::sResponseQueue;
+ResponseQueue ScriptCommandRelay::sTaggedResponseQueue;
 
 void ScriptCommandRelay::SetRegScriptServerFunc(tpRegScriptServerFunc scriptFn)
 {
@@ -50,6 +51,15 @@ void ScriptCommandRelay::Run()
       sScriptFn(&ExecCommand);
 }
 
+/// Gives a socket server the functions for posting commands and collecting
+/// their responses.  The server runs on a thread of its own, which it
+/// starts before returning.
+void ScriptCommandRelay::StartSocketServer(tpRegScriptSocketFunc socketFn)
+{
+   wxASSERT( socketFn != NULL );
+   socketFn(&PostScriptCommand, &ReceiveScriptResponse);
+}
+
 /// Send a command to a project, to be applied in that context.
 void ScriptCommandRelay::PostCommand(AudacityProject *project, const CommandHolder &cmd)
 {
@@ -86,20 +96,70 @@ int ExecCommand(wxString *pIn, wxString *pOut)
 
    // Wait until all responses from the command have been received.
    // The last response is signalled by an empty line.
-   wxString msg = ScriptCommandRelay::ReceiveResponse().GetMessage();
+   // Binary data can't be sent down the pipe, and is dropped.
+   Response response = ScriptCommandRelay::ReceiveResponse();
+   wxString msg = response.GetMessage();
    while (msg != wxT("\n"))
    {
-      *pOut += msg + wxT("\n");
-      msg = ScriptCommandRelay::ReceiveResponse().GetMessage();
+      if (response.GetData().empty())
+      {
+         *pOut += msg + wxT("\n");
+      }
+      response = ScriptCommandRelay::ReceiveResponse();
+      msg = response.GetMessage();
    }
 
    return 0;
 }
 
+/// Sends a command to the active project without waiting for it.  Its
+/// responses, tagged with id, are collected with ReceiveScriptResponse.
+/// Returns 0 and fills in *pError if the command is not valid; there is
+/// still an end of response to collect for it.
+int PostScriptCommand(int id, wxString *pIn, std::string *pData, wxString *pError)
+{
+   wxASSERT(id != 0);
+
+   CommandBuilder builder(*pIn, id);
+   if (!builder.WasValid())
+   {
+      *pError = wxT("Syntax error!\n");
+      *pError += builder.GetErrorMessage() + wxT("\n");
+      return 0;
+   }
+
+   AudacityProject *project = GetActiveProject();
+   CommandHolder cmd = builder.GetCommand();
+   if (pData && !pData->empty())
+   {
+      cmd->SetData(std::move(*pData));
+   }
+   ScriptCommandRelay::PostCommand(project, cmd);
+
+   return 1;
+}
+
+/// Waits for the next piece of response to any posted command: a line of
+/// text, or binary data.  Returns 1 when the piece ends the response for
+/// *pId, and 0 otherwise.
+int ReceiveScriptResponse(int *pId, wxString *pOut, std::string *pData)
+{
+   Response response = ScriptCommandRelay::ReceiveTaggedResponse();
+
+   *pId = response.GetId();
+   *pOut = response.GetMessage();
+   pData->swap(response.GetData());
+
+   return (pData->empty() && *pOut == wxT("\n")) ? 1 : 0;
+}
+
 /// Adds a response to the queue to be sent back to the script
-void ScriptCommandRelay::SendResponse(const wxString &response)
+void ScriptCommandRelay::SendResponse(const wxString &response, int id)
 {
-   sResponseQueue.AddResponse(response);
+   if (id == 0)
+      sResponseQueue.AddResponse(Response(response));
+   else
+      sTaggedResponseQueue.AddResponse(Response(response, id));
 }
 
 /// Gets a response from the queue (may block)
@@ -108,10 +168,18 @@ Response ScriptCommandRelay::ReceiveResponse()
    return ScriptCommandRelay::sResponseQueue.WaitAndGetResponse();
 }
 
+/// Gets a response to a command posted with PostScriptCommand (may block)
+Response ScriptCommandRelay::ReceiveTaggedResponse()
+{
+   return ScriptCommandRelay::sTaggedResponseQueue.WaitAndGetResponse();
+}
+
 /// Get a pointer to a message target which allows commands to send responses
 /// back to a script.
-std::shared_ptr<ResponseQueueTarget> ScriptCommandRelay::GetResponseTarget()
+std::shared_ptr<ResponseQueueTarget> ScriptCommandRelay::GetResponseTarget(int id)
 {
    // This should be deleted by a Command destructor
-   return std::make_shared<ResponseQueueTarget>(sResponseQueue);
+   if (id == 0)
+      return std::make_shared<ResponseQueueTarget>(sResponseQueue);
+   return std::make_shared<ResponseQueueTarget>(sTaggedResponseQueue, id);
 }
@@ -18,6 +18,7 @@
 
 #include "../Audacity.h"
 #include "../MemoryX.h"
+#include <string>
 
 class CommandHandler;
 class ResponseQueue;
@@ -31,8 +32,22 @@ class wxString;
 typedef int (*tpExecScriptServerFunc)( wxString * pIn, wxString * pOut);
 typedef int (*tpRegScriptServerFunc)(tpExecScriptServerFunc pFn);
 
+// For servers that keep several commands in flight: commands are posted
+// without waiting, and the pieces of their responses come back tagged
+// with the id they were posted with, in whatever order they finish.
+typedef int (*tpPostScriptCommandFunc)(int id, wxString *pIn,
+                                       std::string *pData, wxString *pError);
+typedef int (*tpReceiveScriptResponseFunc)(int *pId, wxString *pOut,
+                                           std::string *pData);
+typedef int (*tpRegScriptSocketFunc)(tpPostScriptCommandFunc postFn,
+                                     tpReceiveScriptResponseFunc receiveFn);
+
 extern "C" {
       AUDACITY_DLL_API int ExecCommand(wxString *pIn, wxString *pOut);
+      AUDACITY_DLL_API int PostScriptCommand(int id, wxString *pIn,
+                                             std::string *pData, wxString *pError);
+      AUDACITY_DLL_API int ReceiveScriptResponse(int *pId, wxString *pOut,
+                                                 std::string *pData);
 } // End 'extern C'
 
 class ScriptCommandRelay
@@ -42,6 +57,7 @@ class ScriptCommandRelay
       static CommandHandler *sCmdHandler;
       static tpRegScriptServerFunc sScriptFn;
       static ResponseQueue sResponseQueue;
+      static ResponseQueue sTaggedResponseQueue;
 
    public:
 
@@ -49,10 +65,12 @@ class ScriptCommandRelay
       static void SetCommandHandler(CommandHandler &ch);
 
       static void Run();
+      static void StartSocketServer(tpRegScriptSocketFunc socketFn);
       static void PostCommand(AudacityProject *project, const CommandHolder &cmd);
-      static void SendResponse(const wxString &response);
+      static void SendResponse(const wxString &response, int id = 0);
       static Response ReceiveResponse();
-      static std::shared_ptr<ResponseQueueTarget> GetResponseTarget();
+      static Response ReceiveTaggedResponse();
+      static std::shared_ptr<ResponseQueueTarget> GetResponseTarget(int id = 0);
 };
 
 #endif /* End of include guard: __SCRIPTCOMMANDRELAY__ */
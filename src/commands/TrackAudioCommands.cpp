@@ -0,0 +1,182 @@
+/**********************************************************************
+
+   Audacity - A Digital Audio Editor
+   Copyright 1999-2009 Audacity Team
+   File License: wxWidgets
+
+******************************************************************//**
+
+\file TrackAudioCommands.cpp
+\brief Contains definitions for the GetTrackAudioCommand and
+SetTrackAudioCommand classes
+
+These move samples as binary data rather than through files, so they are
+only useful to scripts that can receive it, such as those on the script
+socket.  Ranges are given in samples from the start of the track.
+
+*//*******************************************************************/
+
+#include "TrackAudioCommands.h"
+#include <algorithm>
+#include <vector>
+#include "../Project.h"
+#include "../Track.h"
+#include "../WaveTrack.h"
+
+namespace {
+
+// (Note: track selection ought to be somewhere else)
+WaveTrack *FindWaveTrack(AudacityProject *project, long trackIndex)
+{
+   long i = 0;
+   TrackListIterator iter(project->GetTracks());
+   Track *t = iter.First();
+   while (t && i != trackIndex)
+   {
+      t = iter.Next();
+      ++i;
+   }
+   if (!t || t->GetKind() != Track::Wave)
+   {
+      return NULL;
+   }
+   return static_cast<WaveTrack *>(t);
+}
+
+}
+
+// GetTrackAudio
+
+wxString GetTrackAudioCommandType::BuildName()
+{
+   return wxT("GetTrackAudio");
+}
+
+void GetTrackAudioCommandType::BuildSignature(CommandSignature &signature)
+{
+   auto trackIndexValidator = make_movable<IntValidator>();
+   signature.AddParameter(wxT("TrackIndex"), 0, std::move(trackIndexValidator));
+
+   auto startValidator = make_movable<IntValidator>();
+   signature.AddParameter(wxT("Start"), 0, std::move(startValidator));
+
+   // 0 means up to the end of the track
+   auto lengthValidator = make_movable<IntValidator>();
+   signature.AddParameter(wxT("Length"), 0, std::move(lengthValidator));
+}
+
+CommandHolder GetTrackAudioCommandType::Create(std::unique_ptr<CommandOutputTarget> &&target)
+{
+   return std::make_shared<GetTrackAudioCommand>(*this, std::move(target));
+}
+
+bool GetTrackAudioCommand::Apply(CommandExecutionContext context)
+{
+   WaveTrack *track = FindWaveTrack(context.GetProject(), GetLong(wxT("TrackIndex")));
+   if (!track)
+   {
+      Error(wxT("TrackIndex does not refer to a wave track."));
+      return false;
+   }
+
+   sampleCount start = GetLong(wxT("Start"));
+   sampleCount len = GetLong(wxT("Length"));
+   sampleCount end = track->TimeToLongSamples(track->GetEndTime());
+   if (len == 0)
+   {
+      len = end - start;
+   }
+   if (start < 0 || len < 0)
+   {
+      Error(wxT("Start and Length must not be negative."));
+      return false;
+   }
+
+   // Send the samples a block at a time, so that a long range doesn't have
+   // to be held twice in memory
+   sampleCount bufferLen = track->GetMaxBlockSize();
+   std::vector<float> buffer(bufferLen);
+   sampleCount pos = start;
+   while (pos < start + len)
+   {
+      sampleCount block = std::min(track->GetBestBlockSize(pos), bufferLen);
+      block = std::min(block, start + len - pos);
+      if (!track->Get((samplePtr)&buffer[0], floatSample, pos, block))
+      {
+         Error(wxT("Could not read the track."));
+         return false;
+      }
+      Data(&buffer[0], block * sizeof(float));
+      pos += block;
+   }
+
+   Status(wxString::Format(wxT("%lld"), (long long)len));
+   return true;
+}
+
+GetTrackAudioCommand::~GetTrackAudioCommand()
+{ }
+
+// SetTrackAudio
+
+wxString SetTrackAudioCommandType::BuildName()
+{
+   return wxT("SetTrackAudio");
+}
+
+void SetTrackAudioCommandType::BuildSignature(CommandSignature &signature)
+{
+   auto trackIndexValidator = make_movable<IntValidator>();
+   signature.AddParameter(wxT("TrackIndex"), 0, std::move(trackIndexValidator));
+
+   auto startValidator = make_movable<IntValidator>();
+   signature.AddParameter(wxT("Start"), 0, std::move(startValidator));
+}
+
+CommandHolder SetTrackAudioCommandType::Create(std::unique_ptr<CommandOutputTarget> &&target)
+{
+   return std::make_shared<SetTrackAudioCommand>(*this, std::move(target));
+}
+
+bool SetTrackAudioCommand::Apply(CommandExecutionContext context)
+{
+   AudacityProject *project = context.GetProject();
+   WaveTrack *track = FindWaveTrack(project, GetLong(wxT("TrackIndex")));
+   if (!track)
+   {
+      Error(wxT("TrackIndex does not refer to a wave track."));
+      return false;
+   }
+
+   sampleCount start = GetLong(wxT("Start"));
+   if (start < 0)
+   {
+      Error(wxT("Start must not be negative."));
+      return false;
+   }
+
+   std::string &data = GetData();
+   if (data.size() % sizeof(float) != 0)
+   {
+      Error(wxT("The data is not a whole number of 32-bit float samples."));
+      return false;
+   }
+
+   // As with WaveTrack::Set, samples that fall outside the clips are dropped
+   sampleCount len = data.size() / sizeof(float);
+   if (len > 0)
+   {
+      if (!track->Set((samplePtr)&data[0], floatSample, start, len))
+      {
+         Error(wxT("Could not write the track."));
+         return false;
+      }
+      project->PushState(wxT("Set audio from script"), wxT("Set Audio"));
+   }
+
+   Status(wxString::Format(wxT("%lld"), (long long)len));
+   return true;
+}
+
+SetTrackAudioCommand::~SetTrackAudioCommand()
+{ }
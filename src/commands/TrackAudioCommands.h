@@ -0,0 +1,73 @@
+/**********************************************************************
+
+   Audacity: A Digital Audio Editor
+   Audacity(R) is copyright (c) 1999-2009 Audacity Team.
+   File License: wxwidgets
+
+   TrackAudioCommands.h
+
+******************************************************************//**
+
+\class GetTrackAudioCommand
+\brief Command that sends the samples of a range of a wave track back to
+the script, as 32-bit float binary data
+
+\class SetTrackAudioCommand
+\brief Command that overwrites a range of a wave track with the 32-bit
+float binary data sent with it
+
+*//*******************************************************************/
+
+#ifndef __TRACKAUDIOCOMMANDS__
+#define __TRACKAUDIOCOMMANDS__
+
+#include "Command.h"
+#include "CommandType.h"
+
+class WaveTrack;
+
+// GetTrackAudio
+
+class GetTrackAudioCommandType final : public CommandType
+{
+public:
+   wxString BuildName() override;
+   void BuildSignature(CommandSignature &signature) override;
+   CommandHolder Create(std::unique_ptr<CommandOutputTarget> &&target) override;
+};
+
+class GetTrackAudioCommand final : public CommandImplementation
+{
+public:
+   GetTrackAudioCommand(CommandType &type,
+                        std::unique_ptr<CommandOutputTarget> &&target)
+      : CommandImplementation(type, std::move(target))
+   { }
+
+   virtual ~GetTrackAudioCommand();
+   bool Apply(CommandExecutionContext context) override;
+};
+
+// SetTrackAudio
+
+class SetTrackAudioCommandType final : public CommandType
+{
+public:
+   wxString BuildName() override;
+   void BuildSignature(CommandSignature &signature) override;
+   CommandHolder Create(std::unique_ptr<CommandOutputTarget> &&target) override;
+};
+
+class SetTrackAudioCommand final : public CommandImplementation
+{
+public:
+   SetTrackAudioCommand(CommandType &type,
+                        std::unique_ptr<CommandOutputTarget> &&target)
+      : CommandImplementation(type, std::move(target))
+   { }
+
+   virtual ~SetTrackAudioCommand();
+   bool Apply(CommandExecutionContext context) override;
+};
+
+#endif /* End of include guard: __TRACKAUDIOCOMMANDS__ */
@@ -0,0 +1,163 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AnalysisJobs.cpp
+
+*******************************************************************//**
+
+\file AnalysisJobs.cpp
+\brief Runs the analyses of several tracks on worker threads.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "AnalysisJobs.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <wx/thread.h>
+#include <wx/utils.h>
+
+#include "../MemoryX.h"
+
+namespace {
+
+class AnalysisThread final : public wxThread
+{
+public:
+   AnalysisThread(const std::function<void()> &work)
+      : wxThread(wxTHREAD_JOINABLE)
+      , mWork(work)
+   {
+   }
+
+   ExitCode Entry() override
+   {
+      mWork();
+      return 0;
+   }
+
+private:
+   std::function<void()> mWork;
+};
+
+}
+
+bool RunAnalysisJobs(size_t numJobs, size_t numWorkers,
+                     const AnalysisJob &analyse,
+                     const AnalysisProgress &totalProgress)
+{
+   if (numJobs == 0)
+   {
+      return true;
+   }
+
+   wxMutex mutex;
+   size_t nextJob = 0;
+   size_t jobsDone = 0;
+   std::vector<double> done(numJobs, 0.0);
+   bool cancelled = false;
+   bool inlined = false;
+
+   // Call with mutex locked
+   auto total = [&]
+   {
+      double frac = 0.0;
+      for (auto d : done)
+      {
+         frac += d;
+      }
+      return frac / numJobs;
+   };
+
+   auto work = [&](size_t w)
+   {
+      while (true)
+      {
+         size_t j;
+         {
+            wxMutexLocker locker(mutex);
+            if (cancelled || nextJob >= numJobs)
+            {
+               break;
+            }
+            j = nextJob++;
+         }
+
+         analyse(w, j, [&](double frac)
+         {
+            double sum;
+            {
+               wxMutexLocker locker(mutex);
+               done[j] = frac;
+               if (!inlined)
+               {
+                  return cancelled;
+               }
+               sum = total();
+            }
+
+            // Without workers this is the caller's thread, which may
+            // report progress itself
+            if (totalProgress(sum))
+            {
+               wxMutexLocker locker(mutex);
+               cancelled = true;
+            }
+            return cancelled;
+         });
+
+         wxMutexLocker locker(mutex);
+         ++jobsDone;
+      }
+   };
+
+   std::vector<std::unique_ptr<AnalysisThread>> threads;
+   for (size_t w = 0; w < std::min(numWorkers, numJobs); w++)
+   {
+      auto thread = std::make_unique<AnalysisThread>([&work, w] { work(w); });
+      if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR)
+      {
+         break;
+      }
+      threads.push_back(std::move(thread));
+   }
+
+   if (threads.empty())
+   {
+      // No threads to be had; analyse everything here instead
+      inlined = true;
+      work(0);
+      return !cancelled;
+   }
+
+   while (true)
+   {
+      double frac;
+      bool finished;
+      {
+         wxMutexLocker locker(mutex);
+         finished = jobsDone == numJobs;
+         frac = total();
+      }
+
+      if (finished || totalProgress(frac))
+      {
+         wxMutexLocker locker(mutex);
+         cancelled = !finished;
+         break;
+      }
+
+      wxMilliSleep(50);
+   }
+
+   for (auto &thread : threads)
+   {
+      thread->Wait();
+   }
+
+   return !cancelled;
+}
@@ -0,0 +1,44 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AnalysisJobs.h
+
+*******************************************************************//**
+
+\file AnalysisJobs.h
+\brief Runs the analyses of several tracks on worker threads.
+
+The jobs, one for each track or stereo pair, are numbered from 0, and
+the workers take them in that order, each as it becomes free, so they
+may finish in any order.  A job keeps what it finds to itself, for the
+caller to gather in the order of the tracks once all are done.
+
+A worker does one job at a time, so whatever the caller keeps for each
+worker, such as a plug-in instance, is used by one thread at a time.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_ANALYSIS_JOBS__
+#define __AUDACITY_ANALYSIS_JOBS__
+
+#include <stddef.h>
+#include <functional>
+
+// Returns true to stop
+using AnalysisProgress = std::function<bool(double frac)>;
+
+// Analyses job number job on worker number worker, reporting how far it
+// is, from 0 to 1, through progress, and stopping when that returns true
+using AnalysisJob =
+   std::function<void(size_t worker, size_t job, const AnalysisProgress &progress)>;
+
+// Runs the jobs on up to numWorkers threads, or on this one if there are
+// none to be had.  totalProgress is called on this thread only, with the
+// average of the jobs' progress, and cancels them all when it returns
+// true.  Returns false if cancelled.
+bool RunAnalysisJobs(size_t numJobs, size_t numWorkers,
+                     const AnalysisJob &analyse,
+                     const AnalysisProgress &totalProgress);
+
+#endif
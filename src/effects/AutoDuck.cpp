@@ -15,15 +15,18 @@
 
 #include "../Audacity.h"
 #include "AutoDuck.h"
+#include "AutoDuckKernels.h"
 
 #include <math.h>
 #include <float.h>
+#include <atomic>
+#include <functional>
 
 #include <wx/dcclient.h>
 #include <wx/dcmemory.h>
-#include <wx/dynarray.h>
 #include <wx/intl.h>
 #include <wx/msgdlg.h>
+#include <wx/thread.h>
 
 #include "../AColor.h"
 #include "../AllThemeResources.h"
@@ -51,28 +54,42 @@ Param( MaximumPause,       double,  XO("MaximumPause"),     1.0,     0.0,     DB
  */
 
 static const int kBufSize = 131072;     // number of samples to process at once
-static const int kRMSWindowSize = 100;  // samples in circular RMS window buffer
 
-/*
- * A auto duck region and an array of auto duck regions
- */
+namespace {
 
-struct AutoDuckRegion
+class AutoDuckThread final : public wxThread
 {
-   AutoDuckRegion(double t0, double t1)
+public:
+   AutoDuckThread(const std::function<void()> &work)
+      : wxThread(wxTHREAD_JOINABLE)
+      , mWork(work)
    {
-      this->t0 = t0;
-      this->t1 = t1;
    }
 
-   double t0;
-   double t1;
+   ExitCode Entry() override
+   {
+      mWork();
+      return 0;
+   }
+
+private:
+   std::function<void()> mWork;
 };
 
-#include <wx/arrimpl.cpp>
+}
 
-WX_DECLARE_OBJARRAY(AutoDuckRegion, AutoDuckRegionArray);
-WX_DEFINE_OBJARRAY(AutoDuckRegionArray);
+// A target track, faded by a worker thread as far as the analysis of the
+// control track allows.  Only the worker touches the track until it is
+// done, and it writes the faded samples back itself; the DirManager lets
+// any thread make block files.
+struct EffectAutoDuck::Job
+{
+   WaveTrack *track;
+
+   // Guarded by the mutex of ProcessJobs()
+   double fraction;   // of the track faded, for the progress
+   bool done;
+};
 
 /*
  * Effect implementation
@@ -254,13 +271,9 @@ void EffectAutoDuck::End()
 
 bool EffectAutoDuck::Process()
 {
-   sampleCount i;
-
    if (GetNumWaveTracks() == 0 || !mControlTrack)
       return false;
 
-   bool cancel = false;
-
    sampleCount start =
       mControlTrack->TimeToLongSamples(mT0 + mOuterFadeDownLen);
    sampleCount end =
@@ -269,152 +282,29 @@ bool EffectAutoDuck::Process()
    if (end <= start)
       return false;
 
-   // the minimum number of samples we have to wait until the maximum
-   // pause has been exceeded
-   double maxPause = mMaximumPause;
-
-   // We don't fade in until we have time enough to actually fade out again
-   if (maxPause < mOuterFadeDownLen + mOuterFadeUpLen)
-      maxPause = mOuterFadeDownLen + mOuterFadeUpLen;
-
-   sampleCount minSamplesPause =
-      mControlTrack->TimeToLongSamples(maxPause);
+   CopyInputTracks(); // Set up mOutputTracks.
 
-   double threshold = DB_TO_LINEAR(mThresholdDb);
+   std::vector<Job> jobs;
+   SelectedTrackListOfKindIterator iter(Track::Wave, mOutputTracks.get());
+   Track *iterTrack = iter.First();
 
-   // adjust the threshold so we can compare it to the rmsSum value
-   threshold = threshold * threshold * kRMSWindowSize;
-
-   int rmsPos = 0;
-   float rmsSum = 0;
-   float *rmsWindow = new float[kRMSWindowSize];
-   for (i = 0; i < kRMSWindowSize; i++)
-      rmsWindow[i] = 0;
-
-   float *buf = new float[kBufSize];
-
-   bool inDuckRegion = false;
-
-   // initialize the following two variables to prevent compiler warning
-   double duckRegionStart = 0;
-   sampleCount curSamplesPause = 0;
-
-   // to make the progress bar appear more natural, we first look for all
-   // duck regions and apply them all at once afterwards
-   AutoDuckRegionArray regions;
-   sampleCount pos = start;
-
-   while (pos < end)
+   while (iterTrack)
    {
-      sampleCount len = end - pos;
-      if (len > kBufSize)
-         len = kBufSize;
-
-      mControlTrack->Get((samplePtr)buf, floatSample, pos, (sampleCount)len);
+      wxASSERT(iterTrack->GetKind() == Track::Wave);
 
-      for (i = pos; i < pos + len; i++)
-      {
-         rmsSum -= rmsWindow[rmsPos];
-         rmsWindow[rmsPos] = buf[i - pos] * buf[i - pos];
-         rmsSum += rmsWindow[rmsPos];
-         rmsPos = (rmsPos + 1) % kRMSWindowSize;
+      Job job;
+      job.track = (WaveTrack*)iterTrack;
+      job.fraction = 0.0;
+      job.done = false;
+      jobs.push_back(std::move(job));
 
-         bool thresholdExceeded = rmsSum > threshold;
-
-         if (thresholdExceeded)
-         {
-            // everytime the threshold is exceeded, reset our count for
-            // the number of pause samples
-            curSamplesPause = 0;
-
-            if (!inDuckRegion)
-            {
-               // the threshold has been exceeded for the first time, so
-               // let the duck region begin here
-               inDuckRegion = true;
-               duckRegionStart = mControlTrack->LongSamplesToTime(i);
-            }
-         }
-
-         if (!thresholdExceeded && inDuckRegion)
-         {
-            // the threshold has not been exceeded and we are in a duck
-            // region, but only fade in if the maximum pause has been
-            // exceeded
-            curSamplesPause += 1;
-
-            if (curSamplesPause >= minSamplesPause)
-            {
-               // do the actual duck fade and reset all values
-               double duckRegionEnd =
-                  mControlTrack->LongSamplesToTime(i - curSamplesPause);
-
-               regions.Add(AutoDuckRegion(
-                              duckRegionStart - mOuterFadeDownLen,
-                              duckRegionEnd + mOuterFadeUpLen));
-
-               inDuckRegion = false;
-            }
-         }
-      }
-
-      pos += len;
-
-      if (TotalProgress( ((double)(pos-start)) / (end-start) /
-                         (GetNumWaveTracks() + 1) ))
-      {
-         cancel = true;
-         break;
-      }
-   }
-
-   // apply last duck fade, if any
-   if (inDuckRegion)
-   {
-      double duckRegionEnd =
-         mControlTrack->LongSamplesToTime(end - curSamplesPause);
-      regions.Add(AutoDuckRegion(
-                     duckRegionStart - mOuterFadeDownLen,
-                     duckRegionEnd + mOuterFadeUpLen));
+      iterTrack = iter.Next();
    }
 
-   delete[] buf;
-   delete[] rmsWindow;
-
-   if (!cancel)
-   {
-      CopyInputTracks(); // Set up mOutputTracks.
-      SelectedTrackListOfKindIterator iter(Track::Wave, mOutputTracks.get());
-      Track *iterTrack = iter.First();
-
-      int trackNumber = 0;
-
-      while (iterTrack)
-      {
-         wxASSERT(iterTrack->GetKind() == Track::Wave);
-
-         WaveTrack* t = (WaveTrack*)iterTrack;
-
-         for (i = 0; i < (int)regions.GetCount(); i++)
-         {
-            const AutoDuckRegion& region = regions[i];
-            if (ApplyDuckFade(trackNumber, t, region.t0, region.t1))
-            {
-               cancel = true;
-               break;
-            }
-         }
-
-         if (cancel)
-            break;
-
-         iterTrack = iter.Next();
-         trackNumber++;
-      }
-   }
+   bool bGoodResult = ProcessJobs(jobs, start, end);
 
-   ReplaceProcessedTracks(!cancel);
-   return !cancel;
+   ReplaceProcessedTracks(bGoodResult);
+   return bGoodResult;
 }
 
 void EffectAutoDuck::PopulateOrExchange(ShuttleGui & S)
@@ -510,70 +400,191 @@ bool EffectAutoDuck::TransferDataFromWindow()
 // EffectAutoDuck implementation
 
 // this currently does an exponential fade
-bool EffectAutoDuck::ApplyDuckFade(int trackNumber, WaveTrack* t,
-                                   double t0, double t1)
+// The duck regions are found in one pass over the control track, and the
+// target tracks are faded in the same pass, each by a worker thread that
+// follows the analysis.  A worker fades only the samples whose gain can no
+// longer change: those before the earliest start of a region still to be
+// found, or, within a region whose end is not yet found, those far enough
+// from its earliest possible end to be fully ducked whatever it is.
+bool EffectAutoDuck::ProcessJobs(std::vector<Job> &jobs,
+                                 sampleCount start, sampleCount end)
 {
-   bool cancel = false;
+   wxMutex mutex;
+   wxCondition analyzed(mutex);  // the analysis went on, or was cancelled
+   wxCondition finished(mutex);  // a worker finished
+   bool cancelled = false;
+
+   // Used on this thread only
+   AutoDuckAnalyzer analyzer(mControlTrack->GetRate(), start, mThresholdDb,
+      mMaximumPause, mOuterFadeDownLen, mOuterFadeUpLen);
+
+   // The results of the analysis so far, guarded by mutex
+   std::vector<AutoDuckRegion> regions;
+   AutoDuckState state = analyzer.GetState();
+   unsigned analysisStep = 0;    // counts the blocks analyzed
+   double analysisFraction = 0.0;
+
+   // Updates the progress, on this thread.  Returns true while the workers
+   // have more to do.
+   auto report = [&]() -> bool {
+      bool more = false;
+      double fraction;
+      {
+         wxMutexLocker locker(mutex);
+         fraction = analysisFraction;
+         for (const auto &job : jobs) {
+            fraction += job.fraction;
+            more = more || !job.done;
+         }
+      }
 
-   sampleCount start = t->TimeToLongSamples(t0);
-   sampleCount end = t->TimeToLongSamples(t1);
+      if (!cancelled && TotalProgress(fraction / (GetNumWaveTracks() + 1))) {
+         wxMutexLocker locker(mutex);
+         cancelled = true;
+         analyzed.Broadcast();
+      }
+      return more;
+   };
 
-   float *buf = new float[kBufSize];
-   sampleCount pos = start;
+   // With no worker threads, the jobs are processed on this thread once
+   // the analysis is done, and it must then report the progress itself
+   auto process = [&](Job &job, bool onMainThread) {
+      WaveTrack *t = job.track;
+
+      AutoDuckFader fader(t->GetRate(), mDuckAmountDb,
+         mOuterFadeDownLen + mInnerFadeDownLen,
+         mOuterFadeUpLen + mInnerFadeUpLen);
 
-   int fadeDownSamples = t->TimeToLongSamples(
-      mOuterFadeDownLen + mInnerFadeDownLen);
-   if (fadeDownSamples < 1)
-      fadeDownSamples = 1;
+      std::vector<float> buf(kBufSize);
 
-   int fadeUpSamples = t->TimeToLongSamples(
-      mOuterFadeUpLen + mInnerFadeUpLen);
-   if (fadeUpSamples < 1)
-      fadeUpSamples = 1;
+      // Writes the faded samples back.  Returns false if cancelled.
+      auto write = [&](sampleCount pos, sampleCount len) -> bool {
+         t->Set((samplePtr)&buf[0], floatSample, pos, len);
 
-   float fadeDownStep = mDuckAmountDb / fadeDownSamples;
-   float fadeUpStep = mDuckAmountDb / fadeUpSamples;
+         bool ok;
+         {
+            wxMutexLocker locker(mutex);
+            job.fraction = (t->LongSamplesToTime(pos + len) - mT0) / (mT1 - mT0);
+            ok = !cancelled;
+         }
+
+         if (onMainThread) {
+            report();
+            ok = !cancelled;
+         }
+
+         return ok;
+      };
+
+      unsigned seenStep = 0;
+      bool ok = true;
+      bool finished = false;
+
+      while (ok && !finished) {
+         {
+            wxMutexLocker locker(mutex);
+            while (!cancelled && !state.done && analysisStep == seenStep)
+               analyzed.Wait();
+            seenStep = analysisStep;
+
+            ok = !cancelled;
+            finished = state.done;
+            fader.Update(regions, state);
+         }
+
+         sampleCount pos, len;
+         while (ok && fader.Next(kBufSize, pos, len)) {
+            t->Get((samplePtr)&buf[0], floatSample, pos, len);
+            fader.Apply(&buf[0]);
+            ok = write(pos, len);
+         }
+      }
 
-   while (pos < end)
+      wxMutexLocker locker(mutex);
+      job.fraction = 1.0;
+      job.done = true;
+      finished.Signal();
+   };
+
+   const size_t numThreads =
+      std::min<size_t>(std::max(1, wxThread::GetCPUCount()), jobs.size());
+   std::vector<std::unique_ptr<AutoDuckThread>> threads;
+
+   std::atomic<size_t> next { 0 };
+   auto work = [&](bool onMainThread) {
+      size_t j;
+      while ((j = next++) < jobs.size())
+         process(jobs[j], onMainThread);
+   };
+
+   for (size_t t = 0; t < numThreads; t++)
+   {
+      auto thread = std::make_unique<AutoDuckThread>([&]{ work(false); });
+      if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR)
+         break;
+      threads.push_back(std::move(thread));
+   }
+
+   std::vector<float> buf(kBufSize);
+   std::vector<AutoDuckRegion> found;
+   sampleCount pos = start;
+
+   while (pos < end && !cancelled)
    {
       sampleCount len = end - pos;
       if (len > kBufSize)
          len = kBufSize;
 
-      t->Get((samplePtr)buf, floatSample, pos, len);
+      mControlTrack->Get((samplePtr)&buf[0], floatSample, pos, (sampleCount)len);
+      analyzer.Analyze(&buf[0], len, found);
+      pos += len;
 
-      for (sampleCount i = pos; i < pos + len; i++)
+      // Tell the workers how far they may go
       {
-         float gainDown = fadeDownStep * (i - start);
-         float gainUp = fadeUpStep * (end - i);;
-
-         float gain;
-         if (gainDown > gainUp)
-            gain = gainDown;
-         else
-            gain = gainUp;
-         if (gain < mDuckAmountDb)
-            gain = mDuckAmountDb;
-
-         buf[i - pos] *= DB_TO_LINEAR(gain);
+         wxMutexLocker locker(mutex);
+         regions.insert(regions.end(), found.begin(), found.end());
+         state = analyzer.GetState();
+         analysisFraction = ((double)(pos-start)) / (end-start);
+         analysisStep++;
+         analyzed.Broadcast();
       }
+      found.clear();
 
-      t->Set((samplePtr)buf, floatSample, pos, len);
+      report();
+   }
 
-      pos += len;
+   // apply last duck fade, if any
+   {
+      wxMutexLocker locker(mutex);
+      analyzer.Finish(regions);
+      state = analyzer.GetState();
+      analyzed.Broadcast();
+   }
 
-      float curTime = t->LongSamplesToTime(pos);
-      float fractionFinished = (curTime - mT0) / (mT1 - mT0);
-      if (TotalProgress( (trackNumber + 1 + fractionFinished) /
-                         (GetNumWaveTracks() + 1) ))
-      {
-         cancel = true;
-         break;
+   if (threads.empty()) {
+      if (!cancelled)
+         work(true);
+   }
+   else {
+      bool more = true;
+      while (more) {
+         {
+            wxMutexLocker locker(mutex);
+            bool doneAll = true;
+            for (const auto &job : jobs)
+               doneAll = doneAll && job.done;
+            // Wake now and then anyway, so that the progress is redrawn
+            if (!doneAll)
+               finished.WaitTimeout(100);
+         }
+         more = report();
       }
+
+      for (const auto &thread : threads)
+         thread->Wait();
    }
 
-   delete[] buf;
-   return cancel;
+   return !cancelled;
 }
 
 void EffectAutoDuck::OnValueChanged(wxCommandEvent & WXUNUSED(evt))
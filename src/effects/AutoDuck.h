@@ -11,6 +11,8 @@
 #ifndef __AUDACITY_EFFECT_AUTODUCK__
 #define __AUDACITY_EFFECT_AUTODUCK__
 
+#include <vector>
+
 #include <wx/bitmap.h>
 #include <wx/event.h>
 #include <wx/gdicmn.h>
@@ -61,7 +63,10 @@ public:
 private:
    // EffectAutoDuck implementation
 
-   bool ApplyDuckFade(int trackNumber, WaveTrack *t, double t0, double t1);
+   struct Job;
+
+   // Analyzes the control track, while the jobs fade their tracks
+   bool ProcessJobs(std::vector<Job> &jobs, sampleCount start, sampleCount end);
 
    void OnValueChanged(wxCommandEvent & evt);
 
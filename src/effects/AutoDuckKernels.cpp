@@ -0,0 +1,250 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AutoDuckKernels.cpp
+
+  Markus Meyer
+
+*******************************************************************//**
+
+\file AutoDuckKernels.cpp
+\brief The analysis and fading of EffectAutoDuck, apart from the tracks.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "AutoDuckKernels.h"
+
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include <limits>
+
+static const int kRMSWindowSize = 100;  // samples in circular RMS window buffer
+
+AutoDuckAnalyzer::AutoDuckAnalyzer(double rate, sampleCount start,
+                                   double thresholdDb, double maximumPause,
+                                   double outerFadeDownLen,
+                                   double outerFadeUpLen)
+   : mRate(rate)
+   , mOuterFadeDownLen(outerFadeDownLen)
+   , mOuterFadeUpLen(outerFadeUpLen)
+   , mPos(start)
+   , mDone(false)
+   , mRMSPos(0)
+   , mRMSSum(0)
+   , mRMSWindow(kRMSWindowSize, 0.0f)
+   , mInRegion(false)
+   // initialize the following two variables to prevent compiler warning
+   , mRegionStart(0)
+   , mCurSamplesPause(0)
+{
+   // the minimum number of samples we have to wait until the maximum
+   // pause has been exceeded
+   double maxPause = maximumPause;
+
+   // We don't fade in until we have time enough to actually fade out again
+   if (maxPause < outerFadeDownLen + outerFadeUpLen)
+      maxPause = outerFadeDownLen + outerFadeUpLen;
+
+   mMinSamplesPause = (sampleCount)floor(maxPause * mRate + 0.5);
+
+   mThreshold = DB_TO_LINEAR(thresholdDb);
+
+   // adjust the threshold so we can compare it to the rmsSum value
+   mThreshold = mThreshold * mThreshold * kRMSWindowSize;
+}
+
+double AutoDuckAnalyzer::LongSamplesToTime(sampleCount pos) const
+{
+   return ((double)pos) / mRate;
+}
+
+void AutoDuckAnalyzer::Analyze(const float *buffer, sampleCount len,
+                               std::vector<AutoDuckRegion> &found)
+{
+   for (sampleCount i = mPos; i < mPos + len; i++)
+   {
+      mRMSSum -= mRMSWindow[mRMSPos];
+      mRMSWindow[mRMSPos] = buffer[i - mPos] * buffer[i - mPos];
+      mRMSSum += mRMSWindow[mRMSPos];
+      mRMSPos = (mRMSPos + 1) % kRMSWindowSize;
+
+      bool thresholdExceeded = mRMSSum > mThreshold;
+
+      if (thresholdExceeded)
+      {
+         // everytime the threshold is exceeded, reset our count for
+         // the number of pause samples
+         mCurSamplesPause = 0;
+
+         if (!mInRegion)
+         {
+            // the threshold has been exceeded for the first time, so
+            // let the duck region begin here
+            mInRegion = true;
+            mRegionStart = LongSamplesToTime(i);
+         }
+      }
+
+      if (!thresholdExceeded && mInRegion)
+      {
+         // the threshold has not been exceeded and we are in a duck
+         // region, but only fade in if the maximum pause has been
+         // exceeded
+         mCurSamplesPause += 1;
+
+         if (mCurSamplesPause >= mMinSamplesPause)
+         {
+            // do the actual duck fade and reset all values
+            double duckRegionEnd = LongSamplesToTime(i - mCurSamplesPause);
+
+            found.push_back(AutoDuckRegion(
+                           mRegionStart - mOuterFadeDownLen,
+                           duckRegionEnd + mOuterFadeUpLen));
+
+            mInRegion = false;
+         }
+      }
+   }
+
+   mPos += len;
+}
+
+void AutoDuckAnalyzer::Finish(std::vector<AutoDuckRegion> &found)
+{
+   // apply last duck fade, if any
+   if (mInRegion)
+   {
+      double duckRegionEnd = LongSamplesToTime(mPos - mCurSamplesPause);
+      found.push_back(AutoDuckRegion(
+                     mRegionStart - mOuterFadeDownLen,
+                     duckRegionEnd + mOuterFadeUpLen));
+   }
+
+   mInRegion = false;
+   mDone = true;
+}
+
+AutoDuckState AutoDuckAnalyzer::GetState() const
+{
+   // A region yet to be found starts at mPos at the earliest, and the
+   // open one ends no earlier than its last loud sample
+   AutoDuckState state;
+   state.done = mDone;
+   state.inRegion = mInRegion;
+   state.openStart = mRegionStart - mOuterFadeDownLen;
+   state.openMinEnd =
+      LongSamplesToTime(mPos - 1 - mCurSamplesPause) + mOuterFadeUpLen;
+   state.clearTime = LongSamplesToTime(mPos) - mOuterFadeDownLen;
+   return state;
+}
+
+AutoDuckFader::AutoDuckFader(double rate, double duckAmountDb,
+                             double fadeDownLen, double fadeUpLen)
+   : mRate(rate)
+   , mDuckAmountDb(duckAmountDb)
+   , mNextRegion(0)
+   , mOpen(false)
+   , mOpenStart(0)
+   , mSettled(std::numeric_limits<sampleCount>::min())
+   , mPos(std::numeric_limits<sampleCount>::min())
+   , mRunStart(0)
+   , mRunLen(0)
+   , mRegionStart(0)
+   , mRegionEnd(0)
+   , mRegionOpen(false)
+{
+   mFadeDownSamples = TimeToLongSamples(fadeDownLen);
+   if (mFadeDownSamples < 1)
+      mFadeDownSamples = 1;
+
+   mFadeUpSamples = TimeToLongSamples(fadeUpLen);
+   if (mFadeUpSamples < 1)
+      mFadeUpSamples = 1;
+
+   mFadeDownStep = mDuckAmountDb / mFadeDownSamples;
+   mFadeUpStep = mDuckAmountDb / mFadeUpSamples;
+}
+
+sampleCount AutoDuckFader::TimeToLongSamples(double t0) const
+{
+   return (sampleCount)floor(t0 * mRate + 0.5);
+}
+
+void AutoDuckFader::Update(const std::vector<AutoDuckRegion> &regions,
+                           const AutoDuckState &state)
+{
+   mRegions.insert(mRegions.end(), regions.begin() + mRegions.size(), regions.end());
+
+   if (state.done)
+      mSettled = std::numeric_limits<sampleCount>::max();
+   else if (state.inRegion)
+      mSettled = TimeToLongSamples(state.openMinEnd) - mFadeUpSamples - 1;
+   else
+      mSettled = TimeToLongSamples(state.clearTime);
+
+   mOpen = state.inRegion;
+   mOpenStart = state.openStart;
+}
+
+bool AutoDuckFader::Next(sampleCount maxLen, sampleCount &start, sampleCount &len)
+{
+   // Fade the settled samples of the known regions, and of the open one,
+   // whose end does not matter to them
+   while (mNextRegion <= mRegions.size()) {
+      const bool isOpen = (mNextRegion == mRegions.size());
+      if (isOpen && !mOpen)
+         return false;
+
+      const double t0 = isOpen ? mOpenStart : mRegions[mNextRegion].t0;
+      const sampleCount regionStart = TimeToLongSamples(t0);
+      const sampleCount regionEnd = isOpen
+         ? std::numeric_limits<sampleCount>::max()
+         : TimeToLongSamples(mRegions[mNextRegion].t1);
+
+      mPos = std::max(mPos, regionStart);
+      const sampleCount to = std::min(regionEnd, mSettled);
+
+      if (mPos < to) {
+         len = std::min(to - mPos, maxLen);
+         start = mPos;
+         mPos += len;
+
+         mRunStart = start;
+         mRunLen = len;
+         mRegionStart = regionStart;
+         mRegionEnd = regionEnd;
+         mRegionOpen = isOpen;
+         return true;
+      }
+
+      if (isOpen || regionEnd > mSettled)
+         return false;
+      mNextRegion++;
+   }
+
+   return false;
+}
+
+void AutoDuckFader::Apply(float *buffer) const
+{
+   for (sampleCount i = mRunStart; i < mRunStart + mRunLen; i++)
+   {
+      float gainDown = mFadeDownStep * (i - mRegionStart);
+      float gainUp = mRegionOpen
+         ? -FLT_MAX
+         : mFadeUpStep * (mRegionEnd - i);
+
+      float gain;
+      if (gainDown > gainUp)
+         gain = gainDown;
+      else
+         gain = gainUp;
+      if (gain < mDuckAmountDb)
+         gain = mDuckAmountDb;
+
+      buffer[i - mRunStart] *= DB_TO_LINEAR(gain);
+   }
+}
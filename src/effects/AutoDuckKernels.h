@@ -0,0 +1,139 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AutoDuckKernels.h
+
+  Markus Meyer
+
+*******************************************************************//**
+
+\file AutoDuckKernels.h
+\brief The analysis and fading of EffectAutoDuck, apart from the tracks.
+
+AutoDuckAnalyzer finds the duck regions of the control track a block at
+a time, and AutoDuckFader fades a target track behind it.  After each
+block the analyzer tells how far the gains are settled: up to the
+earliest start of a region still to be found, or, within a region whose
+end is not yet found, up to where it is fully ducked whatever that end
+is.  So the fader gives the same samples as if all the regions were
+known before it began.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_AUTO_DUCK_KERNELS__
+#define __AUDACITY_AUTO_DUCK_KERNELS__
+
+#include <vector>
+
+#include "audacity/Types.h"
+
+/*
+ * A auto duck region
+ */
+
+struct AutoDuckRegion
+{
+   AutoDuckRegion(double t0, double t1)
+   {
+      this->t0 = t0;
+      this->t1 = t1;
+   }
+
+   double t0;
+   double t1;
+};
+
+// How far the analysis has got, as a fader needs to know it
+struct AutoDuckState
+{
+   bool done;
+   bool inRegion;
+   double openStart;    // of the open region, less the fade
+   double openMinEnd;   // the open region ends no earlier
+   double clearTime;    // no region yet to be found starts before
+};
+
+class AutoDuckAnalyzer
+{
+public:
+   // Times are in seconds, and rate is the control track's
+   AutoDuckAnalyzer(double rate, sampleCount start, double thresholdDb,
+                    double maximumPause, double outerFadeDownLen,
+                    double outerFadeUpLen);
+
+   // Analyzes the next len samples, adding the regions that end in them
+   // to found
+   void Analyze(const float *buffer, sampleCount len,
+                std::vector<AutoDuckRegion> &found);
+
+   // Ends the analysis, adding the region still open, if any, to found
+   void Finish(std::vector<AutoDuckRegion> &found);
+
+   AutoDuckState GetState() const;
+
+private:
+   double LongSamplesToTime(sampleCount pos) const;
+
+   const double mRate;
+   const double mOuterFadeDownLen;
+   const double mOuterFadeUpLen;
+   sampleCount mMinSamplesPause;
+   double mThreshold;
+
+   sampleCount mPos;
+   bool mDone;
+
+   int mRMSPos;
+   float mRMSSum;
+   std::vector<float> mRMSWindow;
+
+   bool mInRegion;
+   double mRegionStart;
+   sampleCount mCurSamplesPause;
+};
+
+class AutoDuckFader
+{
+public:
+   // Times are in seconds, and rate is the target track's.  The fades
+   // are the whole of them, inner and outer.
+   AutoDuckFader(double rate, double duckAmountDb,
+                 double fadeDownLen, double fadeUpLen);
+
+   // Takes the regions found so far, of which those already taken are
+   // the first, and the state of the analysis after them
+   void Update(const std::vector<AutoDuckRegion> &regions,
+               const AutoDuckState &state);
+
+   // Gives the next run of at most maxLen samples whose gains are
+   // settled, or returns false if there is none until the next Update()
+   bool Next(sampleCount maxLen, sampleCount &start, sampleCount &len);
+
+   // Fades the run of samples last given by Next()
+   void Apply(float *buffer) const;
+
+private:
+   sampleCount TimeToLongSamples(double t0) const;
+
+   const double mRate;
+   const double mDuckAmountDb;
+   sampleCount mFadeDownSamples;
+   sampleCount mFadeUpSamples;
+   float mFadeDownStep;
+   float mFadeUpStep;
+
+   std::vector<AutoDuckRegion> mRegions;
+   size_t mNextRegion;
+   bool mOpen;
+   double mOpenStart;
+   sampleCount mSettled;
+   sampleCount mPos;
+
+   // The run last given by Next(), and its region
+   sampleCount mRunStart, mRunLen;
+   sampleCount mRegionStart, mRegionEnd;
+   bool mRegionOpen;
+};
+
+#endif
@@ -315,15 +315,8 @@ void EffectBassTreble::InstanceInit(EffectBassTrebleState & data, float sampleRa
    data.b1Treble = 0;
    data.b2Treble = 0;
 
-   data.xn1Bass = 0;
-   data.xn2Bass = 0;
-   data.yn1Bass = 0;
-   data.yn2Bass = 0;
-
-   data.xn1Treble = 0;
-   data.xn2Treble = 0;
-   data.yn1Treble = 0;
-   data.yn2Treble = 0;
+   data.filter.SetStageCount(2);
+   data.filter.Reset();
 
    data.bass = -1;
    data.treble = -1;
@@ -351,18 +344,37 @@ sampleCount EffectBassTreble::InstanceProcess(EffectBassTrebleState & data,
 
    // Compute coefficents of the low shelf biquand IIR filter
    if (data.bass != oldBass)
+   {
       Coefficents(data.hzBass, data.slope, mBass, data.samplerate, kBass,
                   data.a0Bass, data.a1Bass, data.a2Bass,
                   data.b0Bass, data.b1Bass, data.b2Bass);
+      data.filter.SetStage(0,
+                           data.b0Bass / data.a0Bass,
+                           data.b1Bass / data.a0Bass,
+                           data.b2Bass / data.a0Bass,
+                           data.a1Bass / data.a0Bass,
+                           data.a2Bass / data.a0Bass);
+      data.bass = oldBass;
+   }
 
    // Compute coefficents of the high shelf biquand IIR filter
    if (data.treble != oldTreble)
+   {
       Coefficents(data.hzTreble, data.slope, mTreble, data.samplerate, kTreble,
                   data.a0Treble, data.a1Treble, data.a2Treble,
                   data.b0Treble, data.b1Treble, data.b2Treble);
+      data.filter.SetStage(1,
+                           data.b0Treble / data.a0Treble,
+                           data.b1Treble / data.a0Treble,
+                           data.b2Treble / data.a0Treble,
+                           data.a1Treble / data.a0Treble,
+                           data.a2Treble / data.a0Treble);
+      data.treble = oldTreble;
+   }
 
+   data.filter.Process(ibuf, obuf, blockLen);
    for (sampleCount i = 0; i < blockLen; i++) {
-      obuf[i] = DoFilter(data, ibuf[i]) * data.gain;
+      obuf[i] *= data.gain;
    }
 
    return blockLen;
@@ -401,29 +413,6 @@ void EffectBassTreble::Coefficents(double hz, double slope, double gain, double
    }
 }
 
-float EffectBassTreble::DoFilter(EffectBassTrebleState & data, float in)
-{
-   // Bass filter
-   float out = (data.b0Bass * in + data.b1Bass * data.xn1Bass + data.b2Bass * data.xn2Bass -
-         data.a1Bass * data.yn1Bass - data.a2Bass * data.yn2Bass) / data.a0Bass;
-   data.xn2Bass = data.xn1Bass;
-   data.xn1Bass = in;
-   data.yn2Bass = data.yn1Bass;
-   data.yn1Bass = out;
-
-   // Treble filter
-   in = out;
-   out = (data.b0Treble * in + data.b1Treble * data.xn1Treble + data.b2Treble * data.xn2Treble -
-         data.a1Treble * data.yn1Treble - data.a2Treble * data.yn2Treble) / data.a0Treble;
-   data.xn2Treble = data.xn1Treble;
-   data.xn1Treble = in;
-   data.yn2Treble = data.yn1Treble;
-   data.yn1Treble = out;
-
-   return out;
-}
-
-
 void EffectBassTreble::OnBassText(wxCommandEvent & WXUNUSED(evt))
 {
    double oldBass = mBass;
@@ -19,6 +19,7 @@
 #include <wx/textctrl.h>
 #include <wx/checkbox.h>
 
+#include "Biquad.h"
 #include "Effect.h"
 
 class ShuttleGui;
@@ -35,8 +36,7 @@ public:
    double slope, hzBass, hzTreble;
    double a0Bass, a1Bass, a2Bass, b0Bass, b1Bass, b2Bass;
    double a0Treble, a1Treble, a2Treble, b0Treble, b1Treble, b2Treble;
-   double xn1Bass, xn2Bass, yn1Bass, yn2Bass;
-   double xn1Treble, xn2Treble, yn1Treble, yn2Treble;
+   BiquadCascade filter;   // bass shelf, then treble shelf
 };
 
 WX_DECLARE_OBJARRAY(EffectBassTrebleState, EffectBassTrebleStateArray);
@@ -90,7 +90,6 @@ private:
 
    void Coefficents(double hz, double slope, double gain, double samplerate, int type,
                     double& a0, double& a1, double& a2, double& b0, double& b1, double& b2);
-   float DoFilter(EffectBassTrebleState & data, float in);
 
    void OnBassText(wxCommandEvent & evt);
    void OnTrebleText(wxCommandEvent & evt);
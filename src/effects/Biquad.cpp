@@ -1,33 +1,11 @@
 #include "Biquad.h"
 
-#define square(a) ((a)*(a))
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define BIQUAD_SSE
+#include <xmmintrin.h>
+#endif
 
-void Biquad_Process (BiquadStruct* pBQ, int iNumSamples)
-{
-   float* pfIn = pBQ->pfIn;
-   float* pfOut = pBQ->pfOut;
-   float fPrevIn = pBQ->fPrevIn;
-   float fPrevPrevIn = pBQ->fPrevPrevIn;
-   float fPrevOut = pBQ->fPrevOut;
-   float fPrevPrevOut = pBQ->fPrevPrevOut;
-   for (int i = 0; i < iNumSamples; i++)
-   {
-      float fIn = *pfIn++;
-      *pfOut = fIn * pBQ->fNumerCoeffs [0] +
-         fPrevIn * pBQ->fNumerCoeffs [1] +
-         fPrevPrevIn * pBQ->fNumerCoeffs [2] -
-         fPrevOut * pBQ->fDenomCoeffs [0] -
-         fPrevPrevOut * pBQ->fDenomCoeffs [1];
-      fPrevPrevIn = fPrevIn;
-      fPrevIn = fIn;
-      fPrevPrevOut = fPrevOut;
-      fPrevOut = *pfOut++;
-   }
-   pBQ->fPrevIn = fPrevIn;
-   pBQ->fPrevPrevIn = fPrevPrevIn;
-   pBQ->fPrevOut = fPrevOut;
-   pBQ->fPrevPrevOut = fPrevPrevOut;
-}
+#define square(a) ((a)*(a))
 
 void ComplexDiv (float fNumerR, float fNumerI, float fDenomR, float fDenomI, float* pfQuotientR, float* pfQuotientI)
 {
@@ -49,3 +27,167 @@ float Calc2D_DistSqr (float fX1, float fY1, float fX2, float fY2)
    return square (fX1 - fX2) + square (fY1 - fY2);
 }
 
+
+BiquadCascade::BiquadCascade()
+{
+   mCount = 0;
+}
+
+void BiquadCascade::SetStageCount(int count)
+{
+   if (count > BIQUAD_MAX_STAGES)
+      count = BIQUAD_MAX_STAGES;
+
+   for (int i = mCount; i < count; i++)
+   {
+      SetStage(i, 1, 0, 0, 0, 0);
+      mZ1[i] = mZ2[i] = 0;
+   }
+   mCount = count;
+}
+
+void BiquadCascade::SetStage(int stage, float b0, float b1, float b2, float a1, float a2)
+{
+   mB0[stage] = b0;
+   mB1[stage] = b1;
+   mB2[stage] = b2;
+   mA1[stage] = a1;
+   mA2[stage] = a2;
+}
+
+void BiquadCascade::SetStage(int stage, const BiquadStruct & bq)
+{
+   SetStage(stage,
+            bq.fNumerCoeffs[0], bq.fNumerCoeffs[1], bq.fNumerCoeffs[2],
+            bq.fDenomCoeffs[0], bq.fDenomCoeffs[1]);
+}
+
+void BiquadCascade::Reset()
+{
+   for (int i = 0; i < mCount; i++)
+   {
+      mZ1[i] = mZ2[i] = 0;
+   }
+}
+
+void BiquadCascade::Process(const float *in, float *out, int len)
+{
+   if (mCount == 0)
+   {
+      for (int i = 0; i < len; i++)
+         out[i] = in[i];
+      return;
+   }
+
+   int stage = 0;
+#if defined(BIQUAD_SSE)
+   // One or two stages are as quick without
+   for (; mCount - stage >= 3; stage += 4)
+   {
+      ProcessFour(stage, in, out, len);
+      in = out;
+   }
+#endif
+   if (stage < mCount)
+   {
+      ProcessStages(stage, in, out, len);
+   }
+}
+
+float BiquadCascade::ProcessSample(float in)
+{
+   float out;
+   ProcessStages(0, &in, &out, 1);
+   return out;
+}
+
+void BiquadCascade::ProcessStages(int stage, const float *in, float *out, int len)
+{
+   // A sample through all the stages at a time, which keeps more than
+   // one of them busy at once
+   for (int i = 0; i < len; i++)
+   {
+      float x = in[i];
+      for (int k = stage; k < mCount; k++)
+      {
+         float y = mB0[k] * x + mZ1[k];
+         mZ1[k] = mB1[k] * x - mA1[k] * y + mZ2[k];
+         mZ2[k] = mB2[k] * x - mA2[k] * y;
+         x = y;
+      }
+      out[i] = x;
+   }
+}
+
+#if defined(BIQUAD_SSE)
+void BiquadCascade::ProcessFour(int stage, const float *in, float *out, int len)
+{
+   // Lanes past the last stage pass the signal straight through
+   float b0[4], b1[4], b2[4], a1[4], a2[4], z1[4], z2[4];
+   for (int k = 0; k < 4; k++)
+   {
+      bool used = stage + k < mCount;
+      b0[k] = used ? mB0[stage + k] : 1;
+      b1[k] = used ? mB1[stage + k] : 0;
+      b2[k] = used ? mB2[stage + k] : 0;
+      a1[k] = used ? mA1[stage + k] : 0;
+      a2[k] = used ? mA2[stage + k] : 0;
+      z1[k] = used ? mZ1[stage + k] : 0;
+      z2[k] = used ? mZ2[stage + k] : 0;
+   }
+
+   const __m128 B0 = _mm_loadu_ps(b0);
+   const __m128 B1 = _mm_loadu_ps(b1);
+   const __m128 B2 = _mm_loadu_ps(b2);
+   const __m128 A1 = _mm_loadu_ps(a1);
+   const __m128 A2 = _mm_loadu_ps(a2);
+   __m128 Z1 = _mm_loadu_ps(z1);
+   __m128 Z2 = _mm_loadu_ps(z2);
+   __m128 Y = _mm_setzero_ps();
+
+   const __m128 lane = _mm_set_ps(3, 2, 1, 0);
+   const __m128 end = _mm_set1_ps((float) len);
+
+   // At step t, lane k filters sample t - k, taking the output of lane
+   // k - 1 from the step before.  The last lane is then three samples
+   // behind, so there are three more steps than samples.
+   for (int t = 0; t < len + 3; t++)
+   {
+      __m128 X = _mm_shuffle_ps(Y, Y, _MM_SHUFFLE(2, 1, 0, 0));
+      X = _mm_move_ss(X, _mm_set_ss(t < len ? in[t] : 0.0f));
+
+      Y = _mm_add_ps(_mm_mul_ps(B0, X), Z1);
+      __m128 newZ1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(B1, X), _mm_mul_ps(A1, Y)), Z2);
+      __m128 newZ2 = _mm_sub_ps(_mm_mul_ps(B2, X), _mm_mul_ps(A2, Y));
+
+      if (t >= 3 && t < len)
+      {
+         Z1 = newZ1;
+         Z2 = newZ2;
+      }
+      else
+      {
+         // Filling or emptying: only lanes with a sample of their own step
+         __m128 T = _mm_set1_ps((float) t);
+         __m128 on = _mm_and_ps(_mm_cmple_ps(lane, T),
+                                _mm_cmpgt_ps(lane, _mm_sub_ps(T, end)));
+         Z1 = _mm_or_ps(_mm_and_ps(on, newZ1), _mm_andnot_ps(on, Z1));
+         Z2 = _mm_or_ps(_mm_and_ps(on, newZ2), _mm_andnot_ps(on, Z2));
+      }
+
+      // Written only once read, so that out may be the same as in
+      if (t >= 3)
+      {
+         out[t - 3] = _mm_cvtss_f32(_mm_shuffle_ps(Y, Y, _MM_SHUFFLE(3, 3, 3, 3)));
+      }
+   }
+
+   _mm_storeu_ps(z1, Z1);
+   _mm_storeu_ps(z2, Z2);
+   for (int k = 0; k < 4 && stage + k < mCount; k++)
+   {
+      mZ1[stage + k] = z1[k];
+      mZ2[stage + k] = z2[k];
+   }
+}
+#endif
@@ -1,18 +1,62 @@
 #ifndef __BIQUAD_H__
 #define __BIQUAD_H__
 typedef struct {
-   float* pfIn;
-   float* pfOut;
    float fNumerCoeffs [3];	// B0 B1 B2
    float fDenomCoeffs [2];	// A1 A2
-   float fPrevIn;
-   float fPrevPrevIn;
-   float fPrevOut;
-   float fPrevPrevOut;
 } BiquadStruct;
-void Biquad_Process (BiquadStruct* pBQ, int iNumSamples);
 void ComplexDiv (float fNumerR, float fNumerI, float fDenomR, float fDenomI, float* pfQuotientR, float* pfQuotientI);
 bool BilinTransform (float fSX, float fSY, float* pfZX, float* pfZY);
 float Calc2D_DistSqr (float fX1, float fY1, float fX2, float fY2);
 
+// Enough for the phaser, whose every stage is one (first order) section
+#define BIQUAD_MAX_STAGES 24
+
+// A chain of biquads in transposed direct form II, run a block at a time.
+// Where SSE is available, four stages at a time are run side by side,
+// each a sample behind the one before it.
+//
+// The state is kept between blocks, and the coefficients may be changed
+// between any two blocks, so modulated filters need only process the
+// samples between their updates as a block.  Nothing is allocated, so
+// the cascade may be used in realtime processing.
+class BiquadCascade
+{
+public:
+   BiquadCascade();
+
+   // Added stages pass the signal straight through, until set
+   void SetStageCount(int count);
+   int GetStageCount() const { return mCount; }
+
+   // Coefficients with A0 = 1
+   void SetStage(int stage, float b0, float b1, float b2, float a1, float a2);
+   void SetStage(int stage, const BiquadStruct & bq);
+
+   // Clears the state of all the stages
+   void Reset();
+
+   // out may be the same as in
+   void Process(const float *in, float *out, int len);
+
+   // For filters with feedback around the whole chain
+   float ProcessSample(float in);
+
+private:
+   // From stage to the last
+   void ProcessStages(int stage, const float *in, float *out, int len);
+   // Four stages from stage, side by side, where SSE is available
+   void ProcessFour(int stage, const float *in, float *out, int len);
+
+   int mCount;
+
+   // One array per coefficient, so that four stages load as one vector
+   float mB0[BIQUAD_MAX_STAGES];
+   float mB1[BIQUAD_MAX_STAGES];
+   float mB2[BIQUAD_MAX_STAGES];
+   float mA1[BIQUAD_MAX_STAGES];
+   float mA2[BIQUAD_MAX_STAGES];
+   float mZ1[BIQUAD_MAX_STAGES];
+   float mZ2[BIQUAD_MAX_STAGES];
+};
+
 #endif
@@ -173,7 +173,6 @@ bool EffectChangePitch::LoadFactoryDefaults()
 
 bool EffectChangePitch::Init()
 {
-   mSoundTouch.reset();
    return true;
 }
 
@@ -193,15 +192,13 @@ bool EffectChangePitch::Process()
    else
 #endif
    {
-      mSoundTouch = std::make_unique<SoundTouch>();
       SetTimeWarper(std::make_unique<IdentityTimeWarper>());
-      mSoundTouch->setPitchSemiTones((float)(m_dSemitonesChange));
 #ifdef USE_MIDI
       // Pitch shifting note tracks is currently only supported by SoundTouchEffect
       // and non-real-time-preview effects require an audio track selection.
       //
       // Note: m_dSemitonesChange is private to ChangePitch because it only
-      // needs to pass it along to mSoundTouch (above). I added mSemitones
+      // needs to pass it along to SoundTouch (in MakeSoundTouch). I added mSemitones
       // to SoundTouchEffect (the super class) to convey this value
       // to process Note tracks. This approach minimizes changes to existing
       // code, but it would be cleaner to change all m_dSemitonesChange to
@@ -389,6 +386,15 @@ bool EffectChangePitch::TransferDataFromWindow()
    return true;
 }
 
+// EffectSoundTouch implementation
+
+std::unique_ptr<SoundTouch> EffectChangePitch::MakeSoundTouch()
+{
+   auto soundTouch = std::make_unique<SoundTouch>();
+   soundTouch->setPitchSemiTones((float)(m_dSemitonesChange));
+   return soundTouch;
+}
+
 // EffectChangePitch implementation
 
 // Deduce m_FromFrequency from the samples at the beginning of
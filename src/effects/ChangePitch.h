@@ -68,6 +68,10 @@ public:
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
 
+   // EffectSoundTouch implementation
+
+   std::unique_ptr<SoundTouch> MakeSoundTouch() override;
+
 private:
    // EffectChangePitch implementation
 
@@ -158,8 +158,6 @@ bool EffectChangeTempo::Init()
    m_FromLength = mT1 - mT0;
    m_ToLength = (m_FromLength * 100.0) / (100.0 + m_PercentChange);
 
-   mSoundTouch.reset();
-
    return true;
 }
 
@@ -180,8 +178,6 @@ bool EffectChangeTempo::Process()
    else
 #endif
    {
-      mSoundTouch = std::make_unique<SoundTouch>();
-      mSoundTouch->setTempoChange(m_PercentChange);
       double mT1Dashed = mT0 + (mT1 - mT0)/(m_PercentChange/100.0 + 1.0);
       SetTimeWarper(std::make_unique<RegionTimeWarper>(mT0, mT1,
                std::make_unique<LinearTimeWarper>(mT0, mT0, mT1, mT1Dashed )));
@@ -324,6 +320,15 @@ bool EffectChangeTempo::TransferDataFromWindow()
    return true;
 }
 
+// EffectSoundTouch implementation
+
+std::unique_ptr<SoundTouch> EffectChangeTempo::MakeSoundTouch()
+{
+   auto soundTouch = std::make_unique<SoundTouch>();
+   soundTouch->setTempoChange(m_PercentChange);
+   return soundTouch;
+}
+
 // handler implementations for EffectChangeTempo
 
 void EffectChangeTempo::OnText_PercentChange(wxCommandEvent & WXUNUSED(evt))
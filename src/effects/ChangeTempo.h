@@ -63,6 +63,10 @@ public:
    bool TransferDataToWindow() override;
    bool TransferDataFromWindow() override;
 
+   // EffectSoundTouch implementation
+
+   std::unique_ptr<SoundTouch> MakeSoundTouch() override;
+
 private:
    // EffectChangeTempo implementation
 
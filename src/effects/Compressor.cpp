@@ -11,8 +11,12 @@
 *******************************************************************//**
 
 \class EffectCompressor
-\brief An Effect derived from EffectTwoPassSimpleMono
+\brief An Effect that compresses as a stream, through a DynamicsProcessor
 
+ - Made a streaming effect that can run in realtime, with a look-ahead
+   as long as the attack time in place of the two-buffer scan.  In
+   realtime the look-ahead is only a few milliseconds, and the attack
+   no longer than that, so it works as a peak limiter there.
  - Martyn Shaw made it inherit from EffectTwoPassSimpleMono 10/2005.
  - Steve Jolly made it inherit from EffectSimpleMono.
  - GUI added and implementation improved by Dominic Mazzoni, 5/11/2003.
@@ -63,6 +67,8 @@ Param( ReleaseTime,  double,  XO("ReleaseTime"),   1.0,     1.0,     30.0,    10
 Param( Normalize,    bool,    XO("Normalize"),     true,    false,   true,    1   );
 Param( UsePeak,      bool,    XO("UsePeak"),       false,   false,   true,    1   );
 
+static const double kRealtimeLookAhead = 0.005;  // seconds; the attack in realtime is no longer
+
 //----------------------------------------------------------------------------
 // EffectCompressor
 //----------------------------------------------------------------------------
@@ -81,31 +87,15 @@ EffectCompressor::EffectCompressor()
    mNormalize = DEF_Normalize;
    mUsePeak = DEF_UsePeak;
 
-   mThreshold = 0.25;
-   mNoiseFloor = 0.01;
-   mCompression = 0.5;
-   mCircle = NULL;
-   mFollow1 = NULL;
-   mFollow2 = NULL;
-   mFollowLen = 0;
+   mLatencyDone = false;
+   mMax = 0.0;
+   mMakeup = 1.0f;
 
    SetLinearEffectFlag(false);
 }
 
 EffectCompressor::~EffectCompressor()
 {
-   if (mCircle) {
-      delete[] mCircle;
-      mCircle = NULL;
-   }
-   if(mFollow1!=NULL) {
-      delete[] mFollow1;
-      mFollow1 = NULL;
-   }
-   if(mFollow2!=NULL) {
-      delete[] mFollow2;
-      mFollow2 = NULL;
-   }
 }
 
 // IdentInterface implementation
@@ -129,6 +119,111 @@ EffectType EffectCompressor::GetType()
 
 // EffectClientInterface implementation
 
+bool EffectCompressor::SupportsRealtime()
+{
+#if defined(EXPERIMENTAL_REALTIME_AUDACITY_EFFECTS)
+   return true;
+#else
+   return false;
+#endif
+}
+
+int EffectCompressor::GetAudioInCount()
+{
+   return 1;
+}
+
+int EffectCompressor::GetAudioOutCount()
+{
+   return 1;
+}
+
+sampleCount EffectCompressor::GetLatency()
+{
+   // Only the first pass compresses; the second only scales
+   if (GetPass() == 1 && !mLatencyDone)
+   {
+      mLatencyDone = true;
+      return mMaster.GetLatency();
+   }
+
+   return 0;
+}
+
+bool EffectCompressor::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelNames WXUNUSED(chanMap))
+{
+   if (GetPass() == 1)
+   {
+      mMaster.Init(GetSettings(), mSampleRate);
+      mLatencyDone = false;
+   }
+
+   return true;
+}
+
+sampleCount EffectCompressor::ProcessBlock(float **inBlock, float **outBlock, sampleCount blockLen)
+{
+   if (GetPass() == 1)
+   {
+      mMaster.Process(inBlock[0], outBlock[0], blockLen, mMakeup);
+
+      // Retain the maximum value for use in the normalization pass
+      mMax = wxMax(mMax, (double) mMaster.GetPeak());
+   }
+   else
+   {
+      for (sampleCount i = 0; i < blockLen; i++)
+         outBlock[0][i] = inBlock[0][i] / mMax;
+   }
+
+   return blockLen;
+}
+
+bool EffectCompressor::RealtimeInitialize()
+{
+   SetBlockSize(512);
+
+   mSlaves.clear();
+
+   return true;
+}
+
+bool EffectCompressor::RealtimeAddProcessor(int WXUNUSED(numChannels), float sampleRate)
+{
+   DynamicsProcessor slave;
+
+   // There is no second pass to normalize in, so the make-up gain is
+   // left off: the output is never louder than the input.  A look-ahead
+   // as long as the attack would delay what is heard by as much, so it
+   // is capped, and the slave works as a peak limiter.
+   slave.Init(GetSettings(), sampleRate, kRealtimeLookAhead);
+
+   mSlaves.push_back(slave);
+
+   return true;
+}
+
+bool EffectCompressor::RealtimeFinalize()
+{
+   mSlaves.clear();
+
+   return true;
+}
+
+sampleCount EffectCompressor::RealtimeProcess(int group,
+                                              float **inbuf,
+                                              float **outbuf,
+                                              sampleCount numSamples)
+{
+   DynamicsProcessor & slave = mSlaves[group];
+
+   // Pick up changes from the dialog
+   slave.SetSettings(GetSettings());
+   slave.Process(inbuf[0], outbuf[0], numSamples);
+
+   return numSamples;
+}
+
 bool EffectCompressor::GetAutomationParameters(EffectAutomationParameters & parms)
 {
    parms.Write(KEY_Threshold, mThresholdDB);
@@ -327,294 +422,79 @@ bool EffectCompressor::TransferDataFromWindow()
    return true;
 }
 
-// EffectTwoPassSimpleMono implementation
-
-bool EffectCompressor::NewTrackPass1()
-{
-   mThreshold = DB_TO_LINEAR(mThresholdDB);
-   mNoiseFloor = DB_TO_LINEAR(mNoiseFloorDB);
-   mNoiseCounter = 100;
-
-   mAttackInverseFactor = exp(log(mThreshold) / (mCurRate * mAttackTime + 0.5));
-   mAttackFactor = 1.0 / mAttackInverseFactor;
-   mDecayFactor = exp(log(mThreshold) / (mCurRate * mDecayTime + 0.5));
-
-   if(mRatio > 1)
-      mCompression = 1.0-1.0/mRatio;
-   else
-      mCompression = 0.0;
-
-   mLastLevel = mThreshold;
-
-   if (mCircle)
-      delete[] mCircle;
-   mCircleSize = 100;
-   mCircle = new double[mCircleSize];
-   for(int j=0; j<mCircleSize; j++) {
-      mCircle[j] = 0.0;
-   }
-   mCirclePos = 0;
-   mRMSSum = 0.0;
-
-   return true;
-}
+// Effect implementation
 
 bool EffectCompressor::InitPass1()
 {
-   mMax=0.0;
-   if (!mNormalize)
-      DisableSecondPass();
+   mMax = 0.0;
+   mMakeup = 1.0f;
 
-   // Find the maximum block length required for any track
-   sampleCount maxlen=0;
-   SelectedTrackListOfKindIterator iter(Track::Wave, mTracks);
-   WaveTrack *track = (WaveTrack *) iter.First();
-   while (track) {
-      sampleCount len=track->GetMaxBlockSize();
-      if(len > maxlen)
-         maxlen = len;
-      //Iterate to the next track
-      track = (WaveTrack *) iter.Next();
-   }
-   if(mFollow1!=NULL) {
-      delete[] mFollow1;
-      mFollow1 = NULL;
-   }
-   if(mFollow2!=NULL) {
-      delete[] mFollow2;
-      mFollow2 = NULL;
-   }
-   // Allocate buffers for the envelope
-   if(maxlen > 0) {
-      mFollow1 = new float[maxlen];
-      mFollow2 = new float[maxlen];
+   // Where the output peak can be known before compressing, make up the
+   // gain as we go, and usually save the second pass
+   if (mNormalize && mUsePeak)
+   {
+      double peak = PredictPeak();
+      if (peak > 0.0)
+         mMakeup = (float) (1.0 / peak);
    }
-   mFollowLen = maxlen;
 
    return true;
 }
 
 bool EffectCompressor::InitPass2()
 {
-   // Actually, this should not even be called, because we call
-   // DisableSecondPass() before, if mNormalize is false.
-   return mNormalize;
-}
-
-// Process the input with 2 buffers available at a time
-// buffer1 will be written upon return
-// buffer2 will be passed as buffer1 on the next call
-bool EffectCompressor::TwoBufferProcessPass1(float *buffer1, sampleCount len1, float *buffer2, sampleCount len2)
-{
-   int i;
-
-   // If buffers are bigger than allocated, then abort
-   // (this should never happen, but if it does, we don't want to crash)
-   if((len1 > mFollowLen) || (len2 > mFollowLen))
+   if (!mNormalize || mMax == 0)
       return false;
 
-   // This makes sure that the initial value is well-chosen
-   // buffer1 == NULL on the first and only the first call
-   if (buffer1 == NULL) {
-      // Initialize the mLastLevel to the peak level in the first buffer
-      // This avoids problems with large spike events near the beginning of the track
-      mLastLevel = mThreshold;
-      for(i=0; i<len2; i++) {
-         if(mLastLevel < fabs(buffer2[i]))
-            mLastLevel = fabs(buffer2[i]);
-      }
-   }
-
-   // buffer2 is NULL on the last and only the last call
-   if(buffer2 != NULL) {
-      Follow(buffer2, mFollow2, len2, mFollow1, len1);
-   }
-
-   if(buffer1 != NULL) {
-      for (i = 0; i < len1; i++) {
-         buffer1[i] = DoCompression(buffer1[i], mFollow1[i]);
-      }
-   }
-
-
-#if 0
-   // Copy the envelope over the track data (for debug purposes)
-   memcpy(buffer1, mFollow1, len1*sizeof(float));
-#endif
-
-   // Rotate the buffer pointers
-   float *tmpfloat = mFollow1;
-   mFollow1 = mFollow2;
-   mFollow2 = tmpfloat;
-
-   return true;
+   // Any error in the prediction is put right in a second pass
+   return fabs(mMax - 1.0) > 1.0e-4;
 }
 
-bool EffectCompressor::ProcessPass2(float *buffer, sampleCount len)
-{
-   if (mMax != 0)
-   {
-      for (int i = 0; i < len; i++)
-         buffer[i] /= mMax;
-   }
+// EffectCompressor implementation
 
-   return true;
-}
-
-void EffectCompressor::FreshenCircle()
+DynamicsProcessor::Settings EffectCompressor::GetSettings()
 {
-   // Recompute the RMS sum periodically to prevent accumulation of rounding errors
-   // during long waveforms
-   mRMSSum = 0;
-   for(int i=0; i<mCircleSize; i++)
-      mRMSSum += mCircle[i];
-}
+   DynamicsProcessor::Settings settings;
 
-float EffectCompressor::AvgCircle(float value)
-{
-   float level;
-
-   // Calculate current level from root-mean-squared of
-   // circular buffer ("RMS")
-   mRMSSum -= mCircle[mCirclePos];
-   mCircle[mCirclePos] = value*value;
-   mRMSSum += mCircle[mCirclePos];
-   level = sqrt(mRMSSum/mCircleSize);
-   mCirclePos = (mCirclePos+1)%mCircleSize;
+   settings.threshold = DB_TO_LINEAR(mThresholdDB);
+   settings.noiseFloor = DB_TO_LINEAR(mNoiseFloorDB);
+   settings.ratio = mRatio;
+   settings.attackTime = mAttackTime;
+   settings.releaseTime = mDecayTime;
+   settings.usePeak = mUsePeak;
 
-   return level;
+   return settings;
 }
 
-void EffectCompressor::Follow(float *buffer, float *env, int len, float *previous, int previous_len)
+// The largest output of peak compression, found from the tracks' summary
+// data without reading their samples.  The envelope at a track's peak P
+// is max(P, threshold), and the output there, P * max(P, threshold)^-c,
+// is the largest, since it grows with the level.  Returns 0 where
+// the summaries are not yet computed.
+double EffectCompressor::PredictPeak()
 {
-   /*
-
-   "Follow"ing algorithm by Roger B. Dannenberg, taken from
-   Nyquist.  His description follows.  -DMM
-
-   Description: this is a sophisticated envelope follower.
-    The input is an envelope, e.g. something produced with
-    the AVG function. The purpose of this function is to
-    generate a smooth envelope that is generally not less
-    than the input signal. In other words, we want to "ride"
-    the peaks of the signal with a smooth function. The
-    algorithm is as follows: keep a current output value
-    (called the "value"). The value is allowed to increase
-    by at most rise_factor and decrease by at most fall_factor.
-    Therefore, the next value should be between
-    value * rise_factor and value * fall_factor. If the input
-    is in this range, then the next value is simply the input.
-    If the input is less than value * fall_factor, then the
-    next value is just value * fall_factor, which will be greater
-    than the input signal. If the input is greater than value *
-    rise_factor, then we compute a rising envelope that meets
-    the input value by working bacwards in time, changing the
-    previous values to input / rise_factor, input / rise_factor^2,
-    input / rise_factor^3, etc. until this NEW envelope intersects
-    the previously computed values. There is only a limited buffer
-    in which we can work backwards, so if the NEW envelope does not
-    intersect the old one, then make yet another pass, this time
-    from the oldest buffered value forward, increasing on each
-    sample by rise_factor to produce a maximal envelope. This will
-    still be less than the input.
-
-    The value has a lower limit of floor to make sure value has a
-    reasonable positive value from which to begin an attack.
-   */
-   int i;
-   double level,last;
-
-   if(!mUsePeak) {
-      // Update RMS sum directly from the circle buffer
-      // to avoid accumulation of rounding errors
-      FreshenCircle();
-   }
-   // First apply a peak detect with the requested decay rate
-   last = mLastLevel;
-   for(i=0; i<len; i++) {
-      if(mUsePeak)
-         level = fabs(buffer[i]);
-      else // use RMS
-         level = AvgCircle(buffer[i]);
-      // Don't increase gain when signal is continuously below the noise floor
-      if(level < mNoiseFloor) {
-         mNoiseCounter++;
-      } else {
-         mNoiseCounter = 0;
-      }
-      if(mNoiseCounter < 100) {
-         last *= mDecayFactor;
-         if(last < mThreshold)
-            last = mThreshold;
-         if(level > last)
-            last = level;
-      }
-      env[i] = last;
-   }
-   mLastLevel = last;
-
-   // Next do the same process in reverse direction to get the requested attack rate
-   last = mLastLevel;
-   for(i=len-1; i>=0; i--) {
-      last *= mAttackInverseFactor;
-      if(last < mThreshold)
-         last = mThreshold;
-      if(env[i] < last)
-         env[i] = last;
-      else
-         last = env[i];
-   }
+   const double threshold = DB_TO_LINEAR(mThresholdDB);
+   const double compression = 1.0 - 1.0 / mRatio;
+   double result = 0.0;
 
-   if((previous != NULL) && (previous_len > 0)) {
-      // If the previous envelope was passed, propagate the rise back until we intersect
-      for(i=previous_len-1; i>0; i--) {
-         last *= mAttackInverseFactor;
-         if(last < mThreshold)
-            last = mThreshold;
-         if(previous[i] < last)
-            previous[i] = last;
-         else // Intersected the previous envelope buffer, so we are finished
-            return;
-      }
-      // If we can't back up far enough, project the starting level forward
-      // until we intersect the desired envelope
-      last = previous[0];
-      for(i=1; i<previous_len; i++) {
-         last *= mAttackFactor;
-         if(previous[i] > last)
-            previous[i] = last;
-         else // Intersected the desired envelope, so we are finished
-            return;
-      }
-      // If we still didn't intersect, then continue ramp up into current buffer
-      for(i=0; i<len; i++) {
-         last *= mAttackFactor;
-         if(buffer[i] > last)
-            buffer[i] = last;
-         else // Finally got an intersect
-            return;
+   SelectedTrackListOfKindIterator iter(Track::Wave, mOutputTracks.get());
+   WaveTrack *track = (WaveTrack *) iter.First();
+   while (track) {
+      double t0 = wxMax(mT0, track->GetStartTime());
+      double t1 = wxMin(mT1, track->GetEndTime());
+      if (t1 > t0) {
+         float min, max;
+         if (track->GetODFlags() || !track->GetMinMax(&min, &max, t0, t1))
+            return 0.0;
+
+         double peak = wxMax(-min, max);
+         result = wxMax(result, peak * pow(wxMax(peak, threshold), -compression));
       }
-      // If we still didn't intersect, then reset mLastLevel
-      mLastLevel = last;
-   }
-}
-
-float EffectCompressor::DoCompression(float value, double env)
-{
-   float out;
-   if(mUsePeak) {
-      // Peak values map 1.0 to 1.0 - 'upward' compression
-      out = value * pow(1.0/env, mCompression);
-   } else {
-      // With RMS-based compression don't change values below mThreshold - 'downward' compression
-      out = value * pow(mThreshold/env, mCompression);
+      //Iterate to the next track
+      track = (WaveTrack *) iter.Next();
    }
 
-   // Retain the maximum value for use in the normalization pass
-   if(mMax < fabs(out))
-      mMax = fabs(out);
-
-   return out;
+   return result;
 }
 
 void EffectCompressor::OnSlider(wxCommandEvent & WXUNUSED(evt))
@@ -11,6 +11,8 @@
 #ifndef __AUDACITY_EFFECT_COMPRESSOR__
 #define __AUDACITY_EFFECT_COMPRESSOR__
 
+#include <vector>
+
 #include <wx/bitmap.h>
 #include <wx/checkbox.h>
 #include <wx/event.h>
@@ -21,14 +23,15 @@
 #include <wx/window.h>
 #include "../widgets/wxPanelWrapper.h"
 
-#include "TwoPassSimpleMono.h"
+#include "Effect.h"
+#include "DynamicsProcessor.h"
 
 class EffectCompressorPanel;
 class ShuttleGui;
 
 #define COMPRESSOR_PLUGIN_SYMBOL XO("Compressor")
 
-class EffectCompressor final : public EffectTwoPassSimpleMono
+class EffectCompressor final : public Effect
 {
 public:
 
@@ -46,6 +49,19 @@ public:
 
    // EffectClientInterface implementation
 
+   bool SupportsRealtime() override;
+   int GetAudioInCount() override;
+   int GetAudioOutCount() override;
+   sampleCount GetLatency() override;
+   bool ProcessInitialize(sampleCount totalLen, ChannelNames chanMap = NULL) override;
+   sampleCount ProcessBlock(float **inBlock, float **outBlock, sampleCount blockLen) override;
+   bool RealtimeInitialize() override;
+   bool RealtimeAddProcessor(int numChannels, float sampleRate) override;
+   bool RealtimeFinalize() override;
+   sampleCount RealtimeProcess(int group,
+                               float **inbuf,
+                               float **outbuf,
+                               sampleCount numSamples) override;
    bool GetAutomationParameters(EffectAutomationParameters & parms) override;
    bool SetAutomationParameters(EffectAutomationParameters & parms) override;
 
@@ -57,31 +73,21 @@ public:
    bool TransferDataFromWindow() override;
 
 protected:
-   // EffectTwoPassSimpleMono implementation
+   // Effect implementation
 
    bool InitPass1() override;
    bool InitPass2() override;
-   bool NewTrackPass1() override;
-   bool ProcessPass2(float *buffer, sampleCount len) override;
-   bool TwoBufferProcessPass1(float *buffer1, sampleCount len1, float *buffer2, sampleCount len2) override;
 
 private:
    // EffectCompressor implementation
 
-   void FreshenCircle();
-   float AvgCircle(float x);
-   void Follow(float *buffer, float *env, int len, float *previous, int previous_len);
-   float DoCompression(float x, double env);
+   DynamicsProcessor::Settings GetSettings();
+   double PredictPeak();
 
    void OnSlider(wxCommandEvent & evt);
    void UpdateUI();
 
 private:
-   double    mRMSSum;
-   int       mCircleSize;
-   int       mCirclePos;
-   double   *mCircle;
-
    double    mAttackTime;
    double    mThresholdDB;
    double    mNoiseFloorDB;
@@ -90,20 +96,13 @@ private:
    bool      mUsePeak;
 
    double    mDecayTime;   // The "Release" time.
-   double    mAttackFactor;
-   double    mAttackInverseFactor;
-   double    mDecayFactor;
-   double    mThreshold;
-   double    mCompression;
-   double    mNoiseFloor;
-   int       mNoiseCounter;
-   double    mGain;
-   double    mLastLevel;
-   float	   *mFollow1;
-   float	   *mFollow2;
-   sampleCount mFollowLen;
+
+   DynamicsProcessor mMaster;
+   std::vector<DynamicsProcessor> mSlaves;
+   bool      mLatencyDone;
 
    double    mMax;			//MJS
+   float     mMakeup;      // Gain applied in the first pass
 
    EffectCompressorPanel *mPanel;
 
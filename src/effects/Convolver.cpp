@@ -0,0 +1,399 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  Convolver.cpp
+
+*******************************************************************//**
+
+\file Convolver.cpp
+\brief Uniformly partitioned convolution in the frequency domain.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "Convolver.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "../MemoryX.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CONVOLVER_SSE
+#include <xmmintrin.h>
+#endif
+
+// Fewer partitions than this to a thread are not worth waking it for
+#define CONVOLVER_PARTITIONS_PER_THREAD 16
+
+class ConvolverPoolThread final : public wxThread
+{
+public:
+   ConvolverPoolThread(ConvolverPool &pool)
+      : wxThread(wxTHREAD_JOINABLE)
+      , mPool(pool)
+   {
+   }
+
+   ExitCode Entry() override
+   {
+      mPool.Work();
+      return 0;
+   }
+
+private:
+   ConvolverPool &mPool;
+};
+
+ConvolverPool::ConvolverPool(int maxThreads)
+:  mWork(mMutex),
+   mDone(mMutex)
+{
+   mQueueHead = 0;
+   mQueued = 0;
+   mReserved = 0;
+   mStop = false;
+
+   for (int t = 0; t < maxThreads; t++)
+   {
+      auto thread = std::make_unique<ConvolverPoolThread>(*this);
+      if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR)
+         break;
+      mThreads.push_back(std::move(thread));
+   }
+}
+
+ConvolverPool::~ConvolverPool()
+{
+   {
+      wxMutexLocker locker(mMutex);
+      mStop = true;
+      mWork.Broadcast();
+   }
+   for (const auto &thread : mThreads)
+      thread->Wait();
+}
+
+void ConvolverPool::Reserve(size_t parts)
+{
+   wxMutexLocker locker(mMutex);
+
+   mReserved += parts;
+   if (mReserved <= mQueue.size())
+      return;
+
+   // Jobs may be queued already, so keep them in order
+   std::vector<Job> queue(mReserved);
+   for (size_t i = 0; i < mQueued; i++)
+      queue[i] = mQueue[(mQueueHead + i) % mQueue.size()];
+   mQueue.swap(queue);
+   mQueueHead = 0;
+}
+
+void ConvolverPool::Release(size_t parts)
+{
+   wxMutexLocker locker(mMutex);
+   mReserved -= parts;
+}
+
+void ConvolverPool::Post(PartitionedConvolver &convolver)
+{
+   wxMutexLocker locker(mMutex);
+
+   convolver.mTailNewest = (convolver.mNewest + 1) % convolver.mPartitions;
+   convolver.mPending = convolver.mParts.size();
+   for (size_t p = 0; p < convolver.mParts.size(); p++)
+   {
+      Job &job = mQueue[(mQueueHead + mQueued) % mQueue.size()];
+      job.convolver = &convolver;
+      job.part = p;
+      mQueued++;
+   }
+
+   if (convolver.mParts.size() == 1)
+      mWork.Signal();
+   else
+      mWork.Broadcast();
+}
+
+void ConvolverPool::Wait(PartitionedConvolver &convolver)
+{
+   wxMutexLocker locker(mMutex);
+   while (convolver.mPending > 0)
+      mDone.Wait();
+}
+
+void ConvolverPool::Work()
+{
+   for (;;)
+   {
+      Job job;
+      size_t newest;
+      {
+         wxMutexLocker locker(mMutex);
+         while (!mStop && mQueued == 0)
+            mWork.Wait();
+         if (mStop)
+            return;
+         job = mQueue[mQueueHead];
+         mQueueHead = (mQueueHead + 1) % mQueue.size();
+         mQueued--;
+         newest = job.convolver->mTailNewest;
+      }
+
+      PartitionedConvolver &c = *job.convolver;
+      PartitionedConvolver::Part &part = c.mParts[job.part];
+      std::fill(part.re.begin(), part.re.end(), 0.0f);
+      std::fill(part.im.begin(), part.im.end(), 0.0f);
+      c.Accumulate(part.first, part.last, newest, &part.re[0], &part.im[0]);
+
+      {
+         wxMutexLocker locker(mMutex);
+         // Convolvers wait on the one condition, so all are woken
+         if (--c.mPending == 0)
+            mDone.Broadcast();
+      }
+   }
+}
+
+PartitionedConvolver::PartitionedConvolver(const float *impulse, size_t impulseLen,
+                                           size_t blockSize, ConvolverPool *pool)
+{
+   const size_t B = blockSize;
+
+   mBlockSize = B;
+   mPartitions = std::max<size_t>(1, (impulseLen + B - 1) / B);
+   mFFT = GetFFT(2 * B);
+
+   mBuffer.resize(2 * B);
+   mTime.resize(2 * B);
+   mRe.resize(B);
+   mIm.resize(B);
+
+   // The spectrum of each partition, padded to two blocks
+   mImpulseRe.resize(mPartitions * B);
+   mImpulseIm.resize(mPartitions * B);
+   for (size_t p = 0; p < mPartitions; p++)
+   {
+      const size_t first = p * B;
+      const size_t len = std::min(B, impulseLen - std::min(impulseLen, first));
+      std::fill(mBuffer.begin(), mBuffer.end(), 0.0f);
+      std::copy(impulse + first, impulse + first + len, mBuffer.begin());
+      RealFFTf(&mBuffer[0], mFFT);
+
+      float *re = &mImpulseRe[p * B];
+      float *im = &mImpulseIm[p * B];
+      re[0] = mBuffer[0];
+      im[0] = mBuffer[1];
+      for (size_t k = 1; k < B; k++)
+      {
+         re[k] = mBuffer[mFFT->BitReversed[k]];
+         im[k] = mBuffer[mFFT->BitReversed[k] + 1];
+      }
+   }
+
+   mInputRe.resize(mPartitions * B);
+   mInputIm.resize(mPartitions * B);
+   mWindow.resize(2 * B);
+   mOutput.resize(B);
+
+   // The tail in parts, one to a thread of the pool
+   const size_t tail = mPartitions - 1;
+   size_t numParts = tail / CONVOLVER_PARTITIONS_PER_THREAD;
+   numParts = std::min(numParts, pool ? pool->GetThreadCount() : 0);
+   mParts.resize(numParts);
+   for (size_t t = 0; t < mParts.size(); t++)
+   {
+      mParts[t].first = 1 + tail * t / mParts.size();
+      mParts[t].last = 1 + tail * (t + 1) / mParts.size();
+      mParts[t].re.resize(B);
+      mParts[t].im.resize(B);
+   }
+   mPool = mParts.empty() ? NULL : pool;
+   mPending = 0;
+
+   mNewest = 0;
+   mPos = 0;
+   if (mPool)
+   {
+      mPool->Reserve(mParts.size());
+      StartTail();
+   }
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+   if (mPool)
+   {
+      WaitTail();
+      mPool->Release(mParts.size());
+   }
+
+   ReleaseFFT(mFFT);
+}
+
+void PartitionedConvolver::Reset()
+{
+   if (mPool)
+      WaitTail();
+
+   std::fill(mInputRe.begin(), mInputRe.end(), 0.0f);
+   std::fill(mInputIm.begin(), mInputIm.end(), 0.0f);
+   std::fill(mWindow.begin(), mWindow.end(), 0.0f);
+   std::fill(mOutput.begin(), mOutput.end(), 0.0f);
+   mNewest = 0;
+   mPos = 0;
+
+   if (mPool)
+      StartTail();
+}
+
+void PartitionedConvolver::Process(const float *in, float *out, size_t len)
+{
+   const size_t B = mBlockSize;
+
+   while (len > 0)
+   {
+      const size_t n = std::min(len, B - mPos);
+
+      // The input is taken before the output is given, so they may share
+      memcpy(&mWindow[B + mPos], in, n * sizeof(float));
+      memcpy(out, &mOutput[mPos], n * sizeof(float));
+
+      mPos += n;
+      in += n;
+      out += n;
+      len -= n;
+
+      if (mPos == B)
+      {
+         DoBlock();
+         mPos = 0;
+      }
+   }
+}
+
+void PartitionedConvolver::DoBlock()
+{
+   const size_t B = mBlockSize;
+
+   // Transform the last two blocks into the delay line
+   std::copy(mWindow.begin(), mWindow.end(), mBuffer.begin());
+   RealFFTf(&mBuffer[0], mFFT);
+
+   const size_t slot = (mNewest + 1) % mPartitions;
+   float *re = &mInputRe[slot * B];
+   float *im = &mInputIm[slot * B];
+   re[0] = mBuffer[0];
+   im[0] = mBuffer[1];
+   for (size_t k = 1; k < B; k++)
+   {
+      re[k] = mBuffer[mFFT->BitReversed[k]];
+      im[k] = mBuffer[mFFT->BitReversed[k] + 1];
+   }
+
+   // The tail, from the pool if it has done it
+   if (!mPool)
+   {
+      std::fill(mRe.begin(), mRe.end(), 0.0f);
+      std::fill(mIm.begin(), mIm.end(), 0.0f);
+      Accumulate(1, mPartitions, slot, &mRe[0], &mIm[0]);
+   }
+   else
+   {
+      WaitTail();
+      std::copy(mParts[0].re.begin(), mParts[0].re.end(), mRe.begin());
+      std::copy(mParts[0].im.begin(), mParts[0].im.end(), mIm.begin());
+      for (size_t t = 1; t < mParts.size(); t++)
+      {
+         for (size_t k = 0; k < B; k++)
+         {
+            mRe[k] += mParts[t].re[k];
+            mIm[k] += mParts[t].im[k];
+         }
+      }
+   }
+
+   mNewest = slot;
+
+   // Start on the tail of the next block, while this one is finished
+   if (mPool)
+      StartTail();
+
+   Accumulate(0, 1, slot, &mRe[0], &mIm[0]);
+
+   // The inverse wants the bins in order
+   mBuffer[0] = mRe[0];
+   mBuffer[1] = mIm[0];
+   for (size_t k = 1; k < B; k++)
+   {
+      mBuffer[2 * k] = mRe[k];
+      mBuffer[2 * k + 1] = mIm[k];
+   }
+   InverseRealFFTf(&mBuffer[0], mFFT);
+   ReorderToTime(mFFT, &mBuffer[0], &mTime[0]);
+
+   // The first half wrapped around; the second is the output
+   std::copy(mTime.begin() + B, mTime.end(), mOutput.begin());
+   std::copy(mWindow.begin() + B, mWindow.end(), mWindow.begin());
+}
+
+void PartitionedConvolver::Accumulate(size_t first, size_t last, size_t newest,
+                                      float *accRe, float *accIm) const
+{
+   const size_t B = mBlockSize;
+
+   for (size_t p = first; p < last; p++)
+   {
+      // Partition p meets the block p blocks before the newest
+      const size_t slot = (newest + mPartitions - p) % mPartitions;
+      const float *xr = &mInputRe[slot * B];
+      const float *xi = &mInputIm[slot * B];
+      const float *hr = &mImpulseRe[p * B];
+      const float *hi = &mImpulseIm[p * B];
+
+      // DC and Nyquist are real
+      accRe[0] += xr[0] * hr[0];
+      accIm[0] += xi[0] * hi[0];
+
+      size_t k = 1;
+      for (; k < 4; k++)
+      {
+         accRe[k] += xr[k] * hr[k] - xi[k] * hi[k];
+         accIm[k] += xr[k] * hi[k] + xi[k] * hr[k];
+      }
+
+#if defined(CONVOLVER_SSE)
+      for (; k + 4 <= B; k += 4)
+      {
+         const __m128 vxr = _mm_loadu_ps(xr + k);
+         const __m128 vxi = _mm_loadu_ps(xi + k);
+         const __m128 vhr = _mm_loadu_ps(hr + k);
+         const __m128 vhi = _mm_loadu_ps(hi + k);
+         __m128 vre = _mm_loadu_ps(accRe + k);
+         __m128 vim = _mm_loadu_ps(accIm + k);
+         vre = _mm_add_ps(vre, _mm_sub_ps(_mm_mul_ps(vxr, vhr), _mm_mul_ps(vxi, vhi)));
+         vim = _mm_add_ps(vim, _mm_add_ps(_mm_mul_ps(vxr, vhi), _mm_mul_ps(vxi, vhr)));
+         _mm_storeu_ps(accRe + k, vre);
+         _mm_storeu_ps(accIm + k, vim);
+      }
+#endif
+
+      for (; k < B; k++)
+      {
+         accRe[k] += xr[k] * hr[k] - xi[k] * hi[k];
+         accIm[k] += xr[k] * hi[k] + xi[k] * hr[k];
+      }
+   }
+}
+
+void PartitionedConvolver::StartTail()
+{
+   mPool->Post(*this);
+}
+
+void PartitionedConvolver::WaitTail()
+{
+   mPool->Wait(*this);
+}
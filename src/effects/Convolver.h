@@ -0,0 +1,155 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  Convolver.h
+
+*******************************************************************//**
+
+\class PartitionedConvolver
+\brief Convolves a stream with a long impulse response, such as a
+recorded room, a block at a time.
+
+The impulse is cut into partitions of the block size, and each block of
+input is transformed once, into a frequency domain delay line of the
+spectra of recent blocks.  The output of a block is then the sum, over
+the partitions, of each partition's spectrum times that of the block as
+late as the partition, done by one inverse transform.  The latency is
+one block, however long the impulse.
+
+Only the first partition needs the newest block, so the sum over the
+rest, the tail, is done for the next block as soon as this one is
+done, by worker threads while the caller goes on.  The threads are a
+ConvolverPool's, shared by all the convolvers of an effect, so that
+there are no more of them than cores however many channels there are.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_CONVOLVER__
+#define __AUDACITY_CONVOLVER__
+
+#include <stddef.h>
+#include <memory>
+#include <vector>
+
+#include <wx/thread.h>
+
+#include "../RealFFTf.h"
+
+class ConvolverPoolThread;
+class PartitionedConvolver;
+
+// Worker threads for the tails of any number of convolvers.  It must
+// outlive the convolvers that are given it.
+class ConvolverPool
+{
+public:
+   // Fewer threads may start than asked for, or none
+   explicit ConvolverPool(int maxThreads);
+   ~ConvolverPool();
+
+   size_t GetThreadCount() const { return mThreads.size(); }
+
+private:
+   ConvolverPool(const ConvolverPool &) = delete;
+   ConvolverPool &operator=(const ConvolverPool &) = delete;
+
+   friend class ConvolverPoolThread;
+   friend class PartitionedConvolver;
+
+   struct Job
+   {
+      PartitionedConvolver *convolver;
+      size_t part;
+   };
+
+   // Makes room in the queue for the parts of one more convolver, so
+   // that Post() need not allocate, and gives it back
+   void Reserve(size_t parts);
+   void Release(size_t parts);
+
+   // Queues all the parts of the convolver's tail, and waits for them
+   void Post(PartitionedConvolver &convolver);
+   void Wait(PartitionedConvolver &convolver);
+
+   // Run by each thread, until the pool is destroyed
+   void Work();
+
+   std::vector<std::unique_ptr<ConvolverPoolThread>> mThreads;
+   wxMutex mMutex;
+   wxCondition mWork;        // there are jobs, or the threads are to stop
+   wxCondition mDone;        // a convolver's tail is done
+   std::vector<Job> mQueue;  // a ring
+   size_t mQueueHead;
+   size_t mQueued;
+   size_t mReserved;
+   bool mStop;
+};
+
+class PartitionedConvolver
+{
+public:
+   // blockSize is a power of two, and the latency.  The tail is shared
+   // out among the pool's threads, if there is a pool and the tail is
+   // long enough to be worth it.
+   PartitionedConvolver(const float *impulse, size_t impulseLen,
+                        size_t blockSize, ConvolverPool *pool = NULL);
+   ~PartitionedConvolver();
+
+   size_t GetLatency() const { return mBlockSize; }
+
+   // out is the input convolved with the impulse, GetLatency() samples
+   // late.  out may be the same as in.
+   void Process(const float *in, float *out, size_t len);
+
+   // Forgets the input so far
+   void Reset();
+
+private:
+   PartitionedConvolver(const PartitionedConvolver &) = delete;
+   PartitionedConvolver &operator=(const PartitionedConvolver &) = delete;
+
+   friend class ConvolverPool;
+
+   struct Part
+   {
+      size_t first, last;    // partitions of the tail
+      std::vector<float> re, im;
+   };
+
+   void DoBlock();
+
+   // Sums partitions [first, last) into re and im, for the block whose
+   // spectrum is, or will be, in slot newest
+   void Accumulate(size_t first, size_t last, size_t newest,
+                   float *re, float *im) const;
+
+   void StartTail();
+   void WaitTail();
+
+   size_t mBlockSize;
+   size_t mPartitions;
+   HFFT mFFT;
+
+   // Spectra of blockSize bins, DC and Nyquist sharing the first, as
+   // real and imaginary parts, so that bins go four to a vector
+   std::vector<float> mImpulseRe, mImpulseIm;  // by partition
+   std::vector<float> mInputRe, mInputIm;      // the delay line, a ring
+   size_t mNewest;                             // slot of the newest block
+
+   std::vector<float> mWindow;   // the last block, then the one filling
+   std::vector<float> mOutput;   // output of the last full block
+   size_t mPos;                  // in the block filling
+
+   std::vector<float> mBuffer;
+   std::vector<float> mTime;
+   std::vector<float> mRe, mIm;
+
+   // The tail in parts, for the pool's threads; none without a pool
+   ConvolverPool *mPool;
+   std::vector<Part> mParts;
+   size_t mTailNewest;   // slot the tail is for
+   size_t mPending;      // parts not yet done, under the pool's mutex
+};
+
+#endif
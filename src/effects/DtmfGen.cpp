@@ -24,6 +24,8 @@
 #include "../ShuttleGui.h"
 #include "../widgets/valnum.h"
 
+#include "GeneratorKernels.h"
+
 
 enum
 {
@@ -520,15 +522,21 @@ bool EffectDtmf::MakeDtmfTone(float *buffer, sampleCount len, float fs, wxChar t
          f2=0;
    }
 
-   // precalculations
-   A=B=2*M_PI/fs;
-   A*=f1;
-   B*=f2;
+   // precalculations, in cycles rather than radians
+   A=f1/fs;
+   B=f2/fs;
 
    // now generate the wave: 'last' is used to avoid phase errors
    // when inside the inner for loop of the Process() function.
+   // The second tone is made in place of its phases, in mTone2.
+   if (mTone2.size() < (size_t)len)
+      mTone2.resize(len);
+   CyclesOfRamp(A*last, A, buffer, len);
+   SineOfCycles(buffer, buffer, len);
+   CyclesOfRamp(B*last, B, &mTone2[0], len);
+   SineOfCycles(&mTone2[0], &mTone2[0], len);
    for(sampleCount i=0; i<len; i++) {
-      buffer[i]=amplitude*0.5*(sin(A*(i+last))+sin(B*(i+last)));
+      buffer[i]=amplitude*0.5*(buffer[i]+mTone2[i]);
    }
 
    // generate a fade-in of duration 1/250th of second
@@ -14,6 +14,8 @@
 #ifndef __AUDACITY_EFFECT_DTMF__
 #define __AUDACITY_EFFECT_DTMF__
 
+#include <vector>
+
 #include <wx/event.h>
 #include <wx/slider.h>
 #include <wx/stattext.h>
@@ -90,6 +92,8 @@ private:
    double dtmfDutyCycle;            // ratio of dtmfTone/(dtmfTone+dtmfSilence)
    double dtmfAmplitude;            // amplitude of dtmf tone sequence, restricted to (0-1)
 
+   std::vector<float> mTone2;       // the higher tone, while it is made
+
    wxTextCtrl *mDtmfSequenceT;
    wxTextCtrl *mDtmfAmplitudeT;
    wxSlider   *mDtmfDutyCycleS;
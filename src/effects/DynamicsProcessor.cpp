@@ -0,0 +1,294 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DynamicsProcessor.cpp
+
+*******************************************************************//**
+
+\file DynamicsProcessor.cpp
+\brief The compressor's envelope follower and gain, as a stream.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "DynamicsProcessor.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DYNAMICS_PROCESSOR_SSE
+#ifndef USE_SSE2
+#define USE_SSE2
+#endif
+#include "../SseMathFuncs.h"
+#endif
+
+// New samples are followed this many at a time, so the rings need only
+// be this much longer than the look-ahead
+#define DYNAMICS_BLOCK 1024
+
+#define CIRCLE_SIZE 100
+
+DynamicsProcessor::DynamicsProcessor()
+{
+   Settings settings;
+   settings.threshold = 0.5;
+   settings.noiseFloor = 0.01;
+   settings.ratio = 2.0;
+   settings.attackTime = 0.2;
+   settings.releaseTime = 1.0;
+   settings.usePeak = false;
+
+   Init(settings, 44100.0);
+}
+
+void DynamicsProcessor::Init(const Settings & settings, double rate, double maxLookAhead)
+{
+   mRate = rate;
+   mMaxLookAhead = maxLookAhead;
+
+   mLookAhead = LookAheadFor(settings.attackTime);
+   mInput.assign(mLookAhead + DYNAMICS_BLOCK, 0.0f);
+   mEnv.assign(mLookAhead + DYNAMICS_BLOCK, 0.0f);
+   mHead = 0;
+   mPending = 0;
+   mPrimed = false;
+
+   SetSettings(settings);
+
+   mLastLevel = mThreshold;
+   mNoiseCounter = 100;
+   memset(mCircle, 0, sizeof(mCircle));
+   mCirclePos = 0;
+   mRMSSum = 0.0;
+
+   mPeak = 0.0f;
+}
+
+// Long enough for the backward pass to fall from full scale to the
+// threshold, as the attack factor is set to do
+size_t DynamicsProcessor::LookAheadFor(double attackTime) const
+{
+   size_t lookAhead = (size_t) ceil(mRate * attackTime + 0.5);
+   if (mMaxLookAhead > 0.0)
+   {
+      lookAhead = std::min(lookAhead, (size_t) ceil(mRate * mMaxLookAhead));
+   }
+   return std::max<size_t>(1, lookAhead);
+}
+
+void DynamicsProcessor::SetSettings(const Settings & settings)
+{
+   // The rings are too short for so long an attack
+   if (LookAheadFor(settings.attackTime) > mLookAhead)
+   {
+      Init(settings, mRate, mMaxLookAhead);
+      return;
+   }
+
+   mUsePeak = settings.usePeak;
+   mThreshold = settings.threshold;
+   mNoiseFloor = settings.noiseFloor;
+   mCompression = 1.0 - 1.0 / settings.ratio;
+
+   // With the look-ahead capped, the attack is only as long as it
+   const double attack = std::min(mRate * settings.attackTime + 0.5,
+                                  (double) mLookAhead);
+   mAttackInverseFactor = exp(log(mThreshold) / attack);
+   mDecayFactor =
+      exp(log(mThreshold) / (mRate * settings.releaseTime + 0.5));
+}
+
+void DynamicsProcessor::Process(const float *in, float *out, size_t len, float makeup)
+{
+   const size_t size = mInput.size();
+
+   while (len > 0)
+   {
+      size_t block = std::min(len, (size_t) DYNAMICS_BLOCK);
+
+      size_t tail = (mHead + mPending) % size;
+      for (size_t i = 0; i < block; i++)
+      {
+         mInput[tail] = in[i];
+         if (++tail == size)
+         {
+            tail = 0;
+         }
+      }
+      mPending += block;
+
+      size_t ready = 0;
+      if (mPrimed)
+      {
+         Follow(block);
+         ready = mPending - mLookAhead;
+      }
+      else if (mPending >= mLookAhead)
+      {
+         // Start from the peak of the first look-ahead, so the envelope
+         // is already up to a loud start
+         double peak = 0.0;
+         for (size_t i = 0, j = mHead; i < mPending; i++)
+         {
+            peak = std::max(peak, (double) fabs(mInput[j]));
+            if (++j == size)
+            {
+               j = 0;
+            }
+         }
+         mLastLevel = std::max(mThreshold, peak);
+
+         Follow(mPending);
+         mPrimed = true;
+         ready = mPending - mLookAhead;
+      }
+
+      // Silence until the look-ahead is full
+      memset(out, 0, (block - ready) * sizeof(float));
+      Emit(out + block - ready, ready, makeup);
+
+      in += block;
+      out += block;
+      len -= block;
+   }
+}
+
+float DynamicsProcessor::AvgCircle(float value)
+{
+   float level;
+
+   // Calculate current level from root-mean-squared of
+   // circular buffer ("RMS")
+   mRMSSum -= mCircle[mCirclePos];
+   mCircle[mCirclePos] = value*value;
+   mRMSSum += mCircle[mCirclePos];
+   level = sqrt(mRMSSum/CIRCLE_SIZE);
+   mCirclePos = (mCirclePos+1)%CIRCLE_SIZE;
+
+   return level;
+}
+
+// Follows the newest count samples, and lets their attack rise back
+// into the older ones not yet output
+void DynamicsProcessor::Follow(size_t count)
+{
+   const size_t size = mInput.size();
+   const size_t first = (mHead + mPending - count) % size;
+   size_t i, j;
+   double level, last;
+
+   if (!mUsePeak)
+   {
+      // Recompute the RMS sum periodically to prevent accumulation of
+      // rounding errors during long waveforms
+      mRMSSum = 0;
+      for (int c = 0; c < CIRCLE_SIZE; c++)
+         mRMSSum += mCircle[c];
+   }
+
+   // First apply a peak detect with the requested decay rate
+   last = mLastLevel;
+   for (i = 0, j = first; i < count; i++)
+   {
+      if (mUsePeak)
+         level = fabs(mInput[j]);
+      else // use RMS
+         level = AvgCircle(mInput[j]);
+      // Don't increase gain when signal is continuously below the noise floor
+      if (level < mNoiseFloor) {
+         mNoiseCounter++;
+      } else {
+         mNoiseCounter = 0;
+      }
+      if (mNoiseCounter < 100) {
+         last *= mDecayFactor;
+         if (last < mThreshold)
+            last = mThreshold;
+         if (level > last)
+            last = level;
+      }
+      mEnv[j] = last;
+      if (++j == size)
+         j = 0;
+   }
+   mLastLevel = last;
+
+   // Next do the same process in reverse direction to get the requested
+   // attack rate.  Through the new samples the rise always goes on; into
+   // the older ones, only until it meets the envelope they already have.
+   j = (first + count + size - 1) % size;
+   for (i = 0; i < mPending; i++)
+   {
+      last *= mAttackInverseFactor;
+      if (last < mThreshold)
+         last = mThreshold;
+      if (mEnv[j] < last)
+         mEnv[j] = last;
+      else if (i >= count)
+         break;
+      else
+         last = mEnv[j];
+      j = (j == 0) ? size - 1 : j - 1;
+   }
+}
+
+// Outputs the oldest count samples, compressed
+void DynamicsProcessor::Emit(float *out, size_t count, float makeup)
+{
+   const size_t size = mInput.size();
+
+   // In peak mode full scale maps to full scale, so there is 'upward'
+   // compression; in RMS mode levels below the threshold are left alone,
+   // so there is 'downward' compression
+   const float c = (float) mCompression;
+   const float top = mUsePeak ? 1.0f : (float) mThreshold;
+   float peak = mPeak;
+
+   while (count > 0)
+   {
+      // The ring may wrap, so go in at most two runs
+      const size_t run = std::min(count, size - mHead);
+      const float *x = &mInput[mHead];
+      const float *env = &mEnv[mHead];
+      size_t i = 0;
+
+#if defined(DYNAMICS_PROCESSOR_SSE)
+      // out = x * (top / env)^c, as exp(c * log(top / env)), four at a time
+      const __m128 vc = _mm_set1_ps(c);
+      const __m128 vtop = _mm_set1_ps(top);
+      const __m128 vmakeup = _mm_set1_ps(makeup);
+      const __m128 sign = _mm_set1_ps(-0.0f);
+      __m128 vpeak = _mm_set1_ps(peak);
+      for (; i + 4 <= run; i += 4)
+      {
+         __m128 g = exp_ps(_mm_mul_ps(vc, log_ps(_mm_div_ps(vtop, _mm_loadu_ps(env + i)))));
+         __m128 y = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(x + i), g), vmakeup);
+         _mm_storeu_ps(out + i, y);
+         vpeak = _mm_max_ps(vpeak, _mm_andnot_ps(sign, y));
+      }
+      float lanes[4];
+      _mm_storeu_ps(lanes, vpeak);
+      peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+
+      for (; i < run; i++)
+      {
+         float y = x[i] * (float) pow(top / env[i], c) * makeup;
+         out[i] = y;
+         peak = std::max(peak, (float) fabs(y));
+      }
+
+      mHead += run;
+      if (mHead == size)
+         mHead = 0;
+      mPending -= run;
+      out += run;
+      count -= run;
+   }
+
+   mPeak = peak;
+}
@@ -0,0 +1,101 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DynamicsProcessor.h
+
+*******************************************************************//**
+
+\class DynamicsProcessor
+\brief The compressor as a stream: samples go in, and come out
+compressed after a fixed look-ahead.
+
+The envelope follows Roger B. Dannenberg's algorithm from Nyquist, as
+the Compressor effect always has: a forward peak detect at the release
+rate, then a backward pass that lets the envelope rise ahead of a peak
+at the attack rate.  Going backward from a peak of up to full scale,
+the rise falls to the threshold within the attack time, so a look-ahead
+of that length is all the backward pass needs.
+
+Nothing is allocated after Init(), so the processor can run in
+realtime.  There the look-ahead may be capped, to keep the delay short:
+the attack is then made no longer than the look-ahead, so that peaks are
+still caught, and the processor works as a peak limiter.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_DYNAMICS_PROCESSOR__
+#define __AUDACITY_DYNAMICS_PROCESSOR__
+
+#include <stddef.h>
+#include <vector>
+
+class DynamicsProcessor
+{
+public:
+   struct Settings
+   {
+      double threshold;    // linear
+      double noiseFloor;   // linear
+      double ratio;
+      double attackTime;   // seconds
+      double releaseTime;  // seconds
+      bool usePeak;        // else RMS
+   };
+
+   DynamicsProcessor();
+
+   // Clears the state.  The look-ahead is fixed here, from the attack
+   // time, but no longer than maxLookAhead seconds if that is given.
+   void Init(const Settings & settings, double rate, double maxLookAhead = 0.0);
+
+   // For changes while running.  An attack time that needs a longer
+   // look-ahead than there is starts over, as from Init(), unless the
+   // look-ahead was capped; then the attack is cut short to fit it.
+   void SetSettings(const Settings & settings);
+
+   size_t GetLatency() const { return mLookAhead; }
+
+   // The output is the input of GetLatency() samples before, compressed,
+   // then multiplied by makeup; the first GetLatency() are silence.
+   // out may not be the same as in.
+   void Process(const float *in, float *out, size_t len, float makeup = 1.0f);
+
+   // The largest magnitude output since Init()
+   float GetPeak() const { return mPeak; }
+
+private:
+   void Follow(size_t count);
+   void Emit(float *out, size_t count, float makeup);
+   float AvgCircle(float value);
+   size_t LookAheadFor(double attackTime) const;
+
+   double mRate;
+   double mMaxLookAhead;  // seconds, or 0 for as long as the attack
+   bool mUsePeak;
+   double mThreshold;
+   double mNoiseFloor;
+   double mCompression;
+   double mAttackInverseFactor;
+   double mDecayFactor;
+
+   // Input and envelope, in rings of samples not yet output
+   std::vector<float> mInput;
+   std::vector<float> mEnv;
+   size_t mLookAhead;
+   size_t mHead;      // index of the oldest sample not yet output
+   size_t mPending;   // number of samples not yet output
+   bool mPrimed;      // whether the first look-ahead has been filled
+
+   double mLastLevel;
+   int mNoiseCounter;
+
+   // For the RMS level
+   double mCircle[100];
+   int mCirclePos;
+   double mRMSSum;
+
+   float mPeak;
+};
+
+#endif
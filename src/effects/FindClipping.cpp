@@ -22,11 +22,13 @@
 #include "../Audacity.h"
 #include "FindClipping.h"
 
+#include <algorithm>
 #include <math.h>
 
 #include <wx/intl.h>
 
 #include "../AudacityApp.h"
+#include "../BlockFile.h"
 #include "../ShuttleGui.h"
 #include "../widgets/valnum.h"
 
@@ -177,6 +179,17 @@ bool EffectFindClipping::ProcessOne(LabelTrack * lt,
             break;
          }
 
+         // Outside a run, a block with no clipped samples can't start one,
+         // so skip the rest of it without reading it
+         if (startrun == 0) {
+            SampleStats stats;
+            sampleCount skip = wt->GetBlockStats(start + s, stats);
+            if (skip > 0 && stats.clipped == 0) {
+               s += std::min(skip, len - s);
+               continue;
+            }
+         }
+
          block = s + blockSize > len ? len - s : blockSize;
 
          wt->Get((samplePtr)buffer, floatSample, start + s, block);
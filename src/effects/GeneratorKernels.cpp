@@ -0,0 +1,251 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  GeneratorKernels.cpp
+
+*******************************************************************//**
+
+\file GeneratorKernels.cpp
+\brief Block kernels for the tone and noise generators.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "GeneratorKernels.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GENERATOR_KERNELS_SSE
+#ifndef USE_SSE2
+#define USE_SSE2
+#endif
+#include "../SseMathFuncs.h"
+#endif
+
+#define TWO_PI_F 6.28318530717958647692f
+
+void CyclesOfRamp(double start, double increment, float *cycles, size_t len)
+{
+   start -= floor(start);
+   increment -= floor(increment);
+   for (size_t i = 0; i < len; i++)
+   {
+      double c = start + i * increment;
+      cycles[i] = (float) (c - floor(c));
+   }
+}
+
+void SineOfCycles(const float *cycles, float *out, size_t len)
+{
+   size_t i = 0;
+
+#if defined(GENERATOR_KERNELS_SSE)
+   const __m128 twoPi = _mm_set1_ps(TWO_PI_F);
+   for (; i + 4 <= len; i += 4)
+   {
+      __m128 x = _mm_mul_ps(_mm_loadu_ps(cycles + i), twoPi);
+      _mm_storeu_ps(out + i, sin_ps(x));
+   }
+#endif
+
+   for (; i < len; i++)
+   {
+      out[i] = sinf(TWO_PI_F * cycles[i]);
+   }
+}
+
+void SquareOfCycles(const float *cycles, float *out, size_t len)
+{
+   size_t i = 0;
+
+#if defined(GENERATOR_KERNELS_SSE)
+   const __m128 half = _mm_set1_ps(0.5f);
+   const __m128 one = _mm_set1_ps(1.0f);
+   const __m128 sign = _mm_set1_ps(-0.0f);
+   for (; i + 4 <= len; i += 4)
+   {
+      // -1 where the cycle is at or past its half, by setting the sign bit
+      __m128 late = _mm_cmpge_ps(_mm_loadu_ps(cycles + i), half);
+      _mm_storeu_ps(out + i, _mm_or_ps(one, _mm_and_ps(late, sign)));
+   }
+#endif
+
+   for (; i < len; i++)
+   {
+      out[i] = (cycles[i] < 0.5f) ? 1.0f : -1.0f;
+   }
+}
+
+void SawtoothOfCycles(const float *cycles, float *out, size_t len)
+{
+   size_t i = 0;
+
+#if defined(GENERATOR_KERNELS_SSE)
+   const __m128 half = _mm_set1_ps(0.5f);
+   const __m128 one = _mm_set1_ps(1.0f);
+   const __m128 two = _mm_set1_ps(2.0f);
+   for (; i + 4 <= len; i += 4)
+   {
+      // Cycles are in [0, 1), so the phase plus a half wraps at most once
+      __m128 x = _mm_add_ps(_mm_loadu_ps(cycles + i), half);
+      x = _mm_sub_ps(x, _mm_and_ps(_mm_cmpge_ps(x, one), one));
+      _mm_storeu_ps(out + i, _mm_sub_ps(_mm_mul_ps(two, x), one));
+   }
+#endif
+
+   for (; i < len; i++)
+   {
+      float x = cycles[i] + 0.5f;
+      if (x >= 1.0f)
+      {
+         x -= 1.0f;
+      }
+      out[i] = 2.0f * x - 1.0f;
+   }
+}
+
+// Good down to 110Hz @ 44100Hz sampling.
+void BandLimitedSquareOfCycles(const float *cycles, const float *frequencies,
+                               float *out, size_t len)
+{
+   const float pre4divPI = (float) (4.0 / M_PI);
+   size_t i = 0;
+
+#if defined(GENERATOR_KERNELS_SSE)
+   const __m128 twoPi = _mm_set1_ps(TWO_PI_F);
+   const __m128 fourDivPi = _mm_set1_ps(pre4divPI);
+   const __m128 one = _mm_set1_ps(1.0f);
+   const __m128 nyquist = _mm_set1_ps(0.5f);
+   for (; i + 4 <= len; i += 4)
+   {
+      __m128 p = _mm_loadu_ps(cycles + i);
+      __m128 fr = _mm_loadu_ps(frequencies + i);
+
+      // do fundamental (k=1) outside loop, and the scaling
+      __m128 b = _mm_div_ps(_mm_add_ps(one, cos_ps(_mm_mul_ps(twoPi, fr))), fourDivPi);
+      __m128 f = _mm_mul_ps(fourDivPi, sin_ps(_mm_mul_ps(twoPi, p)));
+
+      // The lanes may have different frequencies, so each stops adding
+      // harmonics at its own Nyquist limit, and the loop when all have
+      for (int k = 3; k < 200; k += 2)
+      {
+         const __m128 kk = _mm_set1_ps((float) k);
+         __m128 below = _mm_cmplt_ps(_mm_mul_ps(kk, fr), nyquist);
+         if (!_mm_movemask_ps(below))
+         {
+            break;
+         }
+
+         // Hanning Window in freq domain
+         __m128 a = _mm_add_ps(one, cos_ps(_mm_mul_ps(twoPi, _mm_mul_ps(kk, fr))));
+
+         // Harmonic phase, kept within the cycle for the sake of precision
+         __m128 kp = _mm_mul_ps(kk, p);
+         kp = _mm_sub_ps(kp, _mm_cvtepi32_ps(_mm_cvttps_epi32(kp)));
+
+         // calc harmonic, apply window, scale to amplitude of fundamental
+         __m128 h = _mm_div_ps(_mm_mul_ps(a, sin_ps(_mm_mul_ps(twoPi, kp))),
+                               _mm_mul_ps(b, kk));
+         f = _mm_add_ps(f, _mm_and_ps(below, h));
+      }
+
+      _mm_storeu_ps(out + i, f);
+   }
+#endif
+
+   for (; i < len; i++)
+   {
+      const float p = cycles[i];
+      const float fr = frequencies[i];
+
+      float b = (1.0f + cosf(TWO_PI_F * fr)) / pre4divPI;
+      float f = pre4divPI * sinf(TWO_PI_F * p);
+      for (int k = 3; (k < 200) && (k * fr < 0.5f); k += 2)
+      {
+         float a = 1.0f + cosf(TWO_PI_F * k * fr);
+         float kp = k * p;
+         kp -= (int) kp;
+         f += a * sinf(TWO_PI_F * kp) / (b * k);
+      }
+      out[i] = f;
+   }
+}
+
+NoiseSource::NoiseSource()
+{
+   Seed(rand());
+}
+
+void NoiseSource::Seed(unsigned int seed)
+{
+   // Spread the seed over the generators, none of which may be zero
+   for (int i = 0; i < 4; i++)
+   {
+      seed = seed * 1664525u + 1013904223u;
+      state[i] = seed ? seed : 0x9E3779B9u;
+   }
+   carried = 0;
+}
+
+// [-1, 1) from the top 24 bits
+#define NOISE_SCALE (1.0f / 8388608.0f)
+
+void WhiteNoise(NoiseSource &source, float *out, size_t len, float amplitude)
+{
+   size_t i = 0;
+
+   // First what the last call left of its group
+   for (; source.carried > 0 && i < len; i++)
+   {
+      out[i] = source.carry[4 - source.carried] * amplitude;
+      source.carried--;
+   }
+
+#if defined(GENERATOR_KERNELS_SSE)
+   __m128i x = _mm_loadu_si128((const __m128i *) source.state);
+   const __m128 scale = _mm_set1_ps(NOISE_SCALE);
+   const __m128 one = _mm_set1_ps(1.0f);
+   const __m128 amp = _mm_set1_ps(amplitude);
+   for (; i + 4 <= len; i += 4)
+   {
+      x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+      x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+      x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+
+      __m128 w = _mm_cvtepi32_ps(_mm_srli_epi32(x, 8));
+      w = _mm_sub_ps(_mm_mul_ps(w, scale), one);
+      _mm_storeu_ps(out + i, _mm_mul_ps(w, amp));
+   }
+   _mm_storeu_si128((__m128i *) source.state, x);
+#endif
+
+   // The rest, and a part group at the end, whose unused values are carried
+   while (i < len)
+   {
+      float w[4];
+      for (int j = 0; j < 4; j++)
+      {
+         unsigned int &s = source.state[j];
+         s ^= s << 13;
+         s ^= s >> 17;
+         s ^= s << 5;
+         w[j] = (float) (int) (s >> 8) * NOISE_SCALE - 1.0f;
+      }
+
+      const size_t n = std::min<size_t>(4, len - i);
+      for (size_t j = 0; j < n; j++)
+      {
+         out[i + j] = w[j] * amplitude;
+      }
+      for (size_t j = n; j < 4; j++)
+      {
+         source.carry[j] = w[j];
+      }
+      source.carried = 4 - n;
+      i += n;
+   }
+}
@@ -0,0 +1,67 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  GeneratorKernels.h
+
+*******************************************************************//**
+
+\file GeneratorKernels.h
+\brief Block kernels for the tone and noise generators.
+
+Waveforms are computed from the phase of each sample in cycles, so that
+the generators keep their own notion of frequency and chirp, and only
+the costly part is done here, four samples at a time where SSE2 is
+available.  Each kernel has a scalar version that gives the same
+output, to within float rounding, for other processors.  The output
+may be the same array as the input.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_GENERATOR_KERNELS__
+#define __AUDACITY_GENERATOR_KERNELS__
+
+#include <stddef.h>
+
+// cycles[i] = the fractional part of start + i * increment, computed in
+// double, so that long tones keep their phase
+void CyclesOfRamp(double start, double increment, float *cycles, size_t len);
+
+// out[i] = sin(2 pi cycles[i])
+void SineOfCycles(const float *cycles, float *out, size_t len);
+
+// out[i] = 1 for the first half of each cycle, else -1
+void SquareOfCycles(const float *cycles, float *out, size_t len);
+
+// out[i] rises from -1 to 1 over each cycle, crossing 0 at its start
+void SawtoothOfCycles(const float *cycles, float *out, size_t len);
+
+// The odd harmonics of a square wave, up to the 199th or half the sample
+// rate, with a Hann window over them.  frequencies are in cycles per
+// sample, and may change from sample to sample.
+void BandLimitedSquareOfCycles(const float *cycles, const float *frequencies,
+                               float *out, size_t len);
+
+// Four xorshift generators that take turns, sample by sample, so that
+// SSE2 can step them all at once.  The state always advances by whole
+// groups of four samples; what a call leaves of its last group is kept
+// in carry, for the start of the next, so the sequence does not depend
+// on how it is split into blocks.
+struct NoiseSource
+{
+   NoiseSource();  // seeded from rand()
+
+   void Seed(unsigned int seed);
+
+   unsigned int state[4];
+
+   // The last carried values of a group, in [-1, 1), before amplitude
+   float carry[4];
+   unsigned int carried;
+};
+
+// Uniform in [-amplitude, amplitude).  The pink and brown noise filters
+// are left to the generator: their feedback goes sample by sample.
+void WhiteNoise(NoiseSource &source, float *out, size_t len, float amplitude);
+
+#endif
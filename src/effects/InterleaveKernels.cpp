@@ -0,0 +1,55 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  InterleaveKernels.cpp
+
+*******************************************************************//**
+
+\file InterleaveKernels.cpp
+\brief Conversion between separate channels and left-right pairs, as
+SoundTouch wants stereo.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "InterleaveKernels.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define INTERLEAVE_KERNELS_SSE
+#include <xmmintrin.h>
+#endif
+
+void Interleave(const float *left, const float *right, float *out, size_t len)
+{
+   size_t i = 0;
+#if defined(INTERLEAVE_KERNELS_SSE)
+   for (; i + 4 <= len; i += 4) {
+      const __m128 l = _mm_loadu_ps(left + i);
+      const __m128 r = _mm_loadu_ps(right + i);
+      _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(l, r));
+      _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+   }
+#endif
+   for (; i < len; i++) {
+      out[2 * i] = left[i];
+      out[2 * i + 1] = right[i];
+   }
+}
+
+void Deinterleave(const float *in, float *left, float *right, size_t len)
+{
+   size_t i = 0;
+#if defined(INTERLEAVE_KERNELS_SSE)
+   for (; i + 4 <= len; i += 4) {
+      const __m128 a = _mm_loadu_ps(in + 2 * i);
+      const __m128 b = _mm_loadu_ps(in + 2 * i + 4);
+      _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+   }
+#endif
+   for (; i < len; i++) {
+      left[i] = in[2 * i];
+      right[i] = in[2 * i + 1];
+   }
+}
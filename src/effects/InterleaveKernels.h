@@ -0,0 +1,30 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  InterleaveKernels.h
+
+*******************************************************************//**
+
+\file InterleaveKernels.h
+\brief Conversion between separate channels and left-right pairs, as
+SoundTouch wants stereo.
+
+Four frames are converted at a time where SSE is available, and the rest
+one at a time.  Either way the samples are only moved, so the results
+are the same.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_INTERLEAVE_KERNELS__
+#define __AUDACITY_INTERLEAVE_KERNELS__
+
+#include <stddef.h>
+
+// Writes len pairs to out
+void Interleave(const float *left, const float *right, float *out, size_t len);
+
+// Reads len pairs from in
+void Deinterleave(const float *in, float *left, float *right, size_t len);
+
+#endif
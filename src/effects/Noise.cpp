@@ -98,26 +98,24 @@ sampleCount EffectNoise::ProcessBlock(float **WXUNUSED(inbuf), float **outbuf, s
 
    float white;
    float amplitude;
-   float div = ((float) RAND_MAX) / 2.0f;
 
    switch (mType)
    {
    default:
    case kWhite: // white
-       for (sampleCount i = 0; i < size; i++)
-       {
-          buffer[i] = mAmp * ((rand() / div) - 1.0f);
-       }
-       break;
+      WhiteNoise(mSource, buffer, size, mAmp);
+      break;
 
    case kPink: // pink
       // based on Paul Kellet's "instrumentation grade" algorithm.
 
       // 0.129f is an experimental normalization factor.
       amplitude = mAmp * 0.129f;
+      // filtered in place
+      WhiteNoise(mSource, buffer, size, 1.0f);
       for (sampleCount i = 0; i < size; i++)
       {
-         white = (rand() / div) - 1.0f;
+         white = buffer[i];
          buf0 = 0.99886f * buf0 + 0.0555179f * white;
          buf1 = 0.99332f * buf1 + 0.0750759f * white;
          buf2 = 0.96900f * buf2 + 0.1538520f * white;
@@ -141,10 +139,11 @@ sampleCount EffectNoise::ProcessBlock(float **WXUNUSED(inbuf), float **outbuf, s
       float scaling = (9.0 / sqrt(mSampleRate) > 0.01)
          ? 9.0 / sqrt(mSampleRate)
          : 0.01f;
- 
+
+      WhiteNoise(mSource, buffer, size, 1.0f);
       for (sampleCount i = 0; i < size; i++)
       {
-         white = (rand() / div) - 1.0f;
+         white = buffer[i];
          z = leakage * y + white * scaling;
          y = fabs(z) > 1.0
             ? leakage * y - white * scaling
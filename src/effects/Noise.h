@@ -18,6 +18,7 @@
 #include "../widgets/NumericTextCtrl.h"
 
 #include "Effect.h"
+#include "GeneratorKernels.h"
 
 class ShuttleGui;
 
@@ -59,6 +60,7 @@ private:
    int mType;
    double mAmp;
 
+   NoiseSource mSource;
    float y, z, buf0, buf1, buf2, buf3, buf4, buf5, buf6;
 
    NumericTextCtrl *mNoiseDurationT;
@@ -23,6 +23,7 @@
 #include <wx/intl.h>
 #include <wx/valgen.h>
 
+#include "../BlockFile.h"
 #include "../Internat.h"
 #include "../Prefs.h"
 #include "../ShuttleGui.h"
@@ -359,7 +360,7 @@ void EffectNormalize::AnalyseTrack(WaveTrack * track, const wxString &msg)
 }
 
 //AnalyseDC() takes a track, transforms it to bunch of buffer-blocks,
-//and executes AnalyzeData on it...
+//and sums it from the blocks' statistics...
 // sets mOffset
 bool EffectNormalize::AnalyseDC(WaveTrack * track, const wxString &msg)
 {
@@ -380,29 +381,29 @@ bool EffectNormalize::AnalyseDC(WaveTrack * track, const wxString &msg)
    //to make it a double now than it is to do it later
    double len = (double)(end - start);
 
-   //Initiate a processing buffer.  This buffer will (most likely)
-   //be shorter than the length of the track being processed.
-   float *buffer = new float[track->GetMaxBlockSize()];
-
    mSum = 0.0; // dc offset inits
    mCount = 0;
 
-   //Go through the track one buffer at a time. s counts which
-   //sample the current buffer starts at.
+   //Go through the track one block at a time. s counts which
+   //sample the current block starts at.
    s = start;
    while (s < end) {
-      //Get a block of samples (smaller than the size of the buffer)
+      //Take the region a block at a time
       sampleCount block = track->GetBestBlockSize(s);
 
       //Adjust the block size if it is the final block in the track
       if (s + block > end)
          block = end - s;
 
-      //Get the samples from the track and put them in the buffer
-      track->Get((samplePtr) buffer, floatSample, s, block);
-
-      //Process the buffer.
-      AnalyzeData(buffer, block);
+      //Whole blocks are summed from their stored statistics, without
+      //reading the samples
+      SampleStats stats;
+      if (!track->GetStats(s, block, stats)) {
+         rc = false;
+         break;
+      }
+      mSum += stats.sum;
+      mCount += stats.count;
 
       //Increment s one blockfull of samples
       s += block;
@@ -410,14 +411,11 @@ bool EffectNormalize::AnalyseDC(WaveTrack * track, const wxString &msg)
       //Update the Progress meter
       if (TrackProgress(mCurTrackNum,
                         ((double)(s - start) / len)/2.0, msg)) {
-         rc = false; //lda .. break, not return, so that buffer is deleted
+         rc = false;
          break;
       }
    }
 
-   //Clean up the buffer
-   delete[] buffer;
-
    mOffset = (float)(-mSum / mCount);  // calculate actual offset (amount that needs to be added on)
 
    //Return true because the effect processing succeeded ... unless cancelled
@@ -482,15 +480,6 @@ bool EffectNormalize::ProcessOne(WaveTrack * track, const wxString &msg)
    return rc;
 }
 
-void EffectNormalize::AnalyzeData(float *buffer, sampleCount len)
-{
-   sampleCount i;
-
-   for(i=0; i<len; i++)
-      mSum += (double)buffer[i];
-   mCount += len;
-}
-
 void EffectNormalize::ProcessData(float *buffer, sampleCount len)
 {
    sampleCount i;
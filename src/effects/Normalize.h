@@ -58,7 +58,6 @@ private:
 
    bool ProcessOne(WaveTrack * t, const wxString &msg);
    void AnalyseTrack(WaveTrack * track, const wxString &msg);
-   void AnalyzeData(float *buffer, sampleCount len);
    bool AnalyseDC(WaveTrack * track, const wxString &msg);
    void ProcessData(float *buffer, sampleCount len);
 
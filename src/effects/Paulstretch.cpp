@@ -16,17 +16,21 @@
 
 #include "../Audacity.h"
 #include "Paulstretch.h"
+#include "PaulstretchKernels.h"
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <vector>
 
 #include <math.h>
 #include <float.h>
 
 #include <wx/intl.h>
+#include <wx/thread.h>
 #include <wx/valgen.h>
 
 #include "../ShuttleGui.h"
-#include "../FFT.h"
 #include "../widgets/valnum.h"
 #include "../Prefs.h"
 
@@ -38,40 +42,6 @@
 Param( Amount, float,   XO("Stretch Factor"),   10.0,    1.0,     FLT_MAX, 1   );
 Param( Time,   float,   XO("Time Resolution"),  0.25f,   0.00099f,  FLT_MAX, 1   );
 
-class PaulStretch
-{
-public:
-   PaulStretch(float rap_,int in_bufsize_,float samplerate_);
-   //in_bufsize is also a half of a FFT buffer (in samples)
-   virtual ~PaulStretch();
-
-   void process(float *smps,int nsmps);
-
-   int in_bufsize;
-   int poolsize;//how many samples are inside the input_pool size (need to know how many samples to fill when seeking)
-
-   int out_bufsize;
-   float *out_buf;
-
-   int get_nsamples();//how many samples are required to be added in the pool next time
-   int get_nsamples_for_fill();//how many samples are required to be added for a complete buffer refill (at start of the song or after seek)
-
-   void set_rap(float newrap);//set the current stretch value
-
-protected:
-   void process_spectrum(float *WXUNUSED(freq)) {};
-   float samplerate;
-
-private:
-   float *in_pool;//de marimea in_bufsize
-   float rap;
-   float *old_out_smp_buf;
-
-   float *fft_smps,*fft_c,*fft_s,*fft_freq,*fft_tmp;
-
-   double remained_samples;//how many fraction of samples has remained (0..1)
-};
-
 //
 // EffectPaulstretch
 //
@@ -155,18 +125,21 @@ bool EffectPaulstretch::Process()
    m_t1=mT1;
    int count=0;
    while (track) {
-      double trackStart = track->GetStartTime();
-      double trackEnd = track->GetEndTime();
-      double t0 = mT0 < trackStart? trackStart: mT0;
-      double t1 = mT1 > trackEnd? trackEnd: mT1;
+      // Both channels of a stereo track are stretched together
+      std::vector<WaveTrack*> tracks{ track };
+      WaveTrack *partner = track->GetLinked() ? (WaveTrack *) track->GetLink() : NULL;
+      if (partner && partner->GetSelected())
+         tracks.push_back(partner);
 
-      if (t1 > t0) {
-         if (!ProcessOne(track, t0,t1,count))
-            return false;
-      }
+      if (!ProcessOne(tracks, count))
+         return false;
 
       track = (WaveTrack *) iter.Next();
       count++;
+      if (track && track == partner) {
+         track = (WaveTrack *) iter.Next();
+         count++;
+      }
    }
    mT1=m_t1;
 
@@ -233,15 +206,8 @@ int EffectPaulstretch::GetBufferSize(double rate)
    return std::max<int>((int)tmp, 128);
 }
 
-bool EffectPaulstretch::ProcessOne(WaveTrack *track,double t0,double t1,int count)
+bool EffectPaulstretch::CheckLength(WaveTrack *track, sampleCount len, int stretch_buf_size)
 {
-   int stretch_buf_size = GetBufferSize(track->GetRate());
-   double amount = this->mAmount;
-
-   sampleCount start = track->TimeToLongSamples(t0);
-   sampleCount end = track->TimeToLongSamples(t1);
-   sampleCount len = (sampleCount)(end - start);
-
    int minDuration = stretch_buf_size * 2 + 1;
    if (len < minDuration){   //error because the selection is too short
 
@@ -283,221 +249,259 @@ bool EffectPaulstretch::ProcessOne(WaveTrack *track,double t0,double t1,int coun
 
       return false;
    }
+   return true;
+}
 
+namespace {
 
-   double adjust_amount=(double)len/((double)len-((double)stretch_buf_size*2.0));
-   amount=1.0+(amount-1.0)*adjust_amount;
-
-   auto outputTrack = mFactory->NewWaveTrack(track->GetSampleFormat(),track->GetRate());
-
-   PaulStretch stretch(amount,stretch_buf_size,track->GetRate());
-
-   sampleCount nget=stretch.get_nsamples_for_fill();
-
-   int bufsize=stretch.poolsize;
-   float *buffer0=new float[bufsize];
-   float *bufferptr0=buffer0;
-   sampleCount outs=0;
-   bool first_time=true;
-
-   int fade_len=100;
-   if (fade_len>(bufsize/2-1)) fade_len=bufsize/2-1;
-   float *fade_track_smps=new float[fade_len];
-   sampleCount s=0;
-   bool cancelled=false;
-
-   while (s<len){
-      track->Get((samplePtr)bufferptr0,floatSample,start+s,nget);
-      stretch.process(buffer0,nget);
-
-      if (first_time) {
-         stretch.process(buffer0,0);
-      };
-
-      outs+=stretch.out_bufsize;
-      s+=nget;
-
-      if (first_time){//blend the the start of the selection
-         track->Get((samplePtr)fade_track_smps,floatSample,start,fade_len);
-         first_time=false;
-         for (int i=0;i<fade_len;i++){
-            float fi=(float)i/(float)fade_len;
-            stretch.out_buf[i]=stretch.out_buf[i]*fi+(1.0-fi)*fade_track_smps[i];
-         };
-      };
-      if (s>=len){//blend the end of the selection
-         track->Get((samplePtr)fade_track_smps,floatSample,end-fade_len,fade_len);
-         for (int i=0;i<fade_len;i++){
-            float fi=(float)i/(float)fade_len;
-            int i2=bufsize/2-1-i;
-            stretch.out_buf[i2]=stretch.out_buf[i2]*fi+(1.0-fi)*fade_track_smps[fade_len-1-i];
-         };
-      };
-
-      outputTrack->Append((samplePtr)stretch.out_buf,floatSample,stretch.out_bufsize);
-
-      nget=stretch.get_nsamples();
-      if (TrackProgress(count, (s / (double) len))) {
-         cancelled=true;
-         break;
-      };
-   };
-
-   delete [] fade_track_smps;
-   outputTrack->Flush();
-
-   track->Clear(t0,t1);
-   bool success = track->Paste(t0, outputTrack.get());
-   if (!cancelled && success){
-      m_t1 = mT0 + outputTrack->GetEndTime();
+class PaulstretchThread final : public wxThread
+{
+public:
+   PaulstretchThread(const std::function<void()> &work)
+      : wxThread(wxTHREAD_JOINABLE)
+      , mWork(work)
+   {
    }
 
-   delete []buffer0;
+   ExitCode Entry() override
+   {
+      mWork();
+      return 0;
+   }
 
-   return !cancelled;
+private:
+   std::function<void()> mWork;
 };
 
-/*************************************************************/
-
-
-PaulStretch::PaulStretch(float rap_,int in_bufsize_,float samplerate_)
-{
-   samplerate=samplerate_;
-   rap=rap_;
-   in_bufsize=in_bufsize_;
-   if (rap<1.0) rap=1.0;
-   out_bufsize=in_bufsize;
-   if (out_bufsize<8) out_bufsize=8;
-
-   out_buf=new float[out_bufsize];
-   old_out_smp_buf=new float[out_bufsize*2];for (int i=0;i<out_bufsize*2;i++) old_out_smp_buf[i]=0.0;
-
-   poolsize=in_bufsize_*2;
-   in_pool=new float[poolsize];for (int i=0;i<poolsize;i++) in_pool[i]=0.0;
-
-   remained_samples=0.0;
-
-   fft_smps=new float[poolsize];
-   fft_s=new float[poolsize];
-   fft_c=new float[poolsize];
-   fft_freq=new float[poolsize];
-   fft_tmp=new float[poolsize];
-   for (int i=0;i<poolsize;i++) {
-      fft_smps[i]=0.0;
-      fft_c[i]=0.0;
-      fft_s[i]=0.0;
-      fft_freq[i]=0.0;
-   }
 }
 
-PaulStretch::~PaulStretch()
+// One channel being stretched.  Windows are planned in the order that
+// PaulStretch used to make them when fed sample by sample: the first pool
+// is made twice, and only the second one gives output.
+struct EffectPaulstretch::Channel
 {
-   delete [] out_buf;
-   delete [] old_out_smp_buf;
-   delete [] in_pool;
-   delete [] fft_smps;
-   delete [] fft_c;
-   delete [] fft_s;
-   delete [] fft_freq;
-   delete [] fft_tmp;
-}
+   WaveTrack *track;
+   double t0, t1;
+   sampleCount start, end, len;
+   std::unique_ptr<PaulStretch> stretch;
+   WaveTrack::Holder output;
+
+   sampleCount s;          // samples of the selection put in the pool
+   sampleCount windows;    // windows planned so far
+   bool done;
+
+   // Input for the windows of this batch, and its place in the track
+   std::vector<float> input;
+   sampleCount inputStart;
+};
 
-void PaulStretch::set_rap(float newrap)
+// A window to compute, and how to use it
+struct EffectPaulstretch::WindowJob
 {
-   if (rap>=1.0) rap=newrap;
-   else rap=1.0;
-}
+   Channel *channel;
+   unsigned seed;
+   sampleCount poolEnd;    // relative to the channel's start
+   bool emits;             // false only for the first window of a channel
+   bool first, last;       // the first and last output, to blend
+   std::vector<float> smps;
+};
 
-void PaulStretch::process(float *smps,int nsmps)
+bool EffectPaulstretch::ProcessOne(const std::vector<WaveTrack*> &tracks, int count)
 {
-   //add NEW samples to the pool
-   if ((smps!=NULL)&&(nsmps!=0)){
-      if (nsmps>poolsize){
-         nsmps=poolsize;
-      }
-      int nleft=poolsize-nsmps;
+   std::vector<std::unique_ptr<Channel>> channels;
 
-      //move left the samples from the pool to make room for NEW samples
-      for (int i=0;i<nleft;i++) in_pool[i]=in_pool[i+nsmps];
-
-      //add NEW samples to the pool
-      for (int i=0;i<nsmps;i++) in_pool[i+nleft]=smps[i];
-   }
+   for (const auto track : tracks)
+   {
+      auto channel = std::make_unique<Channel>();
+      channel->track = track;
 
-   //get the samples from the pool
-   for (int i=0;i<poolsize;i++) fft_smps[i]=in_pool[i];
-   WindowFunc(3,poolsize,fft_smps);
+      double trackStart = track->GetStartTime();
+      double trackEnd = track->GetEndTime();
+      channel->t0 = mT0 < trackStart? trackStart: mT0;
+      channel->t1 = mT1 > trackEnd? trackEnd: mT1;
+      if (channel->t1 <= channel->t0)
+         continue;
 
-   RealFFT(poolsize,fft_smps,fft_c,fft_s);
+      int stretch_buf_size = GetBufferSize(track->GetRate());
+      double amount = this->mAmount;
 
-   for (int i=0;i<poolsize/2;i++) fft_freq[i]=sqrt(fft_c[i]*fft_c[i]+fft_s[i]*fft_s[i]);
-   process_spectrum(fft_freq);
+      channel->start = track->TimeToLongSamples(channel->t0);
+      channel->end = track->TimeToLongSamples(channel->t1);
+      channel->len = (sampleCount)(channel->end - channel->start);
 
+      if (!CheckLength(track, channel->len, stretch_buf_size))
+         return false;
 
-   //put randomize phases to frequencies and do a IFFT
-   float inv_2p15_2pi=1.0/16384.0*(float)M_PI;
-   for (int i=1;i<poolsize/2;i++){
-      unsigned int random=(rand())&0x7fff;
-      float phase=random*inv_2p15_2pi;
-      float s=fft_freq[i]*sin(phase);
-      float c=fft_freq[i]*cos(phase);
+      double adjust_amount=(double)channel->len/((double)channel->len-((double)stretch_buf_size*2.0));
+      amount=1.0+(amount-1.0)*adjust_amount;
 
-      fft_c[i]=fft_c[poolsize-i]=c;
+      channel->stretch = std::make_unique<PaulStretch>(amount,stretch_buf_size,track->GetRate());
+      channel->output = mFactory->NewWaveTrack(track->GetSampleFormat(),track->GetRate());
+      channel->s = 0;
+      channel->windows = 0;
+      channel->done = false;
 
-      fft_s[i]=s;fft_s[poolsize-i]=-s;
+      channels.push_back(std::move(channel));
    }
-   fft_c[0]=fft_s[0]=0.0;
-   fft_c[poolsize/2]=fft_s[poolsize/2]=0.0;
 
-   FFT(poolsize,true,fft_c,fft_s,fft_smps,fft_tmp);
+   if (channels.empty())
+      return true;
 
-   float max=0.0,max2=0.0;
-   for (int i=0;i<poolsize;i++){
-      float a=fabs(fft_tmp[i]);
-      if (a>max) max=a;
-      float b=fabs(fft_smps[i]);
-      if (b>max2) max2=b;
-   }
+   // Windows of every channel are computed together, a batch at a time, as
+   // many at once as there are processors.  A batch is kept small enough
+   // that cancelling is prompt and memory is bounded.
+   const int numCPUs = std::max(1, wxThread::GetCPUCount());
+   size_t poolBytes = 0;
+   for (const auto &channel : channels)
+      poolBytes = std::max<size_t>(poolBytes, channel->stretch->poolsize * sizeof(float));
+   const size_t perChannel = std::max<size_t>(1,
+      std::min<size_t>(numCPUs * 4, (32 << 20) / (poolBytes * channels.size())));
 
+   bool cancelled=false;
+   std::vector<WindowJob> batch;
+   while (!cancelled)
+   {
+      // Plan the windows
+      batch.clear();
+      for (int c = 0; c < (int)channels.size(); c++)
+      {
+         Channel &channel = *channels[c];
+         PaulStretch &stretch = *channel.stretch;
+         for (size_t w = 0; w < perChannel && !channel.done; w++)
+         {
+            WindowJob window;
+            window.channel = &channel;
+            window.seed = PaulStretch::WindowSeed(count + c, channel.windows);
+            window.emits = channel.windows > 0;
+            window.first = channel.windows == 1;
+            if (channel.windows == 0)
+               channel.s = stretch.get_nsamples_for_fill();
+            else if (channel.windows > 1)
+               channel.s += stretch.get_nsamples();
+            window.poolEnd = channel.s;
+            window.last = window.emits && channel.s >= channel.len;
+            channel.done = window.last;
+            channel.windows++;
+            batch.push_back(std::move(window));
+         }
+      }
 
-   //make the output buffer
-   float tmp=1.0/(float) out_bufsize*M_PI;
-   float hinv_sqrt2=0.853553390593f;//(1.0+1.0/sqrt(2))*0.5;
+      if (batch.empty())
+         break;
 
-   float ampfactor=1.0;
-   if (rap<1.0) ampfactor=rap*0.707;
-   else ampfactor=(out_bufsize/(float)poolsize)*4.0;
+      // Read the input the channel's windows need, all at once, as their
+      // pools overlap
+      for (const auto &channel : channels)
+      {
+         const PaulStretch &stretch = *channel->stretch;
+         sampleCount first = -1, last = 0;
+         for (const auto &window : batch)
+         {
+            if (window.channel != channel.get())
+               continue;
+            if (first < 0)
+               first = window.poolEnd - stretch.poolsize;
+            last = window.poolEnd;
+         }
+         if (first < 0)
+            continue;
 
-   for (int i=0;i<out_bufsize;i++) {
-      float a=(0.5+0.5*cos(i*tmp));
-      float out=fft_smps[i+out_bufsize]*(1.0-a)+old_out_smp_buf[i]*a;
-      out_buf[i]=out*(hinv_sqrt2-(1.0-hinv_sqrt2)*cos(i*2.0*tmp))*ampfactor;
-   }
+         channel->inputStart = channel->start + first;
+         channel->input.resize(last - first);
+         channel->track->Get((samplePtr)&channel->input[0], floatSample,
+                             channel->inputStart, last - first);
+      }
 
-   //copy the current output buffer to old buffer
-   for (int i=0;i<out_bufsize*2;i++) old_out_smp_buf[i]=fft_smps[i];
-}
+      // Compute the windows.  FFT() builds its tables on first use, so
+      // the first window is done here before any thread starts.
+      auto compute = [](WindowJob &window, PaulStretch::Scratch &scratch) {
+         const Channel &channel = *window.channel;
+         const PaulStretch &stretch = *channel.stretch;
+         const sampleCount poolStart = channel.start + window.poolEnd - stretch.poolsize;
+         window.smps.resize(stretch.poolsize);
+         stretch.process_window(&channel.input[poolStart - channel.inputStart],
+                                window.seed, &window.smps[0], scratch);
+      };
+      std::atomic<size_t> next { 0 };
+      auto work = [&]() {
+         PaulStretch::Scratch scratch;
+         size_t w;
+         while ((w = next++) < batch.size())
+            compute(batch[w], scratch);
+      };
 
-int PaulStretch::get_nsamples()
-{
-   double r=out_bufsize/rap;
-   int ri=(int)floor(r);
-   double rf=r-floor(r);
-
-   remained_samples+=rf;
-   if (remained_samples>=1.0){
-      ri+=(int)floor(remained_samples);
-      remained_samples=remained_samples-floor(remained_samples);
-   }
+      {
+         PaulStretch::Scratch scratch;
+         compute(batch[next++], scratch);
+      }
 
-   if (ri>poolsize){
-      ri=poolsize;
-   }
+      const size_t numThreads =
+         std::min<size_t>(numCPUs - 1, batch.size() - 1);
+      std::vector<std::unique_ptr<PaulstretchThread>> threads;
+      for (size_t t = 0; t < numThreads; t++)
+      {
+         auto thread = std::make_unique<PaulstretchThread>(work);
+         if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR)
+            break;
+         threads.push_back(std::move(thread));
+      }
+      work();
+      for (const auto &thread : threads)
+         thread->Wait();
+
+      // Overlap the windows in order, and append the output
+      for (auto &window : batch)
+      {
+         Channel &channel = *window.channel;
+         PaulStretch &stretch = *channel.stretch;
+         stretch.add_window(&window.smps[0]);
+         window.smps = std::vector<float>();
+         if (!window.emits)
+            continue;
+
+         int bufsize = stretch.poolsize;
+         int fade_len=100;
+         if (fade_len>(bufsize/2-1)) fade_len=bufsize/2-1;
+         std::vector<float> fade_track_smps(fade_len);
+
+         if (window.first){//blend the the start of the selection
+            channel.track->Get((samplePtr)&fade_track_smps[0],floatSample,channel.start,fade_len);
+            for (int i=0;i<fade_len;i++){
+               float fi=(float)i/(float)fade_len;
+               stretch.out_buf[i]=stretch.out_buf[i]*fi+(1.0-fi)*fade_track_smps[i];
+            };
+         };
+         if (window.last){//blend the end of the selection
+            channel.track->Get((samplePtr)&fade_track_smps[0],floatSample,channel.end-fade_len,fade_len);
+            for (int i=0;i<fade_len;i++){
+               float fi=(float)i/(float)fade_len;
+               int i2=bufsize/2-1-i;
+               stretch.out_buf[i2]=stretch.out_buf[i2]*fi+(1.0-fi)*fade_track_smps[fade_len-1-i];
+            };
+         };
 
-   return ri;
-}
+         channel.output->Append((samplePtr)stretch.out_buf,floatSample,stretch.out_bufsize);
+      }
 
-int PaulStretch::get_nsamples_for_fill()
-{
-   return poolsize;
-}
+      double frac = 0;
+      for (const auto &channel : channels)
+         frac += std::min(1.0, channel->s / (double) channel->len);
+      if (TrackProgress(count, frac / channels.size())) {
+         cancelled=true;
+         break;
+      };
+   };
+
+   for (const auto &channel : channels)
+   {
+      channel->output->Flush();
+
+      channel->track->Clear(channel->t0,channel->t1);
+      bool success = channel->track->Paste(channel->t0, channel->output.get());
+      if (!cancelled && success){
+         m_t1 = mT0 + channel->output->GetEndTime();
+      }
+   }
+
+   return !cancelled;
+};
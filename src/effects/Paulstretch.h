@@ -10,6 +10,7 @@
 #ifndef __AUDACITY_EFFECT_PAULSTRETCH__
 #define __AUDACITY_EFFECT_PAULSTRETCH__
 
+#include <vector>
 #include <wx/string.h>
 
 #include "Effect.h"
@@ -52,7 +53,11 @@ private:
    void OnText(wxCommandEvent & evt);
    int GetBufferSize(double rate);
 
-   bool ProcessOne(WaveTrack *track, double t0, double t1, int count);
+   struct Channel;
+   struct WindowJob;
+
+   bool CheckLength(WaveTrack *track, sampleCount len, int stretch_buf_size);
+   bool ProcessOne(const std::vector<WaveTrack*> &tracks, int count);
 
 private:
    float mAmount;
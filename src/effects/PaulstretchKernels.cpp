@@ -0,0 +1,147 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PaulstretchKernels.cpp
+
+  Nasca Octavian Paul (Paul Nasca)
+
+*******************************************************************//**
+
+\file PaulstretchKernels.cpp
+\brief The stretching at the heart of EffectPaulstretch.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "PaulstretchKernels.h"
+
+#include <random>
+
+#include <math.h>
+
+#include "../FFT.h"
+
+PaulStretch::PaulStretch(float rap_,int in_bufsize_,float samplerate_)
+{
+   samplerate=samplerate_;
+   rap=rap_;
+   in_bufsize=in_bufsize_;
+   if (rap<1.0) rap=1.0;
+   out_bufsize=in_bufsize;
+   if (out_bufsize<8) out_bufsize=8;
+
+   out_buf=new float[out_bufsize];
+   old_out_smp_buf=new float[out_bufsize*2];for (int i=0;i<out_bufsize*2;i++) old_out_smp_buf[i]=0.0;
+
+   poolsize=in_bufsize_*2;
+
+   remained_samples=0.0;
+}
+
+PaulStretch::~PaulStretch()
+{
+   delete [] out_buf;
+   delete [] old_out_smp_buf;
+}
+
+void PaulStretch::set_rap(float newrap)
+{
+   if (rap>=1.0) rap=newrap;
+   else rap=1.0;
+}
+
+unsigned PaulStretch::WindowSeed(int channel, sampleCount window)
+{
+   // std::minstd_rand has a state for each of 1 to 2^31 - 2, and
+   // multiplying by a constant modulo 2^31 - 1 maps those onto themselves,
+   // scattering neighbouring windows' seeds
+   const unsigned long long key =
+      ((unsigned long long)(channel % 255) << 23 | (window & 0x7FFFFF)) + 1;
+   return (unsigned)(key * 1103515245ull % 2147483647ull);
+}
+
+void PaulStretch::process_window(const float *pool, unsigned seed, float *window,
+                                 Scratch &scratch) const
+{
+   if ((int)scratch.c.size()<poolsize){
+      scratch.c.resize(poolsize);
+      scratch.s.resize(poolsize);
+      scratch.freq.resize(poolsize);
+      scratch.tmp.resize(poolsize);
+   }
+   float *fft_c=&scratch.c[0];
+   float *fft_s=&scratch.s[0];
+   float *fft_freq=&scratch.freq[0];
+   float *fft_tmp=&scratch.tmp[0];
+
+   //get the samples from the pool
+   for (int i=0;i<poolsize;i++) window[i]=pool[i];
+   WindowFunc(3,poolsize,window);
+
+   RealFFT(poolsize,window,fft_c,fft_s);
+
+   for (int i=0;i<poolsize/2;i++) fft_freq[i]=sqrt(fft_c[i]*fft_c[i]+fft_s[i]*fft_s[i]);
+
+   //put randomize phases to frequencies and do a IFFT
+   std::minstd_rand generator(seed);
+   float inv_2p15_2pi=1.0/16384.0*(float)M_PI;
+   for (int i=1;i<poolsize/2;i++){
+      unsigned int random=(generator()>>8)&0x7fff;
+      float phase=random*inv_2p15_2pi;
+      float s=fft_freq[i]*sin(phase);
+      float c=fft_freq[i]*cos(phase);
+
+      fft_c[i]=fft_c[poolsize-i]=c;
+
+      fft_s[i]=s;fft_s[poolsize-i]=-s;
+   }
+   fft_c[0]=fft_s[0]=0.0;
+   fft_c[poolsize/2]=fft_s[poolsize/2]=0.0;
+
+   FFT(poolsize,true,fft_c,fft_s,window,fft_tmp);
+}
+
+void PaulStretch::add_window(const float *window)
+{
+   //make the output buffer
+   float tmp=1.0/(float) out_bufsize*M_PI;
+   float hinv_sqrt2=0.853553390593f;//(1.0+1.0/sqrt(2))*0.5;
+
+   float ampfactor=1.0;
+   if (rap<1.0) ampfactor=rap*0.707;
+   else ampfactor=(out_bufsize/(float)poolsize)*4.0;
+
+   for (int i=0;i<out_bufsize;i++) {
+      float a=(0.5+0.5*cos(i*tmp));
+      float out=window[i+out_bufsize]*(1.0-a)+old_out_smp_buf[i]*a;
+      out_buf[i]=out*(hinv_sqrt2-(1.0-hinv_sqrt2)*cos(i*2.0*tmp))*ampfactor;
+   }
+
+   //copy the current output buffer to old buffer
+   for (int i=0;i<out_bufsize*2;i++) old_out_smp_buf[i]=window[i];
+}
+
+int PaulStretch::get_nsamples()
+{
+   double r=out_bufsize/rap;
+   int ri=(int)floor(r);
+   double rf=r-floor(r);
+
+   remained_samples+=rf;
+   if (remained_samples>=1.0){
+      ri+=(int)floor(remained_samples);
+      remained_samples=remained_samples-floor(remained_samples);
+   }
+
+   if (ri>poolsize){
+      ri=poolsize;
+   }
+
+   return ri;
+}
+
+int PaulStretch::get_nsamples_for_fill()
+{
+   return poolsize;
+}
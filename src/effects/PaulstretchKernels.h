@@ -0,0 +1,77 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PaulstretchKernels.h
+
+  Nasca Octavian Paul (Paul Nasca)
+
+*******************************************************************//**
+
+\class PaulStretch
+\brief The stretching at the heart of EffectPaulstretch.
+
+Each window of output is the spectrum of a pool of input with its phases
+randomised.  The phases come from a seed given with the pool, so windows
+can be computed in any order, on any thread, and always come out the
+same; only overlapping them, with add_window(), must be done in order.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_PAULSTRETCH_KERNELS__
+#define __AUDACITY_PAULSTRETCH_KERNELS__
+
+#include <vector>
+
+#include "audacity/Types.h"
+
+class PaulStretch
+{
+public:
+   PaulStretch(float rap_,int in_bufsize_,float samplerate_);
+   //in_bufsize is also a half of a FFT buffer (in samples)
+   virtual ~PaulStretch();
+
+   // Working space for computing windows, one per thread
+   struct Scratch
+   {
+      std::vector<float> c, s, freq, tmp;
+   };
+
+   // Seeds the random phases of each window from its place alone.
+   // channel counts the channels of the whole selection, so that no two
+   // tracks have the same phases.  Seeds differ for up to 255 channels of
+   // 2^23 windows each, and only repeat beyond that.
+   static unsigned WindowSeed(int channel, sampleCount window);
+
+   // Computes the window for the poolsize input samples at pool: their
+   // spectrum, with the phases randomised from seed, transformed back.
+   // It changes nothing, so windows can be computed on several threads.
+   void process_window(const float *pool, unsigned seed, float *window,
+                       Scratch &scratch) const;
+
+   // Overlaps the window with the one before it, making out_buf
+   void add_window(const float *window);
+
+   int in_bufsize;
+   int poolsize;//how many samples are inside the input_pool size (need to know how many samples to fill when seeking)
+
+   int out_bufsize;
+   float *out_buf;
+
+   int get_nsamples();//how many samples are required to be added in the pool next time
+   int get_nsamples_for_fill();//how many samples are required to be added for a complete buffer refill (at start of the song or after seek)
+
+   void set_rap(float newrap);//set the current stretch value
+
+protected:
+   float samplerate;
+
+private:
+   float rap;
+   float *old_out_smp_buf;
+
+   double remained_samples;//how many fraction of samples has remained (0..1)
+};
+
+#endif
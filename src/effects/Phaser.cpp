@@ -358,15 +358,12 @@ void EffectPhaser::InstanceInit(EffectPhaserState & data, float sampleRate)
 {
    data.samplerate = sampleRate;
 
-   for (int j = 0; j < mStages; j++)
-   {
-      data.old[j] = 0;
-   }
+   data.filter.SetStageCount(0);
+   data.filter.SetStageCount(mStages);
 
    data.skipcount = 0;
    data.gain = 0;
    data.fbout = 0;
-   data.laststages = 0;
    data.outgain = 0;
 
    return;
@@ -377,44 +374,65 @@ sampleCount EffectPhaser::InstanceProcess(EffectPhaserState & data, float **inBl
    float *ibuf = inBlock[0];
    float *obuf = outBlock[0];
 
-   for (int j = data.laststages; j < mStages; j++)
-   {
-      data.old[j] = 0;
-   }
-   data.laststages = mStages;
+   // Stages that are added start from silence
+   data.filter.SetStageCount(mStages);
 
    data.lfoskip = mFreq * 2 * M_PI / data.samplerate;
    data.phase = mPhase * M_PI / 180;
    data.outgain = DB_TO_LINEAR(mOutGain);
 
-   for (sampleCount i = 0; i < blockLen; i++)
+   for (sampleCount i = 0; i < blockLen; )
    {
-      double in = ibuf[i];
-
-      double m = in + data.fbout * mFeedback / 101;  // Feedback must be less than 100% to avoid infinite gain.
-
-      if (((data.skipcount++) % lfoskipsamples) == 0)
+      if (data.skipcount % lfoskipsamples == 0)
       {
          //compute sine between 0 and 1
-         data.gain = (1.0 + cos(data.skipcount * data.lfoskip + data.phase)) / 2.0;
+         data.gain = (1.0 + cos((data.skipcount + 1) * data.lfoskip + data.phase)) / 2.0;
 
          // change lfo shape
          data.gain = expm1(data.gain * phaserlfoshape) / expm1(phaserlfoshape);
 
          // attenuate the lfo
          data.gain = 1.0 - data.gain / 255.0 * mDepth;
+
+         // phasing routine: each stage is (-gain + z^-1) / (1 - gain z^-1)
+         for (int j = 0; j < mStages; j++)
+         {
+            data.filter.SetStage(j, -data.gain, 1, 0, -data.gain, 0);
+         }
+      }
+
+      // Up to the next change of the coefficients
+      sampleCount len = lfoskipsamples - data.skipcount % lfoskipsamples;
+      if (len > blockLen - i)
+      {
+         len = blockLen - i;
+      }
+
+      float wet[lfoskipsamples];
+      if (mFeedback == 0)
+      {
+         // Without feedback, the stages can take the samples as a block
+         data.filter.Process(ibuf + i, wet, len);
+         data.fbout = wet[len - 1];
+      }
+      else
+      {
+         for (sampleCount j = 0; j < len; j++)
+         {
+            double m = ibuf[i + j] + data.fbout * mFeedback / 101;  // Feedback must be less than 100% to avoid infinite gain.
+            wet[j] = data.filter.ProcessSample((float) m);
+            data.fbout = wet[j];
+         }
       }
 
-      // phasing routine
-      for (int j = 0; j < mStages; j++)
+      for (sampleCount j = 0; j < len; j++)
       {
-         double tmp = data.old[j];
-         data.old[j] = data.gain * tmp + m;
-         m = tmp - data.gain * data.old[j];
+         double in = ibuf[i + j];
+         obuf[i + j] = (float) (data.outgain * (wet[j] * mDryWet + in * (255 - mDryWet)) / 255);
       }
-      data.fbout = m;
 
-      obuf[i] = (float) (data.outgain * (m * mDryWet + in * (255 - mDryWet)) / 255);
+      data.skipcount += len;
+      i += len;
    }
 
    return blockLen;
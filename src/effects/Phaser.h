@@ -21,6 +21,7 @@
 #include <wx/string.h>
 #include <wx/textctrl.h>
 
+#include "Biquad.h"
 #include "Effect.h"
 
 class ShuttleGui;
@@ -35,13 +36,12 @@ public:
    // state variables
    float samplerate;
    sampleCount skipcount;
-   double old[NUM_STAGES]; // must be as large as MAX_STAGES
+   BiquadCascade filter;   // a first order allpass section per stage
    double gain;
    double fbout;
    double outgain;
    double lfoskip;
    double phase;
-   int laststages;
 };
 
 WX_DECLARE_OBJARRAY(EffectPhaserState, EffectPhaserStateArray);
@@ -17,14 +17,28 @@
 #include "../Audacity.h"
 #include "Reverb.h"
 
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
 #include <wx/arrstr.h>
+#include <wx/file.h>
+#include <wx/filename.h>
 #include <wx/intl.h>
+#include <wx/msgdlg.h>
+#include <wx/thread.h>
+
+#include "sndfile.h"
 
 #include "../Audacity.h"
+#include "../FileFormats.h"
 #include "../Prefs.h"
+#include "../Resample.h"
 #include "../ShuttleGui.h"
 #include "../widgets/valnum.h"
+#include "../lib-src/FileDialog/FileDialog.h"
 
+#include "Convolver.h"
 #include "Reverb_libSoX.h"
 
 enum 
@@ -38,7 +52,10 @@ enum
    ID_WetGain,
    ID_DryGain,
    ID_StereoWidth,
-   ID_WetOnly
+   ID_WetOnly,
+   ID_Convolve,
+   ID_ImpulseFile,
+   ID_Browse
 };
 
 // Define keys, defaults, minimums, and maximums for the effect parameters
@@ -54,6 +71,8 @@ Param( WetGain,      double,  XO("WetGain"),       -1,      -20,     10,   1  );
 Param( DryGain,      double,  XO("DryGain"),       -1,      -20,     10,   1  );
 Param( StereoWidth,  double,  XO("StereoWidth"),   100,     0,       100,  1  );
 Param( WetOnly,      bool,    XO("WetOnly"),       false,   false,   true, 1  );
+Param( Convolve,     bool,    XO("Convolve"),      false,   false,   true, 1  );
+Param( ImpulseFile,  wxString, XO("ImpulseFile"),  wxT(""), wxT(""), wxT(""), wxT(""));
 
 static const struct
 {
@@ -82,6 +101,113 @@ struct Reverb_priv_t
    float *wet[2];
 };
 
+// Convolution blocks, which are also the latency.  Offline the latency
+// is taken out again, so only the cost matters; in realtime it is heard.
+#define CONVOLVE_BLOCK 4096
+#define CONVOLVE_REALTIME_BLOCK 512
+
+// Threads for the tails, however many tracks and channels there are
+#define CONVOLVE_MAX_THREADS 4
+
+#define BLOCK 16384
+
+// Longer impulse responses are cut short
+#define MAX_IMPULSE_SECONDS 30
+
+// The reverb of one track: the algorithmic one, per channel, or the
+// convolution one, per channel
+class EffectReverbState
+{
+public:
+   EffectReverbState()
+   {
+      numChans = 0;
+      sampleRate = 0.0;
+      p = NULL;
+   }
+
+   ~EffectReverbState()
+   {
+      DeleteReverb();
+   }
+
+   void CreateReverb(const EffectReverb::Params & newParams)
+   {
+      params = newParams;
+      p = (Reverb_priv_t *) calloc(sizeof(*p), numChans);
+
+      for (int i = 0; i < numChans; i++)
+      {
+         reverb_create(&p[i].reverb,
+                       sampleRate,
+                       params.mWetGain,
+                       params.mRoomSize,
+                       params.mReverberance,
+                       params.mHfDamping,
+                       params.mPreDelay,
+                       params.mStereoWidth * (numChans == 2 ? 1 : 0),
+                       params.mToneLow,
+                       params.mToneHigh,
+                       BLOCK,
+                       p[i].wet);
+      }
+   }
+
+   // Follows the sliders while it plays in realtime; only the settings
+   // that size the buffers start it over
+   void UpdateReverb(const EffectReverb::Params & newParams)
+   {
+      if (newParams.mRoomSize != params.mRoomSize ||
+          newParams.mPreDelay != params.mPreDelay ||
+          newParams.mStereoWidth != params.mStereoWidth)
+      {
+         DeleteReverb();
+         CreateReverb(newParams);
+         return;
+      }
+
+      if (newParams.mWetGain != params.mWetGain ||
+          newParams.mReverberance != params.mReverberance ||
+          newParams.mHfDamping != params.mHfDamping ||
+          newParams.mToneLow != params.mToneLow ||
+          newParams.mToneHigh != params.mToneHigh)
+      {
+         for (int i = 0; i < numChans; i++)
+         {
+            reverb_set(&p[i].reverb,
+                       sampleRate,
+                       newParams.mWetGain,
+                       newParams.mReverberance,
+                       newParams.mHfDamping,
+                       newParams.mToneLow,
+                       newParams.mToneHigh);
+         }
+      }
+
+      params = newParams;
+   }
+
+   void DeleteReverb()
+   {
+      if (p)
+      {
+         for (int i = 0; i < numChans; i++)
+         {
+            reverb_delete(&p[i].reverb);
+         }
+
+         free(p);
+         p = NULL;
+      }
+   }
+
+   int numChans;
+   double sampleRate;
+   EffectReverb::Params params;   // that the reverb was made with
+   Reverb_priv_t *p;
+   std::unique_ptr<PartitionedConvolver> convolvers[2];
+};
+
 //
 // EffectReverb
 //
@@ -104,6 +230,9 @@ BEGIN_EVENT_TABLE(EffectReverb, wxEvtHandler)
 
 #undef SpinSliderEvent 
 
+   EVT_CHECKBOX(ID_Convolve, EffectReverb::OnConvolve)
+   EVT_BUTTON(ID_Browse, EffectReverb::OnBrowse)
+
 END_EVENT_TABLE()
 
 EffectReverb::EffectReverb()
@@ -119,6 +248,10 @@ EffectReverb::EffectReverb()
    mParams.mStereoWidth = DEF_StereoWidth;
    mParams.mWetOnly = DEF_WetOnly;
 
+   mConvolve = DEF_Convolve;
+   mImpulseFile = DEF_ImpulseFile;
+
+   mLatencyDone = false;
    mProcessingEvent = false;
 
    SetLinearEffectFlag(true);
@@ -147,6 +280,15 @@ EffectType EffectReverb::GetType()
    return EffectTypeProcess;
 }
 
+bool EffectReverb::SupportsRealtime()
+{
+#if defined(EXPERIMENTAL_REALTIME_AUDACITY_EFFECTS)
+   return true;
+#else
+   return false;
+#endif
+}
+
 // EffectClientInterface implementation
 
 int EffectReverb::GetAudioInCount()
@@ -159,34 +301,36 @@ int EffectReverb::GetAudioOutCount()
    return mParams.mStereoWidth ? 2 : 1;
 }
 
-#define BLOCK 16384
+sampleCount EffectReverb::GetLatency()
+{
+   if (mMaster && mMaster->convolvers[0] && !mLatencyDone)
+   {
+      mLatencyDone = true;
+      return mMaster->convolvers[0]->GetLatency();
+   }
+
+   return 0;
+}
 
 bool EffectReverb::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelNames chanMap)
 {
-   bool isStereo = false;
-   mNumChans = 1;
+   int numChans = 1;
    if (chanMap && chanMap[0] != ChannelNameEOL && chanMap[1] == ChannelNameFrontRight)
    {
-      isStereo = true;
-      mNumChans = 2;
+      numChans = 2;
    }
 
-   mP = (Reverb_priv_t *) calloc(sizeof(*mP), mNumChans);
+   mMaster = std::make_unique<EffectReverbState>();
+   mLatencyDone = false;
 
-   for (int i = 0; i < mNumChans; i++)
+   if (!InstanceInit(*mMaster, numChans, mSampleRate, CONVOLVE_BLOCK))
    {
-      reverb_create(&mP[i].reverb,
-                    mSampleRate,
-                    mParams.mWetGain,
-                    mParams.mRoomSize,
-                    mParams.mReverberance,
-                    mParams.mHfDamping,
-                    mParams.mPreDelay,
-                    mParams.mStereoWidth * (isStereo ? 1 : 0),
-                    mParams.mToneLow,
-                    mParams.mToneHigh,
-                    BLOCK,
-                    mP[i].wet);
+      wxMessageBox(
+         wxString::Format(_("Could not read an impulse response from \"%s\"."),
+                          mImpulseFile.c_str()),
+         GetName(),
+         wxOK | wxICON_ERROR);
+      return false;
    }
 
    return true;
@@ -194,75 +338,58 @@ bool EffectReverb::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelName
 
 bool EffectReverb::ProcessFinalize()
 {
-   for (int i = 0; i < mNumChans; i++)
+   mMaster.reset();
+   if (mSlaves.empty())
    {
-      reverb_delete(&mP[i].reverb);
+      mPool.reset();
    }
 
-   free(mP);
-
    return true;
 }
 
 sampleCount EffectReverb::ProcessBlock(float **inBlock, float **outBlock, sampleCount blockLen)
 {
-   float *ichans[2] = {NULL, NULL};
-   float *ochans[2] = {NULL, NULL};
+   return InstanceProcess(*mMaster, inBlock, outBlock, blockLen);
+}
 
-   for (int c = 0; c < mNumChans; c++)
-   {
-      ichans[c] = inBlock[c];
-      ochans[c] = outBlock[c];
-   }
-   
-   float const dryMult = mParams.mWetOnly ? 0 : dB_to_linear(mParams.mDryGain);
+bool EffectReverb::RealtimeInitialize()
+{
+   SetBlockSize(512);
 
-   sampleCount remaining = blockLen;
+   mSlaves.clear();
 
-   while (remaining)
-   {
-      sampleCount len = wxMin(remaining, BLOCK);
-      for (int c = 0; c < mNumChans; c++)
-      {
-         // Write the input samples to the reverb fifo.  Returned value is the address of the
-         // fifo buffer which contains a copy of the input samples.
-         mP[c].dry = (float *) fifo_write(&mP[c].reverb.input_fifo, len, ichans[c]);
-         reverb_process(&mP[c].reverb, len);
-      }
+   return true;
+}
 
-      if (mNumChans == 2)
-      {
-         for (sampleCount i = 0; i < len; i++)
-         {
-            for (int w = 0; w < 2; w++)
-            {
-               ochans[w][i] = dryMult *
-                              mP[w].dry[i] +
-                              0.5 *
-                              (mP[0].wet[w][i] + mP[1].wet[w][i]);
-            }
-         }
-      }
-      else
-      {
-         for (sampleCount i = 0; i < len; i++)
-         {
-            ochans[0][i] = dryMult * 
-                           mP[0].dry[i] +
-                           mP[0].wet[0][i];
-         }
-      }
+bool EffectReverb::RealtimeAddProcessor(int numChannels, float sampleRate)
+{
+   auto slave = std::make_unique<EffectReverbState>();
 
-      remaining -= len;
+   // Added even if it fails, so the groups still match the slaves
+   bool result = InstanceInit(*slave, std::min(numChannels, 2), sampleRate, CONVOLVE_REALTIME_BLOCK);
 
-      for (int c = 0; c < mNumChans; c++)
-      {
-         ichans[c] += len;
-         ochans[c] += len;
-      }
+   mSlaves.push_back(std::move(slave));
+
+   return result;
+}
+
+bool EffectReverb::RealtimeFinalize()
+{
+   mSlaves.clear();
+   if (!mMaster)
+   {
+      mPool.reset();
    }
 
-   return blockLen;
+   return true;
+}
+
+sampleCount EffectReverb::RealtimeProcess(int group,
+                                          float **inbuf,
+                                          float **outbuf,
+                                          sampleCount numSamples)
+{
+   return InstanceProcess(*mSlaves[group], inbuf, outbuf, numSamples);
 }
 
 bool EffectReverb::GetAutomationParameters(EffectAutomationParameters & parms)
@@ -277,6 +404,8 @@ bool EffectReverb::GetAutomationParameters(EffectAutomationParameters & parms)
    parms.Write(KEY_DryGain, mParams.mDryGain);
    parms.Write(KEY_StereoWidth, mParams.mStereoWidth);
    parms.Write(KEY_WetOnly, mParams.mWetOnly);
+   parms.Write(KEY_Convolve, mConvolve);
+   parms.Write(KEY_ImpulseFile, mImpulseFile);
 
    return true;
 }
@@ -293,6 +422,8 @@ bool EffectReverb::SetAutomationParameters(EffectAutomationParameters & parms)
    ReadAndVerifyDouble(DryGain);
    ReadAndVerifyDouble(StereoWidth);
    ReadAndVerifyBool(WetOnly);
+   ReadAndVerifyBool(Convolve);
+   ReadAndVerifyString(ImpulseFile);
 
    mParams.mRoomSize = RoomSize;
    mParams.mPreDelay = PreDelay;
@@ -304,6 +435,8 @@ bool EffectReverb::SetAutomationParameters(EffectAutomationParameters & parms)
    mParams.mDryGain = DryGain;
    mParams.mStereoWidth = StereoWidth;
    mParams.mWetOnly = WetOnly;
+   mConvolve = Convolve;
+   mImpulseFile = ImpulseFile;
 
    return true;
 }
@@ -329,6 +462,9 @@ bool EffectReverb::LoadFactoryPreset(int id)
 
    mParams = FactoryPresets[id].params;
 
+   // The presets are all rooms of the algorithmic reverb
+   mConvolve = false;
+
    if (mUIDialog)
    {
       TransferDataToWindow();
@@ -441,9 +577,22 @@ void EffectReverb::PopulateOrExchange(ShuttleGui & S)
    {
       mWetOnlyC = S.Id(ID_WetOnly).
          AddCheckBox(_("Wet O&nly"), DEF_WetOnly ? wxT("true") : wxT("false"));
+      mConvolveC = S.Id(ID_Convolve).
+         AddCheckBox(_("Con&volve with an impulse response"), DEF_Convolve ? wxT("true") : wxT("false"));
    }
    S.EndHorizontalLay();
 
+   S.StartMultiColumn(3, wxEXPAND);
+   {
+      S.SetStretchyCol(1);
+
+      mImpulseFileT = S.Id(ID_ImpulseFile).
+         AddTextBox(_("Impulse &file:"), DEF_ImpulseFile, 30);
+      mBrowseB = S.Id(ID_Browse).
+         AddButton(_("Br&owse..."));
+   }
+   S.EndMultiColumn();
+
    return;
 }
 
@@ -466,6 +615,10 @@ bool EffectReverb::TransferDataToWindow()
 #undef SetSpinSlider
 
    mWetOnlyC->SetValue((int) mParams.mWetOnly);
+   mConvolveC->SetValue(mConvolve);
+   mImpulseFileT->SetValue(mImpulseFile);
+
+   UpdateUI();
 
    return true;
 }
@@ -487,6 +640,25 @@ bool EffectReverb::TransferDataFromWindow()
    mParams.mDryGain = mDryGainS->GetValue();
    mParams.mStereoWidth = mStereoWidthS->GetValue();
    mParams.mWetOnly = mWetOnlyC->GetValue();
+   mConvolve = mConvolveC->GetValue();
+   mImpulseFile = mImpulseFileT->GetValue();
+
+   if (mConvolve)
+   {
+      std::vector<float> data;
+      int channels;
+      int rate;
+
+      if (!ReadImpulse(data, channels, rate))
+      {
+         wxMessageBox(
+            wxString::Format(_("Could not read an impulse response from \"%s\"."),
+                             mImpulseFile.c_str()),
+            GetName(),
+            wxOK | wxICON_ERROR);
+         return false;
+      }
+   }
 
    return true;
 }
@@ -519,6 +691,270 @@ SpinSliderHandlers(StereoWidth);
 
 #undef SpinSliderHandlers
 
+// EffectReverb implementation
+
+bool EffectReverb::InstanceInit(EffectReverbState & state, int numChans,
+                                double sampleRate, size_t blockSize)
+{
+   state.numChans = numChans;
+   state.sampleRate = sampleRate;
+
+   if (mConvolve)
+   {
+      std::vector<float> impulse[2];
+      if (!LoadImpulse(sampleRate, numChans, impulse))
+      {
+         return false;
+      }
+
+      // The tail partitions go to the other cores
+      if (!mPool)
+      {
+         mPool = std::make_unique<ConvolverPool>(
+            std::min(wxThread::GetCPUCount() - 1, CONVOLVE_MAX_THREADS));
+      }
+
+      for (int c = 0; c < numChans; c++)
+      {
+         state.convolvers[c] = std::make_unique<PartitionedConvolver>(
+            &impulse[c][0], impulse[c].size(), blockSize, mPool.get());
+      }
+
+      return true;
+   }
+
+   state.CreateReverb(mParams);
+
+   return true;
+}
+
+sampleCount EffectReverb::InstanceProcess(EffectReverbState & state,
+                                          float **inBlock, float **outBlock, sampleCount blockLen)
+{
+   if (state.convolvers[0])
+   {
+      // The dry signal is in the impulse, so each channel is one convolution
+      for (int c = 0; c < state.numChans; c++)
+      {
+         state.convolvers[c]->Process(inBlock[c], outBlock[c], blockLen);
+      }
+
+      return blockLen;
+   }
+
+   if (!state.p)
+   {
+      // The impulse response could not be loaded, so pass the audio through
+      for (int c = 0; c < state.numChans; c++)
+      {
+         if (outBlock[c] != inBlock[c])
+         {
+            memcpy(outBlock[c], inBlock[c], blockLen * sizeof(float));
+         }
+      }
+
+      return blockLen;
+   }
+
+   state.UpdateReverb(mParams);
+
+   Reverb_priv_t *p = state.p;
+   float *ichans[2] = {NULL, NULL};
+   float *ochans[2] = {NULL, NULL};
+
+   for (int c = 0; c < state.numChans; c++)
+   {
+      ichans[c] = inBlock[c];
+      ochans[c] = outBlock[c];
+   }
+   
+   float const dryMult = mParams.mWetOnly ? 0 : dB_to_linear(mParams.mDryGain);
+
+   sampleCount remaining = blockLen;
+
+   while (remaining)
+   {
+      sampleCount len = wxMin(remaining, BLOCK);
+      for (int c = 0; c < state.numChans; c++)
+      {
+         // Write the input samples to the reverb fifo.  Returned value is the address of the
+         // fifo buffer which contains a copy of the input samples.
+         p[c].dry = (float *) fifo_write(&p[c].reverb.input_fifo, len, ichans[c]);
+         reverb_process(&p[c].reverb, len);
+      }
+
+      if (state.numChans == 2)
+      {
+         for (sampleCount i = 0; i < len; i++)
+         {
+            for (int w = 0; w < 2; w++)
+            {
+               ochans[w][i] = dryMult *
+                              p[w].dry[i] +
+                              0.5 *
+                              (p[0].wet[w][i] + p[1].wet[w][i]);
+            }
+         }
+      }
+      else
+      {
+         for (sampleCount i = 0; i < len; i++)
+         {
+            ochans[0][i] = dryMult * 
+                           p[0].dry[i] +
+                           p[0].wet[0][i];
+         }
+      }
+
+      remaining -= len;
+
+      for (int c = 0; c < state.numChans; c++)
+      {
+         ichans[c] += len;
+         ochans[c] += len;
+      }
+   }
+
+   return blockLen;
+}
+
+// Reads the impulse response file, interleaved, as it is
+bool EffectReverb::ReadImpulse(std::vector<float> & data, int & channels, int & rate)
+{
+   wxFile f;   // will be closed when it goes out of scope
+   SF_INFO info;
+   SFFile file;
+
+   memset(&info, 0, sizeof(info));
+
+   if (!mImpulseFile.IsEmpty() && f.Open(mImpulseFile))
+   {
+      // As in ImportPCM, libsndfile is given the descriptor, because
+      // wxWidgets can open a Unicode name and libsndfile can't (under Windows)
+      file.reset(SFCall<SNDFILE*>(sf_open_fd, f.fd(), SFM_READ, &info, TRUE));
+      f.Detach();
+   }
+
+   if (!file || info.channels < 1 || info.samplerate < 1 || info.frames < 1)
+   {
+      return false;
+   }
+
+   sf_count_t frames = std::min<sf_count_t>(info.frames,
+                                            (sf_count_t) info.samplerate * MAX_IMPULSE_SECONDS);
+   data.resize(frames * info.channels);
+   frames = SFCall<sf_count_t>(sf_readf_float, file.get(), &data[0], frames);
+   if (frames < 1)
+   {
+      return false;
+   }
+   data.resize(frames * info.channels);
+
+   channels = info.channels;
+   rate = info.samplerate;
+
+   return true;
+}
+
+// Makes the impulse of each channel of the track, at its rate.  A stereo
+// impulse response goes left to left and right to right, or is mixed down
+// for a mono track.  The pre-delay goes before it, and its energy is set
+// by the wet gain; the dry signal goes in as the first sample, so that it
+// comes out as late as the reverb.
+bool EffectReverb::LoadImpulse(double sampleRate, int numChans, std::vector<float> impulse[2])
+{
+   std::vector<float> data;
+   int channels;
+   int rate;
+
+   if (!ReadImpulse(data, channels, rate))
+   {
+      return false;
+   }
+
+   const size_t frames = data.size() / channels;
+   const double factor = sampleRate / rate;
+   double energy = 0.0;
+
+   for (int c = 0; c < numChans; c++)
+   {
+      std::vector<float> in(frames);
+      if (numChans == 1 && channels > 1)
+      {
+         for (size_t i = 0; i < frames; i++)
+         {
+            in[i] = 0.5f * (data[i * channels] + data[i * channels + 1]);
+         }
+      }
+      else
+      {
+         const int ch = std::min(c, channels - 1);
+         for (size_t i = 0; i < frames; i++)
+         {
+            in[i] = data[i * channels + ch];
+         }
+      }
+
+      std::vector<float> &out = impulse[c];
+      out.assign((size_t) (sampleRate * mParams.mPreDelay / 1000.0 + 0.5), 0.0f);
+
+      if (rate == (int) sampleRate)
+      {
+         out.insert(out.end(), in.begin(), in.end());
+      }
+      else
+      {
+         ::Resample resample(true, factor, factor); // constant rate resampling
+         std::vector<float> buffer(65536);
+         size_t pos = 0;
+         int generated = 0;
+
+         // Keep on until the input is used and the resampler is emptied
+         while (pos < frames || generated > 0)
+         {
+            int len = (int) std::min(frames - pos, buffer.size());
+            int used = 0;
+
+            generated = resample.Process(factor, &in[0] + pos, len, pos + len == frames,
+                                         &used, &buffer[0], (int) buffer.size());
+            if (generated < 0)
+            {
+               return false;
+            }
+
+            pos += used;
+            out.insert(out.end(), buffer.begin(), buffer.begin() + generated);
+         }
+      }
+
+      double sum = 0.0;
+      for (size_t i = 0; i < out.size(); i++)
+      {
+         sum += out[i] * out[i];
+      }
+      energy = std::max(energy, sum);
+   }
+
+   if (energy <= 0.0)
+   {
+      return false;
+   }
+
+   // Scale so the louder channel has the energy of the wet gain
+   const float wetMult = dB_to_linear(mParams.mWetGain) / sqrt(energy);
+   const float dryMult = mParams.mWetOnly ? 0 : dB_to_linear(mParams.mDryGain);
+   for (int c = 0; c < numChans; c++)
+   {
+      for (size_t i = 0; i < impulse[c].size(); i++)
+      {
+         impulse[c][i] *= wetMult;
+      }
+      impulse[c][0] += dryMult;
+   }
+
+   return true;
+}
+
 void EffectReverb::SetTitle(const wxString & name)
 {
    wxString title(_("Reverb"));
@@ -530,3 +966,50 @@ void EffectReverb::SetTitle(const wxString & name)
 
    mUIDialog->SetTitle(title);
 }
+
+void EffectReverb::UpdateUI()
+{
+   bool convolve = mConvolveC->GetValue();
+
+   // These shape only the algorithmic reverb
+#define EnableSpinSlider(n) \
+   m ## n ## T->Enable(!convolve); \
+   m ## n ## S->Enable(!convolve);
+
+   EnableSpinSlider(RoomSize);
+   EnableSpinSlider(Reverberance);
+   EnableSpinSlider(HfDamping);
+   EnableSpinSlider(ToneLow);
+   EnableSpinSlider(ToneHigh);
+
+#undef EnableSpinSlider
+
+   mImpulseFileT->Enable(convolve);
+   mBrowseB->Enable(convolve);
+}
+
+void EffectReverb::OnConvolve(wxCommandEvent & WXUNUSED(evt))
+{
+   UpdateUI();
+}
+
+void EffectReverb::OnBrowse(wxCommandEvent & WXUNUSED(evt))
+{
+   wxFileName fn(mImpulseFileT->GetValue());
+
+   wxString path = FileSelector(_("Load Impulse Response:"),
+                                fn.GetPath(),
+                                fn.GetFullName(),
+                                wxT("wav"),
+                                _("WAV files (*.wav)|*.wav;*.WAV|All files|*"),
+                                wxFD_OPEN | wxRESIZE_BORDER,
+                                mUIParent);
+
+   // User canceled...
+   if (path.IsEmpty())
+   {
+      return;
+   }
+
+   mImpulseFileT->SetValue(path);
+}
@@ -12,11 +12,16 @@
 #ifndef __AUDACITY_EFFECT_REVERB__
 #define __AUDACITY_EFFECT_REVERB__
 
+#include <memory>
+#include <vector>
+
+#include <wx/button.h>
 #include <wx/checkbox.h>
 #include <wx/event.h>
 #include <wx/slider.h>
 #include <wx/spinctrl.h>
 #include <wx/string.h>
+#include <wx/textctrl.h>
 
 #include "Effect.h"
 
@@ -24,7 +29,8 @@ class ShuttleGui;
 
 #define REVERB_PLUGIN_SYMBOL XO("Reverb")
 
-struct Reverb_priv_t;
+class ConvolverPool;
+class EffectReverbState;
 
 class EffectReverb final : public Effect
 {
@@ -54,14 +60,23 @@ public:
    // EffectIdentInterface implementation
 
    EffectType GetType() override;
+   bool SupportsRealtime() override;
 
    // EffectClientInterface implementation
 
    int GetAudioInCount() override;
    int GetAudioOutCount() override;
+   sampleCount GetLatency() override;
    bool ProcessInitialize(sampleCount totalLen, ChannelNames chanMap = NULL) override;
    bool ProcessFinalize() override;
    sampleCount ProcessBlock(float **inBlock, float **outBlock, sampleCount blockLen) override;
+   bool RealtimeInitialize() override;
+   bool RealtimeAddProcessor(int numChannels, float sampleRate) override;
+   bool RealtimeFinalize() override;
+   sampleCount RealtimeProcess(int group,
+                               float **inbuf,
+                               float **outbuf,
+                               sampleCount numSamples) override;
    bool GetAutomationParameters(EffectAutomationParameters & parms) override;
    bool SetAutomationParameters(EffectAutomationParameters & parms) override;
    wxArrayString GetFactoryPresets() override;
@@ -77,7 +92,19 @@ public:
 private:
    // EffectReverb implementation
 
+   bool InstanceInit(EffectReverbState & state, int numChans,
+                     double sampleRate, size_t blockSize);
+   sampleCount InstanceProcess(EffectReverbState & state,
+                               float **inBlock, float **outBlock, sampleCount blockLen);
+
+   bool ReadImpulse(std::vector<float> & data, int & channels, int & rate);
+   bool LoadImpulse(double sampleRate, int numChans, std::vector<float> impulse[2]);
+
    void SetTitle(const wxString & name = wxT(""));
+   void UpdateUI();
+
+   void OnConvolve(wxCommandEvent & evt);
+   void OnBrowse(wxCommandEvent & evt);
 
 #define SpinSliderHandlers(n) \
    void On ## n ## Slider(wxCommandEvent & evt); \
@@ -96,11 +123,20 @@ private:
 #undef SpinSliderHandlers
 
 private:
-   int mNumChans;
-   Reverb_priv_t *mP;
+   // Threads for the convolvers' tails, shared by all the tracks, and
+   // so destroyed after them
+   std::unique_ptr<ConvolverPool> mPool;
+   std::unique_ptr<EffectReverbState> mMaster;
+   std::vector<std::unique_ptr<EffectReverbState>> mSlaves;
+   bool mLatencyDone;
 
    Params mParams;
 
+   // Convolve with the impulse response in a file, instead of the
+   // algorithmic reverb
+   bool mConvolve;
+   wxString mImpulseFile;
+
    bool mProcessingEvent;
 
 #define SpinSlider(n) \
@@ -120,6 +156,9 @@ private:
 #undef SpinSlider
 
    wxCheckBox  *mWetOnlyC;
+   wxCheckBox  *mConvolveC;
+   wxTextCtrl  *mImpulseFileT;
+   wxButton    *mBrowseB;
 
    DECLARE_EVENT_TABLE();
 };
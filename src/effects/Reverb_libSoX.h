@@ -148,8 +148,23 @@ typedef struct {
    one_pole_t one_pole[2];
 } filter_array_t;
 
+static void filter_array_set_tone(filter_array_t * p, double rate,
+      double fc_highpass, double fc_lowpass)
+{
+   { /* EQ: highpass */
+      one_pole_t * q = &p->one_pole[0];
+      q->a1 = -exp(-2 * M_PI * fc_highpass / rate);
+      q->b0 = (1 - q->a1)/2, q->b1 = -q->b0;
+   }
+   { /* EQ: lowpass */
+      one_pole_t * q = &p->one_pole[1];
+      q->a1 = -exp(-2 * M_PI * fc_lowpass / rate);
+      q->b0 = 1 + q->a1, q->b1 = 0;
+   }
+}
+
 static void filter_array_create(filter_array_t * p, double rate,
-      double scale, double offset, double fc_highpass, double fc_lowpass)
+      double scale, double offset)
 {
    size_t i;
    double r = rate * (1 / 44100.); /* Compensate for actual sample-rate */
@@ -166,16 +181,6 @@ static void filter_array_create(filter_array_t * p, double rate,
       pallpass->size = (size_t)(r * (allpass_lengths[i] + stereo_adjust * offset) + .5);
       pallpass->ptr = lsx_zalloc(pallpass->buffer, pallpass->size);
    }
-   { /* EQ: highpass */
-      one_pole_t * q = &p->one_pole[0];
-      q->a1 = -exp(-2 * M_PI * fc_highpass / rate);
-      q->b0 = (1 - q->a1)/2, q->b1 = -q->b0;
-   }
-   { /* EQ: lowpass */
-      one_pole_t * q = &p->one_pole[1];
-      q->a1 = -exp(-2 * M_PI * fc_lowpass / rate);
-      q->b0 = 1 + q->a1, q->b1 = 0;
-   }
 }
 
 static void filter_array_process(filter_array_t * p,
@@ -218,6 +223,27 @@ typedef struct {
    float * out[2];
 } reverb_t;
 
+/* The settings that need no new buffers, so may change while it runs */
+static void reverb_set(reverb_t * p, double sample_rate_Hz,
+      double wet_gain_dB,
+      double reverberance,   /* % */
+      double hf_damping,     /* % */
+      double tone_low,       /* % */
+      double tone_high)      /* % */
+{
+   size_t i;
+   double a =  -1 /  log(1 - /**/.3 /**/);           /* Set minimum feedback */
+   double b = 100 / (log(1 - /**/.98/**/) * a + 1);  /* Set maximum feedback */
+   double fc_highpass = midi_to_freq(72 - tone_low / 100 * 48);
+   double fc_lowpass  = midi_to_freq(72 + tone_high/ 100 * 48);
+
+   p->feedback = 1 - exp((reverberance - b) / (a * b));
+   p->hf_damping = hf_damping / 100 * .3 + .2;
+   p->gain = dB_to_linear(wet_gain_dB) * .015;
+   for (i = 0; i < 2 && p->out[i]; ++i)
+      filter_array_set_tone(p->chan + i, sample_rate_Hz, fc_highpass, fc_lowpass);
+}
+
 static void reverb_create(reverb_t * p, double sample_rate_Hz,
       double wet_gain_dB,
       double room_scale,     /* % */
@@ -233,21 +259,15 @@ static void reverb_create(reverb_t * p, double sample_rate_Hz,
    size_t i, delay = pre_delay_ms / 1000 * sample_rate_Hz + .5;
    double scale = room_scale / 100 * .9 + .1;
    double depth = stereo_depth / 100;
-   double a =  -1 /  log(1 - /**/.3 /**/);           /* Set minimum feedback */
-   double b = 100 / (log(1 - /**/.98/**/) * a + 1);  /* Set maximum feedback */
-   double fc_highpass = midi_to_freq(72 - tone_low / 100 * 48);
-   double fc_lowpass  = midi_to_freq(72 + tone_high/ 100 * 48);
 
    memset(p, 0, sizeof(*p));
-   p->feedback = 1 - exp((reverberance - b) / (a * b));
-   p->hf_damping = hf_damping / 100 * .3 + .2;
-   p->gain = dB_to_linear(wet_gain_dB) * .015;
    fifo_create(&p->input_fifo, sizeof(float));
    memset(fifo_write(&p->input_fifo, delay, 0), 0, delay * sizeof(float));
    for (i = 0; i <= ceil(depth); ++i) {
-      filter_array_create(p->chan + i, sample_rate_Hz, scale, i * depth, fc_highpass, fc_lowpass);
+      filter_array_create(p->chan + i, sample_rate_Hz, scale, i * depth);
       out[i] = lsx_zalloc(p->out[i], buffer_size);
    }
+   reverb_set(p, sample_rate_Hz, wet_gain_dB, reverberance, hf_damping, tone_low, tone_high);
 }
 
 static void reverb_process(reverb_t * p, size_t length)
@@ -16,6 +16,8 @@ effect that uses SBSMS to do its processing (TimeScale)
 #if USE_SBSMS
 
 #include <math.h>
+#include <algorithm>
+#include <vector>
 
 #include "SBSMSEffect.h"
 #include "../LabelTrack.h"
@@ -34,8 +36,6 @@ public:
    {
       processed = 0;
       buf = NULL;
-      leftBuffer = NULL;
-      rightBuffer = NULL;
 
       SBSMSBuf = NULL;
       outputLeftTrack = NULL;
@@ -45,8 +45,6 @@ public:
    ~ResampleBuf()
    {
       if(buf)                 free(buf);
-      if(leftBuffer)          free(leftBuffer);
-      if(rightBuffer)         free(rightBuffer);
       if(SBSMSBuf)            free(SBSMSBuf);
    }
 
@@ -58,10 +56,11 @@ public:
    sampleCount SBSMSBlockSize;
    sampleCount offset;
    sampleCount end;
-   float *leftBuffer;
-   float *rightBuffer;
    WaveTrack *leftTrack;
    WaveTrack *rightTrack;
+   // Read ahead of the callback, so that SBSMS seldom waits for the disk
+   WaveTrackCache leftCache;
+   WaveTrackCache rightCache;
    std::unique_ptr<SBSMS> sbsms;
    std::unique_ptr<SBSMSInterface> iface;
    audio *SBSMSBuf;
@@ -104,14 +103,18 @@ long resampleCB(void *cb_data, SBSMSFrame *data)
    if (r->offset + blockSize > r->end)
       blockSize = r->end - r->offset;
 
-   // Get the samples from the tracks and put them in the buffers.
-   r->leftTrack->Get((samplePtr)(r->leftBuffer), floatSample, r->offset, blockSize);
-   r->rightTrack->Get((samplePtr)(r->rightBuffer), floatSample, r->offset, blockSize);
+   // Get the samples from the tracks.  A mono track is read once, and
+   // what can't be read is taken as silence.
+   const float *left =
+      (const float*)r->leftCache.Get(floatSample, r->offset, blockSize);
+   const float *right = left;
+   if (r->rightTrack != r->leftTrack)
+      right = (const float*)r->rightCache.Get(floatSample, r->offset, blockSize);
 
    // convert to sbsms audio format
    for(int i=0; i<blockSize; i++) {
-      r->buf[i][0] = r->leftBuffer[i];
-      r->buf[i][1] = r->rightBuffer[i];
+      r->buf[i][0] = left ? left[i] : 0.0f;
+      r->buf[i][1] = right ? right[i] : 0.0f;
    }
 
    data->buf = r->buf;
@@ -290,8 +293,12 @@ bool EffectSBSMS::Process()
             rb.buf = (audio*)calloc(rb.blockSize,sizeof(audio));
             rb.leftTrack = leftTrack;
             rb.rightTrack = rightTrack?rightTrack:leftTrack;
-            rb.leftBuffer = (float*)calloc(maxBlockSize,sizeof(float));
-            rb.rightBuffer = (float*)calloc(maxBlockSize,sizeof(float));
+            rb.leftCache.SetReadAhead(2);
+            rb.leftCache.SetTrack(leftTrack);
+            if(rightTrack) {
+               rb.rightCache.SetReadAhead(2);
+               rb.rightCache.SetTrack(rightTrack);
+            }
 
             // Samples in selection
             sampleCount samplesIn = end-start;
@@ -344,8 +351,6 @@ bool EffectSBSMS::Process()
             Resampler resampler(outResampleCB,&rb,outSlideType);
 
             audio outBuf[SBSMSOutBlockSize];
-            float outBufLeft[2*SBSMSOutBlockSize];
-            float outBufRight[2*SBSMSOutBlockSize];
 
             // Samples in output after SBSMS
             sampleCount samplesToOutput = rb.iface->getSamplesToOutput();
@@ -367,6 +372,15 @@ bool EffectSBSMS::Process()
             if(rightTrack)
                rb.outputRightTrack = mFactory->NewWaveTrack(rightTrack->GetSampleFormat(),
                                                             rightTrack->GetRate());
+
+            // Output is gathered and appended a disk block at a time, rather
+            // than a few hundred samples at a time
+            sampleCount outBufSize =
+               std::max(rb.outputLeftTrack->GetIdealBlockSize(), (sampleCount)SBSMSOutBlockSize);
+            std::vector<float> outBufLeft(outBufSize);
+            std::vector<float> outBufRight(rightTrack ? outBufSize : 0);
+            sampleCount outBufCount = 0;
+
             long pos = 0;
             long outputCount = -1;
 
@@ -378,16 +392,20 @@ bool EffectSBSMS::Process()
                } else {
                   frames = SBSMSOutBlockSize;
                }
+               if(outBufCount + frames > outBufSize) {
+                  rb.outputLeftTrack->Append((samplePtr)&outBufLeft[0], floatSample, outBufCount);
+                  if(rightTrack)
+                     rb.outputRightTrack->Append((samplePtr)&outBufRight[0], floatSample, outBufCount);
+                  outBufCount = 0;
+               }
                outputCount = resampler.read(outBuf,frames);
                for(int i = 0; i < outputCount; i++) {
-                  outBufLeft[i] = outBuf[i][0];
+                  outBufLeft[outBufCount + i] = outBuf[i][0];
                   if(rightTrack)
-                     outBufRight[i] = outBuf[i][1];
+                     outBufRight[outBufCount + i] = outBuf[i][1];
                }
+               outBufCount += outputCount;
                pos += outputCount;
-               rb.outputLeftTrack->Append((samplePtr)outBufLeft, floatSample, outputCount);
-               if(rightTrack)
-                  rb.outputRightTrack->Append((samplePtr)outBufRight, floatSample, outputCount);
 
                double frac = (double)pos/(double)samplesOut;
                int nWhichTrack = mCurTrackNum;
@@ -404,10 +422,19 @@ bool EffectSBSMS::Process()
                if (TrackProgress(nWhichTrack, frac))
                   return false;
             }
+            if(outBufCount > 0) {
+               rb.outputLeftTrack->Append((samplePtr)&outBufLeft[0], floatSample, outBufCount);
+               if(rightTrack)
+                  rb.outputRightTrack->Append((samplePtr)&outBufRight[0], floatSample, outBufCount);
+            }
             rb.outputLeftTrack->Flush();
             if(rightTrack)
                rb.outputRightTrack->Flush();
 
+            // The tracks are about to change, so stop reading ahead of them
+            rb.leftCache.SetTrack(NULL);
+            rb.rightCache.SetTrack(NULL);
+
             bool bResult =
                leftTrack->ClearAndPaste(mCurT0, mCurT1, rb.outputLeftTrack.get(),
                                           true, false, GetTimeWarper());
@@ -217,27 +217,19 @@ int EffectScienFilter::GetAudioOutCount()
 
 bool EffectScienFilter::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelNames WXUNUSED(chanMap))
 {
+   mCascade.SetStageCount((mOrder + 1) / 2);
    for (int iPair = 0; iPair < (mOrder + 1) / 2; iPair++)
    {
-      mpBiquad[iPair].fPrevIn = 0;
-      mpBiquad[iPair].fPrevPrevIn = 0;
-      mpBiquad[iPair].fPrevOut = 0;
-      mpBiquad[iPair].fPrevPrevOut = 0;
+      mCascade.SetStage(iPair, mpBiquad[iPair]);
    }
+   mCascade.Reset();
 
    return true;
 }
 
 sampleCount EffectScienFilter::ProcessBlock(float **inBlock, float **outBlock, sampleCount blockLen)
 {
-   float *ibuf = inBlock[0];
-   for (int iPair = 0; iPair < (mOrder + 1) / 2; iPair++)
-   {
-      mpBiquad[iPair].pfIn = ibuf;
-      mpBiquad[iPair].pfOut = outBlock[0];
-      Biquad_Process(&mpBiquad[iPair], blockLen);
-      ibuf = outBlock[0];
-   }
+   mCascade.Process(inBlock[0], outBlock[0], blockLen);
 
    return blockLen;
 }
@@ -101,6 +101,7 @@ private:
    int mOrder;
    int mOrderIndex;
    BiquadStruct *mpBiquad;
+   BiquadCascade mCascade;
 
    double mdBMax;
    double mdBMin;
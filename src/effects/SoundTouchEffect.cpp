@@ -17,14 +17,35 @@ effect that uses SoundTouch to do its processing (ChangeTempo
 #if USE_SOUNDTOUCH
 
 #include <math.h>
+#include <algorithm>
+
+#include <wx/thread.h>
 
 #include "../LabelTrack.h"
 #include "../WaveTrack.h"
 #include "../Project.h"
+#include "AnalysisJobs.h"
+#include "InterleaveKernels.h"
 #include "SoundTouchEffect.h"
 #include "TimeWarper.h"
 #include "../NoteTrack.h"
 
+// A track, or stereo pair, with a SoundTouch of its own.  A worker thread
+// reads and processes it, and appends the output to the job's own tracks;
+// the DirManager lets any thread make block files.
+struct EffectSoundTouch::Job
+{
+   WaveTrack *left;
+   WaveTrack *right;   // NULL for a mono track
+   sampleCount start;
+   sampleCount end;
+   double t0;
+   double t1;
+   std::unique_ptr<SoundTouch> soundTouch;
+   std::unique_ptr<WaveTrack> outputLeft;
+   std::unique_ptr<WaveTrack> outputRight;
+};
+
 bool EffectSoundTouch::ProcessLabelTrack(Track *track)
 {
 //   SetTimeWarper(std::make_unique<RegionTimeWarper>(mCurT0, mCurT1,
@@ -48,9 +69,7 @@ bool EffectSoundTouch::ProcessNoteTrack(Track *track)
 
 bool EffectSoundTouch::Process()
 {
-   // Assumes that mSoundTouch has already been initialized
-   // by the subclass for subclass-specific parameters. The
-   // time warper should also be set.
+   // Assumes that the subclass has set the time warper.
 
    // Check if this effect will alter the selection length; if so, we need
    // to operate on sync-lock selected tracks.
@@ -66,9 +85,11 @@ bool EffectSoundTouch::Process()
 
    TrackListIterator iter(mOutputTracks.get());
    Track* t;
-   mCurTrackNum = 0;
    m_maxNewLength = 0.0;
 
+   // The wave tracks are gathered here, then processed all at once
+   std::vector<Job> jobs;
+
    t = iter.First();
    while (t != NULL) {
       if (t->GetKind() == Track::Label &&
@@ -94,6 +115,7 @@ bool EffectSoundTouch::Process()
       else if (t->GetKind() == Track::Wave && t->GetSelected())
       {
          WaveTrack* leftTrack = (WaveTrack*)t;
+         WaveTrack* rightTrack = NULL;
          //Get start and end times from track
          mCurT0 = leftTrack->GetStartTime();
          mCurT1 = leftTrack->GetEndTime();
@@ -105,11 +127,9 @@ bool EffectSoundTouch::Process()
 
          // Process only if the right marker is to the right of the left marker
          if (mCurT1 > mCurT0) {
-            sampleCount start, end;
-
             if (leftTrack->GetLinked()) {
                double t;
-               WaveTrack* rightTrack = (WaveTrack*)(iter.Next());
+               rightTrack = (WaveTrack*)(iter.Next());
 
                //Adjust bounds by the right tracks markers
                t = rightTrack->GetStartTime();
@@ -118,38 +138,29 @@ bool EffectSoundTouch::Process()
                t = rightTrack->GetEndTime();
                t = wxMin(mT1, t);
                mCurT1 = wxMax(mCurT1, t);
-
-               //Transform the marker timepoints to samples
-               start = leftTrack->TimeToLongSamples(mCurT0);
-               end = leftTrack->TimeToLongSamples(mCurT1);
-
-               //Inform soundtouch there's 2 channels
-               mSoundTouch->setChannels(2);
-
-               //ProcessStereo() (implemented below) processes a stereo track
-               if (!ProcessStereo(leftTrack, rightTrack, start, end))
-               {
-                  bGoodResult = false;
-                  break;
-               }
-               mCurTrackNum++; // Increment for rightTrack, too.
-            } else {
-               //Transform the marker timepoints to samples
-               start = leftTrack->TimeToLongSamples(mCurT0);
-               end = leftTrack->TimeToLongSamples(mCurT1);
-
-               //Inform soundtouch there's a single channel
-               mSoundTouch->setChannels(1);
-
-               //ProcessOne() (implemented below) processes a single track
-               if (!ProcessOne(leftTrack, start, end))
-               {
-                  bGoodResult = false;
-                  break;
-               }
             }
+
+            jobs.push_back(Job());
+            Job &job = jobs.back();
+            job.left = leftTrack;
+            job.right = rightTrack;
+            job.t0 = mCurT0;
+            job.t1 = mCurT1;
+
+            //Transform the marker timepoints to samples
+            job.start = leftTrack->TimeToLongSamples(mCurT0);
+            job.end = leftTrack->TimeToLongSamples(mCurT1);
+
+            job.soundTouch = MakeSoundTouch();
+            job.soundTouch->setChannels(rightTrack ? 2 : 1);
+            job.soundTouch->setSampleRate((unsigned int)(leftTrack->GetRate()+0.5));
+
+            job.outputLeft = mFactory->NewWaveTrack(leftTrack->GetSampleFormat(),
+                                                    leftTrack->GetRate());
+            if (rightTrack)
+               job.outputRight = mFactory->NewWaveTrack(rightTrack->GetSampleFormat(),
+                                                        rightTrack->GetRate());
          }
-         mCurTrackNum++;
       }
       else if (mustSync && t->IsSyncLockSelected()) {
          t->SyncLockAdjust(mT1, GetTimeWarper()->Warp(mT1));
@@ -159,228 +170,106 @@ bool EffectSoundTouch::Process()
       t = iter.Next();
    }
 
-   if (bGoodResult)
-      ReplaceProcessedTracks(bGoodResult);
-
-   mSoundTouch.reset();
-
-//   mT0 = mCurT0;
-//   mT1 = mCurT0 + m_maxNewLength; // Update selection.
+   if (bGoodResult && !jobs.empty())
+      bGoodResult = ProcessJobs(jobs);
 
-   return bGoodResult;
-}
+   if (bGoodResult) {
+      // Take the output tracks and insert them in place of the original
+      // sample data, in track order
+      for (auto &job : jobs) {
+         mCurT0 = job.t0;
+         mCurT1 = job.t1;
 
-//ProcessOne() takes a track, transforms it to bunch of buffer-blocks,
-//and executes ProcessSoundTouch on these blocks
-bool EffectSoundTouch::ProcessOne(WaveTrack *track,
-                                  sampleCount start, sampleCount end)
-{
-   sampleCount s;
+         job.outputLeft->Flush();
+         job.left->ClearAndPaste(mCurT0, mCurT1, job.outputLeft.get(), true, false, GetTimeWarper());
+         m_maxNewLength = wxMax(m_maxNewLength, job.outputLeft->GetEndTime());
 
-   mSoundTouch->setSampleRate((unsigned int)(track->GetRate()+0.5));
-
-   auto outputTrack = mFactory->NewWaveTrack(track->GetSampleFormat(), track->GetRate());
-
-   //Get the length of the buffer (as double). len is
-   //used simple to calculate a progress meter, so it is easier
-   //to make it a double now than it is to do it later
-   double len = (double)(end - start);
-
-   //Initiate a processing buffer.  This buffer will (most likely)
-   //be shorter than the length of the track being processed.
-   float *buffer = new float[track->GetMaxBlockSize()];
-
-   //Go through the track one buffer at a time. s counts which
-   //sample the current buffer starts at.
-   s = start;
-   while (s < end) {
-      //Get a block of samples (smaller than the size of the buffer)
-      sampleCount block = track->GetBestBlockSize(s);
-
-      //Adjust the block size if it is the final block in the track
-      if (s + block > end)
-         block = end - s;
-
-      //Get the samples from the track and put them in the buffer
-      track->Get((samplePtr) buffer, floatSample, s, block);
-
-      //Add samples to SoundTouch
-      mSoundTouch->putSamples(buffer, block);
-
-      //Get back samples from SoundTouch
-      unsigned int outputCount = mSoundTouch->numSamples();
-      if (outputCount > 0) {
-         float *buffer2 = new float[outputCount];
-         mSoundTouch->receiveSamples(buffer2, outputCount);
-         outputTrack->Append((samplePtr)buffer2, floatSample, outputCount);
-         delete[] buffer2;
+         if (job.right) {
+            job.outputRight->Flush();
+            job.right->ClearAndPaste(mCurT0, mCurT1, job.outputRight.get(), true, false, GetTimeWarper());
+            m_maxNewLength = wxMax(m_maxNewLength, job.outputRight->GetEndTime());
+         }
       }
 
-      //Increment s one blockfull of samples
-      s += block;
-
-      //Update the Progress meter
-      if (TrackProgress(mCurTrackNum, (s - start) / len))
-         return false;
-   }
-
-   // Tell SoundTouch to finish processing any remaining samples
-   mSoundTouch->flush();   // this should only be used for changeTempo - it dumps data otherwise with pRateTransposer->clear();
-
-   unsigned int outputCount = mSoundTouch->numSamples();
-   if (outputCount > 0) {
-      float *buffer2 = new float[outputCount];
-      mSoundTouch->receiveSamples(buffer2, outputCount);
-      outputTrack->Append((samplePtr)buffer2, floatSample, outputCount);
-      delete[] buffer2;
+      ReplaceProcessedTracks(bGoodResult);
    }
 
-   // Flush the output WaveTrack (since it's buffered, too)
-   outputTrack->Flush();
-
-   // Clean up the buffer
-   delete[]buffer;
-
-   // Take the output track and insert it in place of the original
-   // sample data
-   track->ClearAndPaste(mCurT0, mCurT1, outputTrack.get(), true, false, GetTimeWarper());
-
-   double newLength = outputTrack->GetEndTime();
-   m_maxNewLength = wxMax(m_maxNewLength, newLength);
+//   mT0 = mCurT0;
+//   mT1 = mCurT0 + m_maxNewLength; // Update selection.
 
-   //Return true because the effect processing succeeded.
-   return true;
+   return bGoodResult;
 }
 
-bool EffectSoundTouch::ProcessStereo(WaveTrack* leftTrack, WaveTrack* rightTrack,
-                                     sampleCount start, sampleCount end)
+// Runs a SoundTouch per job, on as many threads as there are processors.
+// Returns false if cancelled.
+bool EffectSoundTouch::ProcessJobs(std::vector<Job> &jobs)
 {
-   mSoundTouch->setSampleRate((unsigned int)(leftTrack->GetRate()+0.5));
-
-   auto outputLeftTrack = mFactory->NewWaveTrack(leftTrack->GetSampleFormat(),
-                                                       leftTrack->GetRate());
-   auto outputRightTrack = mFactory->NewWaveTrack(rightTrack->GetSampleFormat(),
-                                                        rightTrack->GetRate());
+   auto process = [&](size_t, size_t j, const AnalysisProgress &progress) {
+      Job &job = jobs[j];
+      SoundTouch &soundTouch = *job.soundTouch;
+      const sampleCount maxBlockSize = job.left->GetMaxBlockSize();
+      const double len = std::max<double>(job.end - job.start, 1.0);
+
+      std::vector<float> left(maxBlockSize);
+      std::vector<float> right(job.right ? maxBlockSize : 0);
+      std::vector<float> interleaved(job.right ? 2 * maxBlockSize : 0);
+
+      // Appends what SoundTouch has ready
+      auto receive = [&]() {
+         const size_t ready = soundTouch.numSamples();
+         if (ready == 0)
+            return;
+         if (!job.right) {
+            left.resize(std::max(left.size(), ready));
+            soundTouch.receiveSamples(&left[0], ready);
+            job.outputLeft->Append((samplePtr)&left[0], floatSample, ready);
+            return;
+         }
+         left.resize(std::max(left.size(), ready));
+         right.resize(std::max(right.size(), ready));
+         interleaved.resize(std::max(interleaved.size(), 2 * ready));
+         soundTouch.receiveSamples(&interleaved[0], ready);
+         Deinterleave(&interleaved[0], &left[0], &right[0], ready);
+         job.outputLeft->Append((samplePtr)&left[0], floatSample, ready);
+         job.outputRight->Append((samplePtr)&right[0], floatSample, ready);
+      };
+
+      //Go through the track one buffer at a time. s counts which
+      //sample the current buffer starts at.
+      bool cancelled = false;
+      sampleCount s = job.start;
+      while (!cancelled && s < job.end) {
+         //Get a block of samples (smaller than the size of the buffer)
+         sampleCount block = job.left->GetBestBlockSize(s);
+
+         //Adjust the block size if it is the final block in the track
+         if (s + block > job.end)
+            block = job.end - s;
+
+         //Get the samples from the tracks and add them to SoundTouch
+         job.left->Get((samplePtr)&left[0], floatSample, s, block);
+         if (job.right) {
+            job.right->Get((samplePtr)&right[0], floatSample, s, block);
+            Interleave(&left[0], &right[0], &interleaved[0], block);
+            soundTouch.putSamples(&interleaved[0], block);
+         }
+         else
+            soundTouch.putSamples(&left[0], block);
 
-   //Get the length of the buffer (as double). len is
-   //used simple to calculate a progress meter, so it is easier
-   //to make it a double now than it is to do it later
-   double len = (double)(end - start);
-
-   //Initiate a processing buffer.  This buffer will (most likely)
-   //be shorter than the length of the track being processed.
-   // Make soundTouchBuffer twice as big as MaxBlockSize for each channel,
-   // because Soundtouch wants them interleaved, i.e., each
-   // Soundtouch sample is left-right pair.
-   sampleCount maxBlockSize = leftTrack->GetMaxBlockSize();
-   float* leftBuffer = new float[maxBlockSize];
-   float* rightBuffer = new float[maxBlockSize];
-   float* soundTouchBuffer = new float[maxBlockSize * 2];
-
-   // Go through the track one stereo buffer at a time.
-   // sourceSampleCount counts the sample at which the current buffer starts,
-   // per channel.
-   sampleCount sourceSampleCount = start;
-   while (sourceSampleCount < end) {
-      //Get a block of samples (smaller than the size of the buffer)
-      sampleCount blockSize = leftTrack->GetBestBlockSize(sourceSampleCount);
-
-      //Adjust the block size if it is the final block in the track
-      if (sourceSampleCount + blockSize > end)
-         blockSize = end - sourceSampleCount;
-
-      // Get the samples from the tracks and put them in the buffers.
-      leftTrack->Get((samplePtr)(leftBuffer), floatSample, sourceSampleCount, blockSize);
-      rightTrack->Get((samplePtr)(rightBuffer), floatSample, sourceSampleCount, blockSize);
-
-      // Interleave into soundTouchBuffer.
-      for (int index = 0; index < blockSize; index++) {
-         soundTouchBuffer[index*2]       = leftBuffer[index];
-         soundTouchBuffer[(index*2)+1]   = rightBuffer[index];
+         s += block;
+         receive();
+         cancelled = progress((s - job.start) / len);
       }
 
-      //Add samples to SoundTouch
-      mSoundTouch->putSamples(soundTouchBuffer, blockSize);
-
-      //Get back samples from SoundTouch
-      unsigned int outputCount = mSoundTouch->numSamples();
-      if (outputCount > 0)
-         this->ProcessStereoResults(outputCount, outputLeftTrack.get(), outputRightTrack.get());
-
-      //Increment sourceSampleCount one blockfull of samples
-      sourceSampleCount += blockSize;
-
-      //Update the Progress meter
-      // mCurTrackNum is left track. Include right track.
-      int nWhichTrack = mCurTrackNum;
-      double frac = (sourceSampleCount - start) / len;
-      if (frac < 0.5)
-         frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
-      else
-      {
-         nWhichTrack++;
-         frac -= 0.5;
-         frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
+      if (!cancelled) {
+         // Tell SoundTouch to finish processing any remaining samples
+         soundTouch.flush();   // this should only be used for changeTempo - it dumps data otherwise with pRateTransposer->clear();
+         receive();
       }
-      if (TrackProgress(nWhichTrack, frac))
-         return false;
-   }
+   };
 
-   // Tell SoundTouch to finish processing any remaining samples
-   mSoundTouch->flush();
-
-   unsigned int outputCount = mSoundTouch->numSamples();
-   if (outputCount > 0)
-      this->ProcessStereoResults(outputCount, outputLeftTrack.get(), outputRightTrack.get());
-
-   // Flush the output WaveTracks (since they're buffered, too)
-   outputLeftTrack->Flush();
-   outputRightTrack->Flush();
-
-   // Clean up the buffers.
-   delete [] leftBuffer;
-   delete [] rightBuffer;
-   delete [] soundTouchBuffer;
-
-   // Take the output tracks and insert in place of the original
-   // sample data.
-   leftTrack->ClearAndPaste(mCurT0, mCurT1, outputLeftTrack.get(), true, false, GetTimeWarper());
-   rightTrack->ClearAndPaste(mCurT0, mCurT1, outputRightTrack.get(), true, false, GetTimeWarper());
-
-   // Track the longest result length
-   double newLength = outputLeftTrack->GetEndTime();
-   m_maxNewLength = wxMax(m_maxNewLength, newLength);
-   newLength = outputRightTrack->GetEndTime();
-   m_maxNewLength = wxMax(m_maxNewLength, newLength);
-
-   //Return true because the effect processing succeeded.
-   return true;
-}
-
-bool EffectSoundTouch::ProcessStereoResults(const unsigned int outputCount,
-                                            WaveTrack* outputLeftTrack,
-                                            WaveTrack* outputRightTrack)
-{
-   float* outputSoundTouchBuffer = new float[outputCount*2];
-   mSoundTouch->receiveSamples(outputSoundTouchBuffer, outputCount);
-
-   // Dis-interleave outputSoundTouchBuffer into separate track buffers.
-   float* outputLeftBuffer = new float[outputCount];
-   float* outputRightBuffer = new float[outputCount];
-   for (unsigned int index = 0; index < outputCount; index++)
-   {
-      outputLeftBuffer[index] = outputSoundTouchBuffer[index*2];
-      outputRightBuffer[index] = outputSoundTouchBuffer[(index*2)+1];
-   }
-
-   outputLeftTrack->Append((samplePtr)outputLeftBuffer, floatSample, outputCount);
-   outputRightTrack->Append((samplePtr)outputRightBuffer, floatSample, outputCount);
-
-   delete[] outputSoundTouchBuffer;
-   delete[] outputLeftBuffer;
-   delete[] outputRightBuffer;
-
-   return true;
+   return RunAnalysisJobs(jobs.size(), std::max(1, wxThread::GetCPUCount()),
+      process, [this](double frac) { return TotalProgress(frac); });
 }
 
 #endif // USE_SOUNDTOUCH
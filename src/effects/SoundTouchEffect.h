@@ -19,6 +19,8 @@
 #ifndef __AUDACITY_EFFECT_SOUNDTOUCH__
 #define __AUDACITY_EFFECT_SOUNDTOUCH__
 
+#include <vector>
+
 #include "Effect.h"
 
 // Soundtouch defines these as well, so get rid of them before including
@@ -50,23 +52,21 @@ public:
 #endif
 
 protected:
-   std::unique_ptr<SoundTouch> mSoundTouch;
+   // Makes a SoundTouch set up for the subclass's parameters.  Each track,
+   // or stereo pair, gets its own, so that they can be processed at once.
+   virtual std::unique_ptr<SoundTouch> MakeSoundTouch() = 0;
+
    double mCurT0;
    double mCurT1;
 
 private:
+   struct Job;
+
    bool ProcessLabelTrack(Track *track);
 #ifdef USE_MIDI
    bool ProcessNoteTrack(Track *track);
 #endif
-   bool ProcessOne(WaveTrack * t, sampleCount start, sampleCount end);
-   bool ProcessStereo(WaveTrack* leftTrack, WaveTrack* rightTrack,
-                        sampleCount start, sampleCount end);
-   bool ProcessStereoResults(const unsigned int outputCount,
-                              WaveTrack* outputLeftTrack,
-                              WaveTrack* outputRightTrack);
-
-   int    mCurTrackNum;
+   bool ProcessJobs(std::vector<Job> &jobs);
 
    double m_maxNewLength;
 };
@@ -32,6 +32,8 @@ frequency changes smoothly during the tone.
 #include "../widgets/NumericTextCtrl.h"
 #include "../widgets/valnum.h"
 
+#include "GeneratorKernels.h"
+
 enum kInterpolations
 {
    kLinear,
@@ -158,25 +160,16 @@ bool EffectToneGen::ProcessInitialize(sampleCount WXUNUSED(totalLen), ChannelNam
 sampleCount EffectToneGen::ProcessBlock(float **WXUNUSED(inBlock), float **outBlock, sampleCount blockLen)
 {
    float *buffer = outBlock[0];
-   double throwaway = 0;        //passed to modf but never used
    sampleCount i;
-   double f = 0.0;
-   double a, b;
-   int k;
 
    double frequencyQuantum;
    double BlendedFrequency;
    double BlendedAmplitude;
-   double BlendedLogFrequency = 0.0;
 
    // calculate delta, and reposition from where we left
    double amplitudeQuantum = (mAmplitude[1] - mAmplitude[0]) / mSampleCnt;
    BlendedAmplitude = mAmplitude[0] + amplitudeQuantum * mSample;
 
-   // precalculations:
-   double pre2PI = 2.0 * M_PI;
-   double pre4divPI = 4.0 / M_PI;
-
    // initial setup should calculate deltas
    if (mInterpolation == kLogarithmic)
    {
@@ -185,8 +178,9 @@ sampleCount EffectToneGen::ProcessBlock(float **WXUNUSED(inBlock), float **outBl
       mLogFrequency[1] = log10(mFrequency[1]);
       // calculate delta, and reposition from where we left
       frequencyQuantum = (mLogFrequency[1] - mLogFrequency[0]) / mSampleCnt;
-      BlendedLogFrequency = mLogFrequency[0] + frequencyQuantum * mSample;
-      BlendedFrequency = pow(10.0, BlendedLogFrequency);
+      BlendedFrequency = pow(10.0, mLogFrequency[0] + frequencyQuantum * mSample);
+      // stepping by a constant ratio saves a pow() per sample
+      frequencyQuantum = pow(10.0, frequencyQuantum);
    }
    else
    {
@@ -195,41 +189,29 @@ sampleCount EffectToneGen::ProcessBlock(float **WXUNUSED(inBlock), float **outBl
       BlendedFrequency = mFrequency[0] + frequencyQuantum * mSample;
    }
 
-   // synth loop
+   // The phase of each sample, in cycles, is found here in double
+   // precision, and the waveform is then made from it a block at a time.
+   // The output buffer holds the phases until then.
+   bool noAlias = (mWaveform == kSquareNoAlias);
+   if (noAlias && mFrequencies.size() < (size_t) blockLen)
+   {
+      mFrequencies.resize(blockLen);
+   }
+
    for (i = 0; i < blockLen; i++)
    {
-      switch (mWaveform)
+      double cycles = mPositionInCycles / mSampleRate;
+      buffer[i] = (float) (cycles - floor(cycles));
+      if (noAlias)
       {
-      case kSine:
-         f = sin(pre2PI * mPositionInCycles / mSampleRate);
-         break;
-      case kSquare:
-         f = (modf(mPositionInCycles / mSampleRate, &throwaway) < 0.5) ? 1.0 : -1.0;
-         break;
-      case kSawtooth:
-         f = (2.0 * modf(mPositionInCycles / mSampleRate + 0.5, &throwaway)) - 1.0;
-         break;
-      case kSquareNoAlias:    // Good down to 110Hz @ 44100Hz sampling.
-         //do fundamental (k=1) outside loop
-         b = (1.0 + cos((pre2PI * BlendedFrequency) / mSampleRate)) / pre4divPI;  //scaling
-         f = pre4divPI * sin(pre2PI * mPositionInCycles / mSampleRate);
-         for (k = 3; (k < 200) && (k * BlendedFrequency < mSampleRate / 2.0); k += 2)
-         {
-            //Hanning Window in freq domain
-            a = 1.0 + cos((pre2PI * k * BlendedFrequency) / mSampleRate);
-            //calc harmonic, apply window, scale to amplitude of fundamental
-            f += a * sin(pre2PI * mPositionInCycles / mSampleRate * k) / (b * k);
-         }
+         mFrequencies[i] = (float) (BlendedFrequency / mSampleRate);
       }
-      // insert value in buffer
-      buffer[i] = (float) (BlendedAmplitude * f);
-      // update freq,amplitude
+
+      // update freq
       mPositionInCycles += BlendedFrequency;
-      BlendedAmplitude += amplitudeQuantum;
       if (mInterpolation == kLogarithmic)
       {
-         BlendedLogFrequency += frequencyQuantum;
-         BlendedFrequency = pow(10.0, BlendedLogFrequency);
+         BlendedFrequency *= frequencyQuantum;
       }
       else
       {
@@ -237,6 +219,29 @@ sampleCount EffectToneGen::ProcessBlock(float **WXUNUSED(inBlock), float **outBl
       }
    }
 
+   switch (mWaveform)
+   {
+   case kSine:
+      SineOfCycles(buffer, buffer, blockLen);
+      break;
+   case kSquare:
+      SquareOfCycles(buffer, buffer, blockLen);
+      break;
+   case kSawtooth:
+      SawtoothOfCycles(buffer, buffer, blockLen);
+      break;
+   case kSquareNoAlias:
+      BandLimitedSquareOfCycles(buffer, &mFrequencies[0], buffer, blockLen);
+      break;
+   }
+
+   // apply amplitude
+   for (i = 0; i < blockLen; i++)
+   {
+      buffer[i] = (float) (BlendedAmplitude * buffer[i]);
+      BlendedAmplitude += amplitudeQuantum;
+   }
+
    // update external placeholder
    mSample += blockLen;
 
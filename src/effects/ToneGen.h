@@ -13,6 +13,8 @@
 #ifndef __AUDACITY_EFFECT_TONEGEN__
 #define __AUDACITY_EFFECT_TONEGEN__
 
+#include <vector>
+
 #include <wx/arrstr.h>
 #include <wx/string.h>
 
@@ -75,6 +77,9 @@ private:
    double mAmplitude[2];
    double mLogFrequency[2];
 
+   // Per-sample frequency, in cycles per sample, for kSquareNoAlias
+   std::vector<float> mFrequencies;
+
    wxArrayString mWaveforms;
    wxArrayString mInterpolations;
    NumericTextCtrl *mToneDurationT;
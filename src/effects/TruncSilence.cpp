@@ -22,6 +22,7 @@
 #include <list>
 #include <limits>
 #include <math.h>
+#include <vector>
 
 #include <wx/checkbox.h>
 #include <wx/choice.h>
@@ -561,6 +562,13 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
    // Allocate buffer
    float *buffer = new float[blockLen];
 
+   // The summaries can stand in for the samples only while no preview
+   // length is being measured, and only if a silence to be kept can't fit
+   // between loud samples of two adjacent frames
+   const bool useSummaries = !inputLength && minSilenceFrames >= 2 * 256;
+   std::vector<float> peaks;
+   sampleCount peaksStart = 0, peaksLen = 0;
+
    // Loop through current track
    while (*index < end) {
       if (inputLength && ((outLength >= previewLen) || (*index - start > wt->TimeToLongSamples(*minInputLength)))) {
@@ -629,51 +637,119 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
          count = end - *index;
       }
 
-      // Fill buffer
-      wt->Get((samplePtr)(buffer), floatSample, *index, count);
+      // Look for silences in [pos, pos + len) of the current block
+      auto scan = [&](sampleCount pos, sampleCount len) {
+         wt->Get((samplePtr)(buffer), floatSample, pos, len);
 
-      // Look for silenceList in current block
-      for (sampleCount i = 0; i < count; ++i) {
-         if (inputLength && ((outLength >= previewLen) || (outLength > wt->TimeToLongSamples(*minInputLength)))) {
-            *inputLength = wt->LongSamplesToTime(*index + i) - wt->LongSamplesToTime(start);
-            break;
-         }
+         for (sampleCount i = 0; i < len; ++i) {
+            if (inputLength && ((outLength >= previewLen) || (outLength > wt->TimeToLongSamples(*minInputLength)))) {
+               *inputLength = wt->LongSamplesToTime(pos + i) - wt->LongSamplesToTime(start);
+               break;
+            }
 
-         if (fabs(buffer[i]) < truncDbSilenceThreshold) {
-            (*silentFrame)++;
-         }
-         else {
-            sampleCount allowed = 0;
-            if (*silentFrame >= minSilenceFrames) {
-               if (inputLength) {
-                  switch (mActionIndex) {
-                     case kTruncate:
-                        outLength += wt->TimeToLongSamples(mTruncLongestAllowedSilence);
-                        break;
-                     case kCompress:
-                        allowed = wt->TimeToLongSamples(mInitialAllowedSilence);
-                        outLength += allowed +
-                                       (*silentFrame - allowed) * mSilenceCompressPercent / 100.0;
-                        break;
-                     // default: // Not currently used.
+            if (fabs(buffer[i]) < truncDbSilenceThreshold) {
+               (*silentFrame)++;
+            }
+            else {
+               sampleCount allowed = 0;
+               if (*silentFrame >= minSilenceFrames) {
+                  if (inputLength) {
+                     switch (mActionIndex) {
+                        case kTruncate:
+                           outLength += wt->TimeToLongSamples(mTruncLongestAllowedSilence);
+                           break;
+                        case kCompress:
+                           allowed = wt->TimeToLongSamples(mInitialAllowedSilence);
+                           outLength += allowed +
+                                          (*silentFrame - allowed) * mSilenceCompressPercent / 100.0;
+                           break;
+                        // default: // Not currently used.
+                     }
                   }
+
+                  // Record the silent region
+                  trackSilences.push_back(Region(
+                     wt->LongSamplesToTime(pos + i - *silentFrame),
+                     wt->LongSamplesToTime(pos + i)
+                  ));
+               }
+               else if (inputLength) {   // included as part of non-silence
+                  outLength += *silentFrame;
+               }
+               *silentFrame = 0;
+               if (inputLength) {
+                   ++outLength;   // Add non-silent sample to outLength
+               }
+            }
+         }
+      };
+
+      if (!useSummaries)
+         scan(*index, count);
+      else {
+         // Optimization: consult the 256-sample summaries before reading.
+         // Frames whose peak is under the threshold only lengthen the
+         // silence.  Every frame in a run of loud frames holds a loud sample,
+         // so no silence between the first and the last of the run can reach
+         // minSilenceFrames; only those two frames need reading.
+         sampleCount pos = *index;
+         const sampleCount chunkEnd = *index + count;
+         while (pos < chunkEnd) {
+            if (pos < peaksStart || pos >= peaksStart + peaksLen) {
+               if (!wt->GetBlockPeaks(pos, peaksStart, peaksLen, peaks)) {
+                  peaksStart = peaksLen = 0;
+                  scan(pos, chunkEnd - pos);
+                  break;
                }
+            }
 
-               // Record the silent region
-               trackSilences.push_back(Region(
-                  wt->LongSamplesToTime(*index + i - *silentFrame),
-                  wt->LongSamplesToTime(*index + i)
-               ));
+            // Only whole frames before limit are considered
+            const sampleCount limit = std::min(chunkEnd, peaksStart + peaksLen);
+            auto frameStart = [&](size_t f) { return peaksStart + (sampleCount)f * 256; };
+            auto loudRun = [&](size_t f) {
+               size_t g = f;
+               while (frameStart(g + 1) <= limit && peaks[g] >= truncDbSilenceThreshold)
+                  ++g;
+               return g;
+            };
+
+            // Find the first whole frame after pos that starts a quiet run
+            // or a loud run long enough to skip
+            size_t f = (pos - peaksStart + 255) / 256;
+            while (frameStart(f + 1) <= limit && peaks[f] >= truncDbSilenceThreshold) {
+               const size_t g = loudRun(f);
+               if (g - f >= 3)
+                  break;
+               f = g;
             }
-            else if (inputLength) {   // included as part of non-silence
-               outLength += *silentFrame;
+
+            if (frameStart(f + 1) > limit) {
+               scan(pos, limit - pos);
+               pos = limit;
+               continue;
             }
-            *silentFrame = 0;
-            if (inputLength) {
-                ++outLength;   // Add non-silent sample to outLength
+
+            if (frameStart(f) > pos) {
+               scan(pos, frameStart(f) - pos);
+               pos = frameStart(f);
+            }
+
+            if (peaks[f] < truncDbSilenceThreshold) {
+               size_t g = f;
+               while (frameStart(g + 1) <= limit && peaks[g] < truncDbSilenceThreshold)
+                  ++g;
+               *silentFrame += frameStart(g) - pos;
+               pos = frameStart(g);
+            }
+            else {
+               const size_t g = loudRun(f);
+               scan(pos, frameStart(f + 1) - pos);
+               *silentFrame = 0;
+               pos = frameStart(g - 1);
             }
          }
       }
+
       // Next block
       *index += count;
    }
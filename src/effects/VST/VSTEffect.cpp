@@ -452,9 +452,6 @@ wxArrayString VSTEffectsModule::FindPlugins(PluginManagerInterface & pm)
 
 bool VSTEffectsModule::RegisterPlugin(PluginManagerInterface & pm, const wxString & path)
 {
-   // TODO:  Fix this for external usage
-   const wxString &cmdpath = PlatformCompatibility::GetExecutablePath();
-
    wxString effectIDs = wxT("0;");
    wxStringTokenizer effectTzr(effectIDs, wxT(";"));
 
@@ -469,8 +466,7 @@ bool VSTEffectsModule::RegisterPlugin(PluginManagerInterface & pm, const wxStrin
    {
       wxString effectID = effectTzr.GetNextToken();
 
-      wxString cmd;
-      cmd.Printf(wxT("\"%s\" %s \"%s;%s\""), cmdpath.c_str(), VSTCMDKEY, path.c_str(), effectID.c_str());
+      wxString cmd = GetProbeCommand(path, effectID);
 
       VSTSubProcess proc;
       try
@@ -491,125 +487,178 @@ bool VSTEffectsModule::RegisterPlugin(PluginManagerInterface & pm, const wxStrin
       wxStringOutputStream ss(&output);
       proc.GetInputStream()->Read(ss);
 
-      int keycount = 0;
-      bool haveBegin = false;
-      wxStringTokenizer tzr(output, wxT("\n"));
-      while (tzr.HasMoreTokens())
+      wxString subIDs;
+      valid |= RegisterOutput(pm, proc, output, subIDs, [&]
       {
-         wxString line = tzr.GetNextToken();
-
-         // Our output may follow any output the plugin may have written.
-         if (!line.StartsWith(OUTPUTKEY))
+         if (progress)
          {
-            continue;
+            idNdx++;
+            cont = progress->Update(idNdx,
+                                    wxString::Format(_("Registering %d of %d: %-64.64s"), idNdx, idCnt, proc.GetName().c_str()));
          }
+         return cont;
+      });
 
-         long key;
-         if (!line.Mid(wxStrlen(OUTPUTKEY)).BeforeFirst(wxT('=')).ToLong(&key))
+      if (!subIDs.IsEmpty())
+      {
+         effectIDs = subIDs;
+         effectTzr.Reinit(effectIDs);
+         idCnt = effectTzr.CountTokens();
+         if (idCnt > 3)
          {
-            continue;
+            progress.create( _("Scanning Shell VST"),
+                  wxString::Format(_("Registering %d of %d: %-64.64s"), 0, idCnt, proc.GetName().c_str()),
+                  static_cast<int>(idCnt),
+                  nullptr,
+                  wxPD_APP_MODAL |
+                     wxPD_AUTO_HIDE |
+                     wxPD_CAN_ABORT |
+                     wxPD_ELAPSED_TIME |
+                     wxPD_ESTIMATED_TIME |
+                     wxPD_REMAINING_TIME );
+            progress->Show();
          }
-         wxString val = line.AfterFirst(wxT('=')).BeforeFirst(wxT('\r'));
+      }
+   }
 
-         switch (key)
-         {
-            case kKeySubIDs:
-               effectIDs = val;
-               effectTzr.Reinit(effectIDs);
-               idCnt = effectTzr.CountTokens();
-               if (idCnt > 3)
-               {
-                  progress.create( _("Scanning Shell VST"),
-                        wxString::Format(_("Registering %d of %d: %-64.64s"), 0, idCnt, proc.GetName().c_str()),
-                        static_cast<int>(idCnt),
-                        nullptr,
-                        wxPD_APP_MODAL |
-                           wxPD_AUTO_HIDE |
-                           wxPD_CAN_ABORT |
-                           wxPD_ELAPSED_TIME |
-                           wxPD_ESTIMATED_TIME |
-                           wxPD_REMAINING_TIME );
-                  progress->Show();
-               }
-            break;
+   return valid;
+}
 
-            case kKeyBegin:
-               haveBegin = true;
-               keycount++;
-            break;
+wxString VSTEffectsModule::GetProbeCommand(const wxString & path)
+{
+   return GetProbeCommand(path, wxT("0"));
+}
 
-            case kKeyName:
-               proc.mName = val;
-               keycount++;
-            break;
+bool VSTEffectsModule::RegisterProbedPlugin(PluginManagerInterface & pm,
+                                            const wxString & path,
+                                            const wxString & output)
+{
+   VSTSubProcess proc;
+   wxString subIDs;
+   bool valid = RegisterOutput(pm, proc, output, subIDs, []{ return true; });
 
-            case kKeyPath:
-               proc.mPath = val;
-               keycount++;
-            break;
+   // A shell needs a helper per effect, with its progress dialog
+   if (!subIDs.IsEmpty())
+   {
+      return RegisterPlugin(pm, path);
+   }
 
-            case kKeyVendor:
-               proc.mVendor = val;
-               keycount++;
-            break;
+   return valid;
+}
 
-            case kKeyVersion:
-               proc.mVersion = val;
-               keycount++;
-            break;
+wxString VSTEffectsModule::GetProbeCommand(const wxString & path, const wxString & effectID)
+{
+   // TODO:  Fix this for external usage
+   const wxString &cmdpath = PlatformCompatibility::GetExecutablePath();
 
-            case kKeyDescription:
-               proc.mDescription = val;
-               keycount++;
-            break;
+   wxString cmd;
+   cmd.Printf(wxT("\"%s\" %s \"%s;%s\""), cmdpath.c_str(), VSTCMDKEY, path.c_str(), effectID.c_str());
+   return cmd;
+}
 
-            case kKeyEffectType:
-               long type;
-               val.ToLong(&type);
-               proc.mType = (EffectType) type;
-               keycount++;
-            break;
+bool VSTEffectsModule::RegisterOutput(PluginManagerInterface & pm,
+                                      VSTSubProcess & proc,
+                                      const wxString & output,
+                                      wxString & subIDs,
+                                      const std::function<bool()> & onEffect)
+{
+   bool valid = false;
 
-            case kKeyInteractive:
-               proc.mInteractive = val.IsSameAs(wxT("1"));
-               keycount++;
-            break;
+   int keycount = 0;
+   bool haveBegin = false;
+   wxStringTokenizer tzr(output, wxT("\n"));
+   while (tzr.HasMoreTokens())
+   {
+      wxString line = tzr.GetNextToken();
 
-            case kKeyAutomatable:
-               proc.mAutomatable = val.IsSameAs(wxT("1"));
-               keycount++;
-            break;
+      // Our output may follow any output the plugin may have written.
+      if (!line.StartsWith(OUTPUTKEY))
+      {
+         continue;
+      }
 
-            case kKeyEnd:
-            {
-               if (!haveBegin || ++keycount != kKeyEnd)
-               {
-                  keycount = 0;
-                  haveBegin = false;
-                  continue;
-               }
+      long key;
+      if (!line.Mid(wxStrlen(OUTPUTKEY)).BeforeFirst(wxT('=')).ToLong(&key))
+      {
+         continue;
+      }
+      wxString val = line.AfterFirst(wxT('=')).BeforeFirst(wxT('\r'));
 
-               bool skip = false;
-               if (progress)
-               {
-                  idNdx++;
-                  cont = progress->Update(idNdx,
-                                          wxString::Format(_("Registering %d of %d: %-64.64s"), idNdx, idCnt, proc.GetName().c_str()));
-               }
+      switch (key)
+      {
+         case kKeySubIDs:
+            // Only the first helper for a shell reports its effects
+            subIDs = val;
+         break;
 
-               if (!skip && cont)
-               {
-                  valid = true;
-                  pm.RegisterPlugin(this, &proc);
-               }
-            }
-            break;
+         case kKeyBegin:
+            haveBegin = true;
+            keycount++;
+         break;
+
+         case kKeyName:
+            proc.mName = val;
+            keycount++;
+         break;
 
-            default:
+         case kKeyPath:
+            proc.mPath = val;
+            keycount++;
+         break;
+
+         case kKeyVendor:
+            proc.mVendor = val;
+            keycount++;
+         break;
+
+         case kKeyVersion:
+            proc.mVersion = val;
+            keycount++;
+         break;
+
+         case kKeyDescription:
+            proc.mDescription = val;
+            keycount++;
+         break;
+
+         case kKeyEffectType:
+            long type;
+            val.ToLong(&type);
+            proc.mType = (EffectType) type;
+            keycount++;
+         break;
+
+         case kKeyInteractive:
+            proc.mInteractive = val.IsSameAs(wxT("1"));
+            keycount++;
+         break;
+
+         case kKeyAutomatable:
+            proc.mAutomatable = val.IsSameAs(wxT("1"));
+            keycount++;
+         break;
+
+         case kKeyEnd:
+         {
+            if (!haveBegin || ++keycount != kKeyEnd)
+            {
                keycount = 0;
                haveBegin = false;
-            break;
+               continue;
+            }
+
+            if (onEffect())
+            {
+               valid = true;
+               pm.RegisterPlugin(this, &proc);
+            }
          }
+         break;
+
+         default:
+            keycount = 0;
+            haveBegin = false;
+         break;
       }
    }
 
@@ -17,6 +17,7 @@
 #include "audacity/PluginInterface.h"
 
 #include "../../widgets/NumericTextCtrl.h"
+#include "../../PluginScanner.h"
 
 #include "VSTControl.h"
 
@@ -365,7 +366,10 @@ private:
 //
 ///////////////////////////////////////////////////////////////////////////////
 
-class VSTEffectsModule final : public ModuleInterface
+class VSTSubProcess;
+
+class VSTEffectsModule final : public ModuleInterface,
+                               public PluginProbeInterface
 {
 public:
    VSTEffectsModule(ModuleManagerInterface *moduleManager, const wxString *path);
@@ -394,11 +398,30 @@ public:
    IdentInterface *CreateInstance(const wxString & path) override;
    void DeleteInstance(IdentInterface *instance) override;
 
+   // PluginProbeInterface implementation
+
+   wxString GetProbeCommand(const wxString & path) override;
+   bool RegisterProbedPlugin(PluginManagerInterface & pm,
+                             const wxString & path,
+                             const wxString & output) override;
+
    // VSTEffectModule implementation
 
    static void Check(const wxChar *path);
 
 private:
+   wxString GetProbeCommand(const wxString & path, const wxString & effectID);
+
+   // Registers each effect described in the output of a helper.  If the
+   // plugin is a shell, subIDs gets the IDs of its effects.  onEffect is
+   // called before each effect is registered, and may return false to
+   // skip it.
+   bool RegisterOutput(PluginManagerInterface & pm,
+                       VSTSubProcess & proc,
+                       const wxString & output,
+                       wxString & subIDs,
+                       const std::function<bool()> & onEffect);
+
    ModuleManagerInterface *mModMan;
    wxString mPath;
 };
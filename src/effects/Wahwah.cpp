@@ -324,10 +324,8 @@ void EffectWahwah::InstanceInit(EffectWahwahState & data, float sampleRate)
    data.samplerate = sampleRate;
    data.lfoskip = mFreq * 2 * M_PI / sampleRate;
    data.skipcount = 0;
-   data.xn1 = 0;
-   data.xn2 = 0;
-   data.yn1 = 0;
-   data.yn2 = 0;
+   data.filter.SetStageCount(1);
+   data.filter.Reset();
    data.b0 = 0;
    data.b1 = 0;
    data.b2 = 0;
@@ -346,7 +344,6 @@ sampleCount EffectWahwah::InstanceProcess(EffectWahwahState & data, float **inBl
    float *ibuf = inBlock[0];
    float *obuf = outBlock[0];
    double frequency, omega, sn, cs, alpha;
-   double in, out;
 
    data.lfoskip = mFreq * 2 * M_PI / data.samplerate;
    data.depth = mDepth / 100.0;
@@ -355,13 +352,11 @@ sampleCount EffectWahwah::InstanceProcess(EffectWahwahState & data, float **inBl
    data.phase = mPhase * M_PI / 180.0;
    data.outgain = DB_TO_LINEAR(mOutGain);
 
-   for (int i = 0; i < blockLen; i++)
+   for (sampleCount i = 0; i < blockLen; )
    {
-      in = (double) ibuf[i];
-
-      if ((data.skipcount++) % lfoskipsamples == 0)
+      if (data.skipcount % lfoskipsamples == 0)
       {
-         frequency = (1 + cos(data.skipcount * data.lfoskip + data.phase)) / 2;
+         frequency = (1 + cos((data.skipcount + 1) * data.lfoskip + data.phase)) / 2;
          frequency = frequency * data.depth * (1 - data.freqofs) + data.freqofs;
          frequency = exp((frequency - 1) * 6);
          omega = M_PI * frequency;
@@ -374,15 +369,29 @@ sampleCount EffectWahwah::InstanceProcess(EffectWahwahState & data, float **inBl
          data.a0 = 1 + alpha;
          data.a1 = -2 * cs;
          data.a2 = 1 - alpha;
-      };
-      out = (data.b0 * in + data.b1 * data.xn1 + data.b2 * data.xn2 - data.a1 * data.yn1 - data.a2 * data.yn2) / data.a0;
-      data.xn2 = data.xn1;
-      data.xn1 = in;
-      data.yn2 = data.yn1;
-      data.yn1 = out;
-      out *= data.outgain;
-
-      obuf[i] = (float) out;
+         data.filter.SetStage(0,
+                              data.b0 / data.a0,
+                              data.b1 / data.a0,
+                              data.b2 / data.a0,
+                              data.a1 / data.a0,
+                              data.a2 / data.a0);
+      }
+
+      // Filter up to the next change of the coefficients
+      sampleCount len = lfoskipsamples - data.skipcount % lfoskipsamples;
+      if (len > blockLen - i)
+      {
+         len = blockLen - i;
+      }
+      data.filter.Process(ibuf + i, obuf + i, len);
+
+      data.skipcount += len;
+      i += len;
+   }
+
+   for (sampleCount i = 0; i < blockLen; i++)
+   {
+      obuf[i] = (float) (obuf[i] * data.outgain);
    }
 
    return blockLen;
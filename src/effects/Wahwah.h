@@ -21,6 +21,7 @@
 #include <wx/string.h>
 #include <wx/textctrl.h>
 
+#include "Biquad.h"
 #include "Effect.h"
 
 class ShuttleGui;
@@ -37,8 +38,8 @@ public:
    double outgain;
    double lfoskip;
    unsigned long skipcount;
-   double xn1, xn2, yn1, yn2;
    double b0, b1, b2, a0, a1, a2;
+   BiquadCascade filter;
 };
 
 WX_DECLARE_OBJARRAY(EffectWahwahState, EffectWahwahStateArray);
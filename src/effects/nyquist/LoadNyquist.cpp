@@ -13,6 +13,7 @@
 #include <wx/log.h>
 
 #include "Nyquist.h"
+#include "NyquistPool.h"
 
 #include "LoadNyquist.h"
 
@@ -142,6 +143,7 @@ bool NyquistEffectsModule::Initialize()
       {
          // set_xlisp_path doesn't handle fn_Str() in Unicode build. May or may not actually work.
          nyx_set_xlisp_path(name.GetPath().ToUTF8());
+         NyquistPool::SetXlispPath(name.GetPath());
          return true;
       }
    }
@@ -154,6 +156,7 @@ bool NyquistEffectsModule::Initialize()
 void NyquistEffectsModule::Terminate()
 {
    nyx_set_xlisp_path(NULL);
+   NyquistPool::SetXlispPath(wxEmptyString);
 
    return;
 }
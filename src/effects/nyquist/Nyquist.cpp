@@ -60,6 +60,7 @@ effects from this one class.
 #include "FileDialog.h"
 
 #include "Nyquist.h"
+#include "NyquistFeed.h"
 
 #ifndef nyx_returns_start_and_end_time
 #error You need to update lib-src/libnyquist
@@ -596,6 +597,49 @@ bool NyquistEffect::Process()
       mProps += wxString::Format(wxT("(putprop '*SELECTION* %d 'CHANNELS)\n"), mNumSelectedChannels);
    }
 
+   if (mVersion >= 4)
+   {
+      mPerTrackProps = wxEmptyString;
+      wxString lowHz = wxT("nil");
+      wxString highHz = wxT("nil");
+      wxString centerHz = wxT("nil");
+      wxString bandwidth = wxT("nil");
+
+#if defined(EXPERIMENTAL_SPECTRAL_EDITING)
+      if (mF0 >= 0.0) {
+         lowHz.Printf(wxT("(float %s)"), Internat::ToString(mF0).c_str());
+      }
+
+      if (mF1 >= 0.0) {
+         highHz.Printf(wxT("(float %s)"), Internat::ToString(mF1).c_str());
+      }
+
+      if ((mF0 >= 0.0) && (mF1 >= 0.0)) {
+         centerHz.Printf(wxT("(float %s)"), Internat::ToString(sqrt(mF0 * mF1)).c_str());
+      }
+
+      if ((mF0 > 0.0) && (mF1 >= mF0)) {
+         // with very small values, bandwidth calculation may be inf.
+         // (Observed on Linux)
+         double bw = log(mF1 / mF0) / log(2.0);
+         if (!std::isinf(bw)) {
+            bandwidth.Printf(wxT("(float %s)"), Internat::ToString(bw).c_str());
+         }
+      }
+
+#endif
+      mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'LOW-HZ)\n"), lowHz.c_str());
+      mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'CENTER-HZ)\n"), centerHz.c_str());
+      mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'HIGH-HZ)\n"), highHz.c_str());
+      mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'BANDWIDTH)\n"), bandwidth.c_str());
+   }
+
+   // Process effects can run on several tracks at once in helper
+   // processes, when there is no debugging to show
+   const bool usePool = GetType() == EffectTypeProcess && !mDebug && !mExternal &&
+                        mT1 > mT0 && GetNumWaveGroups() > 1 && NyquistPool::IsEnabled();
+   std::vector<NyquistPool::Job> jobs;
+
    // Keep track of whether the current track is first selected in its sync-lock group
    // (we have no idea what the length of the returned audio will be, so we have
    // to handle sync-lock group behavior the "old" way).
@@ -642,78 +686,30 @@ bool NyquistEffect::Process()
          mProgressIn = 0.0;
          mProgressOut = 0.0;
 
-         // libnyquist breaks except in LC_NUMERIC=="C".
-         //
-         // Note that we must set the locale to "C" even before calling
-         // nyx_init() because otherwise some effects will not work!
-         //
-         // MB: setlocale is not thread-safe.  Should use uselocale()
-         //     if available, or fix libnyquist to be locale-independent.
-         // See also http://bugzilla.audacityteam.org/show_bug.cgi?id=642#c9
-         // for further info about this thread safety question.
-         wxString prevlocale = wxSetlocale(LC_NUMERIC, NULL);
-         wxSetlocale(LC_NUMERIC, wxString(wxT("C")));
-
-         nyx_init();
-         nyx_set_os_callback(StaticOSCallback, (void *)this);
-         nyx_capture_output(StaticOutputCallback, (void *)this);
-
-         if (mVersion >= 4)
-         {
-            mPerTrackProps = wxEmptyString;
-            wxString lowHz = wxT("nil");
-            wxString highHz = wxT("nil");
-            wxString centerHz = wxT("nil");
-            wxString bandwidth = wxT("nil");
-
-#if defined(EXPERIMENTAL_SPECTRAL_EDITING)
-            if (mF0 >= 0.0) {
-               lowHz.Printf(wxT("(float %s)"), Internat::ToString(mF0).c_str());
-            }
-
-            if (mF1 >= 0.0) {
-               highHz.Printf(wxT("(float %s)"), Internat::ToString(mF1).c_str());
-            }
-
-            if ((mF0 >= 0.0) && (mF1 >= 0.0)) {
-               centerHz.Printf(wxT("(float %s)"), Internat::ToString(sqrt(mF0 * mF1)).c_str());
-            }
-
-            if ((mF0 > 0.0) && (mF1 >= mF0)) {
-               // with very small values, bandwidth calculation may be inf.
-               // (Observed on Linux)
-               double bw = log(mF1 / mF0) / log(2.0);
-               if (!std::isinf(bw)) {
-                  bandwidth.Printf(wxT("(float %s)"), Internat::ToString(bw).c_str());
-               }
-            }
-
-#endif
-            mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'LOW-HZ)\n"), lowHz.c_str());
-            mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'CENTER-HZ)\n"), centerHz.c_str());
-            mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'HIGH-HZ)\n"), highHz.c_str());
-            mPerTrackProps += wxString::Format(wxT("(putprop '*SELECTION* %s 'BANDWIDTH)\n"), bandwidth.c_str());
+         if (usePool) {
+            jobs.push_back(MakePoolJob());
          }
+         else {
+            success = ProcessGroup();
 
-         success = ProcessOne();
-
-         nyx_capture_output(NULL, (void *)NULL);
-         nyx_set_os_callback(NULL, (void *)NULL);
-         nyx_cleanup();
-
-         // Reset previous locale
-         wxSetlocale(LC_NUMERIC, prevlocale);
-
-         if (!success) {
-            goto finish;
+            if (!success) {
+               goto finish;
+            }
+            mProgressTot += mProgressIn + mProgressOut;
          }
-         mProgressTot += mProgressIn + mProgressOut;
       }
 
       mCurTrack[0] = (WaveTrack *) iter.Next();
       mCount += mCurNumChannels;
    }
 
+   if (usePool) {
+      success = ProcessPool(jobs);
+      if (!success) {
+         goto finish;
+      }
+   }
+
    if (mOutputTime > 0.0) {
       mT1 = mT0 + mOutputTime;
    }
@@ -825,18 +821,19 @@ bool NyquistEffect::TransferDataFromWindow()
 
 // NyquistEffect implementation
 
-bool NyquistEffect::ProcessOne()
+const char *NyquistEffect::GetAudioName() const
 {
-   nyx_rval rval;
+   return (mVersion >= 4) ? "*TRACK*" : "S";
+}
 
+wxString NyquistEffect::BuildCommand()
+{
    wxString cmd;
 
    if (mVersion >= 4) {
-      nyx_set_audio_name("*TRACK*");
       cmd += wxT("(setf S 0.25)\n");
    }
    else {
-      nyx_set_audio_name("S");
       cmd += wxT("(setf *TRACK* '*unbound*)\n");
    }
 
@@ -955,17 +952,6 @@ bool NyquistEffect::ProcessOne()
                               Internat::ToString(maxPeak).c_str());
    }
 
-   if (GetType() == EffectTypeGenerate) {
-      nyx_set_audio_params(mCurTrack[0]->GetRate(), 0);
-   }
-   else {
-      nyx_set_audio_params(mCurTrack[0]->GetRate(), mCurLen);
-
-      nyx_set_input_audio(StaticGetCallback, (void *)this,
-                          mCurNumChannels,
-                          mCurLen, mCurTrack[0]->GetRate());
-   }
-
    // Restore the Nyquist sixteenth note symbol for Generate plugins.
    // See http://bugzilla.audacityteam.org/show_bug.cgi?id=490.
    if (GetType() == EffectTypeGenerate) {
@@ -1049,9 +1035,42 @@ bool NyquistEffect::ProcessOne()
       cmd += mCmd;
    }
 
+   return cmd;
+}
+
+bool NyquistEffect::ProcessOne()
+{
+   nyx_rval rval;
+
+   nyx_set_audio_name(GetAudioName());
+   const wxString cmd = BuildCommand();
+
+   if (GetType() == EffectTypeGenerate) {
+      nyx_set_audio_params(mCurTrack[0]->GetRate(), 0);
+   }
+   else {
+      nyx_set_audio_params(mCurTrack[0]->GetRate(), mCurLen);
+
+      nyx_set_input_audio(StaticGetCallback, (void *)this,
+                          mCurNumChannels,
+                          mCurLen, mCurTrack[0]->GetRate());
+   }
+
+   // The feeds read and write on threads of their own, and must be gone
+   // before the tracks change
+   auto cleanup = finally([&] {
+      for (int i = 0; i < 2; i++) {
+         mInputFeed[i].reset();
+         mOutputFeed[i].reset();
+      }
+   });
+
    int i;
-   for (i = 0; i < mCurNumChannels; i++) {
-      mCurBuffer[i].Free();
+   if (GetType() != EffectTypeGenerate) {
+      for (i = 0; i < mCurNumChannels; i++) {
+         mInputFeed[i] =
+            std::make_unique<NyquistInputFeed>(mCurTrack[i], mCurStart[i], mCurLen);
+      }
    }
 
    rval = nyx_eval_expression(cmd.mb_str(wxConvUTF8));
@@ -1175,11 +1194,21 @@ bool NyquistEffect::ProcessOne()
       }
 
       mOutputTrack[i] = mFactory->NewWaveTrack(format, rate);
-      mCurBuffer[i].Free();
+      mOutputFeed[i] = std::make_unique<NyquistOutputFeed>(mOutputTrack[i].get());
    }
 
    int success = nyx_get_audio(StaticPutCallback, (void *)this);
 
+   for (i = 0; i < mCurNumChannels; i++) {
+      mInputFeed[i].reset();
+   }
+   for (i = 0; i < outChannels; i++) {
+      if (success && !mOutputFeed[i]->Finish()) {
+         success = false;
+      }
+      mOutputFeed[i].reset();
+   }
+
    if (!success) {
       for(i = 0; i < outChannels; i++) {
          mOutputTrack[i].reset();
@@ -1187,9 +1216,14 @@ bool NyquistEffect::ProcessOne()
       return false;
    }
 
+   return PasteOutput(outChannels);
+}
+
+bool NyquistEffect::PasteOutput(int outChannels)
+{
+   int i;
    for (i = 0; i < outChannels; i++) {
       mOutputTrack[i]->Flush();
-      mCurBuffer[i].Free();
       mOutputTime = mOutputTrack[i]->GetEndTime();
 
       if (mOutputTime <= 0) {
@@ -1246,6 +1280,106 @@ bool NyquistEffect::ProcessOne()
    return true;
 }
 
+bool NyquistEffect::ProcessGroup()
+{
+   // libnyquist breaks except in LC_NUMERIC=="C".
+   //
+   // Note that we must set the locale to "C" even before calling
+   // nyx_init() because otherwise some effects will not work!
+   //
+   // MB: setlocale is not thread-safe.  Should use uselocale()
+   //     if available, or fix libnyquist to be locale-independent.
+   // See also http://bugzilla.audacityteam.org/show_bug.cgi?id=642#c9
+   // for further info about this thread safety question.
+   wxString prevlocale = wxSetlocale(LC_NUMERIC, NULL);
+   wxSetlocale(LC_NUMERIC, wxString(wxT("C")));
+
+   nyx_init();
+   nyx_set_os_callback(StaticOSCallback, (void *)this);
+   nyx_capture_output(StaticOutputCallback, (void *)this);
+
+   bool success = ProcessOne();
+
+   nyx_capture_output(NULL, (void *)NULL);
+   nyx_set_os_callback(NULL, (void *)NULL);
+   nyx_cleanup();
+
+   // Reset previous locale
+   wxSetlocale(LC_NUMERIC, prevlocale);
+
+   return success;
+}
+
+NyquistPool::Job NyquistEffect::MakePoolJob()
+{
+   NyquistPool::Job job;
+
+   job.trackIndex = mTrackIndex;
+   job.firstInGroup = mFirstInGroup;
+   job.count = mCount;
+
+   job.channels = mCurNumChannels;
+   job.len = mCurLen;
+   job.rate = mCurTrack[0]->GetRate();
+   for (int i = 0; i < mCurNumChannels; i++) {
+      job.tracks[i] = mCurTrack[i];
+      job.start[i] = mCurStart[i];
+      job.output[i] = mFactory->NewWaveTrack(mCurTrack[i]->GetSampleFormat(), job.rate);
+   }
+
+   job.audioName = wxString::FromUTF8(GetAudioName());
+   job.cmd = BuildCommand();
+
+   return job;
+}
+
+bool NyquistEffect::ProcessPool(std::vector<NyquistPool::Job> &jobs)
+{
+   {
+      NyquistPool pool;
+      if (!pool.Run(jobs, [this](double frac) { return TotalProgress(frac); })) {
+         return false;
+      }
+   }
+
+   // Paste the results in track order.  A job that did not come back as
+   // audio runs again here, where its messages and labels can be shown.
+   for (size_t j = 0; j < jobs.size(); j++) {
+      NyquistPool::Job &job = jobs[j];
+
+      mCurNumChannels = job.channels;
+      for (int i = 0; i < job.channels; i++) {
+         mCurTrack[i] = job.tracks[i];
+         mCurStart[i] = job.start[i];
+      }
+      mCurLen = job.len;
+      mFirstInGroup = job.firstInGroup;
+      mCount = job.count;
+
+      bool success;
+      if (job.done) {
+         std::cout << job.printed;
+         for (int i = 0; i < job.outChannels; i++) {
+            mOutputTrack[i] = std::move(job.output[i]);
+         }
+         success = PasteOutput(job.outChannels);
+      }
+      else {
+         mTrackIndex = job.trackIndex;
+         mProgressIn = 0.0;
+         mProgressOut = 0.0;
+         mProgressTot = (double) j / jobs.size();
+         success = ProcessGroup();
+      }
+
+      if (!success) {
+         return false;
+      }
+   }
+
+   return true;
+}
+
 // ============================================================================
 // NyquistEffect Implementation
 // ============================================================================
@@ -1710,41 +1844,11 @@ int NyquistEffect::StaticGetCallback(float *buffer, int channel,
 int NyquistEffect::GetCallback(float *buffer, int ch,
                                long start, long len, long WXUNUSED(totlen))
 {
-   if (mCurBuffer[ch].ptr()) {
-      if ((mCurStart[ch] + start) < mCurBufferStart[ch] ||
-          (mCurStart[ch] + start)+len >
-          mCurBufferStart[ch]+mCurBufferLen[ch]) {
-         mCurBuffer[ch].Free();
-      }
+   if (!mInputFeed[ch]->Get(buffer, start, len)) {
+      wxPrintf(wxT("GET error\n"));
+      return -1;
    }
 
-   if (!mCurBuffer[ch].ptr()) {
-      mCurBufferStart[ch] = (mCurStart[ch] + start);
-      mCurBufferLen[ch] = mCurTrack[ch]->GetBestBlockSize(mCurBufferStart[ch]);
-
-      if (mCurBufferLen[ch] < len) {
-         mCurBufferLen[ch] = mCurTrack[ch]->GetIdealBlockSize();
-      }
-
-      if (mCurBufferStart[ch] + mCurBufferLen[ch] > mCurStart[ch] + mCurLen) {
-         mCurBufferLen[ch] = mCurStart[ch] + mCurLen - mCurBufferStart[ch];
-      }
-
-      mCurBuffer[ch].Allocate(mCurBufferLen[ch], floatSample);
-      if (!mCurTrack[ch]->Get(mCurBuffer[ch].ptr(), floatSample,
-                              mCurBufferStart[ch], mCurBufferLen[ch])) {
-
-         wxPrintf(wxT("GET error\n"));
-
-         return -1;
-      }
-   }
-
-   long offset = (mCurStart[ch] + start) - mCurBufferStart[ch];
-   CopySamples(mCurBuffer[ch].ptr() + offset*SAMPLE_SIZE(floatSample), floatSample,
-               (samplePtr)buffer, floatSample,
-               len);
-
    if (ch == 0) {
       double progress = mScale*(((float)start+len)/mCurLen);
 
@@ -1783,7 +1887,7 @@ int NyquistEffect::PutCallback(float *buffer, int channel,
       }
    }
 
-   if (mOutputTrack[channel]->Append((samplePtr)buffer, floatSample, len)) {
+   if (mOutputFeed[channel]->Put(buffer, len)) {
       return 0;  // success
    }
 
@@ -27,6 +27,11 @@
 
 #include "nyx.h"
 
+#include "NyquistPool.h"
+
+class NyquistInputFeed;
+class NyquistOutputFeed;
+
 #define NYQUISTEFFECTS_VERSION wxT("1.0.0.0")
 #define NYQUISTEFFECTS_FAMILY wxT("Nyquist")
 
@@ -114,7 +119,14 @@ public:
 private:
    // NyquistEffect implementation
 
+   bool ProcessGroup();
    bool ProcessOne();
+   const char *GetAudioName() const;
+   wxString BuildCommand();
+   bool PasteOutput(int outChannels);
+
+   NyquistPool::Job MakePoolJob();
+   bool ProcessPool(std::vector<NyquistPool::Job> &jobs);
 
    void BuildPromptWindow(ShuttleGui & S);
    void BuildEffectWindow(ShuttleGui & S);
@@ -220,9 +232,8 @@ private:
    double            mProgressTot;
    double            mScale;
 
-   SampleBuffer      mCurBuffer[2];
-   sampleCount       mCurBufferStart[2];
-   sampleCount       mCurBufferLen[2];
+   std::unique_ptr<NyquistInputFeed> mInputFeed[2];
+   std::unique_ptr<NyquistOutputFeed> mOutputFeed[2];
 
    std::unique_ptr<WaveTrack> mOutputTrack[2];
 
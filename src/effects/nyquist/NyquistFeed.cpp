@@ -0,0 +1,290 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  NyquistFeed.cpp
+
+**********************************************************************/
+
+#include "../../Audacity.h"
+#include "NyquistFeed.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include <wx/thread.h>
+
+#include "../../WaveTrack.h"
+
+class NyquistFeedThread final : public wxThread
+{
+ public:
+   NyquistFeedThread()
+      : wxThread(wxTHREAD_JOINABLE)
+      , mCondition(mMutex)
+      , mJob(NULL)
+      , mBusy(false)
+      , mResult(true)
+      , mStop(false)
+   {
+   }
+
+   ExitCode Entry() override;
+
+   wxMutex mMutex;
+   wxCondition mCondition;
+   NyquistFeedWorker::Job *mJob;
+   bool mBusy;
+   bool mResult;
+   bool mStop;
+};
+
+wxThread::ExitCode NyquistFeedThread::Entry()
+{
+   mMutex.Lock();
+   while (true) {
+      while (!mBusy && !mStop)
+         mCondition.Wait();
+      if (mStop)
+         break;
+
+      // Run the job without the lock, so that Wait() can block on it
+      NyquistFeedWorker::Job *job = mJob;
+      mMutex.Unlock();
+      const bool result = job->Run();
+      mMutex.Lock();
+
+      mResult = result;
+      mBusy = false;
+      mCondition.Broadcast();
+   }
+   mMutex.Unlock();
+
+   return 0;
+}
+
+NyquistFeedWorker::NyquistFeedWorker()
+   : mThread(std::make_unique<NyquistFeedThread>())
+   , mResult(true)
+{
+   // Without a thread the jobs are run in Start() instead
+   if (mThread->Create() != wxTHREAD_NO_ERROR || mThread->Run() != wxTHREAD_NO_ERROR)
+      mThread.reset();
+}
+
+NyquistFeedWorker::~NyquistFeedWorker()
+{
+   if (!mThread)
+      return;
+
+   {
+      wxMutexLocker locker(mThread->mMutex);
+      mThread->mStop = true;
+      mThread->mCondition.Broadcast();
+   }
+   mThread->Wait();
+}
+
+void NyquistFeedWorker::Start(Job &job)
+{
+   if (!mThread) {
+      mResult = job.Run() && mResult;
+      return;
+   }
+
+   wxMutexLocker locker(mThread->mMutex);
+   wxASSERT(!mThread->mBusy);
+   mThread->mJob = &job;
+   mThread->mBusy = true;
+   mThread->mCondition.Broadcast();
+}
+
+bool NyquistFeedWorker::Wait()
+{
+   if (!mThread) {
+      const bool result = mResult;
+      mResult = true;
+      return result;
+   }
+
+   wxMutexLocker locker(mThread->mMutex);
+   while (mThread->mBusy)
+      mThread->mCondition.Wait();
+
+   const bool result = mThread->mResult;
+   mThread->mResult = true;
+   return result;
+}
+
+//
+// NyquistInputFeed
+//
+
+NyquistInputFeed::NyquistInputFeed(WaveTrack *track,
+                                   sampleCount start, sampleCount len)
+   : mTrack(track)
+   , mStart(start)
+   , mEnd(start + len)
+   , mBufferLen(track->GetMaxBlockSize())
+   , mCurrent(0)
+   , mPrefetching(false)
+   , mPrefetchPos(0)
+{
+   for (int i = 0; i < 2; i++) {
+      mBuffers[i].Allocate(mBufferLen, floatSample);
+      mWindowStart[i] = 0;
+      mWindowLen[i] = 0;
+   }
+}
+
+NyquistInputFeed::~NyquistInputFeed()
+{
+   mWorker.Wait();
+}
+
+bool NyquistInputFeed::Get(float *buffer, sampleCount start, sampleCount len)
+{
+   while (len > 0) {
+      const sampleCount pos = mStart + start;
+
+      if (!Contains(mCurrent, pos)) {
+         // A failed read-ahead leaves an empty window, and the read is
+         // retried here
+         if (mPrefetching) {
+            mWorker.Wait();
+            mPrefetching = false;
+         }
+
+         if (Contains(1 - mCurrent, pos))
+            mCurrent = 1 - mCurrent;
+         else if (!Fill(mCurrent, pos))
+            return false;
+
+         Prefetch();
+      }
+
+      const sampleCount offset = pos - mWindowStart[mCurrent];
+      const sampleCount count = std::min(len, mWindowLen[mCurrent] - offset);
+      memcpy(buffer, (float *)mBuffers[mCurrent].ptr() + offset,
+             count * sizeof(float));
+
+      buffer += count;
+      start += count;
+      len -= count;
+   }
+
+   return true;
+}
+
+bool NyquistInputFeed::Run()
+{
+   return Fill(1 - mCurrent, mPrefetchPos);
+}
+
+bool NyquistInputFeed::Fill(int which, sampleCount pos)
+{
+   // Read up to the end of the block holding pos, so that the next read
+   // starts on a block boundary
+   sampleCount len = std::min(mTrack->GetBestBlockSize(pos), mBufferLen);
+   len = std::min(len, mEnd - pos);
+
+   mWindowStart[which] = pos;
+   mWindowLen[which] = 0;
+
+   if (len <= 0 ||
+       !mTrack->Get(mBuffers[which].ptr(), floatSample, pos, len))
+      return false;
+
+   mWindowLen[which] = len;
+   return true;
+}
+
+bool NyquistInputFeed::Contains(int which, sampleCount pos) const
+{
+   return pos >= mWindowStart[which] &&
+          pos < mWindowStart[which] + mWindowLen[which];
+}
+
+void NyquistInputFeed::Prefetch()
+{
+   const sampleCount next = mWindowStart[mCurrent] + mWindowLen[mCurrent];
+   if (next >= mEnd)
+      return;
+
+   mPrefetchPos = next;
+   mPrefetching = true;
+   mWorker.Start(*this);
+}
+
+//
+// NyquistOutputFeed
+//
+
+NyquistOutputFeed::NyquistOutputFeed(WaveTrack *track)
+   : mTrack(track)
+   , mBufferLen(track->GetMaxBlockSize())
+   , mFill(0)
+   , mCurrent(0)
+   , mSending(0)
+   , mSendLen(0)
+   , mOk(true)
+{
+   for (int i = 0; i < 2; i++)
+      mBuffers[i].Allocate(mBufferLen, floatSample);
+}
+
+NyquistOutputFeed::~NyquistOutputFeed()
+{
+   mWorker.Wait();
+}
+
+bool NyquistOutputFeed::Put(const float *buffer, sampleCount len)
+{
+   while (len > 0) {
+      const sampleCount count = std::min(len, mBufferLen - mFill);
+      memcpy((float *)mBuffers[mCurrent].ptr() + mFill, buffer,
+             count * sizeof(float));
+
+      mFill += count;
+      buffer += count;
+      len -= count;
+
+      if (mFill == mBufferLen && !Send())
+         return false;
+   }
+
+   return mOk;
+}
+
+bool NyquistOutputFeed::Finish()
+{
+   if (mFill > 0)
+      Send();
+
+   if (!mWorker.Wait())
+      mOk = false;
+
+   return mOk;
+}
+
+bool NyquistOutputFeed::Run()
+{
+   return mTrack->Append(mBuffers[mSending].ptr(), floatSample, mSendLen);
+}
+
+bool NyquistOutputFeed::Send()
+{
+   // Only one block is appended at a time, in order
+   if (!mWorker.Wait())
+      mOk = false;
+   if (!mOk)
+      return false;
+
+   mSending = mCurrent;
+   mSendLen = mFill;
+   mWorker.Start(*this);
+
+   mCurrent = 1 - mCurrent;
+   mFill = 0;
+   return true;
+}
@@ -0,0 +1,123 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  NyquistFeed.h
+
+**********************************************************************//**
+
+\class NyquistInputFeed
+\brief Serves the samples Nyquist asks for from one channel of the
+selection, reading the next block on a worker thread while the
+interpreter uses the current one.
+
+\class NyquistOutputFeed
+\brief Collects the samples Nyquist returns for one channel into whole
+blocks, appending each to the output track on a worker thread while the
+interpreter fills the other.
+
+Both feeds allocate their two buffers once, when they are constructed.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_NYQUIST_FEED__
+#define __AUDACITY_NYQUIST_FEED__
+
+#include "../../MemoryX.h"
+#include "../../SampleFormat.h"
+
+class WaveTrack;
+class NyquistFeedThread;
+
+/// Runs one job at a time on a thread of its own, or in Start() if the
+/// thread could not be started
+class NyquistFeedWorker
+{
+ public:
+   class Job
+   {
+    public:
+      virtual ~Job() {}
+      virtual bool Run() = 0;
+   };
+
+   NyquistFeedWorker();
+   ~NyquistFeedWorker();
+
+   /// Starts job; the previous job must have been waited for
+   void Start(Job &job);
+
+   /// Waits for the job, if any, and returns its result
+   bool Wait();
+
+ private:
+   std::unique_ptr<NyquistFeedThread> mThread;
+   bool mResult; // of the job run in Start(), when there is no thread
+};
+
+class NyquistInputFeed final : private NyquistFeedWorker::Job
+{
+ public:
+   /// Feeds len samples of track from sample start
+   NyquistInputFeed(WaveTrack *track, sampleCount start, sampleCount len);
+   ~NyquistInputFeed();
+
+   /// Copies len samples, from start samples into the selection, to
+   /// buffer.  Returns false if the track cannot be read.
+   bool Get(float *buffer, sampleCount start, sampleCount len);
+
+ private:
+   bool Run() override;
+
+   bool Fill(int which, sampleCount pos);
+   bool Contains(int which, sampleCount pos) const;
+   void Prefetch();
+
+   WaveTrack *mTrack;
+   sampleCount mStart;
+   sampleCount mEnd;
+
+   sampleCount mBufferLen;
+   SampleBuffer mBuffers[2];
+   sampleCount mWindowStart[2];
+   sampleCount mWindowLen[2];
+   int mCurrent;
+   bool mPrefetching;
+   sampleCount mPrefetchPos;
+
+   NyquistFeedWorker mWorker;
+};
+
+class NyquistOutputFeed final : private NyquistFeedWorker::Job
+{
+ public:
+   explicit NyquistOutputFeed(WaveTrack *track);
+   ~NyquistOutputFeed();
+
+   /// Queues len samples for the track.  Returns false if an earlier
+   /// append failed.
+   bool Put(const float *buffer, sampleCount len);
+
+   /// Appends what is left and waits for it; the caller still has to
+   /// Flush() the track.  Returns false if any append failed.
+   bool Finish();
+
+ private:
+   bool Run() override;
+
+   bool Send();
+
+   WaveTrack *mTrack;
+
+   sampleCount mBufferLen;
+   SampleBuffer mBuffers[2];
+   sampleCount mFill;
+   int mCurrent;
+   int mSending;
+   sampleCount mSendLen;
+   bool mOk;
+
+   NyquistFeedWorker mWorker;
+};
+
+#endif
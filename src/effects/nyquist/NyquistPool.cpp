@@ -0,0 +1,678 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  NyquistPool.cpp
+
+**********************************************************************/
+
+#include "../../Audacity.h"
+#include "NyquistPool.h"
+
+#include <algorithm>
+#include <locale.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+#if defined(__WXMSW__)
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include <wx/process.h>
+#include <wx/stdpaths.h>
+#include <wx/stream.h>
+#include <wx/utils.h>
+
+#include "../../Prefs.h"
+#include "../../WaveTrack.h"
+
+#include "nyx.h"
+
+namespace {
+
+// Messages from a helper.  Each starts with one of these, followed by:
+enum : int32_t
+{
+   kMsgGet = 1,   // channel, start, len; answered with a flag and samples
+   kMsgPut,       // channel, len, samples
+   kMsgResult,    // the nyx_rval of the expression, and its audio channels
+   kMsgDone,      // whether nyx_get_audio() succeeded, and the output text
+};
+
+// Milliseconds between drains of the helpers' standard error, when
+// nothing else wakes the pool
+const int kDrainInterval = 100;
+
+#if !defined(__WXMSW__)
+// A helper that dies must not take us with it when we write to it.  The
+// SIGPIPE of a failed write goes to the thread that wrote, so it is blocked
+// there for the write and taken if it came; the rest of the process keeps
+// its handler.
+class SigpipeBlocker
+{
+ public:
+   SigpipeBlocker()
+   {
+      sigemptyset(&mSigpipe);
+      sigaddset(&mSigpipe, SIGPIPE);
+      pthread_sigmask(SIG_BLOCK, &mSigpipe, &mOldMask);
+   }
+
+   ~SigpipeBlocker()
+   {
+      sigset_t pending;
+      int sig;
+      if (!sigismember(&mOldMask, SIGPIPE) &&
+          sigpending(&pending) == 0 && sigismember(&pending, SIGPIPE))
+         sigwait(&mSigpipe, &sig);
+      pthread_sigmask(SIG_SETMASK, &mOldMask, NULL);
+   }
+
+ private:
+   sigset_t mSigpipe;
+   sigset_t mOldMask;
+};
+#endif
+
+// Gathers a message so that it goes out in a single write
+class MessageBuffer
+{
+ public:
+   template<typename T> void Add(const T &value)
+   {
+      const char *bytes = (const char *)&value;
+      mData.insert(mData.end(), bytes, bytes + sizeof(T));
+   }
+
+   void Add(const char *str, size_t len)
+   {
+      Add((int32_t)len);
+      mData.insert(mData.end(), str, str + len);
+   }
+
+   void Add(const float *samples, size_t len)
+   {
+      const char *bytes = (const char *)samples;
+      mData.insert(mData.end(), bytes, bytes + len * sizeof(float));
+   }
+
+   bool Send(wxOutputStream &os)
+   {
+#if !defined(__WXMSW__)
+      SigpipeBlocker blocker;
+#endif
+      const bool ok = mData.empty() || os.WriteAll(&mData[0], mData.size());
+      mData.clear();
+      return ok;
+   }
+
+   bool Send(FILE *out)
+   {
+      const bool ok = mData.empty() ||
+         fwrite(&mData[0], 1, mData.size(), out) == mData.size();
+      mData.clear();
+      return ok && fflush(out) == 0;
+   }
+
+ private:
+   std::vector<char> mData;
+};
+
+template<typename T> bool Read(wxInputStream &is, T &value)
+{
+   return is.ReadAll(&value, sizeof(T));
+}
+
+template<typename T> bool Read(FILE *in, T &value)
+{
+   return fread(&value, sizeof(T), 1, in) == 1;
+}
+
+bool Read(FILE *in, std::string &str)
+{
+   int32_t len;
+   if (!Read(in, len) || len < 0)
+      return false;
+   str.resize(len);
+   return len == 0 || fread(&str[0], 1, len, in) == (size_t)len;
+}
+
+bool Read(wxInputStream &is, std::string &str)
+{
+   int32_t len;
+   if (!Read(is, len) || len < 0)
+      return false;
+   str.resize(len);
+   return len == 0 || is.ReadAll(&str[0], len);
+}
+
+//
+// The helper process
+//
+
+class NyquistWorker
+{
+ public:
+   NyquistWorker(FILE *in, FILE *out)
+      : mIn(in), mOut(out), mBroken(false)
+   {
+   }
+
+   int Run();
+
+ private:
+   static int StaticGetCallback(float *buffer, int channel,
+                                long start, long len, long totlen,
+                                void *userdata);
+   static int StaticPutCallback(float *buffer, int channel,
+                                long start, long len, long totlen,
+                                void *userdata);
+   static void StaticOutputCallback(int c, void *userdata);
+
+   int GetCallback(float *buffer, int channel, long start, long len);
+   int PutCallback(float *buffer, int channel, long len);
+
+   FILE *mIn;
+   FILE *mOut;
+   MessageBuffer mMessage;
+   std::string mOutput;
+   bool mBroken;
+};
+
+int NyquistWorker::Run()
+{
+   std::string xlispPath;
+   if (!Read(mIn, xlispPath))
+      return 1;
+   nyx_set_xlisp_path(xlispPath.c_str());
+
+   while (!mBroken) {
+      std::string audioName;
+      std::string cmd;
+      double rate;
+      int32_t channels;
+      int64_t len;
+
+      // The pool closes our input when it has no more jobs
+      if (!Read(mIn, audioName))
+         break;
+      if (!Read(mIn, rate) || !Read(mIn, channels) || !Read(mIn, len) ||
+          !Read(mIn, cmd))
+         return 1;
+
+      mOutput.clear();
+
+      nyx_init();
+      nyx_capture_output(StaticOutputCallback, this);
+      nyx_set_audio_name(audioName.c_str());
+      nyx_set_audio_params(rate, (long)len);
+      nyx_set_input_audio(StaticGetCallback, this, channels, (long)len, rate);
+
+      const nyx_rval rval = nyx_eval_expression(cmd.c_str());
+      const int32_t outChannels =
+         (rval == nyx_audio) ? nyx_get_audio_num_channels() : 0;
+
+      mMessage.Add(kMsgResult);
+      mMessage.Add((int32_t)rval);
+      mMessage.Add(outChannels);
+      if (!mMessage.Send(mOut))
+         mBroken = true;
+
+      int32_t success = 0;
+      if (!mBroken && outChannels > 0 && outChannels <= channels)
+         success = nyx_get_audio(StaticPutCallback, this);
+
+      mMessage.Add(kMsgDone);
+      mMessage.Add(success);
+      mMessage.Add(mOutput.c_str(), mOutput.size());
+      if (!mMessage.Send(mOut))
+         mBroken = true;
+
+      nyx_capture_output(NULL, NULL);
+      nyx_cleanup();
+   }
+
+   nyx_set_xlisp_path(NULL);
+
+   return mBroken ? 1 : 0;
+}
+
+int NyquistWorker::StaticGetCallback(float *buffer, int channel,
+                                     long start, long len, long WXUNUSED(totlen),
+                                     void *userdata)
+{
+   return ((NyquistWorker *)userdata)->GetCallback(buffer, channel, start, len);
+}
+
+int NyquistWorker::StaticPutCallback(float *buffer, int channel,
+                                     long WXUNUSED(start), long len, long WXUNUSED(totlen),
+                                     void *userdata)
+{
+   return ((NyquistWorker *)userdata)->PutCallback(buffer, channel, len);
+}
+
+void NyquistWorker::StaticOutputCallback(int c, void *userdata)
+{
+   ((NyquistWorker *)userdata)->mOutput += (char)c;
+}
+
+int NyquistWorker::GetCallback(float *buffer, int channel, long start, long len)
+{
+   mMessage.Add(kMsgGet);
+   mMessage.Add((int32_t)channel);
+   mMessage.Add((int64_t)start);
+   mMessage.Add((int64_t)len);
+
+   int32_t ok;
+   if (!mMessage.Send(mOut) || !Read(mIn, ok) ||
+       (ok && fread(buffer, sizeof(float), len, mIn) != (size_t)len)) {
+      mBroken = true;
+      return -1;
+   }
+
+   // The pool refuses when the user cancels
+   return ok ? 0 : -1;
+}
+
+int NyquistWorker::PutCallback(float *buffer, int channel, long len)
+{
+   mMessage.Add(kMsgPut);
+   mMessage.Add((int32_t)channel);
+   mMessage.Add((int64_t)len);
+   mMessage.Add(buffer, len);
+
+   if (!mMessage.Send(mOut)) {
+      mBroken = true;
+      return -1;
+   }
+
+   return 0;
+}
+
+}
+
+int NyquistWorkerMain()
+{
+   // Messages go out on a private copy of standard output.  Anything else
+   // written there, by libnyquist or a library, goes to standard error.
+#if defined(__WXMSW__)
+   _setmode(_fileno(stdin), _O_BINARY);
+   const int fd = _dup(1);
+   _dup2(2, 1);
+   FILE *out = (fd >= 0) ? _fdopen(fd, "wb") : NULL;
+#else
+   const int fd = dup(1);
+   dup2(2, 1);
+   FILE *out = (fd >= 0) ? fdopen(fd, "wb") : NULL;
+#endif
+   if (!out)
+      return 1;
+
+   // libnyquist breaks except in LC_NUMERIC=="C"
+   setlocale(LC_NUMERIC, "C");
+
+   NyquistWorker worker(stdin, out);
+   const int result = worker.Run();
+
+   fclose(out);
+   return result;
+}
+
+//
+// The pool
+//
+
+class NyquistWorkerProcess final : public wxProcess
+{
+ public:
+   NyquistWorkerProcess()
+      : mPid(0)
+      , mActive(false)
+      , mOrphaned(false)
+   {
+      Redirect();
+   }
+
+   bool Start(const wxString &command)
+   {
+      mPid = wxExecute(command, wxEXEC_ASYNC, this);
+      mActive = (mPid > 0);
+      return mActive;
+   }
+
+   bool IsActive() const
+   {
+      return mActive;
+   }
+
+   void OnTerminate(int WXUNUSED(pid), int WXUNUSED(status)) override
+   {
+      mActive = false;
+      if (mOrphaned)
+         delete this;
+   }
+
+   // wxWidgets tells the object when the helper ends, so it must live as
+   // long as the helper.  Deletes it now, or when the helper ends.
+   void DeleteWhenEnded()
+   {
+      if (mActive)
+         mOrphaned = true;
+      else
+         delete this;
+   }
+
+   void Kill()
+   {
+      if (mActive)
+         wxProcess::Kill(mPid, wxSIGKILL);
+   }
+
+   // Keeps the helper from blocking on a full standard error pipe
+   void DrainErrors()
+   {
+      wxInputStream *es = GetErrorStream();
+      char buffer[1024];
+      while (es && es->CanRead() && es->Read(buffer, sizeof(buffer)).LastRead() > 0)
+         ;
+   }
+
+   // Input and output buffers, reused from job to job
+   std::vector<float> mSamples;
+   MessageBuffer mMessage;
+
+ private:
+   long mPid;
+   bool mActive;
+   bool mOrphaned;
+};
+
+class NyquistPoolThread final : public wxThread
+{
+ public:
+   NyquistPoolThread(NyquistPool &pool, NyquistWorkerProcess &process)
+      : wxThread(wxTHREAD_JOINABLE)
+      , mPool(pool)
+      , mProcess(process)
+   {
+   }
+
+   ExitCode Entry() override
+   {
+      size_t index;
+      while (mPool.NextJob(index)) {
+         // A helper that fails mid-job is not given another; its job is
+         // left for the caller
+         if (!mPool.RunJob(mProcess, index))
+            break;
+      }
+
+      mPool.ThreadFinished();
+      return 0;
+   }
+
+ private:
+   NyquistPool &mPool;
+   NyquistWorkerProcess &mProcess;
+};
+
+wxString NyquistPool::sXlispPath;
+
+NyquistPool::Job::Job()
+   : channels(0)
+   , len(0)
+   , rate(0.0)
+   , firstInGroup(false)
+   , count(0)
+   , trackIndex(0)
+   , done(false)
+   , outChannels(0)
+{
+   for (int i = 0; i < 2; i++) {
+      tracks[i] = NULL;
+      start[i] = 0;
+   }
+}
+
+void NyquistPool::SetXlispPath(const wxString &path)
+{
+   sXlispPath = path;
+}
+
+bool NyquistPool::IsEnabled()
+{
+   return !sXlispPath.IsEmpty() &&
+          gPrefs->Read(wxT("/Nyquist/WorkerProcesses"), 0L) != 0 &&
+          wxThread::GetCPUCount() > 1;
+}
+
+NyquistPool::NyquistPool()
+   : mJobs(NULL)
+   , mCondition(mMutex)
+   , mNextJob(0)
+   , mRunning(0)
+   , mChanged(false)
+   , mCancelled(false)
+{
+}
+
+NyquistPool::~NyquistPool()
+{
+   Shutdown();
+}
+
+bool NyquistPool::Run(std::vector<Job> &jobs,
+                      const std::function<bool(double)> &progress)
+{
+   mJobs = &jobs;
+   mNextJob = 0;
+   mProgress.assign(jobs.size(), 0.0);
+   mCancelled = false;
+
+   const size_t numWorkers =
+      std::min<size_t>(jobs.size(), std::max(1, wxThread::GetCPUCount()));
+   const wxString command = wxT("\"") +
+      wxStandardPaths::Get().GetExecutablePath() + wxT("\" ") + NYQUIST_WORKER_ARG;
+   const wxScopedCharBuffer xlispPath = sXlispPath.ToUTF8();
+
+   for (size_t i = 0; i < numWorkers; i++) {
+      auto process = std::make_unique<NyquistWorkerProcess>();
+      if (!process->Start(command))
+         break;
+
+      process->mMessage.Add(xlispPath.data(), xlispPath.length());
+      const bool ok = process->mMessage.Send(*process->GetOutputStream());
+      mProcesses.push_back(std::move(process));
+      if (!ok)
+         continue;
+
+      auto thread = std::make_unique<NyquistPoolThread>(*this, *mProcesses.back());
+      if (thread->Create() != wxTHREAD_NO_ERROR)
+         continue;
+
+      {
+         wxMutexLocker locker(mMutex);
+         mRunning++;
+      }
+      thread->Run();
+      mThreads.push_back(std::move(thread));
+   }
+
+   // With no helpers, every job is left for the caller
+   bool cancelled = false;
+   while (true) {
+      double done = 0.0;
+      {
+         wxMutexLocker locker(mMutex);
+         if (mRunning > 0 && !mChanged)
+            mCondition.WaitTimeout(kDrainInterval);
+         mChanged = false;
+         if (mRunning == 0)
+            break;
+         for (auto p : mProgress)
+            done += p;
+      }
+
+      for (auto &process : mProcesses)
+         process->DrainErrors();
+
+      if (!cancelled && progress(done / jobs.size())) {
+         cancelled = true;
+         {
+            wxMutexLocker locker(mMutex);
+            mCancelled = true;
+         }
+         // Wakes the threads that are waiting for audio
+         for (auto &process : mProcesses)
+            process->Kill();
+      }
+   }
+
+   Shutdown();
+
+   return !cancelled;
+}
+
+bool NyquistPool::NextJob(size_t &index)
+{
+   wxMutexLocker locker(mMutex);
+   if (mCancelled || mNextJob >= mJobs->size())
+      return false;
+
+   index = mNextJob++;
+   return true;
+}
+
+bool NyquistPool::RunJob(NyquistWorkerProcess &process, size_t index)
+{
+   Job &job = (*mJobs)[index];
+   wxOutputStream &os = *process.GetOutputStream();
+   wxInputStream &is = *process.GetInputStream();
+   MessageBuffer &message = process.mMessage;
+   std::vector<float> &samples = process.mSamples;
+
+   {
+      const wxScopedCharBuffer audioName = job.audioName.ToUTF8();
+      const wxScopedCharBuffer cmd = job.cmd.ToUTF8();
+      message.Add(audioName.data(), audioName.length());
+      message.Add(job.rate);
+      message.Add((int32_t)job.channels);
+      message.Add((int64_t)job.len);
+      message.Add(cmd.data(), cmd.length());
+      if (!message.Send(os))
+         return false;
+   }
+
+   bool appended = true;
+   while (true) {
+      int32_t msg;
+      if (!Read(is, msg))
+         return false;
+
+      switch (msg) {
+      case kMsgGet: {
+         int32_t channel;
+         int64_t start, len;
+         if (!Read(is, channel) || !Read(is, start) || !Read(is, len))
+            return false;
+
+         bool ok = channel >= 0 && channel < job.channels &&
+                   start >= 0 && len >= 0 && start + len <= job.len;
+         {
+            wxMutexLocker locker(mMutex);
+            ok = ok && !mCancelled;
+         }
+         if (ok) {
+            samples.resize(std::max<size_t>(len, 1));
+            ok = job.tracks[channel]->Get((samplePtr)&samples[0], floatSample,
+                                          job.start[channel] + start, len);
+         }
+
+         message.Add((int32_t)ok);
+         if (ok)
+            message.Add(&samples[0], len);
+         if (!message.Send(os))
+            return false;
+
+         if (ok && channel == 0)
+            SetProgress(index, 0.5 * (start + len) / std::max<sampleCount>(job.len, 1));
+         break;
+      }
+
+      case kMsgResult: {
+         int32_t rval, outChannels;
+         if (!Read(is, rval) || !Read(is, outChannels))
+            return false;
+         if (rval == nyx_audio && outChannels > 0 && outChannels <= job.channels)
+            job.outChannels = outChannels;
+         break;
+      }
+
+      case kMsgPut: {
+         int32_t channel;
+         int64_t len;
+         if (!Read(is, channel) || !Read(is, len) || len < 0)
+            return false;
+
+         samples.resize(std::max<size_t>(len, 1));
+         if (len > 0 && !is.ReadAll(&samples[0], len * sizeof(float)))
+            return false;
+
+         if (channel >= 0 && channel < job.outChannels && appended)
+            appended = job.output[channel]->Append((samplePtr)&samples[0],
+                                                   floatSample, len);
+         break;
+      }
+
+      case kMsgDone: {
+         int32_t success;
+         if (!Read(is, success) || !Read(is, job.printed))
+            return false;
+
+         job.done = success && appended && job.outChannels > 0;
+         SetProgress(index, 1.0);
+         return true;
+      }
+
+      default:
+         return false;
+      }
+   }
+}
+
+void NyquistPool::SetProgress(size_t index, double progress)
+{
+   wxMutexLocker locker(mMutex);
+   mProgress[index] = progress;
+   mChanged = true;
+   mCondition.Signal();
+}
+
+void NyquistPool::ThreadFinished()
+{
+   wxMutexLocker locker(mMutex);
+   mRunning--;
+   mChanged = true;
+   mCondition.Signal();
+}
+
+void NyquistPool::Shutdown()
+{
+   for (auto &thread : mThreads)
+      thread->Wait();
+   mThreads.clear();
+
+   // Closing its input tells a helper to quit.  Nothing here waits for
+   // that, so that no events are dispatched under the caller.
+   for (auto &process : mProcesses) {
+      process->CloseOutput();
+      process.release()->DeleteWhenEnded();
+   }
+   mProcesses.clear();
+}
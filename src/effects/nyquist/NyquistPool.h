@@ -0,0 +1,117 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  NyquistPool.h
+
+**********************************************************************//**
+
+\class NyquistPool
+\brief Applies a Nyquist effect to several tracks at once, each in a
+helper process of its own.
+
+The XLISP interpreter in libnyquist is global and not thread-safe, so
+tracks can only be processed in parallel by separate processes.  The
+helpers are Audacity itself, started with NYQUIST_WORKER_ARG, which
+makes it run NyquistWorkerMain() instead of the application.
+
+A helper asks for input audio and sends back output audio over its
+standard input and output; one thread per helper serves those requests
+from the tracks.  Jobs that do not come back as audio are left for the
+caller to run in-process, so that their messages and labels appear just
+as they would have.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_NYQUIST_POOL__
+#define __AUDACITY_NYQUIST_POOL__
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <wx/string.h>
+#include <wx/thread.h>
+
+#include "../../MemoryX.h"
+#include "../../SampleFormat.h"
+
+class WaveTrack;
+class NyquistPoolThread;
+class NyquistWorkerProcess;
+
+/// Command line argument that makes Audacity run as a Nyquist helper
+#define NYQUIST_WORKER_ARG wxT("--nyquist-worker")
+
+/// Serves jobs on standard input and output until it is closed.
+/// Returns the exit code of the helper process.
+int NyquistWorkerMain();
+
+class NyquistPool
+{
+ public:
+   struct Job
+   {
+      Job();
+
+      // Set by the caller before Run()
+      WaveTrack *tracks[2];
+      int channels;
+      sampleCount start[2];
+      sampleCount len;
+      double rate;
+      wxString audioName;
+      wxString cmd;
+      std::unique_ptr<WaveTrack> output[2]; // empty tracks to append to
+
+      // Not used by the pool; the caller's place in its track loop
+      bool firstInGroup;
+      int count;
+      int trackIndex;
+
+      // Set by Run()
+      bool done;        // output holds the audio the job returned
+      int outChannels;
+      std::string printed; // what the job printed
+   };
+
+   /// Where the helpers find nyquist.lsp; empty to disable the pool
+   static void SetXlispPath(const wxString &path);
+
+   /// Whether the user wants the pool and it can run
+   static bool IsEnabled();
+
+   NyquistPool();
+   ~NyquistPool();
+
+   /// Runs the jobs, calling progress on this thread with the fraction
+   /// done until it returns true to cancel.  Returns false if cancelled.
+   bool Run(std::vector<Job> &jobs, const std::function<bool(double)> &progress);
+
+ private:
+   friend class NyquistPoolThread;
+
+   // Called on the worker threads
+   bool NextJob(size_t &index);
+   bool RunJob(NyquistWorkerProcess &process, size_t index);
+   void SetProgress(size_t index, double progress);
+   void ThreadFinished();
+
+   void Shutdown();
+
+   static wxString sXlispPath;
+
+   std::vector<Job> *mJobs;
+   std::vector<std::unique_ptr<NyquistWorkerProcess>> mProcesses;
+   std::vector<std::unique_ptr<NyquistPoolThread>> mThreads;
+
+   wxMutex mMutex;
+   wxCondition mCondition; // signalled on progress and as threads finish
+   size_t mNextJob;
+   std::vector<double> mProgress;
+   int mRunning;
+   bool mChanged;
+   bool mCancelled;
+};
+
+#endif
@@ -35,6 +35,7 @@
 #include <wx/intl.h>
 #include <wx/scrolwin.h>
 #include <wx/version.h>
+#include <wx/thread.h>
 
 
 #include "../../ShuttleGui.h"
@@ -42,6 +43,9 @@
 
 #include "../../LabelTrack.h"
 #include "../../WaveTrack.h"
+#include "../AnalysisJobs.h"
+
+#include <algorithm>
 
 #ifdef __AUDACITY_OLD_STD__
 #include <list>
@@ -386,6 +390,19 @@ bool VampEffect::Init()
    return true;
 }
 
+// One selected track, or stereo pair, and the labels found in it
+struct VampEffect::Job
+{
+   WaveTrack *left;
+   WaveTrack *right;
+   int channels;
+   sampleCount lstart;
+   sampleCount rstart;
+   sampleCount len;
+
+   std::vector<std::pair<SelectedRegion, wxString>> labels;
+};
+
 bool VampEffect::Process()
 {
    if (!mPlugin)
@@ -395,12 +412,7 @@ bool VampEffect::Process()
 
    TrackListOfKindIterator iter(Track::Wave, mTracks);
 
-   int count = 0;
-
-   WaveTrack *left = (WaveTrack *)iter.First();
-
    bool multiple = false;
-   int prevTrackChannels = 0;
 
    if (GetNumWaveGroups() > 1)
    {
@@ -411,162 +423,248 @@ bool VampEffect::Process()
       multiple = true;
    }
 
-   std::vector<std::shared_ptr<Effect::AddedAnalysisTrack>> addedTracks;
+   // Gather the tracks first, so that they can be analysed in any order
+   std::vector<Job> jobs;
+   bool needed[2] = { false, false };
 
-   while (left)
+   for (WaveTrack *left = (WaveTrack *)iter.First(); left; left = (WaveTrack *)iter.Next())
    {
-      sampleCount lstart, rstart = 0;
-      sampleCount len;
-      GetSamples(left, &lstart, &len);
-
-      WaveTrack *right = NULL;
-      int channels = 1;
+      Job job;
+      job.left = left;
+      job.right = NULL;
+      job.channels = 1;
+      job.rstart = 0;
+      GetSamples(left, &job.lstart, &job.len);
 
       if (left->GetLinked())
       {
-         right = (WaveTrack *)iter.Next();
-         channels = 2;
-         GetSamples(right, &rstart, &len);
+         job.right = (WaveTrack *)iter.Next();
+         job.channels = 2;
+         GetSamples(job.right, &job.rstart, &job.len);
       }
 
-      size_t step = mPlugin->getPreferredStepSize();
-      size_t block = mPlugin->getPreferredBlockSize();
+      needed[job.channels - 1] = true;
+      jobs.push_back(std::move(job));
+   }
+
+   if (jobs.empty())
+   {
+      return true;
+   }
 
-      bool initialiseRequired = true;
+   size_t step = mPlugin->getPreferredStepSize();
+   size_t block = mPlugin->getPreferredBlockSize();
 
-      if (block == 0)
+   if (block == 0)
+   {
+      if (step != 0)
       {
-         if (step != 0)
-         {
-            block = step;
-         }
-         else
-         {
-            block = 1024;
-         }
+         block = step;
       }
-
-      if (step == 0)
+      else
       {
-         step = block;
+         block = 1024;
       }
+   }
 
-      if (prevTrackChannels > 0)
+   if (step == 0)
+   {
+      step = block;
+   }
+
+   // Each worker needs its own plugin instance for each channel count,
+   // because a Vamp plugin can't be re-initialised.  The first one is
+   // the plugin the user set up; the others copy its settings.
+   const size_t numWorkers =
+      std::min<size_t>(jobs.size(), std::max(1, wxThread::GetCPUCount()));
+   std::vector<std::unique_ptr<Vamp::Plugin>> clones;
+   std::vector<Vamp::Plugin *> instances(numWorkers * 2, NULL);
+
+   for (size_t w = 0; w < numWorkers; w++)
+   {
+      for (int c = 0; c < 2; c++)
       {
-         // Plugin has already been initialised, so if the number of
-         // channels remains the same, we only need to do a reset.
-         // Otherwise we need to re-construct the whole plugin,
-         // because a Vamp plugin can't be re-initialised.
-         if (prevTrackChannels == channels)
+         if (!needed[c])
          {
-            mPlugin->reset();
-            initialiseRequired = false;
+            continue;
+         }
+
+         Vamp::Plugin *plugin;
+         if (w == 0 && c + 1 == jobs[0].channels)
+         {
+            plugin = mPlugin.get();
          }
          else
          {
-            //!!! todo: retain parameters previously set
-            Init();
+            clones.push_back(ClonePlugin());
+            plugin = clones.back().get();
          }
-      }
 
-      if (initialiseRequired)
-      {
-         if (!mPlugin->initialise(channels, step, block))
+         if (!plugin)
+         {
+            wxMessageBox(_("Sorry, failed to load Vamp Plug-in."));
+            return false;
+         }
+
+         if (!plugin->initialise(c + 1, step, block))
          {
             wxMessageBox(_("Sorry, Vamp Plug-in failed to initialize."));
             return false;
          }
+
+         instances[w * 2 + c] = plugin;
       }
+   }
 
+   // Each worker resets its instances before using them again.  A
+   // worker does one job at a time, so there is no need to lock these.
+   std::vector<char> used(numWorkers * 2, 0);
+
+   if (!RunAnalysisJobs(jobs.size(), numWorkers,
+      [&](size_t w, size_t j, const AnalysisProgress &progress)
+      {
+         Job &job = jobs[j];
+         const int c = job.channels - 1;
+         Vamp::Plugin *plugin = instances[w * 2 + c];
+         if (used[w * 2 + c])
+         {
+            plugin->reset();
+         }
+         used[w * 2 + c] = 1;
+
+         Analyse(plugin, job, step, block, progress);
+      },
+      [&](double frac) { return TotalProgress(frac); }))
+   {
+      return false;
+   }
+
+   // Make the label tracks in the original order of the tracks
+   std::vector<std::shared_ptr<Effect::AddedAnalysisTrack>> addedTracks;
+   for (auto &job : jobs)
+   {
       addedTracks.push_back(AddAnalysisTrack(
          multiple
          ? wxString::Format(wxT("%s: %s"),
-            left->GetName().c_str(), GetName().c_str())
+            job.left->GetName().c_str(), GetName().c_str())
          : GetName()
       ));
       LabelTrack *ltrack = addedTracks.back()->get();
 
-      float **data = new float *[channels]; // ANSWER-ME: Vigilant Sentry marks this as memory leak, var "data" not deleted.
-      for (int c = 0; c < channels; ++c)
+      for (const auto &label : job.labels)
       {
-         data[c] = new float[block];
+         ltrack->AddLabel(label.first, label.second);
       }
+   }
+
+   // All completed without cancellation, so commit the addition of tracks now
+   for (auto &addedTrack : addedTracks)
+      addedTrack->Commit();
 
-      sampleCount originalLen = len;
-      sampleCount ls = lstart;
-      sampleCount rs = rstart;
+   return true;
+}
 
-      while (len)
-      {
-         int request = block;
-         if (request > len) request = len;
+std::unique_ptr<Vamp::Plugin> VampEffect::ClonePlugin()
+{
+   Vamp::HostExt::PluginLoader *loader = Vamp::HostExt::PluginLoader::getInstance();
+   std::unique_ptr<Vamp::Plugin> plugin
+      { loader->loadPlugin(mKey, mRate, Vamp::HostExt::PluginLoader::ADAPT_ALL) };
+   if (!plugin)
+   {
+      return plugin;
+   }
 
-         if (left)
-         {
-            left->Get((samplePtr)data[0], floatSample, ls, request);
-         }
+   if (!plugin->getPrograms().empty())
+   {
+      plugin->selectProgram(mPlugin->getCurrentProgram());
+   }
 
-         if (right)
-         {
-            right->Get((samplePtr)data[1], floatSample, rs, request);
-         }
+   Vamp::Plugin::ParameterList params = mPlugin->getParameterDescriptors();
+   for (size_t p = 0, cnt = params.size(); p < cnt; p++)
+   {
+      plugin->setParameter(params[p].identifier,
+                           mPlugin->getParameter(params[p].identifier));
+   }
 
-         if (request < (int)block)
-         {
-            for (int c = 0; c < channels; ++c)
-            {
-               for (int i = request; i < (int)block; ++i)
-               {
-                  data[c][i] = 0.f;
-               }
-            }
-         }
+   return plugin;
+}
 
-         Vamp::RealTime timestamp = Vamp::RealTime::frame2RealTime(ls, (int)(mRate + 0.5));
+// Runs on a worker thread, so it must not touch anything but job and
+// its plugin.  progress returns true to stop.
+bool VampEffect::Analyse(Vamp::Plugin *plugin, Job &job, size_t step, size_t block,
+                         const std::function<bool(double)> &progress)
+{
+   const int channels = job.channels;
 
-         Vamp::Plugin::FeatureSet features = mPlugin->process(data, timestamp);
-         AddFeatures(ltrack, features);
+   // The cache keeps the overlap of successive blocks, when the step is
+   // less than the block, and reads ahead of the analysis
+   WaveTrackCache caches[2];
+   for (int c = 0; c < channels; ++c)
+   {
+      caches[c].SetReadAhead(2);
+      caches[c].SetTrack(c ? job.right : job.left);
+   }
+   std::vector<float> buffers[2];
+   float *data[2];
+   for (int c = 0; c < channels; ++c)
+   {
+      buffers[c].resize(block);
+      data[c] = &buffers[c][0];
+   }
 
-         if (len > (int)step)
-         {
-            len -= step;
-         }
-         else
-         {
-            len = 0;
-         }
+   sampleCount len = job.len;
+   sampleCount ls = job.lstart;
+   sampleCount rs = job.rstart;
 
-         ls += step;
-         rs += step;
+   while (len)
+   {
+      int request = block;
+      if (request > len) request = len;
 
-         if (channels > 1)
+      for (int c = 0; c < channels; ++c)
+      {
+         const float *samples =
+            (const float *)caches[c].Get(floatSample, c ? rs : ls, request);
+         if (samples)
          {
-            if (TrackGroupProgress(count, (ls - lstart) / double(originalLen)))
-            {
-               return false;
-            }
+            std::copy(samples, samples + request, data[c]);
          }
          else
          {
-            if (TrackProgress(count, (ls - lstart) / double(originalLen)))
-            {
-               return false;
-            }
+            std::fill(data[c], data[c] + request, 0.f);
          }
+
+         std::fill(data[c] + request, data[c] + block, 0.f);
       }
 
-      Vamp::Plugin::FeatureSet features = mPlugin->getRemainingFeatures();
-      AddFeatures(ltrack, features);
+      Vamp::RealTime timestamp = Vamp::RealTime::frame2RealTime(ls, (int)(mRate + 0.5));
 
-      prevTrackChannels = channels;
+      Vamp::Plugin::FeatureSet features = plugin->process(data, timestamp);
+      AddFeatures(job, features);
 
-      left = (WaveTrack *)iter.Next();
+      if (len > (int)step)
+      {
+         len -= step;
+      }
+      else
+      {
+         len = 0;
+      }
+
+      ls += step;
+      rs += step;
+
+      // Leave the last bit of progress for the remaining features
+      if (progress(0.99 * (ls - job.lstart) / double(job.len)))
+      {
+         return false;
+      }
    }
 
-   // All completed without cancellation, so commit the addition of tracks now
-   for (auto &addedTrack : addedTracks)
-      addedTrack->Commit();
+   Vamp::Plugin::FeatureSet features = plugin->getRemainingFeatures();
+   AddFeatures(job, features);
 
+   progress(1.0);
    return true;
 }
 
@@ -772,7 +870,7 @@ bool VampEffect::TransferDataFromWindow()
 
 // VampEffect implementation
 
-void VampEffect::AddFeatures(LabelTrack *ltrack,
+void VampEffect::AddFeatures(Job &job,
                              Vamp::Plugin::FeatureSet &features)
 {
    for (Vamp::Plugin::FeatureList::iterator fli = features[mOutput].begin();
@@ -798,7 +896,7 @@ void VampEffect::AddFeatures(LabelTrack *ltrack,
          }
       }
 
-      ltrack->AddLabel(SelectedRegion(ltime0, ltime1), label);
+      job.labels.push_back(std::make_pair(SelectedRegion(ltime0, ltime1), label));
    }
 }
 
@@ -23,6 +23,8 @@
 #include <wx/stattext.h>
 #include <wx/textctrl.h>
 
+#include <functional>
+
 #include <vamp-hostsdk/PluginLoader.h>
 
 #include "../Effect.h"
@@ -75,7 +77,12 @@ public:
 private:
    // VampEffect implemetation
 
-   void AddFeatures(LabelTrack *track, Vamp::Plugin::FeatureSet & features);
+   struct Job;
+
+   std::unique_ptr<Vamp::Plugin> ClonePlugin();
+   bool Analyse(Vamp::Plugin *plugin, Job &job, size_t step, size_t block,
+                const std::function<bool(double)> &progress);
+   void AddFeatures(Job &job, Vamp::Plugin::FeatureSet & features);
 
    void UpdateFromPlugin();
 
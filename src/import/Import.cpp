@@ -39,6 +39,8 @@ and ImportLOF.cpp.
 #include "Import.h"
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include "ImportPlugin.h"
 
 #include <wx/textctrl.h>
@@ -49,8 +51,11 @@ and ImportLOF.cpp.
 #include <wx/sizer.h>         //for wxBoxSizer
 #include <wx/arrimpl.cpp>
 #include <wx/listimpl.cpp>
+#include <wx/thread.h>
 #include "../ShuttleGui.h"
 #include "../Project.h"
+#include "../Tags.h"
+#include "../WaveTrack.h"
 
 #include "ImportPCM.h"
 #include "ImportMP3.h"
@@ -329,25 +334,10 @@ movable_ptr<ExtImportItem> Importer::CreateDefaultImportItem()
 }
 
 // returns number of tracks imported
-bool Importer::Import(const wxString &fName,
-                     TrackFactory *trackFactory,
-                     TrackHolders &tracks,
-                     Tags *tags,
-                     wxString &errorMessage)
+void Importer::GetPluginsForFile(const wxString &fName, ImportPluginPtrs &importPlugins)
 {
-   AudacityProject *pProj = GetActiveProject();
-   pProj->mbBusyImporting = true;
-
    wxString extension = fName.AfterLast(wxT('.'));
 
-   using ImportPluginPtrs = std::vector< ImportPlugin* >;
-
-   // This list is used to call plugins in correct order
-   ImportPluginPtrs importPlugins;
-
-   // This list is used to remember plugins that should have been compatible with the file.
-   ImportPluginPtrs compatiblePlugins;
-
    // If user explicitly selected a filter,
    // then we should try importing via corresponding plugin first
    wxString type = gPrefs->Read(wxT("/LastOpenType"),wxT(""));
@@ -492,6 +482,26 @@ bool Importer::Import(const wxString &fName,
          }
       }
    }
+}
+
+bool Importer::Import(const wxString &fName,
+                     TrackFactory *trackFactory,
+                     TrackHolders &tracks,
+                     Tags *tags,
+                     wxString &errorMessage)
+{
+   AudacityProject *pProj = GetActiveProject();
+   pProj->mbBusyImporting = true;
+
+   wxString extension = fName.AfterLast(wxT('.'));
+
+   // This list is used to call plugins in correct order
+   ImportPluginPtrs importPlugins;
+
+   // This list is used to remember plugins that should have been compatible with the file.
+   ImportPluginPtrs compatiblePlugins;
+
+   GetPluginsForFile(fName, importPlugins);
 
    // Try the import plugins, in the permuted sequences just determined
    for (const auto plugin : importPlugins)
@@ -691,6 +701,222 @@ bool Importer::Import(const wxString &fName,
    return false;
 }
 
+//-------------------------------------------------------------------------
+// Batch import
+//-------------------------------------------------------------------------
+
+ImportBatchProgress::ImportBatchProgress(size_t numFiles)
+   : mFractions(numFiles, 0.0)
+   , mResult(eProgressSuccess)
+{
+}
+
+int ImportBatchProgress::Update(size_t file, double fraction)
+{
+   ODLocker locker(&mMutex);
+   mFractions[file] = std::min(1.0, std::max(0.0, fraction));
+   return mResult;
+}
+
+double ImportBatchProgress::GetFraction() const
+{
+   ODLocker locker(&mMutex);
+   if (mFractions.empty())
+      return 1.0;
+   double sum = 0.0;
+   for (auto fraction : mFractions)
+      sum += fraction;
+   return sum / mFractions.size();
+}
+
+void ImportBatchProgress::SetResult(int result)
+{
+   ODLocker locker(&mMutex);
+   mResult = result;
+}
+
+namespace {
+
+class ImportThread final : public wxThread
+{
+public:
+   ImportThread(const std::function<void()> &work)
+      : wxThread(wxTHREAD_JOINABLE)
+      , mWork(work)
+   {
+   }
+
+   ExitCode Entry() override
+   {
+      mWork();
+      return 0;
+   }
+
+private:
+   std::function<void()> mWork;
+};
+
+}
+
+// Each file of a batch starts with no tags, so that the caller can merge
+// only what the file had
+static std::shared_ptr<Tags> NewBatchTags()
+{
+   auto tags = std::make_shared<Tags>();
+   tags->Clear();
+   return tags;
+}
+
+bool Importer::ImportBatch(const wxArrayString &fNames,
+                           TrackFactory *trackFactory,
+                           std::vector<BatchResult> &results)
+{
+   AudacityProject *pProj = GetActiveProject();
+   pProj->mbBusyImporting = true;
+
+   const size_t numFiles = fNames.GetCount();
+   results.clear();
+   results.resize(numFiles);
+
+   struct Job
+   {
+      std::unique_ptr<ImportFileHandle> handle;
+      bool background { false };
+      bool cancelled { false };
+      int result { eProgressFailed };
+   };
+   std::vector<Job> jobs(numFiles);
+   std::vector<size_t> background;
+
+   // Probe every file here on the main thread, where the importers may
+   // still ask questions, such as which streams to import.
+   for (size_t i = 0; i < numFiles; i++)
+   {
+      auto &job = jobs[i];
+      results[i].tags = NewBatchTags();
+
+      ImportPluginPtrs importPlugins;
+      GetPluginsForFile(fNames[i], importPlugins);
+      for (const auto plugin : importPlugins)
+      {
+         auto inFile = plugin->Open(fNames[i]);
+         if (!inFile || inFile->GetStreamCount() <= 0)
+            continue;
+
+         if (inFile->GetStreamCount() > 1)
+         {
+            ImportStreamDialog ImportDlg(inFile.get(), NULL, -1, _("Select stream(s) to import"));
+            if (ImportDlg.ShowModal() == wxID_CANCEL)
+            {
+               job.cancelled = true;
+               break;
+            }
+         }
+         else
+            inFile->SetStreamUsage(0,TRUE);
+
+         job.background = inFile->PrepareBackgroundImport();
+         if (job.background)
+            background.push_back(i);
+         job.handle = std::move(inFile);
+         break;
+      }
+   }
+
+   // Decode the files that allow it, several at a time, each into its own
+   // tracks.  The dialog and the block file directory are shared.
+   bool cancelled = false;
+   if (!background.empty())
+   {
+      ImportBatchProgress progress(background.size());
+
+      // The workers make tracks, which must not read preferences there
+      WaveTrack::PrefsSnapshot prefsSnapshot;
+      for (size_t k = 0; k < background.size(); k++)
+         jobs[background[k]].handle->SetBatchProgress(&progress, k);
+
+      std::atomic<size_t> next { 0 };
+      std::atomic<size_t> finished { 0 };
+      auto work = [&]() {
+         size_t k;
+         while ((k = next++) < background.size())
+         {
+            const size_t i = background[k];
+            jobs[i].result =
+               jobs[i].handle->Import(trackFactory, results[i].tracks, results[i].tags.get());
+            ++finished;
+         }
+      };
+
+      const int numCPUs = wxThread::GetCPUCount();
+      const size_t numThreads =
+         std::min<size_t>(std::max(1, numCPUs), background.size());
+      std::vector<std::unique_ptr<ImportThread>> threads;
+      for (size_t t = 0; t < numThreads; t++)
+      {
+         auto thread = std::make_unique<ImportThread>(work);
+         if (thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR)
+            break;
+         threads.push_back(std::move(thread));
+      }
+
+      if (threads.empty())
+         // No threads to be had; do the work here
+         work();
+      else
+      {
+         ProgressDialog dialog(_("Import"),
+            wxString::Format(_("Importing %d files"), (int)background.size()));
+         while (finished < background.size())
+         {
+            int res = dialog.Update(progress.GetFraction(), 1.0);
+            if (res != eProgressSuccess)
+            {
+               progress.SetResult(res);
+               cancelled = cancelled || res == eProgressCancelled || res == eProgressFailed;
+            }
+            wxMilliSleep(50);
+         }
+         for (const auto &thread : threads)
+            thread->Wait();
+      }
+   }
+
+   // Now do the rest one at a time, in order.  A file that its first
+   // importer could not handle gets the full treatment of Import(), which
+   // tries the other importers too and explains failures.  Files decoded
+   // before a cancel are kept.
+   for (size_t i = 0; i < numFiles; i++)
+   {
+      auto &job = jobs[i];
+      auto &result = results[i];
+      if (job.cancelled || (cancelled && !job.background))
+         continue;
+
+      if (!job.background && job.handle)
+         job.result = job.handle->Import(trackFactory, result.tracks, result.tags.get());
+      job.handle.reset();
+
+      if ((job.result == eProgressSuccess || job.result == eProgressStopped) &&
+          result.tracks.size() > 0)
+      {
+         result.success = true;
+         continue;
+      }
+      if (job.result == eProgressCancelled)
+         continue;
+
+      result.tracks.clear();
+      result.tags = NewBatchTags();
+      result.success = Import(fNames[i], trackFactory, result.tracks, result.tags.get(),
+                              result.errorMessage);
+      pProj->mbBusyImporting = true;
+   }
+
+   pProj->mbBusyImporting = false;
+   return !cancelled;
+}
+
 //-------------------------------------------------------------------------
 // ImportStreamDialog
 //-------------------------------------------------------------------------
@@ -144,7 +144,32 @@ public:
               Tags *tags,
               wxString &errorMessage);
 
+   // The outcome of importing one file of a batch
+   struct BatchResult
+   {
+      TrackHolders tracks;
+      std::shared_ptr<Tags> tags;
+      wxString errorMessage;
+      bool success { false };
+   };
+
+   /**
+    * Imports several files, and fills @results in the same order.  Files
+    * whose importers allow it are decoded on worker threads, several at a
+    * time, under one progress dialog; the rest are imported one at a time
+    * as by Import().  Each file's tags start empty, for the caller to
+    * merge in order.  Returns false if the user cancelled the batch.
+    */
+   bool ImportBatch(const wxArrayString &fNames,
+                    TrackFactory *trackFactory,
+                    std::vector<BatchResult> &results);
+
 private:
+   using ImportPluginPtrs = std::vector< ImportPlugin* >;
+
+   // Lists the plugins to try for a file, in the order to try them
+   void GetPluginsForFile(const wxString &fName, ImportPluginPtrs &importPlugins);
+
    static Importer mInstance;
 
    ExtImportItems mExtImportItems;
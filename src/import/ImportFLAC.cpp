@@ -367,6 +367,8 @@ bool FLACImportFileHandle::Init()
    mBitsPerSample=odDecoder->mBitsPerSample;
    mFormat=odDecoder->mFormat;
    mStreamInfoDone=true;
+   //the tags were read by the OD decoder's file, not ours.
+   mFile->mComments=odDecoder->GetFlacFile()->GetComments();
 
 
    return true;
@@ -86,6 +86,11 @@ extern "C" {
 
 #include "../WaveTrack.h"
 
+#ifdef EXPERIMENTAL_OD_MP3
+#include "../ondemand/ODManager.h"
+#include "../ondemand/ODDecodeMP3Task.h"
+#endif
+
 #define INPUT_BUFFER_SIZE 65535
 #define PROGRESS_SCALING_FACTOR 100000
 
@@ -146,6 +151,9 @@ public:
 
 private:
    void ImportID3(Tags *tags);
+#ifdef EXPERIMENTAL_OD_MP3
+   int ImportOnDemand(TrackFactory *trackFactory, TrackHolders &outTracks);
+#endif
 
    std::unique_ptr<wxFile> mFile;
    void *mUserData;
@@ -212,6 +220,18 @@ int MP3ImportFileHandle::Import(TrackFactory *trackFactory, TrackHolders &outTra
 
    CreateProgress();
 
+#ifdef EXPERIMENTAL_OD_MP3
+   {
+      int result = ImportOnDemand(trackFactory, outTracks);
+      if (result != eProgressFailed) {
+         if (result == eProgressSuccess || result == eProgressStopped)
+            ImportID3(tags);
+         return result;
+      }
+      // Otherwise fall back to decoding everything now
+   }
+#endif
+
    /* Prepare decoder data, initialize decoder */
 
    mPrivateData.file        = mFile.get();
@@ -257,6 +277,66 @@ int MP3ImportFileHandle::Import(TrackFactory *trackFactory, TrackHolders &outTra
    return mPrivateData.updateResult;
 }
 
+#ifdef EXPERIMENTAL_OD_MP3
+/// Scans the frame headers only and makes tracks of ODDecodeBlockFiles,
+/// which an ODDecodeMP3Task then decodes in the background.
+/// Returns eProgressFailed if the file could not be scanned.
+int MP3ImportFileHandle::ImportOnDemand(TrackFactory *trackFactory,
+                                        TrackHolders &outTracks)
+{
+   auto decoderTask = make_movable<ODDecodeMP3Task>();
+   ODMP3Decoder *decoder =
+      static_cast<ODMP3Decoder*>(decoderTask->CreateFileDecoder(mFilename));
+
+   int updateResult = eProgressSuccess;
+   if (!decoder->ScanFrames(mProgress.get(), &updateResult))
+      return updateResult == eProgressSuccess ? eProgressFailed : updateResult;
+
+   const int numChannels = decoder->GetNumChannels();
+   TrackHolders channels(numChannels);
+   for (auto &channel : channels) {
+      // Decoded blocks are float, as in the synchronous import
+      channel = trackFactory->NewWaveTrack(floatSample, decoder->GetSampleRate());
+      channel->SetChannel(Track::MonoChannel);
+   }
+
+   /* special case: 2 channels is understood to be stereo */
+   if (numChannels == 2) {
+      channels.begin()->get()->SetChannel(Track::LeftChannel);
+      channels.rbegin()->get()->SetChannel(Track::RightChannel);
+      channels.begin()->get()->SetLinked(true);
+   }
+
+   const sampleCount fileTotalFrames = decoder->GetNumSamples();
+   const sampleCount maxBlockSize = channels.begin()->get()->GetMaxBlockSize();
+   for (sampleCount i = 0; i < fileTotalFrames; i += maxBlockSize) {
+      const sampleCount blockLen = std::min(maxBlockSize, fileTotalFrames - i);
+
+      auto iter = channels.begin();
+      for (int c = 0; c < numChannels; ++c, ++iter)
+         iter->get()->AppendCoded(mFilename, i, blockLen, c, ODTask::eODMP3);
+
+      updateResult = mProgress->Update(i, fileTotalFrames);
+      if (updateResult != eProgressSuccess)
+         break;
+   }
+
+   if (updateResult == eProgressFailed || updateResult == eProgressCancelled)
+      return updateResult;
+
+   //MP3 has at most two channels, so ONE task serves the mono or linked track
+   //and its decoder decodes both channels at once.
+   for (const auto &channel : channels) {
+      channel->Flush();
+      decoderTask->AddWaveTrack(channel.get());
+   }
+   ODManager::Instance()->AddNewTask(std::move(decoderTask));
+
+   outTracks.swap(channels);
+   return updateResult;
+}
+#endif
+
 MP3ImportFileHandle::~MP3ImportFileHandle()
 {
 }
@@ -149,6 +149,9 @@ public:
       }
    }
 
+   // Decoding needs no questions and no dialogs but the progress
+   bool PrepareBackgroundImport() override { return true; }
+
 private:
    std::unique_ptr<wxFFile> mFile;
    std::unique_ptr<OggVorbis_File> mVorbisFile;
@@ -356,8 +359,8 @@ int OggImportFileHandle::Import(TrackFactory *trackFactory, TrackHolders &outTra
 
       samplesSinceLastCallback += samplesRead;
       if (samplesSinceLastCallback > SAMPLES_PER_CALLBACK) {
-          updateResult = mProgress->Update(ov_time_tell(mVorbisFile.get()),
-                                         ov_time_total(mVorbisFile.get(), bitstream));
+          updateResult = UpdateProgress(ov_time_tell(mVorbisFile.get()),
+                                        ov_time_total(mVorbisFile.get(), bitstream));
           samplesSinceLastCallback -= SAMPLES_PER_CALLBACK;
 
       }
@@ -107,10 +107,13 @@ public:
 
    void SetStreamUsage(wxInt32 WXUNUSED(StreamID), bool WXUNUSED(Use)){}
 
+   bool PrepareBackgroundImport() override;
+
 private:
    SFFile                mFile;
    SF_INFO               mInfo;
    sampleFormat          mFormat;
+   wxString              mCopyEdit; // the answer of AskCopyOrEdit(), if asked already
 };
 
 void GetPCMImportPlugin(ImportPluginList & importPluginList,
@@ -322,6 +325,15 @@ How do you want to import the current file(s)?"), oldCopyPref == wxT("copy") ? _
    return oldCopyPref;
 }
 
+bool PCMImportFileHandle::PrepareBackgroundImport()
+{
+   mCopyEdit = AskCopyOrEdit();
+
+   // Reading directly only makes alias block files, which is quick, and
+   // it starts an on-demand task, so leave that to the main thread.
+   return !(mCopyEdit.IsSameAs(wxT("edit"), false) && mInfo.seekable);
+}
+
 int PCMImportFileHandle::Import(TrackFactory *trackFactory,
                                 TrackHolders &outTracks,
                                 Tags *tags)
@@ -331,7 +343,7 @@ int PCMImportFileHandle::Import(TrackFactory *trackFactory,
    wxASSERT(mFile.get());
 
    // Get the preference / warn the user about aliased files.
-   wxString copyEdit = AskCopyOrEdit();
+   wxString copyEdit = mCopyEdit.IsEmpty() ? AskCopyOrEdit() : mCopyEdit;
 
    if (copyEdit == wxT("cancel"))
       return eProgressCancelled;
@@ -398,13 +410,13 @@ int PCMImportFileHandle::Import(TrackFactory *trackFactory,
             iter->get()->AppendAlias(mFilename, i, blockLen, c,useOD);
 
          if (++updateCounter == 50) {
-            updateResult = mProgress->Update(i, fileTotalFrames);
+            updateResult = UpdateProgress(i, fileTotalFrames);
             updateCounter = 0;
             if (updateResult != eProgressSuccess)
                break;
          }
       }
-      updateResult = mProgress->Update(fileTotalFrames, fileTotalFrames);
+      updateResult = UpdateProgress(fileTotalFrames, fileTotalFrames);
 
       if(useOD)
       {
@@ -479,8 +491,7 @@ int PCMImportFileHandle::Import(TrackFactory *trackFactory,
             framescompleted += block;
          }
 
-         updateResult = mProgress->Update((long long unsigned)framescompleted,
-                                        (long long unsigned)fileTotalFrames);
+         updateResult = UpdateProgress(framescompleted, fileTotalFrames);
          if (updateResult != eProgressSuccess)
             break;
 
@@ -34,6 +34,12 @@ Gives API for sound file import.
 
 *//****************************************************************//**
 
+\class ImportBatchProgress
+\brief Collects the progress of files imported on worker threads, so
+that one dialog on the main thread can show them all.
+
+*//****************************************************************//**
+
 \class UnusableImportPlugin
 \brief Used in place of a real plug in for plug ins that have not
 been compiled or are not available in this version of Audacity.  Has
@@ -59,9 +65,11 @@ but little else.
 #include <wx/arrstr.h>
 #include <wx/filename.h>
 #include <wx/string.h>
+#include <vector>
 #include "../MemoryX.h"
 
 #include "../widgets/ProgressDialog.h"
+#include "../ondemand/ODTaskThread.h"
 
 #include "ImportRaw.h" // defines TrackHolders
 
@@ -71,6 +79,25 @@ class Tags;
 
 class ImportFileHandle;
 
+class ImportBatchProgress
+{
+public:
+   ImportBatchProgress(size_t numFiles);
+
+   // Called from the worker threads.  Returns what the dialog last
+   // returned, so that Cancel and Stop reach every file.
+   int Update(size_t file, double fraction);
+
+   // Called from the main thread
+   double GetFraction() const;
+   void SetResult(int result);
+
+private:
+   mutable ODLock mMutex;
+   std::vector<double> mFractions;
+   int mResult;
+};
+
 class ImportPlugin /* not final */
 {
 public:
@@ -122,7 +149,9 @@ class ImportFileHandle /* not final */
 public:
    ImportFileHandle(const wxString & filename)
    :  mFilename(filename),
-   mProgress{}
+   mProgress{},
+   mBatchProgress(NULL),
+   mBatchFile(0)
    {
    }
 
@@ -134,6 +163,10 @@ public:
    // identify the filename being imported.
    void CreateProgress()
    {
+      // The batch has one dialog for all its files
+      if (mBatchProgress)
+         return;
+
       wxFileName ff(mFilename);
       wxString title;
 
@@ -165,9 +198,32 @@ public:
    // Set stream "import/don't import" flag
    virtual void SetStreamUsage(wxInt32 StreamID, bool Use) = 0;
 
+   // Called on the main thread when several files are imported at once.
+   // Return true if Import() may then run on a worker thread; it must
+   // then report progress only through UpdateProgress() and must not
+   // show any dialogs.  Ask the user any questions here instead.
+   virtual bool PrepareBackgroundImport() { return false; }
+
+   // Report progress to the batch instead of to a dialog of our own
+   void SetBatchProgress(ImportBatchProgress *progress, size_t file)
+   {
+      mBatchProgress = progress;
+      mBatchFile = file;
+   }
+
 protected:
+   // Updates our dialog, or the batch; returns eProgressSuccess to go on
+   int UpdateProgress(double current, double total)
+   {
+      if (mBatchProgress)
+         return mBatchProgress->Update(mBatchFile, total > 0 ? current / total : 1.0);
+      return mProgress->Update(current, total);
+   }
+
    wxString mFilename;
    Maybe<ProgressDialog> mProgress;
+   ImportBatchProgress *mBatchProgress;
+   size_t mBatchFile;
 };
 
 
@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <map>
 
 #include "../FFmpeg.h"      // which brings in avcodec.h, avformat.h
 #include "../import/ImportFFmpeg.h"
@@ -85,6 +86,11 @@ public:
    bool SeekingAllowed() ;
 
 private:
+   ///Goes back to the last packet before start that we have seen, or else to
+   ///the beginning of the file, for when the samples we need have been
+   ///decoded already but dropped out of the cache.
+   bool Rewind(sampleCount start);
+
    void InsertCache(movable_ptr<FFMpegDecodeCache> &&cache);
 
    //puts the actual audio samples into the blockfile's data array
@@ -108,10 +114,28 @@ private:
    sampleCount                  mCurrentPos;     //the index of the next sample to be decoded
    sampleCount                  mCurrentLen;     //length of the last packet decoded
 
-   bool                 mSeekingAllowedStatus;
+   int                  mSeekingAllowedStatus;
    int                  mStreamIndex;
+
+   //packets of our stream whose first sample we counted on the way down.
+   //the timestamps aren't good enough to find a sample, but they do find a
+   //packet again.
+   struct SeekPoint
+   {
+      sampleCount sample;
+      int64_t     dts;
+   };
+   std::vector<SeekPoint> mSeekPoints;
+   int64_t              mResyncDts;      //dts of the packet Rewind went to, until it is read
 };
 
+// The decoders for the streams of one file share its format context and
+// codecs, and each stream gets its own task and thread, so decoding is
+// serialized across all of them.  The map remembers which decoder last moved
+// each file position, so the others know their position is stale.
+static ODLock ffmpegDecodeMutex;
+static std::map<const FFmpegContext*, const ODFFmpegDecoder*> ffmpegContextUsers;
+
 auto ODDecodeFFmpegTask::FromList(const std::list<TrackHolders> &channels) -> Streams
 {
    Streams streams;
@@ -250,21 +274,17 @@ mContext(context),
 mNumSamplesInCache(0),
 mCurrentLen(0),
 mSeekingAllowedStatus(ODFFMPEG_SEEKING_TEST_UNKNOWN),
-mStreamIndex(streamIndex)
+mStreamIndex(streamIndex),
+mResyncDts(AV_NOPTS_VALUE)
 {
    PickFFmpegLibs();
 
    //do a shallow copy of the 2d array.
    mChannels = std::move(channels);
 
-   // get the current stream start time.
-   int64_t stream_delay = 0;
-   const auto sc = mScs->get()[streamIndex].get();
-   if (sc->m_stream->start_time != int64_t(AV_NOPTS_VALUE) &&
-       sc->m_stream->start_time > 0) {
-      stream_delay = sc->m_stream->start_time;
-   }
-   mCurrentPos = double(stream_delay) / AV_TIME_BASE;
+   // Sample positions count from the first decoded sample.  ImportFFmpeg
+   // inserts the silence for the stream start time ahead of the coded blocks.
+   mCurrentPos = 0;
 
    //TODO: add a ref counter to scs?  This will be necessary if we want to allow copy and paste of not-yet decoded
    //ODDecodeBlockFiles that point to FFmpeg files.
@@ -273,6 +293,13 @@ mStreamIndex(streamIndex)
 //we have taken ownership, so DELETE the ffmpeg stuff allocated in ImportFFmpeg that was given to us.
 ODFFmpegDecoder::~ODFFmpegDecoder()
 {
+   {
+      ODLocker locker(&ffmpegDecodeMutex);
+      auto iter = ffmpegContextUsers.find(mContext.get());
+      if (iter != ffmpegContextUsers.end() && iter->second == this)
+         ffmpegContextUsers.erase(iter);
+   }
+
    // Do this before unloading libraries
    mContext.reset();
 
@@ -288,8 +315,13 @@ ODFFmpegDecoder::~ODFFmpegDecoder()
 #define kDecodeSampleAllowance 400000
 //number of jump backwards seeks
 #define kMaxSeekRewindAttempts 8
+//samples between the packets remembered for rewinding
+#define kSeekPointSpacing (kDecodeSampleAllowance / 8)
 int ODFFmpegDecoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCount start, sampleCount len, unsigned int channel)
 {
+   //we need to lock this so the format context, codecs and cache stay consistent over the whole decode.
+   ODLocker locker(&ffmpegDecodeMutex);
+
    auto mFormatContext = mContext->ic_ptr;
 
    auto scs = mScs->get();
@@ -298,15 +330,25 @@ int ODFFmpegDecoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCo
 
    data.Allocate(len, format);
    samplePtr bufStart = data.ptr();
+   //anything we fail to decode stays silent.
+   ClearSamples(bufStart, format, 0, len);
    streamContext* sc = NULL;
 
    // printf("start %llu len %llu\n", start, len);
-   //TODO update this to work with seek - this only works linearly now.
-   if(mCurrentPos > start && mCurrentPos  <= start+len + kDecodeSampleAllowance)
-   {
-      //this next call takes data, start and len as reference variables and updates them to reflect the NEW area that is needed.
-      FillDataFromCache(bufStart, format, start,len,channel);
+   //this next call takes data, start and len as reference variables and updates them to reflect the NEW area that is needed.
+   FillDataFromCache(bufStart, format, start,len,channel);
+
+   //the decoding timestamps aren't accurate enough to seek to a sample, so if we have
+   //passed what we need, or another stream's decoder has moved the file position,
+   //start again from the top and count samples on the way down.
+   const ODFFmpegDecoder *&contextUser = ffmpegContextUsers[mContext.get()];
+   if(len && contextUser && contextUser != this)
+      mCurrentPos = start + len + 1;
+   if(len && mCurrentPos > start && !SeekingAllowed()) {
+      if(!Rewind(start))
+         return -1;
    }
+   contextUser = this;
 
    bool seeking = false;
    //look at the decoding timestamp and see if the next sample that will be decoded is not the next sample we need.
@@ -329,9 +371,10 @@ int ODFFmpegDecoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCo
          mCurrentPos = start+len +1;
          while(numAttempts++ < kMaxSeekRewindAttempts && mCurrentPos > start) {
             //we want to move slightly before the start of the block file, but not too far ahead
-            targetts = (start-kDecodeSampleAllowance*numAttempts/kMaxSeekRewindAttempts)  * ((double)st->time_base.den/(st->time_base.num * st->codec->sample_rate ));
-            if(targetts<0)
-               targetts=0;
+            double target = start - (double)kDecodeSampleAllowance*numAttempts/kMaxSeekRewindAttempts;
+            if(target<0)
+               target=0;
+            targetts = target * ((double)st->time_base.den/(st->time_base.num * st->codec->sample_rate ));
 
             //printf("attempting seek to %llu, attempts %d\n", targetts, numAttempts);
             if(av_seek_frame(mFormatContext,stindex,targetts,0) >= 0){
@@ -349,7 +392,7 @@ int ODFFmpegDecoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCo
             }
          }
          if(mCurrentPos>start){
-            mSeekingAllowedStatus = (bool)ODFFMPEG_SEEKING_TEST_FAILED;
+            mSeekingAllowedStatus = ODFFMPEG_SEEKING_TEST_FAILED;
             //               url_fseek(mFormatContext->pb,sc->m_pkt.pos,SEEK_SET);
             printf("seek fail, reverting to previous pos\n");
             return -1;
@@ -362,8 +405,24 @@ int ODFFmpegDecoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCo
    while (len>0 && (mCurrentPos < start+len) && (sc = ReadNextFrame()) != NULL)
    {
       // ReadNextFrame returns 1 if stream is not to be imported
-      if (sc != (streamContext*)1)
+      // Packets of the other streams are left to their own decoders, which
+      // will read them again; caching them here would mix the streams.
+      if (sc != (streamContext*)1 && sc != sci)
+         sc->m_pkt.reset();
+      else if (sc != (streamContext*)1)
       {
+         //make sure a rewind landed on the packet it was after, or else go back to the top.
+         if (mResyncDts != int64_t(AV_NOPTS_VALUE)) {
+            const bool landed = sc->m_pkt->dts == mResyncDts;
+            mResyncDts = AV_NOPTS_VALUE;
+            if (!landed) {
+               sc->m_pkt.reset();
+               if (!Rewind(0))
+                  return -1;
+               continue;
+            }
+         }
+
          //find out the dts we've seekd to.  can't use the stream->cur_dts because it is faulty.  also note that until we do the first seek, pkt.dts can be false and will change for the same samples after the initial seek.
          sampleCount actualDecodeStart = mCurrentPos;
 
@@ -412,6 +471,15 @@ int ODFFmpegDecoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCo
          }
          firstpass=false;
          mCurrentPos = actualDecodeStart;
+
+         //remember a packet now and then, to rewind to instead of the top.
+         if (sc->m_pkt->dts != int64_t(AV_NOPTS_VALUE) &&
+             (mSeekPoints.empty() || mCurrentPos >= mSeekPoints.back().sample + kSeekPointSpacing)) {
+            SeekPoint point;
+            point.sample = mCurrentPos;
+            point.dts = sc->m_pkt->dts;
+            mSeekPoints.push_back(point);
+         }
          //decode the entire packet (unused bits get saved in cache, so as long as cache size limit is bigger than the
          //largest packet size, we're ok.
          while (sc->m_pktRemainingSiz > 0)
@@ -427,14 +495,11 @@ int ODFFmpegDecoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCo
    // Flush the decoders if we're done.
    if((!sc || sc == (streamContext*) 1)&& len>0)
    {
-      for (int i = 0; i < mChannels.size(); i++)
+      sc = sci;
+      sc->m_pkt.create();
+      if (DecodeFrame(sc, true) == 0)
       {
-         sc = scs[i].get();
-         sc->m_pkt.create();
-         if (DecodeFrame(sc, true) == 0)
-         {
-            sc->m_pkt.reset();
-         }
+         sc->m_pkt.reset();
       }
    }
 
@@ -452,6 +517,44 @@ int ODFFmpegDecoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCo
 }
 
 
+bool ODFFmpegDecoder::Rewind(sampleCount start)
+{
+   auto scs = mScs->get();
+   auto sc = scs[mStreamIndex].get();
+
+   //find the last remembered packet at or before start, and go one further
+   //back so the codec has settled by the time we get there.
+   auto point = std::upper_bound(mSeekPoints.begin(), mSeekPoints.end(), start,
+      [](sampleCount value, const SeekPoint &seekPoint) { return value < seekPoint.sample; });
+   if (point - mSeekPoints.begin() >= 2)
+      point -= 2;
+   else
+      point = mSeekPoints.end();
+
+   if (point != mSeekPoints.end() &&
+       av_seek_frame(mContext->ic_ptr, sc->m_stream->index, point->dts, AVSEEK_FLAG_BACKWARD) >= 0) {
+      mCurrentPos = point->sample;
+      mResyncDts = point->dts;
+   }
+   else if (av_seek_frame(mContext->ic_ptr, sc->m_stream->index, 0, AVSEEK_FLAG_BACKWARD) >= 0 ||
+            av_seek_frame(mContext->ic_ptr, -1, 0, AVSEEK_FLAG_BYTE) >= 0) {
+      mCurrentPos = 0;
+      mResyncDts = AV_NOPTS_VALUE;
+   }
+   else
+      return false;
+
+   //drop whatever the codecs were holding from before the seek.
+   for (int i = 0; i < (int)mChannels.size(); i++) {
+      scs[i]->m_pkt.reset();
+      scs[i]->m_pktRemainingSiz = 0;
+      avcodec_flush_buffers(scs[i]->m_codecCtx);
+   }
+
+   mCurrentLen = 0;
+   return true;
+}
+
 //puts the actual audio samples into the blockfile's data array
 // the minimum amount of cache entries necessary to warrant a binary search.
 #define kODFFmpegSearchThreshold 10
@@ -636,7 +739,8 @@ void ODFFmpegDecoder::InsertCache(movable_ptr<FFMpegDecodeCache> &&cache) {
    mDecodeCache.insert(mDecodeCache.begin()+guess, std::move(cache));
    //      mDecodeCache.push_back(cache);
 
-   mNumSamplesInCache+=cache->len;
+   //cache has been moved from, so count what it held with mCurrentLen.
+   mNumSamplesInCache+=mCurrentLen;
 
    //if the cache is too big, drop some.
    while(mNumSamplesInCache>kMaxSamplesInCache)
@@ -110,52 +110,49 @@ void ODFLACFile::error_callback(FLAC__StreamDecoderErrorStatus status)
 FLAC__StreamDecoderWriteStatus ODFLACFile::write_callback(const FLAC__Frame *frame,
                        const FLAC__int32 * const buffer[])
 {
-
-   unsigned int bytesToCopy = frame->header.blocksize;
-   if(bytesToCopy>mDecoder->mDecodeBufferLen-mDecoder->mDecodeBufferWritePosition)
-      bytesToCopy=mDecoder->mDecodeBufferLen-mDecoder->mDecodeBufferWritePosition;
-
-   //the decodeBuffer was allocated to be the same format as the flac buffer, so we can do a straight up memcpy.
-   memcpy(mDecoder->mDecodeBuffer+SAMPLE_SIZE(mDecoder->mFormat)*mDecoder->mDecodeBufferWritePosition,buffer[mDecoder->mTargetChannel],SAMPLE_SIZE(mDecoder->mFormat) * bytesToCopy);
-
-   mDecoder->mDecodeBufferWritePosition+=bytesToCopy;
-/*
-   short *tmp=new short[frame->header.blocksize];
-
-   for (unsigned int chn=0; chn<mDecoder->mNumChannels; chn++) {
-      if (frame->header.bits_per_sample == 16) {
-         for (unsigned int s=0; s<frame->header.blocksize; s++) {
-            tmp[s]=buffer[chn][s];
-         }
-
-         mDecoder->mChannels[chn]->Append((samplePtr)tmp,
-                  int16Sample,
-                  frame->header.blocksize);
+   //after seek_absolute() libflac hands us the frame starting at the target sample,
+   //so we only need to copy up to the end of the requested range.
+   unsigned int samplesToCopy = frame->header.blocksize;
+   if(samplesToCopy>mDecoder->mDecodeBufferLen-mDecoder->mDecodeBufferWritePosition)
+      samplesToCopy=mDecoder->mDecodeBufferLen-mDecoder->mDecodeBufferWritePosition;
+
+   //libflac always gives us 32 bit ints, right justified to the stream's bit depth.
+   const FLAC__int32 *src = buffer[mDecoder->mTargetChannel];
+   const unsigned int bits = frame->header.bits_per_sample;
+   samplePtr dest = mDecoder->mDecodeBuffer + SAMPLE_SIZE(mDecoder->mFormat) * mDecoder->mDecodeBufferWritePosition;
+
+   switch (mDecoder->mFormat)
+   {
+   case int16Sample:
+      {
+         short *out = (short *)dest;
+         const unsigned int shift = bits < 16 ? 16 - bits : 0;
+         for (unsigned int s = 0; s < samplesToCopy; s++)
+            out[s] = (short)(src[s] << shift);
       }
-      else {
-         mDecoder->mChannels[chn]->Append((samplePtr)buffer[chn],
-                  int24Sample,
-                  frame->header.blocksize);
+      break;
+   case int24Sample:
+      {
+         int *out = (int *)dest;
+         const unsigned int shift = bits < 24 ? 24 - bits : 0;
+         for (unsigned int s = 0; s < samplesToCopy; s++)
+            out[s] = src[s] << shift;
+      }
+      break;
+   default:
+      {
+         float *out = (float *)dest;
+         const double scale = 1.0 / (double)(1u << (bits - 1));
+         for (unsigned int s = 0; s < samplesToCopy; s++)
+            out[s] = (float)(src[s] * scale);
       }
+      break;
    }
 
-   delete [] tmp;
-*/
-
+   mDecoder->mDecodeBufferWritePosition+=samplesToCopy;
    mDecoder->mSamplesDone += frame->header.blocksize;
 
    return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
-//   return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
-
-//   mDecoder->mUpdateResult = mDecoder->mProgress->Update((wxULongLong_t) mDecoder->mSamplesDone, mDecoder->mNumSamples != 0 ? (wxULongLong_t)mDecoder->mNumSamples : 1);
-/*
-   if (mDecoder->mUpdateResult != eProgressSuccess)
-   {
-      return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
-   }
-
-   return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
-   */
 }
 
 
@@ -169,16 +166,11 @@ FLAC__StreamDecoderWriteStatus ODFLACFile::write_callback(const FLAC__Frame *fra
    ///the file object if it needs to.
 int ODFlacDecoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCount start, sampleCount len, unsigned int channel)
 {
-
    //we need to lock this so the target stays fixed over the seek/write callback.
-   mFlacFileLock.Lock();
-
-   bool usingCache=mLastDecodeStartSample==start;
-   if(usingCache)
-   {
-      //we've just decoded this, so lets use a cache.  (often so for
-   }
+   ODLocker locker(&mFlacFileLock);
 
+   if(!mFile)
+      return -1;
 
    mDecodeBufferWritePosition=0;
    mDecodeBufferLen = len;
@@ -189,20 +181,28 @@ int ODFlacDecoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCoun
 
    mTargetChannel=channel;
 
+   //seek_absolute delivers the frame containing start through the write callback,
+   //trimmed so that it begins exactly at start.
    if(!mFile->seek_absolute(start))
    {
-      mFlacFileLock.Unlock();
+      //libflac needs a flush before the decoder can be used again.
+      if(mFile->get_state() == FLAC__STREAM_DECODER_SEEK_ERROR)
+         mFile->flush();
       return -1;
    }
 
    while(mDecodeBufferWritePosition<mDecodeBufferLen)
-      mFile->process_single();
-
-   mFlacFileLock.Unlock();
-   if(!usingCache)
    {
-      mLastDecodeStartSample=start;
+      if(!mFile->process_single() ||
+         mFile->get_state() == FLAC__STREAM_DECODER_END_OF_STREAM ||
+         mFile->get_state() == FLAC__STREAM_DECODER_ABORTED)
+         break;
    }
+
+   //a truncated or damaged file: pad with silence rather than leave garbage in the block.
+   if(mDecodeBufferWritePosition<mDecodeBufferLen)
+      ClearSamples(mDecodeBuffer, mFormat, mDecodeBufferWritePosition, mDecodeBufferLen - mDecodeBufferWritePosition);
+
    //insert into blockfile and
    //calculate summary happen in ODDecodeBlockFile::WriteODDecodeBlockFile, where this method is also called.
    return 1;
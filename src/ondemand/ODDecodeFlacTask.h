@@ -76,6 +76,12 @@ class ODFLACFile final : public FLAC::Decoder::File
    {
       return mWasError;
    }
+
+   ///The vorbis comments read along with the header, as NAME=value strings.
+   const wxArrayString &GetComments() const
+   {
+      return mComments;
+   }
  private:
    friend class ODFlacDecoder;
    ODFlacDecoder *mDecoder;
@@ -96,7 +102,8 @@ class ODFlacDecoder final : public ODFileDecoder
    friend class ODFLACFile;
 public:
    ///This should handle unicode converted to UTF-8 on mac/linux, but OD TODO:check on windows
-   ODFlacDecoder(const wxString & fileName):ODFileDecoder(fileName),mSamplesDone(0){mFile=NULL;}
+   ODFlacDecoder(const wxString & fileName)
+      : ODFileDecoder(fileName), mFormat(int16Sample), mSamplesDone(0), mStreamInfoDone(false) {}
    virtual ~ODFlacDecoder();
 
    ///Decodes the samples for this blockfile from the real file into a float buffer.
@@ -127,7 +134,6 @@ private:
    unsigned long         mBitsPerSample;
    FLAC__uint64          mNumSamples;
    FLAC__uint64          mSamplesDone;
-   sampleCount          mLastDecodeStartSample;
    bool                  mStreamInfoDone;
    int                   mUpdateResult;
    WaveTrack           **mChannels;
@@ -0,0 +1,352 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ODDecodeMP3Task.cpp
+
+  Audacity(R) is copyright (c) 1999-2016 Audacity Team.
+  License: GPL v2.  See License.txt.
+
+**********************************************************************/
+
+#include "../Audacity.h"
+#include "ODDecodeMP3Task.h"
+
+#ifdef USE_LIBMAD
+
+#include <algorithm>
+#include <string.h>
+
+#include "../widgets/ProgressDialog.h"
+
+extern "C" {
+#include "mad.h"
+
+#ifdef USE_LIBID3TAG
+#include <id3tag.h>
+#endif
+}
+
+#define INPUT_BUFFER_SIZE 65535
+
+// Frames decoded and thrown away before the first wanted one, besides
+// those holding its bit reservoir, for the overlap of the IMDCT and the
+// synthesis filter to settle
+#define SETTLE_FRAMES 2
+
+namespace {
+
+inline float scale(mad_fixed_t sample)
+{
+   return (float) (sample / (float) (1L << MAD_F_FRACBITS));
+}
+
+// Feeds a mad_stream from a file, keeping track of the file offset
+// of the start of the buffer so that frame positions can be recovered.
+class MP3Input
+{
+public:
+   MP3Input(wxFile &file, wxFileOffset start)
+      : mFile(file), mBufferOffset(start), mEof(false)
+      , mBuffer(INPUT_BUFFER_SIZE + MAD_BUFFER_GUARD)
+   {
+      mFile.Seek(start);
+   }
+
+   // Returns false when there is nothing more to read
+   bool Refill(mad_stream &stream)
+   {
+      if (mEof)
+         return false;
+
+      unsigned char *const buffer = &mBuffer[0];
+      size_t remaining = 0;
+      if (stream.next_frame) {
+         remaining = stream.bufend - stream.next_frame;
+         memmove(buffer, stream.next_frame, remaining);
+         mBufferOffset += stream.next_frame - buffer;
+      }
+
+      ssize_t read = mFile.Read(buffer + remaining, INPUT_BUFFER_SIZE - remaining);
+      if (read <= 0 || mFile.Eof()) {
+         // libmad needs some zero bytes after the last frame to decode it
+         if (read < 0)
+            read = 0;
+         memset(buffer + remaining + read, 0, MAD_BUFFER_GUARD);
+         read += MAD_BUFFER_GUARD;
+         mEof = true;
+      }
+
+      mad_stream_buffer(&stream, buffer, remaining + read);
+      stream.error = MAD_ERROR_NONE;
+      return true;
+   }
+
+   wxFileOffset OffsetOf(const unsigned char *ptr) const
+   {
+      return mBufferOffset + (ptr - &mBuffer[0]);
+   }
+
+private:
+   wxFile &mFile;
+   wxFileOffset mBufferOffset;
+   bool mEof;
+   std::vector<unsigned char> mBuffer;
+};
+
+}
+
+ODDecodeMP3Task::~ODDecodeMP3Task()
+{
+}
+
+movable_ptr<ODTask> ODDecodeMP3Task::Clone() const
+{
+   auto clone = make_movable<ODDecodeMP3Task>();
+   clone->mDemandSample = GetDemandSample();
+
+   //the decoders and blockfiles should not be copied.  They are created as the task runs.
+   return std::move(clone);
+}
+
+///Creates an ODFileDecoder that decodes a file of filetype the subclass handles.
+ODFileDecoder* ODDecodeMP3Task::CreateFileDecoder(const wxString & fileName)
+{
+   auto decoder = make_movable<ODMP3Decoder>(fileName);
+
+   mDecoders.push_back(std::move(decoder));
+   return mDecoders.back().get();
+}
+
+ODMP3Decoder::ODMP3Decoder(const wxString & fileName)
+   : ODFileDecoder(fileName)
+   , mCacheStart(0)
+   , mCacheLen(0)
+   , mTotalSamples(0)
+{
+   mSampleRate = 0;
+   mNumSamples = 0;
+   mNumChannels = 0;
+}
+
+ODMP3Decoder::~ODMP3Decoder()
+{
+}
+
+wxFileOffset ODMP3Decoder::SkipID3(wxFile &file)
+{
+#ifdef USE_LIBID3TAG
+   id3_byte_t query[ID3_TAG_QUERYSIZE];
+   file.Seek(0);
+   int cnt = file.Read(query, sizeof(query));
+   if (cnt == (int)sizeof(query)) {
+      long len = id3_tag_query(query, cnt);
+      if (len > 0)
+         return len;
+   }
+#else
+   wxUnusedVar(file);
+#endif
+   return 0;
+}
+
+bool ODMP3Decoder::ReadHeader()
+{
+   return ScanFrames(NULL);
+}
+
+bool ODMP3Decoder::ScanFrames(ProgressDialog *progress, int *updateResult)
+{
+   ODLocker locker(&mMP3FileLock);
+
+   if (!mFile.IsOpened() && !mFile.Open(mFName))
+      return false;
+
+   const wxFileOffset fileLength = mFile.Length();
+   MP3Input input(mFile, SkipID3(mFile));
+
+   mad_stream stream;
+   mad_header header;
+   mad_stream_init(&stream);
+   mad_header_init(&header);
+
+   int result = eProgressSuccess;
+   sampleCount samples = 0;
+   mFrames.clear();
+
+   bool more = input.Refill(stream);
+   while (more) {
+      if (mad_header_decode(&header, &stream) != 0) {
+         if (stream.error == MAD_ERROR_BUFLEN)
+            more = input.Refill(stream);
+         else if (!MAD_RECOVERABLE(stream.error))
+            break;
+         continue;
+      }
+
+      if (mFrames.empty()) {
+         mSampleRate = header.samplerate;
+         mNumChannels = MAD_NCHANNELS(&header);
+      }
+
+      FrameInfo info;
+      info.offset = input.OffsetOf(stream.this_frame);
+      info.start = samples;
+      info.sideBytes = 0;
+      info.mainDataBegin = 0;
+      if (header.layer == MAD_LAYER_III) {
+         // Layer III frames may take their main data from as far back as
+         // main_data_begin bytes, the bit reservoir, which is the first
+         // field of the side information.  libmad has checked that the
+         // whole frame is in the buffer.
+         const bool lsf = (header.flags & MAD_FLAG_LSF_EXT) != 0;
+         const bool mono = MAD_NCHANNELS(&header) == 1;
+         const unsigned char *side =
+            stream.this_frame + 4 + ((header.flags & MAD_FLAG_PROTECTION) ? 2 : 0);
+         info.sideBytes = (side - stream.this_frame) + (lsf ? (mono ? 9 : 17) : (mono ? 17 : 32));
+         info.mainDataBegin = lsf ? side[0] : ((side[0] << 1) | (side[1] >> 7));
+      }
+      mFrames.push_back(info);
+      samples += 32 * MAD_NSBSAMPLES(&header);
+
+      if (progress && (mFrames.size() % 1000) == 0) {
+         result = progress->Update((wxULongLong_t)info.offset,
+                                   (wxULongLong_t)std::max<wxFileOffset>(fileLength, 1));
+         if (result != eProgressSuccess)
+            break;
+      }
+   }
+
+   mad_header_finish(&header);
+   mad_stream_finish(&stream);
+
+   if (updateResult)
+      *updateResult = result;
+
+   mTotalSamples = samples;
+   mNumSamples = samples;
+
+   if (mFrames.empty() || result != eProgressSuccess)
+      return false;
+
+   MarkInitialized();
+   return true;
+}
+
+size_t ODMP3Decoder::MainDataStart(size_t index) const
+{
+   // Walk back over the main data of the earlier frames, which is what
+   // is left of each after its header and side information
+   long needed = mFrames[index].mainDataBegin;
+   while (needed > 0 && index > 0) {
+      --index;
+      needed -= (long) (mFrames[index + 1].offset - mFrames[index].offset)
+                - mFrames[index].sideBytes;
+   }
+   return index;
+}
+
+size_t ODMP3Decoder::PrerollStart(size_t target) const
+{
+   // The frames settling the synthesis must decode right too, so their
+   // reservoirs must be read as well
+   size_t first = target > SETTLE_FRAMES ? target - SETTLE_FRAMES : 0;
+   size_t start = first;
+   for (size_t f = first; f <= target; f++)
+      start = std::min(start, MainDataStart(f));
+   return start;
+}
+
+void ODMP3Decoder::DecodeAll(sampleCount start, sampleCount len)
+{
+   const unsigned int numChannels = std::max(1u, mNumChannels);
+   mCache.resize(numChannels);
+   for (auto &channel : mCache)
+      channel.assign(len, 0.0f);
+   mCacheStart = start;
+   mCacheLen = len;
+
+   // Find the frame containing the first wanted sample
+   auto compare = [](sampleCount value, const FrameInfo &info)
+      { return value < info.start; };
+   size_t target =
+      std::upper_bound(mFrames.begin(), mFrames.end(), start, compare) - mFrames.begin();
+   target = target > 0 ? target - 1 : 0;
+   size_t frameIndex = PrerollStart(target);
+
+   MP3Input input(mFile, mFrames[frameIndex].offset);
+
+   mad_stream stream;
+   mad_frame frame;
+   mad_synth synth;
+   mad_stream_init(&stream);
+   mad_frame_init(&frame);
+   mad_synth_init(&synth);
+
+   const sampleCount end = start + len;
+   bool more = input.Refill(stream);
+   while (more) {
+      if (mad_frame_decode(&frame, &stream) != 0) {
+         if (stream.error == MAD_ERROR_BUFLEN)
+            more = input.Refill(stream);
+         else if (!MAD_RECOVERABLE(stream.error))
+            break;
+         // Errors such as a missing bit reservoir are expected in the preroll
+         continue;
+      }
+
+      // Identify the frame from its position, in case some were skipped
+      const wxFileOffset offset = input.OffsetOf(stream.this_frame);
+      while (frameIndex + 1 < mFrames.size() && mFrames[frameIndex + 1].offset <= offset)
+         ++frameIndex;
+      const sampleCount frameStart = mFrames[frameIndex].start;
+      if (frameStart >= end)
+         break;
+
+      mad_synth_frame(&synth, &frame);
+
+      if (frameIndex >= target) {
+         const struct mad_pcm &pcm = synth.pcm;
+         const sampleCount first = std::max(start, frameStart);
+         const sampleCount last = std::min(end, frameStart + pcm.length);
+         for (unsigned int c = 0; c < numChannels; c++) {
+            const unsigned int chn = std::min<unsigned int>(c, pcm.channels - 1);
+            float *const out = &mCache[c][0];
+            for (sampleCount s = first; s < last; s++)
+               out[s - start] = scale(pcm.samples[chn][s - frameStart]);
+         }
+      }
+   }
+
+   mad_synth_finish(&synth);
+   mad_frame_finish(&frame);
+   mad_stream_finish(&stream);
+}
+
+int ODMP3Decoder::Decode(SampleBuffer & data, sampleFormat & format, sampleCount start, sampleCount len, unsigned int channel)
+{
+   //we need to lock this so the file position and decoder state stay ours.
+   ODLocker locker(&mMP3FileLock);
+
+   data.Allocate(len, floatSample);
+   format = floatSample;
+   float *const out = (float *)data.ptr();
+   std::fill(out, out + len, 0.0f);
+
+   if (mFrames.empty() || (!mFile.IsOpened() && !mFile.Open(mFName)))
+      return -1;
+
+   // The blocks of the channels come in turn, so the other channel's
+   // samples are usually decoded already
+   if (mCache.empty() || start != mCacheStart || len != mCacheLen)
+      DecodeAll(start, len);
+
+   const std::vector<float> &samples = mCache[std::min<size_t>(channel, mCache.size() - 1)];
+   std::copy(samples.begin(), samples.end(), out);
+
+   //insert into blockfile and
+   //calculate summary happen in ODDecodeBlockFile::WriteODDecodeBlockFile, where this method is also called.
+   return 1;
+}
+
+#endif /* USE_LIBMAD */
@@ -0,0 +1,109 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ODDecodeMP3Task.h
+
+  Audacity(R) is copyright (c) 1999-2016 Audacity Team.
+  License: GPL v2.  See License.txt.
+
+******************************************************************//**
+
+\class ODDecodeMP3Task
+\brief Decodes an MP3 file into ODDecodeBlockFiles, but not immediately.
+
+The file is scanned once for frame headers, which is fast because no
+audio is synthesized.  The resulting seek index lets ODMP3Decoder decode
+any block of the file starting a few frames before it, so blocks can be
+decoded in whatever order the ODDecodeTask chooses.  The channels of a
+block are decoded together, and kept until the other channel's block
+asks for them.
+
+*//*******************************************************************/
+
+#ifndef __AUDACITY_ODDecodeMP3Task__
+#define __AUDACITY_ODDecodeMP3Task__
+
+#include <vector>
+#include <wx/file.h>
+#include "ODDecodeTask.h"
+#include "ODTaskThread.h"
+
+class ProgressDialog;
+
+/// A class representing a modular task to be used with the On-Demand structures.
+class ODDecodeMP3Task final : public ODDecodeTask
+{
+ public:
+
+   /// Constructs an ODTask
+   ODDecodeMP3Task(){}
+   virtual ~ODDecodeMP3Task();
+
+   movable_ptr<ODTask> Clone() const override;
+   ///Creates an ODFileDecoder that decodes a file of filetype the subclass handles.
+   ODFileDecoder* CreateFileDecoder(const wxString & fileName) override;
+
+   ///Lets other classes know that this class handles mp3
+   unsigned int GetODType() override { return eODMP3; }
+};
+
+///class to decode a particular mp3 file (one per file), using a seek index built by ScanFrames().
+class ODMP3Decoder final : public ODFileDecoder
+{
+public:
+   ODMP3Decoder(const wxString & fileName);
+   virtual ~ODMP3Decoder();
+
+   ///Decodes len samples of one channel, starting at sample start, into data.
+   ///Decoding starts early enough that the bit reservoir and the synthesis
+   ///filter are primed; those samples are discarded.  All the channels are
+   ///decoded, and the others kept for the next call for the same samples.
+   int Decode(SampleBuffer & data, sampleFormat & format, sampleCount start, sampleCount len, unsigned int channel) override;
+
+   ///Builds the seek index without a progress dialog.
+   bool ReadHeader() override;
+
+   ///Builds the seek index, reading only frame headers.  Returns false if
+   ///no frames were found or the user cancelled; updateResult, if given,
+   ///receives the last progress result.
+   bool ScanFrames(ProgressDialog *progress, int *updateResult = NULL);
+
+   unsigned int GetSampleRate() const { return mSampleRate; }
+   unsigned int GetNumChannels() const { return mNumChannels; }
+   sampleCount GetNumSamples() const { return mTotalSamples; }
+
+private:
+   struct FrameInfo
+   {
+      wxFileOffset offset; // of the frame header in the file
+      sampleCount start;   // first sample the frame decodes to
+      unsigned short sideBytes;      // header, CRC and side information
+      unsigned short mainDataBegin;  // bytes of main data in earlier frames
+   };
+
+   ///Skips an ID3v2 tag, if any, and returns the offset of the audio data.
+   static wxFileOffset SkipID3(wxFile &file);
+
+   ///The first frame to decode so that frame target comes out right.
+   size_t PrerollStart(size_t target) const;
+
+   ///The frame holding the start of the main data of frame index.
+   size_t MainDataStart(size_t index) const;
+
+   ///Decodes all channels of len samples starting at start into mCache.
+   void DecodeAll(sampleCount start, sampleCount len);
+
+   std::vector<FrameInfo> mFrames;
+
+   // The samples last decoded, by channel
+   std::vector< std::vector<float> > mCache;
+   sampleCount    mCacheStart;
+   sampleCount    mCacheLen;
+
+   sampleCount    mTotalSamples;
+   wxFile         mFile;
+   ODLock         mMP3FileLock;//for mFile and the decoder state
+};
+
+#endif
@@ -133,6 +133,12 @@ void EffectsPrefs::PopulateOrExchange(ShuttleGui & S)
                              5);
       }
       S.EndMultiColumn();
+
+#if USE_NYQUIST
+      S.TieCheckBox(_("Run N&yquist effects on several tracks at once, in helper processes"),
+                    wxT("/Nyquist/WorkerProcesses"),
+                    false);
+#endif
    }
    S.EndStatic();
 
@@ -56,9 +56,12 @@
 #include <wx/radiobut.h>
 #include <wx/tooltip.h>
 #include <wx/msgdlg.h>
+#include <wx/thread.h>
 
 #include <math.h>
+#include <vector>
 
+#include "MeterAnalyzer.h"
 #include "../AudioIO.h"
 #include "../AColor.h"
 #include "../ImageManipulation.h"
@@ -67,6 +70,7 @@
 #include "../toolbars/MeterToolBar.h"
 #include "../toolbars/ControlToolBar.h"
 #include "../Prefs.h"
+#include "../RingBuffer.h"
 #include "../ShuttleGui.h"
 
 #include "../Theme.h"
@@ -77,6 +81,11 @@
 static const long MIN_REFRESH_RATE = 1;
 static const long MAX_REFRESH_RATE = 100;
 
+// Frames of audio a meter can hold for the metering thread
+static const int kMeterBufferFrames = 65536;
+// Frames measured for each update message
+static const int kMeterAnalysisFrames = 1024;
+
 /* Updates to the meter are passed accross via meter updates, each contained in
  * a MeterUpdateMsg object */
 wxString MeterUpdateMsg::toString()
@@ -166,6 +175,83 @@ bool MeterUpdateQueue::Get(MeterUpdateMsg &msg)
    return true;
 }
 
+//
+// The audio callback only copies audio into each meter's ring buffer.
+// One thread measures the audio of all meters and passes the results on
+// through their update queues.
+//
+
+class MeterThread final : public wxThread
+{
+ public:
+   MeterThread() : wxThread(wxTHREAD_JOINABLE) {}
+
+   static void Add(Meter *meter);
+   static void Remove(Meter *meter);
+
+ protected:
+   ExitCode Entry() override;
+
+ private:
+   static wxMutex sMutex;
+   static std::vector<Meter *> sMeters;
+   static MeterThread *sThread;
+};
+
+wxMutex MeterThread::sMutex;
+std::vector<Meter *> MeterThread::sMeters;
+MeterThread *MeterThread::sThread = NULL;
+
+void MeterThread::Add(Meter *meter)
+{
+   wxMutexLocker locker(sMutex);
+   sMeters.push_back(meter);
+
+   if (!sThread) {
+      sThread = safenew MeterThread;
+      sThread->Create();
+      sThread->Run();
+   }
+}
+
+void MeterThread::Remove(Meter *meter)
+{
+   MeterThread *thread = NULL;
+   {
+      wxMutexLocker locker(sMutex);
+      sMeters.erase(std::remove(sMeters.begin(), sMeters.end(), meter),
+                    sMeters.end());
+
+      // Stop the thread with the last meter, but not while holding the
+      // lock it needs to finish
+      if (sMeters.empty()) {
+         thread = sThread;
+         sThread = NULL;
+      }
+   }
+
+   if (thread) {
+      thread->Delete();
+      delete thread;
+   }
+}
+
+wxThread::ExitCode MeterThread::Entry()
+{
+   while (!TestDestroy()) {
+      {
+         wxMutexLocker locker(sMutex);
+         for (auto meter : sMeters)
+            meter->Analyze();
+      }
+
+      // Audio callbacks usually deliver a few milliseconds at a time
+      Sleep(10);
+   }
+
+   return 0;
+}
+
 //
 // Meter class
 //
@@ -219,12 +305,19 @@ Meter::Meter(AudacityProject *project,
 : wxPanelWrapper(parent, id, pos, size, wxTAB_TRAVERSAL | wxNO_BORDER | wxWANTS_CHARS),
    mProject(project),
    mQueue(1024),
+   mSamples{ std::make_unique<RingBuffer>(floatSample,
+                                          kMeterBufferFrames * kMaxMeterBars) },
+   mSamplesChannels{ 0 },
+   mResetPending{ true },
+   mAnalyzer{ std::make_unique<MeterAnalyzer>() },
    mWidth(size.x),
    mHeight(size.y),
    mIsInput(isInput),
    mDesiredStyle(style),
    mGradient(true),
    mDB(true),
+   mLoudness(false),
+   mShortTerm(kMeterLoudnessFloor),
    mDBRange(ENV_DB_RANGE),
    mDecay(true),
    mDecayRate(fDecayRate),
@@ -330,6 +423,8 @@ Meter::Meter(AudacityProject *project,
    // balistics are right for 44KHz and a bit more frisky than they should be
    // for higher sample rates.
    Reset(44100.0, true);
+
+   MeterThread::Add(this);
 }
 
 void Meter::Clear()
@@ -339,6 +434,9 @@ void Meter::Clear()
 
 Meter::~Meter()
 {
+   // Make sure the metering thread is done with this meter
+   MeterThread::Remove(this);
+
    if (mIsInput)
    {
       // Unregister for AudioIO events
@@ -380,6 +478,7 @@ void Meter::UpdatePrefs()
          gPrefs->Read(Key(wxT("RefreshRate")), 30)));
    mGradient = gPrefs->Read(Key(wxT("Bars")), wxT("Gradient")) == wxT("Gradient");
    mDB = gPrefs->Read(Key(wxT("Type")), wxT("dB")) == wxT("dB");
+   mLoudness = gPrefs->Read(Key(wxT("Mode")), wxT("PeakRMS")) == wxT("Loudness");
    mMeterDisabled = gPrefs->Read(Key(wxT("Disabled")), (long)0);
 
    if (mDesiredStyle != MixerTrackCluster)
@@ -846,6 +945,11 @@ void Meter::Reset(double sampleRate, bool resetClipping)
    {
       ResetBar(&mBar[j], resetClipping);
    }
+   mShortTerm = kMeterLoudnessFloor;
+
+   // The metering thread drops what it has queued and starts measuring
+   // afresh at the NEW rate
+   mResetPending = true;
 
    // wxTimers seem to be a little unreliable - sometimes they stop for
    // no good reason, so this "primes" it every now and then...
@@ -898,39 +1002,54 @@ static float ToDB(float v, float range)
 
 void Meter::UpdateDisplay(int numChannels, int numFrames, float *sampleData)
 {
-   int i, j;
-   float *sptr = sampleData;
-   int num = intmin(numChannels, mNumBars);
-   MeterUpdateMsg msg;
+   const int num = intmin(intmin(numChannels, mNumBars), kMaxMeterBars);
 
-   memset(&msg, 0, sizeof(msg));
-   msg.numFrames = numFrames;
-
-   for(i=0; i<numFrames; i++) {
-      for(j=0; j<num; j++) {
-         msg.peak[j] = floatMax(msg.peak[j], fabs(sptr[j]));
-         msg.rms[j] += sptr[j]*sptr[j];
-
-         // In addition to looking for mNumPeakSamplesToClip peaked
-         // samples in a row, also send the number of peaked samples
-         // at the head and tail, in case there's a run of peaked samples
-         // that crosses block boundaries
-         if (fabs(sptr[j])>=MAX_AUDIO) {
-            if (msg.headPeakCount[j]==i)
-               msg.headPeakCount[j]++;
-            msg.tailPeakCount[j]++;
-            if (msg.tailPeakCount[j] > mNumPeakSamplesToClip)
-               msg.clipping[j] = true;
-         }
-         else
-            msg.tailPeakCount[j] = 0;
+   // If the metering thread has fallen behind, drop the block rather than
+   // wait in the audio callback
+   if (mSamples->AvailForPut() < numFrames * kMaxMeterBars)
+      return;
+
+   mSamplesChannels = num;
+
+   if (numChannels == kMaxMeterBars) {
+      mSamples->Put((samplePtr)sampleData, floatSample,
+                    numFrames * kMaxMeterBars);
+      return;
+   }
+
+   // Copy the channels shown, in frames of kMaxMeterBars
+   float frames[256 * kMaxMeterBars];
+   const float *sptr = sampleData;
+   while (numFrames > 0) {
+      const int block = intmin(numFrames, 256);
+      for (int i = 0; i < block; i++) {
+         for (int j = 0; j < kMaxMeterBars; j++)
+            frames[i * kMaxMeterBars + j] = j < num ? sptr[j] : 0.0f;
+         sptr += numChannels;
       }
-      sptr += numChannels;
+      mSamples->Put((samplePtr)frames, floatSample, block * kMaxMeterBars);
+      numFrames -= block;
+   }
+}
+
+void Meter::Analyze()
+{
+   if (mResetPending.exchange(false)) {
+      mSamples->Discard(mSamples->AvailForGet());
+      mAnalyzer->Reset(mRate);
    }
-   for(j=0; j<mNumBars; j++)
-      msg.rms[j] = sqrt(msg.rms[j]/numFrames);
 
-   mQueue.Put(msg);
+   float frames[kMeterAnalysisFrames * kMaxMeterBars];
+   int avail;
+   while ((avail = mSamples->AvailForGet() / kMaxMeterBars) > 0) {
+      const int numFrames = intmin(avail, kMeterAnalysisFrames);
+      mSamples->Get((samplePtr)frames, floatSample, numFrames * kMaxMeterBars);
+
+      MeterUpdateMsg msg;
+      mAnalyzer->Process(frames, numFrames, mSamplesChannels,
+                         mNumPeakSamplesToClip, msg);
+      mQueue.Put(msg);
+   }
 }
 
 // Vaughan, 2010-11-29: This not currently used. See comments in MixerTrackCluster::UpdateMeter().
@@ -1007,6 +1126,14 @@ void Meter::OnMeterUpdate(wxTimerEvent & WXUNUSED(event))
       for(j=0; j<mNumBars; j++) {
          mBar[j].isclipping = false;
 
+         // The bars show the true peak, and the momentary loudness in place
+         // of RMS; LUFS are on the same scale as dB
+         if (mLoudness) {
+            msg.peak[j] = msg.truePeak[j];
+            msg.rms[j] = msg.momentary > kMeterLoudnessFloor
+               ? DB_TO_LINEAR(msg.momentary) : 0.0;
+         }
+
          //
          if (mDB) {
             msg.peak[j] = ToDB(msg.peak[j], mDBRange);
@@ -1029,9 +1156,14 @@ void Meter::OnMeterUpdate(wxTimerEvent & WXUNUSED(event))
          else
             mBar[j].peak = msg.peak[j];
 
-         // This smooths out the RMS signal
-         float smooth = pow(0.9, (double)msg.numFrames/1024.0);
-         mBar[j].rms = mBar[j].rms * smooth + msg.rms[j] * (1.0 - smooth);
+         // This smooths out the RMS signal; the loudness is already
+         // averaged over 400 ms
+         if (mLoudness)
+            mBar[j].rms = msg.rms[j];
+         else {
+            float smooth = pow(0.9, (double)msg.numFrames/1024.0);
+            mBar[j].rms = mBar[j].rms * smooth + msg.rms[j] * (1.0 - smooth);
+         }
 
          if (mT - mBar[j].peakHoldTime > mPeakHoldDuration ||
              mBar[j].peak > mBar[j].peakHold) {
@@ -1062,6 +1194,8 @@ void Meter::OnMeterUpdate(wxTimerEvent & WXUNUSED(event))
          }
 #endif
       }
+
+      mShortTerm = msg.shortTerm;
    } // while
 
    if (numChanges > 0) {
@@ -1933,6 +2067,8 @@ void Meter::OnPreferences(wxCommandEvent & WXUNUSED(event))
    wxRadioButton *rms;
    wxRadioButton *db;
    wxRadioButton *linear;
+   wxRadioButton *peakRMS;
+   wxRadioButton *loudness;
    wxRadioButton *automatic;
    wxRadioButton *horizontal;
    wxRadioButton *vertical;
@@ -2000,6 +2136,22 @@ void Meter::OnPreferences(wxCommandEvent & WXUNUSED(event))
         }
         S.EndStatic();
 
+        S.StartStatic(_("Measurement"), 0);
+        {
+           S.StartVerticalLay();
+           {
+              peakRMS = S.AddRadioButton(_("Peak and RMS"));
+              peakRMS->SetName(_("Peak and RMS"));
+              peakRMS->SetValue(!mLoudness);
+
+              loudness = S.AddRadioButtonToGroup(_("True peak and loudness (EBU R128)"));
+              loudness->SetName(_("True peak and loudness (EBU R128)"));
+              loudness->SetValue(mLoudness);
+           }
+           S.EndVerticalLay();
+        }
+        S.EndStatic();
+
         S.StartStatic(_("Orientation"), 1);
         {
            S.StartVerticalLay();
@@ -2044,6 +2196,7 @@ void Meter::OnPreferences(wxCommandEvent & WXUNUSED(event))
       gPrefs->Write(Key(wxT("Style")), style[s]);
       gPrefs->Write(Key(wxT("Bars")), gradient->GetValue() ? wxT("Gradient") : wxT("RMS"));
       gPrefs->Write(Key(wxT("Type")), db->GetValue() ? wxT("dB") : wxT("Linear"));
+      gPrefs->Write(Key(wxT("Mode")), peakRMS->GetValue() ? wxT("PeakRMS") : wxT("Loudness"));
       gPrefs->Write(Key(wxT("RefreshRate")), rate->GetValue());
 
       gPrefs->Flush();
@@ -2257,6 +2410,11 @@ wxAccStatus MeterAx::GetName(int WXUNUSED(childId), wxString* name)
          *name += wxT(" ") + wxString::Format(_(" Peak %.2f "), peak);
       }
 
+      if (m->mLoudness && m->mShortTerm > kMeterLoudnessFloor)
+      {
+         *name += wxT(" ") + wxString::Format(_(" Loudness %.1f LUFS "), m->mShortTerm);
+      }
+
       if (clipped)
       {
          *name += wxT(" ") + wxString::Format(_(" Clipped "));
@@ -16,6 +16,7 @@
 #ifndef __AUDACITY_METER__
 #define __AUDACITY_METER__
 
+#include <atomic>
 #include <wx/defs.h>
 #include <wx/timer.h>
 
@@ -53,6 +54,9 @@ class MeterUpdateMsg
    bool clipping[kMaxMeterBars];
    int headPeakCount[kMaxMeterBars];
    int tailPeakCount[kMaxMeterBars];
+   float truePeak[kMaxMeterBars];
+   float momentary;  // LUFS, over the last 400 ms
+   float shortTerm;  // LUFS, over the last 3 s
 
    /* neither constructor nor destructor do anything */
    MeterUpdateMsg() { }
@@ -84,6 +88,9 @@ class MeterUpdateQueue
 };
 
 class MeterAx;
+class MeterAnalyzer;
+class MeterThread;
+class RingBuffer;
 
 class Meter final : public wxPanelWrapper
 {
@@ -133,9 +140,10 @@ class Meter final : public wxPanelWrapper
 
    /** \brief Update the meters with a block of audio data
     *
-    * Process the supplied block of audio data, extracting the peak and RMS
-    * levels to send to the meter. Also record runs of clipped samples to detect
-    * clipping that lies on block boundaries.
+    * Queue the supplied block of audio data for the metering thread, which
+    * extracts the peak and RMS levels, the true peak and the loudness to send
+    * to the meter, and records runs of clipped samples to detect clipping
+    * that lies on block boundaries.  Only the copying happens here.
     * This method is thread-safe!  Feel free to call from a different thread
     * (like from an audio I/O callback).
     *
@@ -207,6 +215,9 @@ class Meter final : public wxPanelWrapper
 
    void OnMeterUpdate(wxTimerEvent &evt);
 
+   // Called on the metering thread
+   void Analyze();
+
    void HandleLayout(wxDC &dc);
    void SetActiveStyle(Style style);
    void SetBarAndClip(int iBar, bool vert);
@@ -229,6 +240,12 @@ class Meter final : public wxPanelWrapper
    MeterUpdateQueue mQueue;
    wxTimer          mTimer;
 
+   // Audio waiting for the metering thread, in frames of kMaxMeterBars
+   std::unique_ptr<RingBuffer> mSamples;
+   std::atomic<int> mSamplesChannels;
+   std::atomic<bool> mResetPending;
+   std::unique_ptr<MeterAnalyzer> mAnalyzer;
+
    int       mWidth;
    int       mHeight;
 
@@ -241,6 +258,8 @@ class Meter final : public wxPanelWrapper
    Style     mDesiredStyle;
    bool      mGradient;
    bool      mDB;
+   bool      mLoudness; // true peak and loudness in place of peak and RMS
+   float     mShortTerm;
    int       mDBRange;
    bool      mDecay;
    float     mDecayRate; // dB/sec
@@ -289,6 +308,7 @@ class Meter final : public wxPanelWrapper
    bool mAccSilent;
 
    friend class MeterAx;
+   friend class MeterThread;
 
    bool mHighlighted {};
 
@@ -0,0 +1,308 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MeterAnalyzer.cpp
+
+*******************************************************************//**
+
+\class MeterAnalyzer
+\brief Measures blocks of audio for a Meter, on the metering thread
+rather than in the audio callback.
+
+Besides the sample peak and RMS, it keeps the K-weighting filters and
+100 ms loudness blocks of ITU-R BS.1770, giving the momentary (400 ms)
+and short-term (3 s) loudness of EBU R128, and finds the true peak by
+oversampling with a polyphase interpolator.
+
+*//*******************************************************************/
+
+#include "../Audacity.h"
+#include "MeterAnalyzer.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#include "../AudacityApp.h"
+#include "Meter.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define METER_ANALYZER_SSE
+#include <xmmintrin.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static_assert(MeterAnalyzer::kChannels == kMaxMeterBars,
+              "The analyzer takes frames as wide as the meter");
+
+namespace {
+
+const int kTaps = 12;              // of each phase of the interpolator
+const double kBlockSeconds = 0.1;
+const int kMomentaryBlocks = 4;
+const int kShortTermBlocks = 30;
+
+float BlocksToLoudness(const std::vector<double> &blocks,
+                       int next, int count, int wanted)
+{
+   const int n = std::min(count, wanted);
+   if (n == 0)
+      return kMeterLoudnessFloor;
+
+   double sum = 0.0;
+   const int size = blocks.size();
+   for (int i = 1; i <= n; i++)
+      sum += blocks[(next - i + size) % size];
+   sum /= n;
+
+   if (sum <= 0.0)
+      return kMeterLoudnessFloor;
+   return std::max(kMeterLoudnessFloor, (float)(-0.691 + 10.0 * log10(sum)));
+}
+
+}
+
+MeterAnalyzer::MeterAnalyzer()
+{
+   Reset(44100.0);
+}
+
+MeterAnalyzer::~MeterAnalyzer()
+{
+}
+
+void MeterAnalyzer::Reset(double rate)
+{
+   mRate = rate > 0 ? rate : 44100.0;
+
+   // The K-weighting filters of BS.1770 are specified for 48 kHz; these
+   // are their analog prototypes, so that any rate can be measured
+   {
+      const double f0 = 1681.974450955533;
+      const double G = 3.999843853973347;
+      const double Q = 0.7071752369554196;
+      const double K = tan(M_PI * f0 / mRate);
+      const double Vh = pow(10.0, G / 20.0);
+      const double Vb = pow(Vh, 0.4996667741545416);
+      const double a0 = 1.0 + K / Q + K * K;
+      mShelf.b0 = (Vh + Vb * K / Q + K * K) / a0;
+      mShelf.b1 = 2.0 * (K * K - Vh) / a0;
+      mShelf.b2 = (Vh - Vb * K / Q + K * K) / a0;
+      mShelf.a1 = 2.0 * (K * K - 1.0) / a0;
+      mShelf.a2 = (1.0 - K / Q + K * K) / a0;
+   }
+   {
+      const double f0 = 38.13547087602444;
+      const double Q = 0.5003270373238773;
+      const double K = tan(M_PI * f0 / mRate);
+      const double a0 = 1.0 + K / Q + K * K;
+      mHighPass.b0 = 1.0;
+      mHighPass.b1 = -2.0;
+      mHighPass.b2 = 1.0;
+      mHighPass.a1 = 2.0 * (K * K - 1.0) / a0;
+      mHighPass.a2 = (1.0 - K / Q + K * K) / a0;
+   }
+   for (int c = 0; c < kChannels; c++) {
+      mShelf.z1[c] = mShelf.z2[c] = 0.0;
+      mHighPass.z1[c] = mHighPass.z2[c] = 0.0;
+   }
+
+   mBlockLen = std::max(1, (int)(mRate * kBlockSeconds + 0.5));
+   mBlockFill = 0;
+   mBlockSum = 0.0;
+   mBlocks.assign(kShortTermBlocks, 0.0);
+   mBlockCount = 0;
+   mNextBlock = 0;
+   mMomentary = kMeterLoudnessFloor;
+   mShortTerm = kMeterLoudnessFloor;
+
+   // BS.1770 asks for at least 4x oversampling below 96 kHz
+   mOversample = mRate < 96000.0 ? 4 : (mRate < 192000.0 ? 2 : 1);
+
+   // Windowed sinc interpolator, cut off at the original Nyquist
+   // frequency, split into phases.  Each phase is stored reversed so that
+   // it lines up with the history, oldest sample first, and scaled to unit
+   // gain.
+   const int length = mOversample * kTaps;
+   const double center = (length - 1) / 2.0;
+   mPhases.assign(length, 0.0f);
+   for (int p = 0; p < mOversample; p++) {
+      double sum = 0.0;
+      for (int k = 0; k < kTaps; k++) {
+         const int n = p + k * mOversample;
+         const double x = (n - center) / mOversample;
+         const double sinc = (x == 0.0) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+         const double window = 0.42 - 0.5 * cos(2.0 * M_PI * n / (length - 1))
+            + 0.08 * cos(4.0 * M_PI * n / (length - 1));
+         mPhases[p * kTaps + (kTaps - 1 - k)] = (float)(sinc * window);
+         sum += sinc * window;
+      }
+      for (int i = 0; i < kTaps; i++)
+         mPhases[p * kTaps + i] /= (float)sum;
+   }
+
+   for (int c = 0; c < kChannels; c++) {
+      mHistory[c].assign(2 * kTaps, 0.0f);
+      mHistoryPos[c] = 0;
+   }
+}
+
+void MeterAnalyzer::Process(const float *frames, int numFrames, int channels,
+                            int numPeakSamplesToClip, MeterUpdateMsg &msg)
+{
+   memset(&msg, 0, sizeof(msg));
+   msg.numFrames = numFrames;
+   msg.momentary = mMomentary;
+   msg.shortTerm = mShortTerm;
+
+   if (numFrames <= 0)
+      return;
+
+   float peak[kChannels];
+   float sumsq[kChannels];
+   PeakAndRMS(frames, numFrames, peak, sumsq);
+
+   for (int j = 0; j < kChannels; j++) {
+      msg.peak[j] = peak[j];
+      msg.rms[j] = sqrt(sumsq[j] / numFrames);
+
+      // In addition to looking for numPeakSamplesToClip peaked samples
+      // in a row, also send the number of peaked samples at the head and
+      // tail, in case there's a run of peaked samples that crosses block
+      // boundaries.  There can only be any if the peak reaches full scale.
+      if (peak[j] >= MAX_AUDIO) {
+         for (int i = 0; i < numFrames; i++) {
+            if (fabs(frames[i * kChannels + j]) >= MAX_AUDIO) {
+               if (msg.headPeakCount[j] == i)
+                  msg.headPeakCount[j]++;
+               msg.tailPeakCount[j]++;
+               if (msg.tailPeakCount[j] > numPeakSamplesToClip)
+                  msg.clipping[j] = true;
+            }
+            else
+               msg.tailPeakCount[j] = 0;
+         }
+      }
+
+      if (j < channels)
+         msg.truePeak[j] = std::max(peak[j], TruePeak(j, frames, numFrames));
+   }
+
+   Loudness(frames, numFrames, std::min(channels, (int)kChannels));
+   msg.momentary = mMomentary;
+   msg.shortTerm = mShortTerm;
+}
+
+void MeterAnalyzer::PeakAndRMS(const float *frames, int numFrames,
+                               float *peak, float *sumsq) const
+{
+   for (int j = 0; j < kChannels; j++)
+      peak[j] = sumsq[j] = 0.0f;
+
+   const int total = numFrames * kChannels;
+   int i = 0;
+
+#if defined(METER_ANALYZER_SSE)
+   // Four samples are two stereo frames, so lanes 0 and 2 are the left
+   // channel and lanes 1 and 3 the right
+   const __m128 signMask = _mm_set1_ps(-0.0f);
+   __m128 vPeak = _mm_setzero_ps();
+   __m128 vSum = _mm_setzero_ps();
+   for (; i + 4 <= total; i += 4) {
+      const __m128 v = _mm_loadu_ps(frames + i);
+      vPeak = _mm_max_ps(vPeak, _mm_andnot_ps(signMask, v));
+      vSum = _mm_add_ps(vSum, _mm_mul_ps(v, v));
+   }
+   float lanes[4];
+   _mm_storeu_ps(lanes, vPeak);
+   peak[0] = std::max(lanes[0], lanes[2]);
+   peak[1] = std::max(lanes[1], lanes[3]);
+   _mm_storeu_ps(lanes, vSum);
+   sumsq[0] = lanes[0] + lanes[2];
+   sumsq[1] = lanes[1] + lanes[3];
+#endif
+
+   for (; i < total; i++) {
+      const float v = frames[i];
+      const int j = i % kChannels;
+      peak[j] = std::max(peak[j], (float)fabs(v));
+      sumsq[j] += v * v;
+   }
+}
+
+float MeterAnalyzer::TruePeak(int channel, const float *frames, int numFrames)
+{
+   if (mOversample == 1)
+      return 0.0f;
+
+   float *const history = &mHistory[channel][0];
+   int pos = mHistoryPos[channel];
+   float result = 0.0f;
+
+   for (int i = 0; i < numFrames; i++) {
+      // The history holds each sample twice, so that the last kTaps of
+      // them are always contiguous
+      pos = (pos + 1) % kTaps;
+      history[pos] = history[pos + kTaps] = frames[i * kChannels + channel];
+      const float *window = history + pos + 1;
+
+      for (int p = 0; p < mOversample; p++) {
+         const float *coeffs = &mPhases[p * kTaps];
+#if defined(METER_ANALYZER_SSE)
+         __m128 acc = _mm_setzero_ps();
+         for (int k = 0; k < kTaps; k += 4)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(window + k),
+                                             _mm_loadu_ps(coeffs + k)));
+         float lanes[4];
+         _mm_storeu_ps(lanes, acc);
+         const float y = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+         float y = 0.0f;
+         for (int k = 0; k < kTaps; k++)
+            y += window[k] * coeffs[k];
+#endif
+         result = std::max(result, (float)fabs(y));
+      }
+   }
+
+   mHistoryPos[channel] = pos;
+   return result;
+}
+
+double MeterAnalyzer::Filter(Biquad &bq, int channel, double x)
+{
+   // Transposed direct form II
+   const double y = bq.b0 * x + bq.z1[channel];
+   bq.z1[channel] = bq.b1 * x - bq.a1 * y + bq.z2[channel];
+   bq.z2[channel] = bq.b2 * x - bq.a2 * y;
+   return y;
+}
+
+void MeterAnalyzer::Loudness(const float *frames, int numFrames, int channels)
+{
+   for (int i = 0; i < numFrames; i++) {
+      // Channels are weighted equally, as for left and right in BS.1770
+      for (int c = 0; c < channels; c++) {
+         const double y =
+            Filter(mHighPass, c, Filter(mShelf, c, frames[i * kChannels + c]));
+         mBlockSum += y * y;
+      }
+
+      if (++mBlockFill == mBlockLen) {
+         mBlocks[mNextBlock] = mBlockSum / mBlockLen;
+         mNextBlock = (mNextBlock + 1) % kShortTermBlocks;
+         mBlockCount = std::min(mBlockCount + 1, kShortTermBlocks);
+         mBlockFill = 0;
+         mBlockSum = 0.0;
+
+         mMomentary = BlocksToLoudness(mBlocks, mNextBlock, mBlockCount,
+                                       kMomentaryBlocks);
+         mShortTerm = BlocksToLoudness(mBlocks, mNextBlock, mBlockCount,
+                                       kShortTermBlocks);
+      }
+   }
+}
@@ -0,0 +1,78 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MeterAnalyzer.h
+
+  Measures the audio given to a Meter: sample peak, RMS and runs of
+  clipped samples, and also the true peak and the momentary and
+  short-term loudness of ITU-R BS.1770 / EBU R128.
+
+**********************************************************************/
+
+#ifndef __AUDACITY_METER_ANALYZER__
+#define __AUDACITY_METER_ANALYZER__
+
+#include <vector>
+
+class MeterUpdateMsg;
+
+// Loudness reported before there is any audio to measure
+const float kMeterLoudnessFloor = -200.0f;
+
+class MeterAnalyzer
+{
+ public:
+   // Number of channels in each frame given to Process()
+   enum { kChannels = 2 };
+
+   MeterAnalyzer();
+   ~MeterAnalyzer();
+
+   /// Forgets all history, and prepares the filters for the rate
+   void Reset(double rate);
+
+   /// Measures numFrames interleaved frames of kChannels samples, of
+   /// which only the first channels carry audio, into msg
+   void Process(const float *frames, int numFrames, int channels,
+                int numPeakSamplesToClip, MeterUpdateMsg &msg);
+
+ private:
+   struct Biquad
+   {
+      double b0, b1, b2, a1, a2;
+      double z1[kChannels], z2[kChannels];
+   };
+
+   void PeakAndRMS(const float *frames, int numFrames,
+                   float *peak, float *sumsq) const;
+   float TruePeak(int channel, const float *frames, int numFrames);
+   void Loudness(const float *frames, int numFrames, int channels);
+
+   static double Filter(Biquad &bq, int channel, double x);
+
+   double mRate;
+
+   // K-weighting: the shelving pre-filter and the RLB high pass
+   Biquad mShelf;
+   Biquad mHighPass;
+
+   // Loudness is kept as mean squares of 100 ms blocks, the last 30 of
+   // which make up the 3 s short-term window
+   int mBlockLen;
+   int mBlockFill;
+   double mBlockSum;
+   std::vector<double> mBlocks;
+   int mBlockCount;
+   int mNextBlock;
+   float mMomentary;
+   float mShortTerm;
+
+   // True peak is found by 4x polyphase oversampling
+   int mOversample;
+   std::vector<float> mPhases;            // kTaps coefficients per phase
+   std::vector<float> mHistory[kChannels]; // last samples, stored twice
+   int mHistoryPos[kChannels];
+};
+
+#endif
@@ -0,0 +1,198 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include <wx/init.h>
+#include <wx/thread.h>
+#include <wx/utils.h>
+
+#include "effects/AnalysisJobs.h"
+
+
+// Stands in for a plug-in, finding a label for each step of a track, so
+// that the analysis runs as VampEffect's does but without Vamp
+class AnalysisJobsTest {
+   static const size_t numTracks = 12;
+   static const size_t numWorkers = 4;
+
+   struct Label
+   {
+      size_t track;
+      int step;
+   };
+
+   wxMutex mMutex;
+   std::vector<std::vector<Label>> mLabels;
+   std::vector<size_t> mFinished;
+   std::vector<int> mBusy;
+   std::vector<int> mRuns;
+   std::vector<int> mWorkerRuns;
+   bool mOverlapped;
+
+public:
+   AnalysisJobsTest()
+   {
+       std::cout << "==> Testing RunAnalysisJobs\n";
+       srand(1);
+   }
+
+   void setUp() {
+      mLabels.assign(numTracks, std::vector<Label>());
+      mFinished.clear();
+      mBusy.assign(numWorkers, 0);
+      mRuns.assign(numTracks, 0);
+      mWorkerRuns.assign(numWorkers, 0);
+      mOverlapped = false;
+   }
+
+   void tearDown() {
+      mLabels.clear();
+      mFinished.clear();
+   }
+
+   // The first track takes longest, so it finishes last
+   int Steps(size_t track)
+   {
+      return track == 0 ? 40 : 5 + (int)track % 3;
+   }
+
+   AnalysisJob Analysis()
+   {
+      return [this](size_t worker, size_t track, const AnalysisProgress &progress)
+      {
+         assert(worker < numWorkers);
+         {
+            wxMutexLocker locker(mMutex);
+            mOverlapped = mOverlapped || mBusy[worker]++ > 0;
+            mRuns[track]++;
+            mWorkerRuns[worker]++;
+         }
+
+         const int steps = Steps(track);
+         for (int step = 0; step < steps; step++)
+         {
+            wxMilliSleep(track == 0 ? 10 : 1);
+            // Labels go to the job's own list, without locking
+            mLabels[track].push_back({ track, step });
+            if (progress((step + 1.0) / steps))
+               break;
+         }
+
+         wxMutexLocker locker(mMutex);
+         mBusy[worker]--;
+         mFinished.push_back(track);
+      };
+   }
+
+   // The label tracks made as VampEffect makes them, after all are done
+   std::vector<Label> Merged()
+   {
+      std::vector<Label> labels;
+      for (const auto &track : mLabels)
+         labels.insert(labels.end(), track.begin(), track.end());
+      return labels;
+   }
+
+   void testOrder() {
+      std::cout << "\tlabels should come out in track order however the jobs finish...";
+      std::cout << std::flush;
+
+      double last = 0.0;
+      assert(RunAnalysisJobs(numTracks, numWorkers, Analysis(), [&](double frac)
+      {
+         // Progress only grows, and is reported on this thread
+         assert(frac >= last && frac <= 1.0);
+         last = frac;
+         return false;
+      }));
+
+      // Every track was analysed once, and never two at once by a worker
+      for (size_t track = 0; track < numTracks; track++)
+         assert(mRuns[track] == 1);
+      assert(!mOverlapped);
+
+      // The jobs finished out of order, if there were threads for them...
+      assert(mFinished.size() == numTracks);
+      if (std::count(mWorkerRuns.begin(), mWorkerRuns.end(), 0) < (int)numWorkers - 1)
+         assert(mFinished.back() == 0);
+
+      // ...but the labels are in order of track, then of time
+      const auto labels = Merged();
+      size_t i = 0;
+      for (size_t track = 0; track < numTracks; track++)
+         for (int step = 0; step < Steps(track); step++, i++)
+            assert(labels[i].track == track && labels[i].step == step);
+      assert(i == labels.size());
+
+      std::cout << "OK\n";
+   }
+
+   void testCancel() {
+      std::cout << "\tcancelling should stop every worker...";
+      std::cout << std::flush;
+
+      assert(!RunAnalysisJobs(numTracks, numWorkers, Analysis(), [](double)
+      {
+         return true;
+      }));
+
+      // Those running stopped at their next step, and no more were started
+      assert(mLabels[0].size() < (size_t)Steps(0));
+      int runs = 0;
+      for (size_t track = 0; track < numTracks; track++)
+         runs += mRuns[track];
+      assert(runs < (int)numTracks);
+      assert(mFinished.size() == (size_t)runs);
+
+      std::cout << "OK\n";
+   }
+
+   void testOneWorker() {
+      std::cout << "\ta single worker should take the tracks in order...";
+      std::cout << std::flush;
+
+      assert(RunAnalysisJobs(numTracks, 1, Analysis(), [](double) { return false; }));
+      for (size_t track = 0; track < numTracks; track++)
+         assert(mFinished[track] == track);
+      assert(!mOverlapped);
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    // Threads need the library's modules
+    wxInitializer initializer;
+
+    AnalysisJobsTest tester;
+
+    tester.setUp();
+    tester.testOrder();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testCancel();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testOneWorker();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
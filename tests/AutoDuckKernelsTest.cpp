@@ -0,0 +1,297 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "effects/AutoDuckKernels.h"
+
+
+class AutoDuckKernelsTest {
+   struct Params
+   {
+      double controlRate, targetRate;
+      double duckAmountDb;
+      double innerFadeDownLen, innerFadeUpLen;
+      double outerFadeDownLen, outerFadeUpLen;
+      double thresholdDb;
+      double maximumPause;
+   };
+
+   static const int seconds = 40;
+
+   std::vector<float> mControl;
+   std::vector<float> mTarget;
+
+public:
+   AutoDuckKernelsTest()
+   {
+       std::cout << "==> Testing AutoDuckAnalyzer and AutoDuckFader\n";
+       srand(1);
+   }
+
+   void setUp() {
+   }
+
+   void tearDown() {
+      mControl.clear();
+      mTarget.clear();
+   }
+
+   static double Random()
+   {
+      return (double)rand() / RAND_MAX;
+   }
+
+   // Quiet noise, with loud bursts of all lengths, and gaps between them
+   // both shorter and longer than the pause
+   void MakeSignals(const Params &params)
+   {
+      mControl.resize((size_t)(seconds * params.controlRate));
+      bool loud = false;
+      size_t i = 0;
+      while (i < mControl.size())
+      {
+         const double len = 0.01 +
+            (loud ? 3 * Random() : Random() < 0.5 ? 0.5 * Random() : 7 * Random());
+         const size_t to = std::min(mControl.size(), i + (size_t)(len * params.controlRate) + 1);
+         for (; i < to; i++)
+            mControl[i] = (float)((loud ? 0.5 : 0.001) * (2 * Random() - 1));
+         loud = !loud;
+      }
+
+      // Room at the end for rounding at any rate
+      mTarget.resize((size_t)((seconds + 1) * params.targetRate));
+      for (auto &sample : mTarget)
+         sample = (float)(2 * Random() - 1);
+   }
+
+   static sampleCount TimeToLongSamples(double t, double rate)
+   {
+      return (sampleCount)floor(t * rate + 0.5);
+   }
+
+   // The analysis of the whole selection, then the fade of each region
+   // in turn, as EffectAutoDuck did before it did both at once
+   std::vector<float> TwoPass(const Params &params, sampleCount start, sampleCount end)
+   {
+      static const int kRMSWindowSize = 100;
+
+      double maxPause = params.maximumPause;
+      if (maxPause < params.outerFadeDownLen + params.outerFadeUpLen)
+         maxPause = params.outerFadeDownLen + params.outerFadeUpLen;
+      sampleCount minSamplesPause = TimeToLongSamples(maxPause, params.controlRate);
+
+      double threshold = pow(10.0, params.thresholdDb / 20.0);
+      threshold = threshold * threshold * kRMSWindowSize;
+
+      int rmsPos = 0;
+      float rmsSum = 0;
+      float rmsWindow[kRMSWindowSize] = {0};
+      bool inDuckRegion = false;
+      double duckRegionStart = 0;
+      sampleCount curSamplesPause = 0;
+
+      std::vector<AutoDuckRegion> regions;
+      for (sampleCount i = start; i < end; i++)
+      {
+         rmsSum -= rmsWindow[rmsPos];
+         rmsWindow[rmsPos] = mControl[i] * mControl[i];
+         rmsSum += rmsWindow[rmsPos];
+         rmsPos = (rmsPos + 1) % kRMSWindowSize;
+
+         bool thresholdExceeded = rmsSum > threshold;
+         if (thresholdExceeded)
+         {
+            curSamplesPause = 0;
+            if (!inDuckRegion)
+            {
+               inDuckRegion = true;
+               duckRegionStart = i / params.controlRate;
+            }
+         }
+
+         if (!thresholdExceeded && inDuckRegion)
+         {
+            curSamplesPause += 1;
+            if (curSamplesPause >= minSamplesPause)
+            {
+               regions.push_back(AutoDuckRegion(
+                  duckRegionStart - params.outerFadeDownLen,
+                  (i - curSamplesPause) / params.controlRate + params.outerFadeUpLen));
+               inDuckRegion = false;
+            }
+         }
+      }
+      if (inDuckRegion)
+         regions.push_back(AutoDuckRegion(
+            duckRegionStart - params.outerFadeDownLen,
+            (end - curSamplesPause) / params.controlRate + params.outerFadeUpLen));
+
+      // Most selections have a few regions, or the test shows little
+      assert(regions.size() > 2);
+
+      std::vector<float> target = mTarget;
+      for (const auto &region : regions)
+      {
+         sampleCount start = TimeToLongSamples(region.t0, params.targetRate);
+         sampleCount end = TimeToLongSamples(region.t1, params.targetRate);
+
+         int fadeDownSamples = TimeToLongSamples(
+            params.outerFadeDownLen + params.innerFadeDownLen, params.targetRate);
+         if (fadeDownSamples < 1)
+            fadeDownSamples = 1;
+         int fadeUpSamples = TimeToLongSamples(
+            params.outerFadeUpLen + params.innerFadeUpLen, params.targetRate);
+         if (fadeUpSamples < 1)
+            fadeUpSamples = 1;
+
+         float fadeDownStep = params.duckAmountDb / fadeDownSamples;
+         float fadeUpStep = params.duckAmountDb / fadeUpSamples;
+
+         for (sampleCount i = start; i < end; i++)
+         {
+            float gainDown = fadeDownStep * (i - start);
+            float gainUp = fadeUpStep * (end - i);
+
+            float gain;
+            if (gainDown > gainUp)
+               gain = gainDown;
+            else
+               gain = gainUp;
+            if (gain < params.duckAmountDb)
+               gain = params.duckAmountDb;
+
+            target[i] *= pow(10.0, gain / 20.0);
+         }
+      }
+
+      return target;
+   }
+
+   // The fader following the analysis, as a worker of EffectAutoDuck does,
+   // with blocks and runs of random sizes
+   std::vector<float> OnePass(const Params &params, sampleCount start, sampleCount end,
+                              sampleCount maxBlock, sampleCount maxRun)
+   {
+      AutoDuckAnalyzer analyzer(params.controlRate, start, params.thresholdDb,
+         params.maximumPause, params.outerFadeDownLen, params.outerFadeUpLen);
+      AutoDuckFader fader(params.targetRate, params.duckAmountDb,
+         params.outerFadeDownLen + params.innerFadeDownLen,
+         params.outerFadeUpLen + params.innerFadeUpLen);
+
+      std::vector<float> target = mTarget;
+      std::vector<int> faded(target.size(), 0);
+      std::vector<AutoDuckRegion> regions;
+
+      auto fade = [&] {
+         fader.Update(regions, analyzer.GetState());
+         sampleCount runStart, runLen;
+         while (fader.Next(1 + rand() % maxRun, runStart, runLen))
+         {
+            assert(runLen > 0);
+            assert(runStart >= 0 && runStart + runLen <= (sampleCount)target.size());
+            fader.Apply(&target[runStart]);
+            for (sampleCount i = runStart; i < runStart + runLen; i++)
+               assert(faded[i]++ == 0);
+         }
+      };
+
+      sampleCount pos = start;
+      while (pos < end)
+      {
+         const sampleCount len = std::min<sampleCount>(end - pos, 1 + rand() % maxBlock);
+         analyzer.Analyze(&mControl[pos], len, regions);
+         pos += len;
+         fade();
+      }
+      analyzer.Finish(regions);
+      fade();
+
+      return target;
+   }
+
+   void AssertSame(const Params &params)
+   {
+      MakeSignals(params);
+      const sampleCount start = TimeToLongSamples(params.outerFadeDownLen, params.controlRate);
+      const sampleCount end = TimeToLongSamples(seconds - params.outerFadeUpLen, params.controlRate);
+
+      const auto expected = TwoPass(params, start, end);
+
+      static const sampleCount blocks[][2] = {
+         {1, 1}, {37, 500}, {1000, 50}, {20000, 131072}, {1000000, 1000000},
+      };
+      for (const auto &block : blocks)
+      {
+         const auto actual = OnePass(params, start, end, block[0], block[1]);
+         assert(memcmp(&expected[0], &actual[0], expected.size() * sizeof(float)) == 0);
+      }
+   }
+
+   void testDefaults() {
+      std::cout << "\tfading behind the analysis should give the same output as after it...";
+      std::cout << std::flush;
+
+      AssertSame({ 2000, 2000, -12.0, 0.0, 0.0, 0.5, 0.5, -30.0, 1.0 });
+
+      std::cout << "OK\n";
+   }
+
+   void testRates() {
+      std::cout << "\tthe target tracks' rates should not matter...";
+      std::cout << std::flush;
+
+      AssertSame({ 2000, 3001, -12.0, 0.0, 0.0, 0.5, 0.5, -30.0, 1.0 });
+      AssertSame({ 3001, 1000, -12.0, 0.0, 0.0, 0.5, 0.5, -30.0, 1.0 });
+
+      std::cout << "OK\n";
+   }
+
+   void testFades() {
+      std::cout << "\tany fades and pauses should give the same output...";
+      std::cout << std::flush;
+
+      // Inner fades, long and short pauses, and no outer fades at all
+      AssertSame({ 2000, 2000, -24.0, 0.3, 0.7, 0.2, 0.9, -30.0, 1.5 });
+      AssertSame({ 2000, 1500, -6.0, 1.0, 0.0, 0.0, 0.0, -30.0, 0.1 });
+      AssertSame({ 1500, 2000, -12.0, 0.0, 0.0, 2.0, 1.0, -30.0, 0.0 });
+      AssertSame({ 2000, 2000, -12.0, 0.0, 0.0, 0.0, 0.0, -40.0, 0.0 });
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    AutoDuckKernelsTest tester;
+
+    tester.setUp();
+    tester.testDefaults();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testRates();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testFades();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
@@ -0,0 +1,223 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "effects/Biquad.h"
+
+
+class BiquadTest {
+   static const int len = 5003;
+
+   std::vector<float> input;
+   std::vector<float> output;
+   std::vector<double> expected;
+
+   // Coefficients and state of the chain, in double
+   std::vector<double> b0, b1, b2, a1, a2, z1, z2;
+
+public:
+   BiquadTest()
+   {
+       std::cout << "==> Testing BiquadCascade\n";
+       srand(1);
+   }
+
+   void setUp() {
+      input.resize(len);
+      output.resize(len);
+      expected.resize(len);
+      for (int i = 0; i < len; i++)
+         input[i] = 2.0f * rand() / RAND_MAX - 1.0f;
+   }
+
+   void tearDown() {
+      input.clear();
+      output.clear();
+      expected.clear();
+   }
+
+   // A peaking section, as the equalizers make, at a frequency that
+   // differs from stage to stage; odd stages are first order allpasses,
+   // as the phaser makes, so both kinds are in every group of four
+   void SetStage(BiquadCascade &cascade, int stage, double shift)
+   {
+      double w = 2.0 * M_PI * (0.01 + 0.3 * fmod(stage * 0.37 + shift, 1.0));
+      double bb0, bb1, bb2, aa1, aa2;
+      if (stage % 2)
+      {
+         double c = (1.0 - tan(w / 2.0)) / (1.0 + tan(w / 2.0));
+         bb0 = -c; bb1 = 1.0; bb2 = 0.0; aa1 = -c; aa2 = 0.0;
+      }
+      else
+      {
+         double A = pow(10.0, (stage % 5 - 2) * 3.0 / 40.0);
+         double alpha = sin(w) / (2.0 * 1.5);
+         double a0 = 1.0 + alpha / A;
+         bb0 = (1.0 + alpha * A) / a0;
+         bb1 = -2.0 * cos(w) / a0;
+         bb2 = (1.0 - alpha * A) / a0;
+         aa1 = -2.0 * cos(w) / a0;
+         aa2 = (1.0 - alpha / A) / a0;
+      }
+
+      cascade.SetStage(stage, (float) bb0, (float) bb1, (float) bb2,
+                       (float) aa1, (float) aa2);
+      // The reference filters with what the cascade was really given
+      b0[stage] = (float) bb0;
+      b1[stage] = (float) bb1;
+      b2[stage] = (float) bb2;
+      a1[stage] = (float) aa1;
+      a2[stage] = (float) aa2;
+   }
+
+   void SetStages(BiquadCascade &cascade, int count, double shift)
+   {
+      for (int k = 0; k < count; k++)
+         SetStage(cascade, k, shift);
+   }
+
+   void Reference(int first, int n)
+   {
+      const int count = (int) b0.size();
+      for (int i = first; i < first + n; i++)
+      {
+         double x = input[i];
+         for (int k = 0; k < count; k++)
+         {
+            double y = b0[k] * x + z1[k];
+            z1[k] = b1[k] * x - a1[k] * y + z2[k];
+            z2[k] = b2[k] * x - a2[k] * y;
+            x = y;
+         }
+         expected[i] = x;
+      }
+   }
+
+   void StartReference(int count)
+   {
+      b0.assign(count, 1.0); b1.assign(count, 0.0); b2.assign(count, 0.0);
+      a1.assign(count, 0.0); a2.assign(count, 0.0);
+      z1.assign(count, 0.0); z2.assign(count, 0.0);
+   }
+
+   void AssertNear(int count, int first, int n)
+   {
+      for (int i = first; i < first + n; i++)
+         if (fabs(expected[i] - output[i]) > 1e-4)
+         {
+            std::cout << expected[i] << " != " << output[i]
+               << " (stages=" << count << ", i=" << i << ")" << std::endl;
+            assert(false);
+         }
+   }
+
+   void testStageCounts() {
+      std::cout << "\tevery number of stages should match the double precision chain...";
+      std::cout << std::flush;
+
+      for (int count = 0; count <= BIQUAD_MAX_STAGES; count++)
+      {
+         BiquadCascade cascade;
+         cascade.SetStageCount(count);
+         assert(cascade.GetStageCount() == count);
+         StartReference(count);
+         SetStages(cascade, count, 0.0);
+
+         cascade.Process(&input[0], &output[0], len);
+         Reference(0, len);
+         AssertNear(count, 0, len);
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testBlocks() {
+      std::cout << "\tstate and new coefficients should carry across blocks of any size...";
+      std::cout << std::flush;
+
+      for (int count = 1; count <= 9; count++)
+      {
+         BiquadCascade cascade;
+         cascade.SetStageCount(count);
+         StartReference(count);
+
+         // Blocks shorter than the lanes' lag, and empty ones, too
+         int done = 0;
+         for (int block = 0; done < len; block = (block + 1) % 11)
+         {
+            const int n = std::min(block, len - done);
+            SetStages(cascade, count, done / (double) len);
+
+            // In place, as the effects use it
+            std::copy(input.begin() + done, input.begin() + done + n,
+                      output.begin() + done);
+            cascade.Process(&output[done], &output[done], n);
+            Reference(done, n);
+            done += n;
+         }
+         AssertNear(count, 0, len);
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testSamples() {
+      std::cout << "\tsample by sample should match a block..." << std::flush;
+
+      const int count = 7;
+      BiquadCascade cascade;
+      cascade.SetStageCount(count);
+      StartReference(count);
+      SetStages(cascade, count, 0.5);
+
+      for (int i = 0; i < len; i++)
+         output[i] = cascade.ProcessSample(input[i]);
+      Reference(0, len);
+      AssertNear(count, 0, len);
+
+      // And Reset should start it over
+      cascade.Reset();
+      for (int k = 0; k < count; k++)
+         z1[k] = z2[k] = 0.0;
+      cascade.Process(&input[0], &output[0], len);
+      Reference(0, len);
+      AssertNear(count, 0, len);
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    BiquadTest tester;
+
+    tester.setUp();
+    tester.testStageCounts();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testBlocks();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testSamples();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
@@ -0,0 +1,337 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "ClipIndex.h"
+
+
+// Places itself as WaveClip does, and like it, changes the placement
+// generation whenever it moves or changes rate.  WaveClip itself needs
+// too much of the program to be linked here.
+class TestClip {
+public:
+   TestClip(double offset, int rate, sampleCount numSamples)
+      : mOffset(offset), mRate(rate), mNumSamples(numSamples)
+   {
+   }
+
+   static unsigned long sPlacementGeneration;
+
+   void SetOffset(double offset)
+   {
+      if (offset != mOffset)
+         ++sPlacementGeneration;
+      mOffset = offset;
+   }
+
+   void SetRate(int rate)
+   {
+      ++sPlacementGeneration;
+      mRate = rate;
+   }
+
+   void Resample(int rate)
+   {
+      mNumSamples = (sampleCount)floor(mNumSamples * (double)rate / mRate + 0.5);
+      ++sPlacementGeneration;
+      mRate = rate;
+   }
+
+   // Appending and deleting inside a clip leave it where it is
+   void SetNumSamples(sampleCount numSamples) { mNumSamples = numSamples; }
+
+   double GetStartTime() const { return mOffset; }
+   double GetEndTime() const { return mOffset + double(mNumSamples) / mRate; }
+   sampleCount GetStartSample() const { return (sampleCount)floor(mOffset * mRate + 0.5); }
+   sampleCount GetEndSample() const { return GetStartSample() + mNumSamples; }
+   sampleCount GetNumSamples() const { return mNumSamples; }
+
+private:
+   double mOffset;
+   int mRate;
+   sampleCount mNumSamples;
+};
+
+unsigned long TestClip::sPlacementGeneration = 0;
+
+typedef std::vector<TestClip*> TestClipPointers;
+
+class ClipIndexTest {
+   // Clips start on whole seconds, and are shorter than one, so they
+   // never overlap
+   static const int numSlots = 200;
+
+   int mRate;
+   std::vector<std::unique_ptr<TestClip>> mClips;
+   std::vector<bool> mSlotUsed;
+   ClipIndex<TestClip> mIndex;
+
+public:
+   ClipIndexTest()
+   {
+       std::cout << "==> Testing ClipIndex\n";
+       srand(1);
+   }
+
+   void setUp() {
+      mRate = 44100;
+      mSlotUsed.assign(numSlots, false);
+      mIndex = ClipIndex<TestClip>();
+      for (int i = 0; i < 60; i++)
+         AddClip();
+      // Some empty clips, which may lie inside others
+      for (int i = 0; i < 10; i++)
+      {
+         mClips.push_back(std::make_unique<TestClip>(
+            (rand() % numSlots) + 0.5 * rand() / RAND_MAX, mRate, 0));
+         mIndex.Invalidate();
+      }
+   }
+
+   void tearDown() {
+      mClips.clear();
+      mSlotUsed.clear();
+   }
+
+   int FreeSlot()
+   {
+      int slot;
+      do
+         slot = rand() % numSlots;
+      while (mSlotUsed[slot]);
+      mSlotUsed[slot] = true;
+      return slot;
+   }
+
+   void AddClip()
+   {
+      const sampleCount len = 1 + rand() % (mRate * 9 / 10);
+      mClips.push_back(std::make_unique<TestClip>(FreeSlot(), mRate, len));
+      mIndex.Invalidate();
+   }
+
+   void RemoveClip(size_t ii)
+   {
+      const TestClip *clip = mClips[ii].get();
+      if (clip->GetNumSamples() > 0)
+         mSlotUsed[(int)clip->GetStartTime()] = false;
+      mClips.erase(mClips.begin() + ii);
+      mIndex.Invalidate();
+   }
+
+   // Moves a clip with samples to an empty slot, without telling the index
+   void MoveClip(size_t ii)
+   {
+      TestClip *clip = mClips[ii].get();
+      if (clip->GetNumSamples() == 0)
+         return;
+      mSlotUsed[(int)clip->GetStartTime()] = false;
+      clip->SetOffset(FreeSlot());
+   }
+
+   // The clips in order of start, looked for one by one
+   TestClipPointers Sorted()
+   {
+      TestClipPointers clips;
+      for (const auto &clip : mClips)
+         clips.push_back(clip.get());
+      std::stable_sort(clips.begin(), clips.end(),
+         [](const TestClip *a, const TestClip *b)
+      { return a->GetStartTime() < b->GetStartTime(); });
+      return clips;
+   }
+
+   static void AssertSame(const TestClipPointers &expected, const TestClipPointers &actual)
+   {
+      if (actual != expected)
+      {
+         std::cout << expected.size() << " clips expected, "
+            << actual.size() << " found" << std::endl;
+         assert(false);
+      }
+   }
+
+   void AssertIndexCorrect()
+   {
+      mIndex.Update(mClips, TestClip::sPlacementGeneration);
+
+      // The entries are the clips in order, each knowing its place
+      const auto &entries = mIndex.GetEntries();
+      const TestClipPointers sorted = Sorted();
+      assert(entries.size() == sorted.size());
+      for (size_t ii = 0; ii < entries.size(); ii++)
+      {
+         assert(entries[ii].clip == sorted[ii]);
+         assert(entries[ii].start == sorted[ii]->GetStartSample());
+         assert(mClips[entries[ii].position].get() == entries[ii].clip);
+      }
+
+      const sampleCount total = (sampleCount)numSlots * mRate;
+      for (int i = 0; i < 500; i++)
+      {
+         // Ranges of every size from nothing to many clips, and past
+         // either end of the track
+         const sampleCount start = (sampleCount)((double)rand() / RAND_MAX * (total + 2 * mRate)) - mRate;
+         sampleCount len = 0;
+         switch (rand() % 4)
+         {
+            case 0: len = rand() % 2; break;
+            case 1: len = rand() % mRate; break;
+            default: len = (sampleCount)((double)rand() / RAND_MAX * 10 * mRate); break;
+         }
+         const sampleCount end = start + len;
+
+         TestClipPointers expected;
+         for (const auto clip : sorted)
+            if (clip->GetEndSample() > start && clip->GetStartSample() < end)
+               expected.push_back(clip);
+         TestClipPointers actual;
+         mIndex.GetInRange(start, end, actual);
+         AssertSame(expected, actual);
+
+         const double t0 = (double)start / mRate;
+         const double t1 = t0 + (double)rand() / RAND_MAX * len / mRate;
+         expected.clear();
+         for (const auto clip : sorted)
+            if (clip->GetEndTime() > t0 && clip->GetStartTime() < t1)
+               expected.push_back(clip);
+         actual.clear();
+         mIndex.GetInTimeRange(t0, t1, mRate, actual);
+         AssertSame(expected, actual);
+      }
+   }
+
+   void testInsertRemove() {
+      std::cout << "\tthe index should follow clips added and removed...";
+      std::cout << std::flush;
+
+      AssertIndexCorrect();
+      for (int i = 0; i < 20; i++)
+      {
+         AddClip();
+         AssertIndexCorrect();
+         RemoveClip(rand() % mClips.size());
+         RemoveClip(rand() % mClips.size());
+         AssertIndexCorrect();
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testSetOffset() {
+      std::cout << "\tthe index should follow clips that move...";
+      std::cout << std::flush;
+
+      AssertIndexCorrect();
+      for (int i = 0; i < 20; i++)
+      {
+         MoveClip(rand() % mClips.size());
+         AssertIndexCorrect();
+      }
+
+      // Moving a clip to where it is already changes nothing
+      const unsigned long generation = TestClip::sPlacementGeneration;
+      mClips[0]->SetOffset(mClips[0]->GetStartTime());
+      assert(TestClip::sPlacementGeneration == generation);
+      AssertIndexCorrect();
+
+      std::cout << "OK\n";
+   }
+
+   void testSetRate() {
+      std::cout << "\tthe index should follow a change of rate...";
+      std::cout << std::flush;
+
+      AssertIndexCorrect();
+      // Clips keep their samples, so they get no longer than a second at
+      // any rate above the first
+      static const int rates[] = {48000, 96000, 192000, 44100};
+      for (int rate : rates)
+      {
+         // As WaveTrack::SetRate does
+         mRate = rate;
+         for (const auto &clip : mClips)
+            clip->SetRate(rate);
+         AssertIndexCorrect();
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testResample() {
+      std::cout << "\tthe index should follow resampled clips...";
+      std::cout << std::flush;
+
+      AssertIndexCorrect();
+      static const int rates[] = {48000, 11025, 192000};
+      for (int rate : rates)
+      {
+         mRate = rate;
+         for (const auto &clip : mClips)
+            clip->Resample(rate);
+         AssertIndexCorrect();
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testLengths() {
+      std::cout << "\tclips that grow or shrink should be found without a rebuild...";
+      std::cout << std::flush;
+
+      AssertIndexCorrect();
+      for (int i = 0; i < 20; i++)
+      {
+         TestClip *clip = mClips[rand() % mClips.size()].get();
+         if (clip->GetNumSamples() > 0)
+            clip->SetNumSamples(rand() % (mRate * 9 / 10));
+         AssertIndexCorrect();
+      }
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    ClipIndexTest tester;
+
+    tester.setUp();
+    tester.testInsertRemove();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testSetOffset();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testSetRate();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testResample();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testLengths();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
@@ -0,0 +1,205 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "commands/CompareKernels.h"
+
+
+class CompareKernelsTest {
+   std::vector<float> buff0;
+   std::vector<float> buff1;
+
+public:
+   CompareKernelsTest()
+   {
+       std::cout << "==> Testing CompareKernels\n";
+       srand(1);
+   }
+
+   void setUp() {
+   }
+
+   void tearDown() {
+      buff0.clear();
+      buff1.clear();
+   }
+
+   // Two signals that differ a little everywhere, and by more than the
+   // threshold now and then
+   void Fill(size_t len)
+   {
+      buff0.resize(len);
+      buff1.resize(len);
+      for (size_t i = 0; i < len; i++)
+      {
+         buff0[i] = 2.0f * rand() / RAND_MAX - 1.0f;
+         float diff = 0.001f * rand() / RAND_MAX;
+         if (rand() % 50 == 0)
+            diff = 0.5f * rand() / RAND_MAX;
+         buff1[i] = buff0[i] + ((rand() % 2) ? diff : -diff);
+      }
+   }
+
+   // The comparison one sample at a time, in double
+   static CompareStats Scalar(const float *b0, const float *b1,
+                              sampleCount pos, sampleCount len, float threshold)
+   {
+      CompareStats stats;
+      for (sampleCount i = 0; i < len; i++)
+      {
+         const float error = fabs(b0[i] - b1[i]);
+         if (error > threshold)
+         {
+            stats.errorCount++;
+            if (stats.firstError < 0)
+               stats.firstError = pos + i;
+         }
+         stats.maxError = std::max(stats.maxError, (double)error);
+         stats.sumSquares += (double)error * error;
+      }
+      return stats;
+   }
+
+   static void AssertSame(const CompareStats &expected, const CompareStats &actual)
+   {
+      if (actual.errorCount != expected.errorCount ||
+          actual.firstError != expected.firstError ||
+          actual.maxError != expected.maxError)
+      {
+         std::cout << expected.errorCount << " " << expected.firstError << " "
+            << expected.maxError << " != " << actual.errorCount << " "
+            << actual.firstError << " " << actual.maxError << std::endl;
+         assert(false);
+      }
+
+      // Only the order of the sum may differ
+      if (fabs(actual.sumSquares - expected.sumSquares) >
+          1e-10 * std::max(1.0, expected.sumSquares))
+      {
+         std::cout << expected.sumSquares << " != " << actual.sumSquares << std::endl;
+         assert(false);
+      }
+   }
+
+   void Check(size_t offset, size_t len, float threshold)
+   {
+      const sampleCount pos = 1000000;
+      CompareStats stats;
+      CompareBuffers(&buff0[offset], &buff1[offset], pos, len, threshold, stats);
+      AssertSame(Scalar(&buff0[offset], &buff1[offset], pos, len, threshold), stats);
+   }
+
+   void testShort() {
+      std::cout << "\tshort buffers of any length should match the scalar loop...";
+      std::cout << std::flush;
+
+      Fill(64);
+      // Every length and misalignment around a group of four
+      for (size_t offset = 0; offset < 4; offset++)
+         for (size_t len = 0; len <= 21; len++)
+         {
+            Check(offset, len, 0.01f);
+            Check(offset, len, 0.0f);
+         }
+
+      // A difference only in the last sample, after the groups of four
+      buff1 = buff0;
+      buff1[18] += 0.25f;
+      for (size_t len = 17; len <= 21; len++)
+         Check(0, len, 0.01f);
+
+      std::cout << "OK\n";
+   }
+
+   void testLong() {
+      std::cout << "\tlong runs should match the scalar loop...";
+      std::cout << std::flush;
+
+      // Several runs of 4096 samples, and a part run, with the threshold
+      // crossed many times in each lane
+      Fill(3 * 4096 + 1000 + 3);
+      Check(0, buff0.size(), 0.01f);
+      Check(1, buff0.size() - 1, 0.01f);
+
+      // Every sample over the threshold, so each lane counts a full run
+      Check(0, buff0.size(), -1.0f);
+
+      // A million samples, where float sums of squares would drift
+      Fill(1 << 20);
+      Check(0, buff0.size(), 0.01f);
+
+      std::cout << "OK\n";
+   }
+
+   void testSplit() {
+      std::cout << "\tstats added up piece by piece should match the whole...";
+      std::cout << std::flush;
+
+      Fill(10000);
+      const sampleCount pos = 5000;
+      const float threshold = 0.01f;
+      CompareStats whole;
+      CompareBuffers(&buff0[0], &buff1[0], pos, buff0.size(), threshold, whole);
+
+      // Pieces of uneven sizes, some of them empty
+      CompareStats pieces;
+      static const size_t sizes[] = {1, 7, 4100, 3, 0, 129, 2000};
+      size_t done = 0;
+      for (size_t i = 0; done < buff0.size(); i++)
+      {
+         const size_t n = std::min(sizes[i % 7], buff0.size() - done);
+         CompareStats piece;
+         CompareBuffers(&buff0[done], &buff1[done], pos + done, n, threshold, piece);
+         pieces.Add(piece);
+         done += n;
+      }
+      AssertSame(whole, pieces);
+
+      CompareStats constant;
+      CompareConstant(-0.5f, pos + done, 100, threshold, constant);
+      assert(constant.errorCount == 100);
+      assert(constant.firstError == pos + (sampleCount)done);
+      assert(constant.maxError == 0.5);
+      assert(constant.sumSquares == 25.0);
+      whole.Add(constant);
+      assert(whole.errorCount == pieces.errorCount + 100);
+      assert(whole.firstError == pieces.firstError);
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    CompareKernelsTest tester;
+
+    tester.setUp();
+    tester.testShort();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testLong();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testSplit();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
@@ -0,0 +1,188 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <wx/init.h>
+
+#include "effects/Convolver.h"
+
+
+class ConvolverTest {
+   static const size_t blockSize = 64;
+   // Long enough that the tail is shared out, and not a whole number
+   // of partitions
+   static const size_t impulseLen = 64 * 70 + 17;
+   static const size_t len = 20000;
+
+   std::vector<float> impulse;
+   std::vector<float> input;
+   std::vector<float> output;
+   std::vector<double> expected;
+
+public:
+   ConvolverTest()
+   {
+       std::cout << "==> Testing PartitionedConvolver\n";
+       srand(1);
+   }
+
+   void setUp() {
+      impulse.resize(impulseLen);
+      input.resize(len);
+      output.resize(len);
+      for (size_t i = 0; i < impulseLen; i++)
+         impulse[i] = (float) ((rand() / (double) RAND_MAX - 0.5) * exp(-3.0 * i / impulseLen));
+      for (size_t i = 0; i < len; i++)
+         input[i] = 2.0f * rand() / RAND_MAX - 1.0f;
+
+      // Direct convolution in double, a block late
+      expected.assign(len, 0.0);
+      for (size_t n = 0; n + blockSize < len; n++)
+      {
+         double sum = 0.0;
+         for (size_t k = 0; k < impulseLen && k <= n; k++)
+            sum += impulse[k] * (double) input[n - k];
+         expected[n + blockSize] = sum;
+      }
+   }
+
+   void tearDown() {
+      impulse.clear();
+      input.clear();
+      output.clear();
+      expected.clear();
+   }
+
+   // Blocks of uneven sizes, some shorter and some longer than the
+   // convolver's, in place
+   void Run(PartitionedConvolver &convolver, std::vector<float> &out, size_t first, size_t n)
+   {
+      static const size_t sizes[] = {1, 7, 300, 64, 1000, 3, 0, 129};
+      size_t done = first;
+      for (size_t i = 0; done < first + n; i++)
+      {
+         const size_t m = std::min(sizes[i % 8], first + n - done);
+         std::copy(input.begin() + done, input.begin() + done + m, out.begin() + done);
+         convolver.Process(&out[done], &out[done], m);
+         done += m;
+      }
+   }
+
+   void AssertNear(const std::vector<float> &out)
+   {
+      for (size_t i = 0; i < len; i++)
+         if (fabs(expected[i] - out[i]) > 1e-4)
+         {
+            std::cout << expected[i] << " != " << out[i] << " (i=" << i << ")" << std::endl;
+            assert(false);
+         }
+   }
+
+   void testDirect() {
+      std::cout << "\tthe output should match direct convolution..." << std::flush;
+
+      PartitionedConvolver convolver(&impulse[0], impulseLen, blockSize);
+      assert(convolver.GetLatency() == blockSize);
+      Run(convolver, output, 0, len);
+      AssertNear(output);
+
+      // And Reset should start it over
+      convolver.Reset();
+      Run(convolver, output, 0, len);
+      AssertNear(output);
+
+      std::cout << "OK\n";
+   }
+
+   void testShort() {
+      std::cout << "\tan impulse shorter than a block should be convolved..." << std::flush;
+
+      impulse.resize(10);
+      PartitionedConvolver convolver(&impulse[0], impulse.size(), blockSize);
+      Run(convolver, output, 0, len);
+      for (size_t n = 0; n < len; n++)
+      {
+         double sum = 0.0;
+         for (size_t k = 0; k < impulse.size() && k + blockSize <= n; k++)
+            sum += impulse[k] * (double) input[n - blockSize - k];
+         if (fabs(sum - output[n]) > 1e-5)
+         {
+            std::cout << sum << " != " << output[n] << " (n=" << n << ")" << std::endl;
+            assert(false);
+         }
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testPool() {
+      std::cout << "\tconvolvers sharing a pool should match direct convolution...";
+      std::cout << std::flush;
+
+      ConvolverPool pool(3);
+
+      // As the channels of an effect, taking turns a buffer at a time
+      std::vector<float> other(len);
+      {
+         PartitionedConvolver left(&impulse[0], impulseLen, blockSize, &pool);
+         PartitionedConvolver right(&impulse[0], impulseLen, blockSize, &pool);
+         for (size_t done = 0; done < len; done += 512)
+         {
+            const size_t n = std::min<size_t>(512, len - done);
+            Run(left, output, done, n);
+            Run(right, other, done, n);
+         }
+         AssertNear(output);
+         AssertNear(other);
+
+         left.Reset();
+         Run(left, output, 0, len);
+         AssertNear(output);
+      }
+
+      // The pool is free for others once those are gone
+      PartitionedConvolver again(&impulse[0], impulseLen, blockSize, &pool);
+      Run(again, output, 0, len);
+      AssertNear(output);
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    // The pool's threads need the library's modules
+    wxInitializer initializer;
+
+    ConvolverTest tester;
+
+    tester.setUp();
+    tester.testDirect();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testShort();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testPool();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
@@ -0,0 +1,263 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "effects/DynamicsProcessor.h"
+
+
+class DynamicsProcessorTest {
+   static const int rate = 44100;
+
+   std::vector<float> input;
+   std::vector<float> output;
+   std::vector<double> expected;
+
+   DynamicsProcessor::Settings settings;
+
+public:
+   DynamicsProcessorTest()
+   {
+       std::cout << "==> Testing DynamicsProcessor\n";
+       srand(1);
+   }
+
+   void setUp() {
+      settings.threshold = pow(10.0, -12.0 / 20.0);
+      settings.noiseFloor = pow(10.0, -40.0 / 20.0);
+      settings.ratio = 4.0;
+      settings.attackTime = 0.1;
+      settings.releaseTime = 1.0;
+      settings.usePeak = false;
+
+      // Quiet, so the envelope starts at the threshold however the
+      // first look-ahead is cut into blocks, then a sudden full scale
+      // burst, then notes that swell and fade
+      const int len = 4 * rate;
+      input.resize(len);
+      output.resize(len);
+      for (int i = 0; i < len; i++)
+      {
+         double noise = 2.0 * rand() / RAND_MAX - 1.0;
+         double t = (double) i / rate;
+         if (t < 1.0)
+            input[i] = (float) (0.001 * noise);
+         else if (t < 1.5)
+            input[i] = (float) sin(2.0 * M_PI * 440.0 * t);
+         else
+            input[i] = (float) (0.9 * fabs(sin(M_PI * t)) * sin(2.0 * M_PI * 220.0 * t)
+                                + 0.05 * noise);
+      }
+   }
+
+   void tearDown() {
+      input.clear();
+      output.clear();
+      expected.clear();
+   }
+
+   // The whole input at once, in double, with the backward pass going
+   // all the way, as the old two-pass Compressor did
+   void Reference(size_t lookAhead)
+   {
+      const size_t len = input.size();
+      const double thr = settings.threshold;
+      const double c = 1.0 - 1.0 / settings.ratio;
+      const double attack = std::min(rate * settings.attackTime + 0.5, (double) lookAhead);
+      const double attackFactor = exp(log(thr) / attack);
+      const double decayFactor = exp(log(thr) / (rate * settings.releaseTime + 0.5));
+
+      std::vector<double> env(len);
+      std::vector<double> circle(100, 0.0);
+      double sum = 0.0;
+      int noiseCounter = 100;
+      double last = thr;
+      for (size_t i = 0; i < len; i++)
+      {
+         double level;
+         if (settings.usePeak)
+            level = fabs(input[i]);
+         else
+         {
+            sum -= circle[i % 100];
+            circle[i % 100] = input[i] * input[i];
+            sum += circle[i % 100];
+            level = sqrt(sum / 100);
+         }
+         if (level < settings.noiseFloor)
+            noiseCounter++;
+         else
+            noiseCounter = 0;
+         if (noiseCounter < 100)
+         {
+            last = std::max(last * decayFactor, thr);
+            last = std::max(last, level);
+         }
+         env[i] = last;
+      }
+
+      last = 0.0;
+      for (size_t i = len; i-- > 0;)
+      {
+         last = std::max(last * attackFactor, thr);
+         if (env[i] < last)
+            env[i] = last;
+         else
+            last = env[i];
+      }
+
+      const double top = settings.usePeak ? 1.0 : thr;
+      expected.resize(len);
+      for (size_t i = 0; i < len; i++)
+         expected[i] = input[i] * pow(top / env[i], c);
+   }
+
+   // Blocks of the given size, or of random sizes if 0
+   void Run(DynamicsProcessor &processor, size_t block)
+   {
+      const size_t len = input.size();
+      size_t done = 0;
+      while (done < len)
+      {
+         size_t n = block ? block : 1 + rand() % 3000;
+         n = std::min(n, len - done);
+         processor.Process(&input[done], &output[done], n);
+         done += n;
+      }
+   }
+
+   void AssertMatches(size_t lookAhead)
+   {
+      for (size_t i = 0; i < lookAhead; i++)
+         assert(output[i] == 0.0f);
+
+      for (size_t i = 0; i + lookAhead < input.size(); i++)
+         if (fabs(expected[i] - output[i + lookAhead]) > 1e-4)
+         {
+            std::cout << expected[i] << " != " << output[i + lookAhead]
+               << " (i=" << i << ")" << std::endl;
+            assert(false);
+         }
+   }
+
+   void testLatency() {
+      std::cout << "\tthe look-ahead should be as long as the attack..." << std::flush;
+
+      DynamicsProcessor processor;
+      processor.Init(settings, rate);
+      assert(processor.GetLatency() == (size_t) ceil(rate * 0.1 + 0.5));
+
+      std::cout << "OK\n";
+   }
+
+   void testReference() {
+      std::cout << "\tthe stream should match the whole-track envelope...";
+      std::cout << std::flush;
+
+      const bool modes[] = {false, true};
+      const size_t blocks[] = {512, 4096, 0};
+      for (bool usePeak : modes)
+      {
+         settings.usePeak = usePeak;
+         for (size_t block : blocks)
+         {
+            DynamicsProcessor processor;
+            processor.Init(settings, rate);
+            Run(processor, block);
+            Reference(processor.GetLatency());
+            AssertMatches(processor.GetLatency());
+         }
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testCapped() {
+      std::cout << "\ta capped look-ahead should limit peaks with a shorter attack...";
+      std::cout << std::flush;
+
+      settings.usePeak = true;
+      settings.attackTime = 2.0;
+
+      DynamicsProcessor processor;
+      processor.Init(settings, rate, 0.005);
+      const size_t lookAhead = processor.GetLatency();
+      assert(lookAhead == (size_t) ceil(rate * 0.005));
+
+      Run(processor, 512);
+      Reference(lookAhead);
+      AssertMatches(lookAhead);
+
+      // Full scale maps to full scale, even for the sudden burst
+      for (size_t i = 0; i < output.size(); i++)
+         assert(fabs(output[i]) <= 1.0f + 1e-6f);
+
+      // Nor does a yet longer attack lengthen it
+      settings.attackTime = 5.0;
+      processor.SetSettings(settings);
+      assert(processor.GetLatency() == lookAhead);
+
+      std::cout << "OK\n";
+   }
+
+   void testAttackGrows() {
+      std::cout << "\ta longer attack should lengthen the look-ahead..." << std::flush;
+
+      DynamicsProcessor processor;
+      processor.Init(settings, rate);
+
+      settings.attackTime = 0.5;
+      processor.SetSettings(settings);
+      const size_t lookAhead = processor.GetLatency();
+      assert(lookAhead == (size_t) ceil(rate * 0.5 + 0.5));
+
+      // And a shorter one keeps it, the envelope being no less right
+      settings.attackTime = 0.2;
+      processor.SetSettings(settings);
+      assert(processor.GetLatency() == lookAhead);
+
+      Run(processor, 1024);
+      Reference(lookAhead);
+      AssertMatches(lookAhead);
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    DynamicsProcessorTest tester;
+
+    tester.setUp();
+    tester.testLatency();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testReference();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testCapped();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testAttackGrows();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
@@ -0,0 +1,234 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "effects/GeneratorKernels.h"
+
+
+class GeneratorKernelsTest {
+   // Not a multiple of four, so that the scalar tail is tried too
+   static const size_t len = 4099;
+
+   std::vector<float> cycles;
+   std::vector<float> frequencies;
+   std::vector<float> out;
+
+public:
+   GeneratorKernelsTest()
+   {
+       std::cout << "==> Testing GeneratorKernels\n";
+   }
+
+   void setUp() {
+      cycles.resize(len);
+      frequencies.resize(len);
+      out.resize(len);
+
+      // An odd step, so the phases come out at many different points
+      CyclesOfRamp(0.1234, 0.0137, &cycles[0], len);
+
+      // A chirp from 100Hz to 5kHz at 44100Hz, so the lanes of a group
+      // stop adding harmonics at different places
+      for (size_t i = 0; i < len; i++)
+         frequencies[i] = (float) ((100.0 + 4900.0 * i / len) / 44100.0);
+   }
+
+   void tearDown() {
+      cycles.clear();
+      frequencies.clear();
+      out.clear();
+   }
+
+   void AssertNear(double expected, float actual, double tolerance, size_t i)
+   {
+      if (fabs(expected - actual) > tolerance)
+      {
+         std::cout << expected << " != " << actual << " (i=" << i << ")" << std::endl;
+         assert(false);
+      }
+   }
+
+   void testCycles() {
+      std::cout << "\tthe phases of a long ramp should stay within the cycle...";
+      std::cout << std::flush;
+
+      const double start = 1000000.25, increment = 1.0 / 3.0;
+      CyclesOfRamp(start, increment, &out[0], len);
+      for (size_t i = 0; i < len; i++)
+      {
+         double c = start + i * increment;
+         c -= floor(c);
+         assert(out[i] >= 0.0f && out[i] < 1.0f);
+         // Either side of a whole cycle is the same phase
+         double d = fabs(c - out[i]);
+         AssertNear(0.0, (float) std::min(d, 1.0 - d), 1e-6, i);
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testSine() {
+      std::cout << "\tsine should match the double precision formula..." << std::flush;
+
+      SineOfCycles(&cycles[0], &out[0], len);
+      for (size_t i = 0; i < len; i++)
+         AssertNear(sin(2.0 * M_PI * cycles[i]), out[i], 1e-5, i);
+
+      std::cout << "OK\n";
+   }
+
+   void testSquare() {
+      std::cout << "\tsquare should match the double precision formula..." << std::flush;
+
+      SquareOfCycles(&cycles[0], &out[0], len);
+      for (size_t i = 0; i < len; i++)
+         AssertNear(cycles[i] < 0.5 ? 1.0 : -1.0, out[i], 0.0, i);
+
+      std::cout << "OK\n";
+   }
+
+   void testSawtooth() {
+      std::cout << "\tsawtooth should match the double precision formula..." << std::flush;
+
+      SawtoothOfCycles(&cycles[0], &out[0], len);
+      for (size_t i = 0; i < len; i++)
+      {
+         double x = cycles[i] + 0.5;
+         x -= floor(x);
+         AssertNear(2.0 * x - 1.0, out[i], 1e-6, i);
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testBandLimitedSquare() {
+      std::cout << "\tband limited square should match the double precision formula...";
+      std::cout << std::flush;
+
+      BandLimitedSquareOfCycles(&cycles[0], &frequencies[0], &out[0], len);
+      for (size_t i = 0; i < len; i++)
+      {
+         const double p = cycles[i];
+         const double fr = frequencies[i];
+
+         double b = (1.0 + cos(2.0 * M_PI * fr)) * M_PI / 4.0;
+         double f = 4.0 / M_PI * sin(2.0 * M_PI * p);
+         for (int k = 3; (k < 200) && (k * fr < 0.5); k += 2)
+         {
+            double a = 1.0 + cos(2.0 * M_PI * k * fr);
+            f += a * sin(2.0 * M_PI * k * p) / (b * k);
+         }
+
+         // The harmonics' phases are taken in float, so some loss is
+         // expected at the top of the series
+         AssertNear(f, out[i], 1e-3, i);
+      }
+
+      std::cout << "OK\n";
+   }
+
+   // One step of the generator that gives sample n, as WhiteNoise should
+   static float NextNoise(unsigned int state[4], size_t n)
+   {
+      unsigned int &s = state[n % 4];
+      s ^= s << 13;
+      s ^= s >> 17;
+      s ^= s << 5;
+      return (float) (int) (s >> 8) * (1.0f / 8388608.0f) - 1.0f;
+   }
+
+   void testWhiteNoise() {
+      std::cout << "\twhite noise should match the scalar xorshift..." << std::flush;
+
+      NoiseSource source;
+      source.Seed(12345);
+      unsigned int state[4];
+      for (int j = 0; j < 4; j++)
+         state[j] = source.state[j];
+
+      WhiteNoise(source, &out[0], len, 0.5f);
+      for (size_t i = 0; i < len; i++)
+      {
+         float w = NextNoise(state, i);
+         assert(w >= -1.0f && w < 1.0f);
+         AssertNear(w * 0.5f, out[i], 0.0, i);
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testWhiteNoiseBlocks() {
+      std::cout << "\twhite noise should not depend on the block sizes..." << std::flush;
+
+      NoiseSource whole, parts;
+      whole.Seed(54321);
+      parts.Seed(54321);
+
+      std::vector<float> expected(len);
+      WhiteNoise(whole, &expected[0], len, 1.0f);
+
+      // Blocks of every size mod 4, so part groups are carried over
+      size_t done = 0;
+      for (size_t block = 1; done < len; block++)
+      {
+         const size_t n = std::min(block, len - done);
+         WhiteNoise(parts, &out[done], n, 1.0f);
+         done += n;
+      }
+
+      for (size_t i = 0; i < len; i++)
+         AssertNear(expected[i], out[i], 0.0, i);
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    GeneratorKernelsTest tester;
+
+    tester.setUp();
+    tester.testCycles();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testSine();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testSquare();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testSawtooth();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testBandLimitedSquare();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testWhiteNoise();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testWhiteNoiseBlocks();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
@@ -0,0 +1,142 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+
+#include "effects/InterleaveKernels.h"
+
+
+class InterleaveKernelsTest {
+   std::vector<float> left;
+   std::vector<float> right;
+   std::vector<float> pairs;
+
+public:
+   InterleaveKernelsTest()
+   {
+       std::cout << "==> Testing InterleaveKernels\n";
+       srand(1);
+   }
+
+   void setUp() {
+   }
+
+   void tearDown() {
+      left.clear();
+      right.clear();
+      pairs.clear();
+   }
+
+   // Room for offset + len frames, and a guard sample past the end
+   void Fill(size_t offset, size_t len)
+   {
+      left.resize(offset + len + 1);
+      right.resize(offset + len + 1);
+      pairs.resize(2 * (offset + len) + 1);
+      for (auto &sample : left)
+         sample = 2.0f * rand() / RAND_MAX - 1.0f;
+      for (auto &sample : right)
+         sample = 2.0f * rand() / RAND_MAX - 1.0f;
+      for (auto &sample : pairs)
+         sample = 2.0f * rand() / RAND_MAX - 1.0f;
+   }
+
+   // Checks one size, from pointers offset by whole samples, so that the
+   // SSE path sees every alignment
+   void Check(size_t offset, size_t len)
+   {
+      Fill(offset, len);
+      const std::vector<float> guard = pairs;
+      Interleave(&left[offset], &right[offset], &pairs[2 * offset], len);
+      for (size_t i = 0; i < 2 * offset; i++)
+         assert(pairs[i] == guard[i]);
+      for (size_t i = 0; i < len; i++)
+      {
+         assert(pairs[2 * (offset + i)] == left[offset + i]);
+         assert(pairs[2 * (offset + i) + 1] == right[offset + i]);
+      }
+      assert(pairs.back() == guard.back());
+
+      Fill(offset, len);
+      const std::vector<float> guardLeft = left, guardRight = right;
+      Deinterleave(&pairs[2 * offset], &left[offset], &right[offset], len);
+      for (size_t i = 0; i < offset; i++)
+         assert(left[i] == guardLeft[i] && right[i] == guardRight[i]);
+      for (size_t i = 0; i < len; i++)
+      {
+         assert(left[offset + i] == pairs[2 * (offset + i)]);
+         assert(right[offset + i] == pairs[2 * (offset + i) + 1]);
+      }
+      assert(left.back() == guardLeft.back());
+      assert(right.back() == guardRight.back());
+   }
+
+   void testShort() {
+      std::cout << "\tshort runs at any alignment should match the scalar loop...";
+      std::cout << std::flush;
+
+      for (size_t offset = 0; offset < 4; offset++)
+         for (size_t len = 0; len <= 21; len++)
+            Check(offset, len);
+
+      std::cout << "OK\n";
+   }
+
+   void testLong() {
+      std::cout << "\ta whole block should match the scalar loop...";
+      std::cout << std::flush;
+
+      Check(0, 262144);
+      Check(3, 65536 + 3);
+
+      std::cout << "OK\n";
+   }
+
+   void testRoundTrip() {
+      std::cout << "\tdeinterleaving what was interleaved should give it back...";
+      std::cout << std::flush;
+
+      const size_t len = 1003;
+      Fill(0, len);
+      const std::vector<float> l = left, r = right;
+      Interleave(&l[0], &r[0], &pairs[0], len);
+      std::vector<float> l2(len), r2(len);
+      Deinterleave(&pairs[0], &l2[0], &r2[0], len);
+      for (size_t i = 0; i < len; i++)
+         assert(l2[i] == l[i] && r2[i] == r[i]);
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    InterleaveKernelsTest tester;
+
+    tester.setUp();
+    tester.testShort();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testLong();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testRoundTrip();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
@@ -0,0 +1,207 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include <wx/init.h>
+
+#include "effects/PaulstretchKernels.h"
+#include "effects/AnalysisJobs.h"
+
+
+class PaulstretchKernelsTest {
+   static const int bufsize = 1024;
+   static const int numWindows = 24;
+   static const size_t numWorkers = 4;
+
+   std::vector<float> mInput;
+   std::vector<unsigned> mSeeds;
+
+public:
+   PaulstretchKernelsTest()
+   {
+       std::cout << "==> Testing PaulStretch\n";
+       srand(1);
+   }
+
+   void setUp() {
+      // Noise, with each window's pool starting a hop after the last
+      mInput.resize(2 * bufsize + numWindows * bufsize / 4);
+      for (auto &sample : mInput)
+         sample = 2.0f * rand() / RAND_MAX - 1.0f;
+      mSeeds.clear();
+      for (int w = 0; w < numWindows; w++)
+         mSeeds.push_back(PaulStretch::WindowSeed(0, w));
+   }
+
+   void tearDown() {
+      mInput.clear();
+      mSeeds.clear();
+   }
+
+   const float *Pool(int w)
+   {
+      return &mInput[w * bufsize / 4];
+   }
+
+   // The windows computed one after another, as one thread would
+   std::vector<std::vector<float>> Sequential(const PaulStretch &stretch)
+   {
+      std::vector<std::vector<float>> windows(numWindows);
+      PaulStretch::Scratch scratch;
+      for (int w = 0; w < numWindows; w++)
+      {
+         windows[w].resize(stretch.poolsize);
+         stretch.process_window(Pool(w), mSeeds[w], &windows[w][0], scratch);
+      }
+      return windows;
+   }
+
+   static bool Same(const std::vector<float> &a, const std::vector<float> &b)
+   {
+      return a.size() == b.size() &&
+         memcmp(&a[0], &b[0], a.size() * sizeof(float)) == 0;
+   }
+
+   void testThreads() {
+      std::cout << "\twindows should be the same whatever thread computes them...";
+      std::cout << std::flush;
+
+      PaulStretch stretch(10.0f, bufsize, 44100.0f);
+      // This also builds the FFT tables before any worker needs them
+      const auto expected = Sequential(stretch);
+
+      // The workers take the windows in a shuffled order, each with its
+      // own scratch space, as EffectPaulstretch::ProcessOne does
+      std::vector<int> order(numWindows);
+      for (int w = 0; w < numWindows; w++)
+         order[w] = w;
+      std::random_shuffle(order.begin(), order.end());
+
+      std::vector<PaulStretch::Scratch> scratch(numWorkers);
+      std::vector<std::vector<float>> windows(numWindows);
+      assert(RunAnalysisJobs(numWindows, numWorkers,
+         [&](size_t worker, size_t job, const AnalysisProgress &)
+      {
+         const int w = order[job];
+         windows[w].resize(stretch.poolsize);
+         stretch.process_window(Pool(w), mSeeds[w], &windows[w][0], scratch[worker]);
+      }, [](double) { return false; }));
+
+      for (int w = 0; w < numWindows; w++)
+         assert(Same(expected[w], windows[w]));
+
+      // And the output made from them in order is the same too
+      PaulStretch a(10.0f, bufsize, 44100.0f), b(10.0f, bufsize, 44100.0f);
+      for (int w = 0; w < numWindows; w++)
+      {
+         a.add_window(&expected[w][0]);
+         b.add_window(&windows[w][0]);
+         assert(memcmp(a.out_buf, b.out_buf, a.out_bufsize * sizeof(float)) == 0);
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testSeeds() {
+      std::cout << "\tonly the seed should decide the phases...";
+      std::cout << std::flush;
+
+      PaulStretch stretch(10.0f, bufsize, 44100.0f);
+      PaulStretch::Scratch scratch;
+      std::vector<float> a(stretch.poolsize), b(stretch.poolsize);
+
+      // The same seed twice, with the scratch space already used
+      stretch.process_window(Pool(0), mSeeds[0], &a[0], scratch);
+      stretch.process_window(Pool(1), mSeeds[1], &b[0], scratch);
+      stretch.process_window(Pool(0), mSeeds[0], &b[0], scratch);
+      assert(Same(a, b));
+
+      // Another seed, for the same pool
+      stretch.process_window(Pool(0), mSeeds[1], &b[0], scratch);
+      assert(!Same(a, b));
+
+      // Every window of every channel has a seed of its own, up to the
+      // last that are promised to differ
+      std::vector<int> channels;
+      for (int channel = 0; channel < 16; channel++)
+         channels.push_back(channel);
+      channels.push_back(253);
+      channels.push_back(254);
+      std::set<unsigned> seeds;
+      for (int channel : channels)
+      {
+         for (sampleCount w = 0; w < 10000; w++)
+            assert(seeds.insert(PaulStretch::WindowSeed(channel, w)).second);
+         for (sampleCount w = 0x7FFFFF - 100; w <= 0x7FFFFF; w++)
+            assert(seeds.insert(PaulStretch::WindowSeed(channel, w)).second);
+      }
+      for (unsigned seed : seeds)
+         assert(seed > 0 && seed < 2147483647u);
+
+      std::cout << "OK\n";
+   }
+
+   void testNumSamples() {
+      std::cout << "\tthe pool should advance by the stretched window on average...";
+      std::cout << std::flush;
+
+      static const float raps[] = {1.0f, 1.5f, 10.0f, 333.3f};
+      for (float rap : raps)
+      {
+         PaulStretch stretch(rap, bufsize, 44100.0f);
+         assert(stretch.get_nsamples_for_fill() == stretch.poolsize);
+
+         // The fractions left over each time are carried, so none is lost
+         double total = 0;
+         for (int n = 1; n <= 1000; n++)
+         {
+            const int nsamples = stretch.get_nsamples();
+            assert(nsamples >= 0 && nsamples <= stretch.poolsize);
+            total += nsamples;
+            assert(fabs(total - n * (double)stretch.out_bufsize / rap) < 1.0 + 1e-6 * n);
+         }
+      }
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    // Threads need the library's modules
+    wxInitializer initializer;
+
+    PaulstretchKernelsTest tester;
+
+    tester.setUp();
+    tester.testThreads();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testSeeds();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testNumSamples();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
@@ -0,0 +1,222 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include <wx/arrstr.h>
+#include <wx/string.h>
+
+#include "PluginScanQueue.h"
+
+
+// Stands in for PluginScanner and the providers, with helpers that finish
+// in any order, so that the queue can be followed without processes
+class PluginScanQueueTest {
+   static const size_t numPaths = 200;
+   static const size_t maxRunning = 4;
+
+   struct Path
+   {
+      wxString name;
+      wxArrayString providers;
+      int registeredBy;   // index of the provider that registers it, or -1
+      std::vector<PluginID> tried;
+      int done;
+   };
+
+   struct Running
+   {
+      size_t index;
+      PluginID provider;
+   };
+
+   std::vector<Path> mPaths;
+
+public:
+   PluginScanQueueTest()
+   {
+       std::cout << "==> Testing PluginScanQueue\n";
+       srand(1);
+   }
+
+   void setUp() {
+      static const char *const names[] = { "VST", "LV2", "LADSPA" };
+      mPaths.resize(numPaths);
+      for (size_t i = 0; i < numPaths; i++)
+      {
+         Path &path = mPaths[i];
+         path.name = wxString::Format(wxT("/plugins/%d.so"), (int)i);
+         path.providers.Clear();
+         const int count = 1 + rand() % 3;
+         for (int j = 0; j < count; j++)
+            path.providers.Add(names[j]);
+         path.registeredBy = rand() % (count + 1) - 1;
+         path.tried.clear();
+         path.done = 0;
+      }
+   }
+
+   void tearDown() {
+      mPaths.clear();
+   }
+
+   // Tries the path as its provider would.  Returns true if it registered.
+   bool Registers(const Running &run)
+   {
+      Path &path = mPaths[run.index];
+      path.tried.push_back(run.provider);
+      return (int)path.tried.size() - 1 == path.registeredBy;
+   }
+
+   void Finish(PluginScanQueue &queue, const Running &run, std::vector<size_t> &waitingAgain)
+   {
+      if (queue.Tried(run.index, Registers(run)))
+         mPaths[run.index].done++;
+      else
+         waitingAgain.push_back(run.index);
+   }
+
+   void testProviders() {
+      std::cout << "\teach path should be tried with its providers in turn...";
+      std::cout << std::flush;
+
+      PluginScanQueue queue(maxRunning);
+      for (const auto &path : mPaths)
+         queue.Add(path.name, path.providers);
+      assert(queue.GetCount() == numPaths);
+
+      std::vector<Running> running;
+      std::vector<size_t> waitingAgain;
+      while (queue.GetDone() < numPaths)
+      {
+         // Start helpers while there is room, a path whose provider
+         // failed going first
+         Running run;
+         while (queue.Take(run.index, run.provider))
+         {
+            if (!waitingAgain.empty())
+            {
+               assert(run.index == waitingAgain.back());
+               waitingAgain.pop_back();
+            }
+            assert(queue.GetPath(run.index) == mPaths[run.index].name);
+
+            // Some providers register in-process, at once
+            if (rand() % 3 == 0)
+               Finish(queue, run, waitingAgain);
+            else
+               running.push_back(run);
+
+            assert(running.size() == queue.GetRunning());
+            assert(queue.GetRunning() <= maxRunning);
+         }
+         assert(running.size() == maxRunning || queue.GetDone() + running.size() == numPaths);
+
+         // Some helpers finish, in any order
+         std::random_shuffle(running.begin(), running.end());
+         const size_t finishing = running.empty() ? 0 : 1 + rand() % running.size();
+         for (size_t i = 0; i < finishing; i++)
+         {
+            Finish(queue, running.back(), waitingAgain);
+            running.pop_back();
+         }
+      }
+
+      assert(running.empty() && queue.GetRunning() == 0);
+      Running run;
+      assert(!queue.Take(run.index, run.provider));
+
+      // Each path is done once, after trying the providers up to the one
+      // that registered it, or all of them
+      for (const auto &path : mPaths)
+      {
+         assert(path.done == 1);
+         const size_t expected = path.registeredBy < 0
+            ? path.providers.GetCount()
+            : (size_t)path.registeredBy + 1;
+         assert(path.tried.size() == expected);
+         for (size_t j = 0; j < expected; j++)
+            assert(path.tried[j] == path.providers[j]);
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testOrder() {
+      std::cout << "\tpaths should be started in the order they were added...";
+      std::cout << std::flush;
+
+      PluginScanQueue queue(1);
+      for (const auto &path : mPaths)
+         queue.Add(path.name, path.providers);
+
+      // One at a time, each path is finished before the next starts
+      Running run, another;
+      size_t expected = 0;
+      while (queue.Take(run.index, run.provider))
+      {
+         assert(run.index == expected);
+         assert(!queue.Take(another.index, another.provider));
+         if (queue.Tried(run.index, Registers(run)))
+            expected++;
+      }
+      assert(expected == numPaths && queue.GetDone() == numPaths);
+
+      std::cout << "OK\n";
+   }
+
+   void testClear() {
+      std::cout << "\tclearing should abandon the paths waiting...";
+      std::cout << std::flush;
+
+      PluginScanQueue queue(maxRunning);
+      for (const auto &path : mPaths)
+         queue.Add(path.name, path.providers);
+
+      Running run;
+      for (size_t i = 0; i < maxRunning; i++)
+         assert(queue.Take(run.index, run.provider));
+      assert(!queue.Take(run.index, run.provider));
+
+      // The helpers under way are forgotten, and finish unheard
+      queue.Clear();
+      assert(queue.GetRunning() == 0);
+      assert(!queue.Take(run.index, run.provider));
+      assert(queue.GetDone() == 0 && queue.GetCount() == numPaths);
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    PluginScanQueueTest tester;
+
+    tester.setUp();
+    tester.testProviders();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testOrder();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testClear();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
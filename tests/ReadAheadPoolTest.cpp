@@ -0,0 +1,192 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include <wx/init.h>
+#include <wx/thread.h>
+#include <wx/utils.h>
+
+#include "ReadAheadPool.h"
+
+
+// Stands in for the caches of several tracks, each posting its blocks as
+// WaveTrackCache does, with jobs that count themselves instead of reading
+class ReadAheadPoolTest {
+   static const size_t numOwners = 6;
+   static const size_t maxThreads = 2;
+
+   wxMutex mMutex;
+   std::vector<int> mDone;
+   int mBusy;
+   int mMostBusy;
+
+public:
+   ReadAheadPoolTest()
+   {
+       std::cout << "==> Testing ReadAheadPool\n";
+   }
+
+   void setUp() {
+      mDone.assign(numOwners, 0);
+      mBusy = 0;
+      mMostBusy = 0;
+   }
+
+   void tearDown() {
+      mDone.clear();
+   }
+
+   const void *Owner(size_t owner) { return &mDone[owner]; }
+
+   ReadAheadPool::Job Read(size_t owner, int ms)
+   {
+      return [this, owner, ms]
+      {
+         {
+            wxMutexLocker locker(mMutex);
+            mMostBusy = std::max(mMostBusy, ++mBusy);
+         }
+         wxMilliSleep(ms);
+         wxMutexLocker locker(mMutex);
+         --mBusy;
+         ++mDone[owner];
+      };
+   }
+
+   int Done(size_t owner)
+   {
+      wxMutexLocker locker(mMutex);
+      return mDone[owner];
+   }
+
+   // Waits up to ten seconds for the jobs to be done
+   bool WaitFor(size_t owner, int jobs)
+   {
+      for (int i = 0; i < 1000 && Done(owner) < jobs; i++)
+         wxMilliSleep(10);
+      return Done(owner) == jobs;
+   }
+
+   void testShared() {
+      std::cout << "\tall the owners' jobs should run on the few threads...";
+      std::cout << std::flush;
+
+      ReadAheadPool pool(maxThreads);
+      for (int block = 0; block < 20; block++)
+         for (size_t owner = 0; owner < numOwners; owner++)
+            assert(pool.Post(Owner(owner), Read(owner, 1)));
+
+      for (size_t owner = 0; owner < numOwners; owner++)
+         assert(WaitFor(owner, 20));
+      assert(pool.GetThreadCount() <= maxThreads);
+      assert(mMostBusy <= (int)maxThreads);
+
+      std::cout << "OK\n";
+   }
+
+   void testCancel() {
+      std::cout << "\tcancelling should wait for the owner's running job and drop the rest...";
+      std::cout << std::flush;
+
+      ReadAheadPool pool(maxThreads);
+      for (int block = 0; block < 20; block++)
+      {
+         assert(pool.Post(Owner(0), Read(0, 5)));
+         assert(pool.Post(Owner(1), Read(1, 1)));
+      }
+      wxMilliSleep(12);
+
+      pool.Cancel(Owner(0));
+      // Nothing of the owner's runs once Cancel returns, so it may go
+      const int done = Done(0);
+      assert(done < 20);
+
+      // The other owner's jobs are left to run
+      assert(WaitFor(1, 20));
+      assert(Done(0) == done);
+
+      // Cancelling when nothing is queued returns at once
+      pool.Cancel(Owner(2));
+
+      std::cout << "OK\n";
+   }
+
+   void testIdle() {
+      std::cout << "\tidle threads should end, and others start for new jobs...";
+      std::cout << std::flush;
+
+      ReadAheadPool pool(maxThreads, 20);
+      assert(pool.GetThreadCount() == 0);
+      assert(pool.Post(Owner(0), Read(0, 1)));
+      assert(WaitFor(0, 1));
+
+      for (int i = 0; i < 500 && pool.GetThreadCount() > 0; i++)
+         wxMilliSleep(10);
+      assert(pool.GetThreadCount() == 0);
+
+      assert(pool.Post(Owner(0), Read(0, 1)));
+      assert(WaitFor(0, 2));
+
+      std::cout << "OK\n";
+   }
+
+   void testDestroy() {
+      std::cout << "\ta pool should end its threads when destroyed...";
+      std::cout << std::flush;
+
+      {
+         ReadAheadPool pool(maxThreads);
+         for (int block = 0; block < 50; block++)
+            assert(pool.Post(Owner(0), Read(0, 2)));
+         wxMilliSleep(5);
+      }
+
+      // No job is left running, and those queued were dropped
+      const int done = Done(0);
+      assert(done < 50);
+      wxMilliSleep(20);
+      assert(Done(0) == done);
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    // Threads need the library's modules
+    wxInitializer initializer;
+
+    ReadAheadPoolTest tester;
+
+    tester.setUp();
+    tester.testShared();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testCancel();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testIdle();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testDestroy();
+    tester.tearDown();
+
+    return 0;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3
@@ -0,0 +1,263 @@
+
+#include <iostream>
+#include <ostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "Sequence.h"
+#include "DirManager.h"
+#include "BlockFile.h"
+
+
+class SampleStatsTest {
+   std::shared_ptr<DirManager> mDirManager;
+   std::unique_ptr<Sequence> mSequence;
+   std::vector<float> mMemorySequence;
+
+public:
+   SampleStatsTest()
+   {
+       std::cout << "==> Testing SampleStats\n";
+       srand(1);
+   }
+
+   void setUp() {
+      DirManager::SetTempDir(wxT("/tmp/samplestats-test-dir"));
+      mDirManager = std::make_shared<DirManager>();
+      mSequence = std::make_unique<Sequence>(mDirManager, floatSample);
+      mMemorySequence.clear();
+   }
+
+   void tearDown() {
+      mSequence.reset();
+      mDirManager.reset();
+      mMemorySequence.clear();
+   }
+
+   // Noise at a level that changes every few thousand samples, so every
+   // octave of the histogram is used, with some samples clipped and some
+   // digital silence
+   void Append(size_t len)
+   {
+      std::vector<float> buffer(len);
+      float level = 1.0f;
+      for (size_t i = 0; i < len; i++)
+      {
+         if (i % 3000 == 0)
+            level = (float) ldexp(1.0, -(rand() % 20));
+         const int r = rand() % 100;
+         if (r == 0)
+            buffer[i] = 0.0f;
+         else if (r == 1)
+            buffer[i] = (rand() % 2) ? 1.0f : -1.5f;
+         else
+            buffer[i] = level * (2.0f * rand() / RAND_MAX - 1.0f);
+      }
+
+      mSequence->Append((samplePtr) &buffer[0], floatSample, len);
+      mMemorySequence.insert(mMemorySequence.end(), buffer.begin(), buffer.end());
+   }
+
+   // The statistics computed directly from the samples
+   static SampleStats Direct(const std::vector<float> &samples, size_t start, size_t len)
+   {
+      SampleStats stats;
+      for (size_t i = start; i < start + len; i++)
+      {
+         const float value = samples[i];
+         stats.count++;
+         stats.sum += value;
+         // MAX_AUDIO, the largest 16-bit sample
+         if (fabs(value) >= 1.0 - 1.0 / 32768)
+            stats.clipped++;
+
+         // 2^(e-1) <= |value| < 2^e, so the bin is -e
+         int e = 0;
+         int bin = SampleStats::nBins - 1;
+         if (value != 0.0f)
+         {
+            frexp(value, &e);
+            bin = std::max(0, std::min<int>(SampleStats::nBins - 1, -e));
+         }
+         stats.histogram[bin]++;
+      }
+      return stats;
+   }
+
+   static void AssertSame(const SampleStats &expected, const SampleStats &actual)
+   {
+      assert(actual.count == expected.count);
+      assert(actual.clipped == expected.clipped);
+      // Whole blocks were summed apart, so the order of the sum differs
+      assert(fabs(actual.sum - expected.sum) <= 1e-9 * std::max<double>(1, expected.count));
+      for (int k = 0; k < SampleStats::nBins; k++)
+         if (actual.histogram[k] != expected.histogram[k])
+         {
+            std::cout << expected.histogram[k] << " != " << actual.histogram[k]
+               << " (bin=" << k << ")" << std::endl;
+            assert(false);
+         }
+   }
+
+   void AssertMatchesSequence()
+   {
+      const size_t total = mMemorySequence.size();
+      assert((size_t) mSequence->GetNumSamples() == total);
+
+      // The sequence holds what was put in it
+      std::vector<float> samples(total);
+      assert(mSequence->Get((samplePtr) &samples[0], floatSample, 0, total));
+      assert(samples == mMemorySequence);
+
+      SampleStats stats;
+      assert(mSequence->GetStats(0, total, stats));
+      AssertSame(Direct(mMemorySequence, 0, total), stats);
+
+      // Regions starting and ending within blocks, or on their edges
+      for (int i = 0; i < 50; i++)
+      {
+         const size_t start = rand() % total;
+         const size_t len = rand() % (total - start + 1);
+         assert(mSequence->GetStats(start, len, stats));
+         AssertSame(Direct(mMemorySequence, start, len), stats);
+      }
+
+      // Block by block
+      size_t start = 0;
+      while (start < total)
+      {
+         const sampleCount left = mSequence->GetBlockStats(start, stats);
+         assert(left > 0);
+         const size_t blockStart = start + left - stats.count;
+         AssertSame(Direct(mMemorySequence, blockStart, stats.count), stats);
+         start += left;
+      }
+   }
+
+   void testAppended() {
+      std::cout << "\tthe statistics of appended blocks should match the samples...";
+      std::cout << std::flush;
+
+      const size_t block = mSequence->GetMaxBlockSize();
+      Append(block * 3 + block / 3);
+      Append(block / 2);
+      AssertMatchesSequence();
+
+      std::cout << "OK\n";
+   }
+
+   void testEdited() {
+      std::cout << "\tthe statistics should follow copies, pastes, deletes and silence...";
+      std::cout << std::flush;
+
+      const size_t block = mSequence->GetMaxBlockSize();
+      Append(block * 4);
+
+      for (int i = 0; i < 10; i++)
+      {
+         const size_t total = mMemorySequence.size();
+
+         const size_t s0 = rand() % total;
+         const size_t len = rand() % (total - s0);
+         std::unique_ptr<Sequence> copy;
+         assert(mSequence->Copy(s0, s0 + len, copy));
+         const size_t dest = rand() % total;
+         assert(mSequence->Paste(dest, copy.get()));
+         std::vector<float> copied(mMemorySequence.begin() + s0,
+                                   mMemorySequence.begin() + s0 + len);
+         mMemorySequence.insert(mMemorySequence.begin() + dest,
+                                copied.begin(), copied.end());
+
+         const size_t del = rand() % mMemorySequence.size();
+         const size_t dellen = rand() % ((mMemorySequence.size() - del) / 2 + 1);
+         assert(mSequence->Delete(del, dellen));
+         mMemorySequence.erase(mMemorySequence.begin() + del,
+                               mMemorySequence.begin() + del + dellen);
+
+         const size_t at = rand() % mMemorySequence.size();
+         const size_t silence = rand() % block;
+         assert(mSequence->InsertSilence(at, silence));
+         mMemorySequence.insert(mMemorySequence.begin() + at, silence, 0.0f);
+
+         AssertMatchesSequence();
+      }
+
+      std::cout << "OK\n";
+   }
+
+   void testLevels() {
+      std::cout << "\tcounts below and above a level should agree with the histogram...";
+      std::cout << std::flush;
+
+      Append(mSequence->GetMaxBlockSize() * 2);
+      const size_t total = mMemorySequence.size();
+      SampleStats stats;
+      assert(mSequence->GetStats(0, total, stats));
+
+      // On the edges of the bins the counts are exact.  Bin 0 also holds
+      // what is louder than full scale, so full scale itself is left out.
+      for (int k = 1; k < SampleStats::nBins; k++)
+      {
+         const float level = (float) ldexp(1.0, -k);
+         sampleCount below = 0, atLeast = 0;
+         for (size_t i = 0; i < total; i++)
+         {
+            if (fabs(mMemorySequence[i]) < level)
+               below++;
+            else
+               atLeast++;
+         }
+         assert(stats.CountBelow(level) == below);
+         assert(stats.CountAtLeast(level) == atLeast);
+      }
+
+      // And the record survives the project file
+      SampleStats read;
+      assert(read.FromString(stats.ToString()));
+      AssertSame(stats, read);
+
+      std::cout << "OK\n";
+   }
+};
+
+int main()
+{
+    SampleStatsTest tester;
+
+    tester.setUp();
+    tester.testAppended();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testEdited();
+    tester.tearDown();
+
+    tester.setUp();
+    tester.testLevels();
+    tester.tearDown();
+
+    return 0;
+}
+
+class wxWindow;
+
+void ShowWarningDialog(wxWindow *parent,
+                      wxString internalDialogName,
+                      wxString message)
+{
+   std::cout << "warning: " << message << std::endl;
+}
+
+
+// Indentation settings for Vim and Emacs and unique identifier for Arch, a
+// version control system. Please do not modify past this point.
+//
+// Local Variables:
+// c-basic-offset: 3
+// indent-tabs-mode: nil
+// End:
+//
+// vim: et sts=3 sw=3